@@ -52,7 +52,9 @@ T getArg(const CommandLineArgs& args, unsigned int idx, const T& defaultVal) {
 //===========================================
 // AppConfig::AppConfig
 //===========================================
-AppConfig::AppConfig(int argc, char** argv) {
+AppConfig::AppConfig(int argc, char** argv, const string& saveDataDir)
+  : m_saveDataDir(saveDataDir) {
+
   for (int i = 1; i < argc; ++i) {
     this->args.push_back(argv[i]);
   }
@@ -80,6 +82,27 @@ AppConfig::AppConfig(int argc, char** argv) {
 // AppConfig::loadState
 //===========================================
 void AppConfig::loadState() {
+  m_journal.reset(new StateJournal(saveDataPath("procalc")));
+
+  if (!m_journal->load()) {
+    DBG_PRINT("No saved state journal\n");
+    loadLegacyState();
+  }
+
+  auto& params = m_journal->state();
+  auto it = params.find("state-id");
+
+  if (it != params.end()) {
+    this->stateId = convert<int>(it->second);
+  }
+}
+
+//===========================================
+// AppConfig::loadLegacyState
+//
+// Earlier versions saved the whole state to procalc.dat on exit
+//===========================================
+void AppConfig::loadLegacyState() {
   string filePath = saveDataPath("procalc.dat");
 
   XMLDocument doc;
@@ -92,15 +115,12 @@ void AppConfig::loadState() {
     while (e != nullptr) {
       string tagName(e->Name());
 
-      m_params[tagName] = e->GetText();
+      m_journal->set(tagName, e->GetText());
 
       DBG_PRINT("Loaded param " << tagName << "=" << e->GetText() << "\n");
 
       e = e->NextSiblingElement();
     }
-
-    this->stateId = convert<int>(GET_VALUE(m_params, "state-id"));
-    m_params.erase("state-id");
   }
   else {
     DBG_PRINT("Could not load procalc.dat\n");
@@ -109,6 +129,8 @@ void AppConfig::loadState() {
 
 //===========================================
 // AppConfig::persistState
+//
+// Only the params that have changed since the last call are written
 //===========================================
 void AppConfig::persistState() {
   DBG_PRINT("Persisting state id " << this->stateId << "\n");
@@ -116,45 +138,22 @@ void AppConfig::persistState() {
   QDir rootDir{"/"};
   rootDir.mkpath(saveDataPath("").c_str());
 
-  string filePath = saveDataPath("procalc.dat");
-
-  XMLDocument doc;
-  XMLElement* root = doc.NewElement("config");
-
-  doc.InsertEndChild(root);
-
-  XMLElement* e = doc.NewElement("state-id");
-  e->SetText(this->stateId);
-
-  root->InsertEndChild(e);
-
-  for (auto it = m_params.begin(); it != m_params.end(); ++it) {
-    auto& name = it->first;
-    auto& value = it->second;
-
-    DBG_PRINT("Persisting param " << name << "=" << value << "\n");
-
-    XMLElement* e = doc.NewElement(name.c_str());
-    e->SetText(value.c_str());
-
-    root->InsertEndChild(e);
-  }
-
-  doc.SaveFile(filePath.c_str());
+  m_journal->set("state-id", std::to_string(this->stateId));
+  m_journal->commit();
 }
 
 //===========================================
 // AppConfig::getParam
 //===========================================
 const string& AppConfig::getParam(const string& name) const {
-  return GET_VALUE(m_params, name);
+  return GET_VALUE(m_journal->state(), name);
 }
 
 //===========================================
 // AppConfig::setParam
 //===========================================
 void AppConfig::setParam(const string& name, const string& value) {
-  m_params[name] = value;
+  m_journal->set(name, value);
 }
 
 //===========================================
@@ -244,6 +243,10 @@ string AppConfig::dataPath(const string& relPath) const {
 // AppConfig::saveDataPath
 //===========================================
 string AppConfig::saveDataPath(const string& relPath) const {
+  if (m_saveDataDir.length() > 0) {
+    return m_saveDataDir + "/" + relPath;
+  }
+
 #ifdef DEBUG
   return QCoreApplication::applicationDirPath().toStdString() + "/" + relPath;
 #else
@@ -3,10 +3,11 @@
 
 
 #include <string>
-#include <map>
+#include <memory>
 #include <vector>
 #include <QFont>
 #include "event.hpp"
+#include "state_journal.hpp"
 
 
 struct RequestStateChangeEvent : public Event {
@@ -33,7 +34,8 @@ class AppConfig {
   public:
     typedef std::vector<std::string> CommandLineArgs;
 
-    AppConfig(int argc, char** argv);
+    // saveDataDir overrides where state is saved, e.g. so tests don't touch the user's save
+    AppConfig(int argc, char** argv, const std::string& saveDataDir = "");
 
     void persistState();
 
@@ -57,10 +59,12 @@ class AppConfig {
 
   private:
     void loadState();
+    void loadLegacyState();
     std::string versionFilePath() const;
     void readVersionFile();
 
-    std::map<std::string, std::string> m_params;
+    std::string m_saveDataDir;
+    std::unique_ptr<StateJournal> m_journal;
 };
 
 
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include "console_output.hpp"
+#include "exception.hpp"
+
+
+using std::string;
+using std::vector;
+using std::lock_guard;
+using std::mutex;
+
+
+//===========================================
+// ConsoleOutput::ConsoleOutput
+//===========================================
+ConsoleOutput::ConsoleOutput(size_t maxLines)
+  : m_lines(maxLines),
+    m_cancelled(false) {
+
+  if (maxLines == 0) {
+    EXCEPTION("Error constructing ConsoleOutput; maxLines must be at least 1");
+  }
+}
+
+//===========================================
+// ConsoleOutput::writeLine
+//
+// When the buffer is full the oldest line is overwritten. Assigning into the existing string
+// reuses its storage, and take() leaves a string with storage in each slot it empties, so a
+// steady stream of lines doesn't allocate.
+//===========================================
+void ConsoleOutput::writeLine(const string& line) {
+  lock_guard<mutex> lock(m_mutex);
+
+  if (m_count == m_lines.size()) {
+    m_lines[m_first].assign(line);
+    m_first = (m_first + 1) % m_lines.size();
+    ++m_numDropped;
+  }
+  else {
+    m_lines[(m_first + m_count) % m_lines.size()].assign(line);
+    ++m_count;
+  }
+}
+
+//===========================================
+// ConsoleOutput::close
+//===========================================
+void ConsoleOutput::close() {
+  lock_guard<mutex> lock(m_mutex);
+  m_closed = true;
+}
+
+//===========================================
+// ConsoleOutput::cancel
+//===========================================
+void ConsoleOutput::cancel() {
+  m_cancelled = true;
+}
+
+//===========================================
+// ConsoleOutput::cancelled
+//===========================================
+bool ConsoleOutput::cancelled() const {
+  return m_cancelled;
+}
+
+//===========================================
+// ConsoleOutput::take
+//===========================================
+bool ConsoleOutput::take(vector<string>& out, size_t maxLines) {
+  lock_guard<mutex> lock(m_mutex);
+
+  size_t n = std::min(m_count, maxLines);
+
+  if (out.size() < n) {
+    out.resize(n);
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    out[i].swap(m_lines[(m_first + i) % m_lines.size()]);
+  }
+
+  out.resize(n);
+
+  m_first = (m_first + n) % m_lines.size();
+  m_count -= n;
+
+  return m_closed && m_count == 0;
+}
+
+//===========================================
+// ConsoleOutput::reset
+//===========================================
+void ConsoleOutput::reset() {
+  lock_guard<mutex> lock(m_mutex);
+
+  m_first = 0;
+  m_count = 0;
+  m_numDropped = 0;
+  m_closed = false;
+  m_cancelled = false;
+}
+
+//===========================================
+// ConsoleOutput::maxLines
+//===========================================
+size_t ConsoleOutput::maxLines() const {
+  return m_lines.size();
+}
+
+//===========================================
+// ConsoleOutput::numWaiting
+//===========================================
+size_t ConsoleOutput::numWaiting() const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_count;
+}
+
+//===========================================
+// ConsoleOutput::numDropped
+//===========================================
+unsigned long ConsoleOutput::numDropped() const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_numDropped;
+}
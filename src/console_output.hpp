@@ -0,0 +1,59 @@
+#ifndef __PROCALC_CONSOLE_OUTPUT_HPP__
+#define __PROCALC_CONSOLE_OUTPUT_HPP__
+
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <limits>
+
+
+// The output of a console command, which may be written from a worker thread while the console
+// takes it a frame at a time.
+//
+// Lines wait in a ring buffer. Only the most recent maxLines are kept, as the console would drop
+// any older ones from its scrollback anyway, so memory stays bounded however fast a command
+// writes. Writers never wait on the console.
+class ConsoleOutput {
+  public:
+    explicit ConsoleOutput(size_t maxLines);
+
+    ConsoleOutput(const ConsoleOutput& cpy) = delete;
+
+    void writeLine(const std::string& line);
+    // Called once the command has finished writing
+    void close();
+
+    // Asks the command to stop. Long running commands should check cancelled() regularly.
+    void cancel();
+    bool cancelled() const;
+
+    // Replaces the contents of out with up to maxLines of the waiting lines, oldest first. Returns
+    // true once the output is closed and there's nothing left to take.
+    //
+    // The lines are swapped with the strings already in out, whose storage later writes then
+    // reuse. So if the same vector is passed each time, neither side allocates once warmed up.
+    bool take(std::vector<std::string>& out,
+      size_t maxLines = std::numeric_limits<size_t>::max());
+
+    // Readies the output for another command
+    void reset();
+
+    size_t maxLines() const;
+    size_t numWaiting() const;
+    // The number of lines written that were dropped before they could be taken
+    unsigned long numDropped() const;
+
+  private:
+    mutable std::mutex m_mutex;
+    std::vector<std::string> m_lines;
+    size_t m_first = 0;
+    size_t m_count = 0;
+    unsigned long m_numDropped = 0;
+    bool m_closed = false;
+    std::atomic<bool> m_cancelled;
+};
+
+
+#endif
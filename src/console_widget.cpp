@@ -1,4 +1,5 @@
 #include <sstream>
+#include <QKeyEvent>
 #include "console_widget.hpp"
 #include "app_config.hpp"
 
@@ -9,13 +10,20 @@ using std::stringstream;
 using std::istream_iterator;
 
 
+static const int FRAME_RATE = 60;
+
+
 //===========================================
 // ConsoleWidget::ConsoleWidget
 //===========================================
-ConsoleWidget::ConsoleWidget(const AppConfig& appConfig, const string& initialContent,
-  vector<string> initialHistory)
+ConsoleWidget::ConsoleWidget(const AppConfig& appConfig, FrameScheduler& frameScheduler,
+  const string& initialContent, vector<string> initialHistory, int maxLines,
+  int maxLinesPerFrame)
   : QPlainTextEdit(nullptr),
-    m_commandHistory(initialHistory.begin(), initialHistory.end()) {
+    m_frameScheduler(frameScheduler),
+    m_commandHistory(initialHistory.begin(), initialHistory.end()),
+    m_output(maxLines),
+    m_maxLinesPerFrame(maxLinesPerFrame) {
 
   setMinimumWidth(330);
 
@@ -28,9 +36,15 @@ ConsoleWidget::ConsoleWidget(const AppConfig& appConfig, const string& initialCo
   font.setPixelSize(12);
   document()->setDefaultFont(font);
 
+  // Otherwise every line ever output would be kept on the undo stack
+  setUndoRedoEnabled(false);
+  setMaximumBlockCount(maxLines);
+
   insertPlainText(initialContent.c_str());
 
-  m_commandPos = textCursor().position();
+  m_hFlush = m_frameScheduler.add("ConsoleWidget", 1000 / FRAME_RATE, [this]() {
+    flushOutput();
+  }, FrameScheduler::PRIORITY_NORMAL, false);
 }
 
 //===========================================
@@ -40,10 +54,19 @@ void ConsoleWidget::addCommand(const string& name, const ConsoleWidget::CommandF
   m_commandFns[name] = fn;
 }
 
+//===========================================
+// ConsoleWidget::addStreamingCommand
+//===========================================
+void ConsoleWidget::addStreamingCommand(const string& name,
+  const ConsoleWidget::StreamingCommandFn& fn) {
+
+  m_streamingCommandFns[name] = fn;
+}
+
 //===========================================
 // ConsoleWidget::executeCommand
 //===========================================
-string ConsoleWidget::executeCommand(const string& commandString) {
+void ConsoleWidget::executeCommand(const string& commandString) {
   string output;
   stringstream ss(commandString);
   ArgList vec{istream_iterator<string>(ss), istream_iterator<string>{}};
@@ -54,16 +77,86 @@ string ConsoleWidget::executeCommand(const string& commandString) {
     const string& cmd = vec[0];
     ArgList args(++vec.begin(), vec.end());
 
-    auto it = m_commandFns.find(cmd);
-    if (it != m_commandFns.end()) {
-      output = it->second(args);
+    auto it = m_streamingCommandFns.find(cmd);
+    if (it != m_streamingCommandFns.end()) {
+      startCommand(it->second, args);
+      return;
+    }
+
+    auto jt = m_commandFns.find(cmd);
+    if (jt != m_commandFns.end()) {
+      output = jt->second(args);
     }
     else {
       output = "Unknown command";
     }
   }
 
-  return output;
+  insertPlainText(("\n" + output + "\n> ").c_str());
+}
+
+//===========================================
+// ConsoleWidget::startCommand
+//===========================================
+void ConsoleWidget::startCommand(const StreamingCommandFn& fn, const ArgList& args) {
+  m_output.reset();
+  m_running = true;
+
+  m_worker = std::thread([this, fn, args]() {
+    try {
+      fn(args, m_output);
+    }
+    catch (const std::exception& e) {
+      m_output.writeLine(e.what());
+    }
+
+    m_output.close();
+  });
+
+  m_frameScheduler.setActive(m_hFlush, true);
+}
+
+//===========================================
+// ConsoleWidget::flushOutput
+//
+// What the command has written since the last frame goes in with one edit, up to
+// m_maxLinesPerFrame lines so that the edit's cost is bounded. The rest wait for later frames.
+// Lines pushed out of the scrollback by the edit are removed by the document.
+//===========================================
+void ConsoleWidget::flushOutput() {
+  bool finished = m_output.take(m_lines, m_maxLinesPerFrame);
+
+  m_text.clear();
+  for (const string& line : m_lines) {
+    m_text.append("\n");
+    m_text.append(line);
+  }
+
+  if (finished) {
+    m_text.append("\n> ");
+  }
+
+  if (!m_text.empty()) {
+    cursorToEnd();
+    insertPlainText(QString::fromStdString(m_text));
+  }
+
+  if (finished) {
+    finishCommand();
+  }
+}
+
+//===========================================
+// ConsoleWidget::finishCommand
+//===========================================
+void ConsoleWidget::finishCommand() {
+  m_frameScheduler.setActive(m_hFlush, false);
+
+  if (m_worker.joinable()) {
+    m_worker.join();
+  }
+
+  m_running = false;
 }
 
 //===========================================
@@ -75,21 +168,27 @@ void ConsoleWidget::cursorToEnd() {
   setTextCursor(cursor);
 }
 
+//===========================================
+// ConsoleWidget::commandPos
+//
+// Measured back from the end of the document, as blocks may have been removed from the start
+//===========================================
+int ConsoleWidget::commandPos() const {
+  return document()->characterCount() - 1 - m_commandLength;
+}
+
 //===========================================
 // ConsoleWidget::applyCommand
 //===========================================
 void ConsoleWidget::applyCommand() {
   cursorToEnd();
 
-  string output = executeCommand(m_buffer.toPlainText().toStdString());
-
-  insertPlainText("\n");
-  insertPlainText(output.c_str());
-  insertPlainText("\n> ");
-
-  m_commandPos = textCursor().position();
+  string commandString = m_buffer.toPlainText().toStdString();
 
   m_buffer.clear();
+  m_commandLength = 0;
+
+  executeCommand(commandString);
 }
 
 //===========================================
@@ -97,29 +196,38 @@ void ConsoleWidget::applyCommand() {
 //===========================================
 void ConsoleWidget::resetCursorPos() {
   QTextCursor cursor = textCursor();
-  cursor.setPosition(m_commandPos + m_buffer.textCursor().position());
+  cursor.setPosition(commandPos() + m_buffer.textCursor().position());
   setTextCursor(cursor);
 }
 
 //===========================================
 // ConsoleWidget::syncCommandText
+//
+// Replaces the command in one edit
 //===========================================
 void ConsoleWidget::syncCommandText() {
   QTextCursor cursor = textCursor();
-  cursor.setPosition(m_commandPos);
-
-  while (!cursor.atEnd()) {
-    cursor.deleteChar();
-  }
+  cursor.setPosition(commandPos());
+  cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
 
   QString str = m_buffer.toPlainText();
-  insertPlainText(str);
+  cursor.insertText(str);
+
+  m_commandLength = str.length();
 }
 
 //===========================================
 // ConsoleWidget::keyPressEvent
 //===========================================
 void ConsoleWidget::keyPressEvent(QKeyEvent* event) {
+  if (m_running) {
+    if (event->key() == Qt::Key_C && (event->modifiers() & Qt::ControlModifier)) {
+      m_output.cancel();
+    }
+
+    return;
+  }
+
   resetCursorPos();
 
   switch (event->key()) {
@@ -157,3 +265,14 @@ void ConsoleWidget::keyPressEvent(QKeyEvent* event) {
 
   resetCursorPos();
 }
+
+//===========================================
+// ConsoleWidget::~ConsoleWidget
+//===========================================
+ConsoleWidget::~ConsoleWidget() {
+  m_output.cancel();
+
+  if (m_worker.joinable()) {
+    m_worker.join();
+  }
+}
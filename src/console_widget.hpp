@@ -7,22 +7,39 @@
 #include <vector>
 #include <functional>
 #include <deque>
+#include <thread>
 #include <QPlainTextEdit>
+#include "console_output.hpp"
+#include "frame_scheduler.hpp"
 
 
 class AppConfig;
 
+// Only the last maxLines lines are kept in the scrollback.
+//
+// A streaming command runs on a worker thread and writes its output a line at a time. Up to
+// maxLinesPerFrame of the lines are gathered into the scrollback once per frame, with a single
+// edit, until the command finishes. Until then, key presses are ignored except Ctrl+C, which
+// cancels the command.
 class ConsoleWidget : public QPlainTextEdit {
   Q_OBJECT
 
   public:
+    static const int DEFAULT_MAX_LINES = 10000;
+    static const int DEFAULT_MAX_LINES_PER_FRAME = 500;
+
     typedef std::vector<std::string> ArgList;
     typedef std::function<std::string(const ArgList&)> CommandFn;
+    typedef std::function<void(const ArgList&, ConsoleOutput&)> StreamingCommandFn;
 
-    ConsoleWidget(const AppConfig& appConfig, const std::string& initialContent,
-      std::vector<std::string> initialHistory = {});
+    ConsoleWidget(const AppConfig& appConfig, FrameScheduler& frameScheduler,
+      const std::string& initialContent, std::vector<std::string> initialHistory = {},
+      int maxLines = DEFAULT_MAX_LINES, int maxLinesPerFrame = DEFAULT_MAX_LINES_PER_FRAME);
 
     void addCommand(const std::string& name, const CommandFn& fn);
+    void addStreamingCommand(const std::string& name, const StreamingCommandFn& fn);
+
+    ~ConsoleWidget() override;
 
   protected:
     void keyPressEvent(QKeyEvent* event) override;
@@ -35,15 +52,33 @@ class ConsoleWidget : public QPlainTextEdit {
     } m_buffer;
 
     void applyCommand();
-    std::string executeCommand(const std::string& cmd);
+    void executeCommand(const std::string& cmd);
+    void startCommand(const StreamingCommandFn& fn, const ArgList& args);
+    void flushOutput();
+    void finishCommand();
+    int commandPos() const;
     void resetCursorPos();
     void cursorToEnd();
     void syncCommandText();
 
-    int m_commandPos;
+    FrameScheduler& m_frameScheduler;
+    FrameScheduler::Handle m_hFlush;
+
+    // The length of the command being typed, which sits at the end of the document
+    int m_commandLength = 0;
     std::deque<std::string> m_commandHistory;
     int m_historyIdx = -1;
     std::map<std::string, CommandFn> m_commandFns;
+    std::map<std::string, StreamingCommandFn> m_streamingCommandFns;
+
+    ConsoleOutput m_output;
+    int m_maxLinesPerFrame;
+    std::thread m_worker;
+    bool m_running = false;
+
+    // Scratch space, kept between calls to avoid reallocating
+    std::vector<std::string> m_lines;
+    std::string m_text;
 };
 
 
@@ -1,4 +1,9 @@
 #include <random>
+#include <array>
+#include <vector>
+#include <thread>
+#include <cmath>
+#include <cstring>
 #include <QWidget>
 #include <QImage>
 #include "effects.hpp"
@@ -7,10 +12,21 @@
 
 
 using std::function;
+using std::vector;
 
 
 static std::mt19937 randEngine;
 
+// Images smaller than this (in pixels) aren't worth splitting across threads
+static const int MIN_PIXELS_PER_THREAD = 128 * 128;
+
+// Hue rotation matrices are stored in fixed point with this many fractional bits
+static const int HUE_FRAC_BITS = 12;
+
+struct HueMatrix {
+  int m[9];
+};
+
 
 //===========================================
 // mod
@@ -24,32 +40,191 @@ inline static int mod(int n, int quot) {
   }
 }
 
+//===========================================
+// hueMatrices
+//
+// One matrix per degree, rotating colours about the grey axis of the RGB cube. This is close to,
+// but not exactly, a shift of the HSV hue, and avoids converting each pixel to HSV and back.
+//===========================================
+static const std::array<HueMatrix, 360>& hueMatrices() {
+  static const std::array<HueMatrix, 360> matrices = []() {
+    std::array<HueMatrix, 360> matrices;
+
+    const double k = 1.0 / 3.0;
+    const double sqrtK = std::sqrt(k);
+    const double scale = 1 << HUE_FRAC_BITS;
+
+    for (int deg = 0; deg < 360; ++deg) {
+      double a = deg * 3.14159265358979323846 / 180.0;
+      double cosA = std::cos(a);
+      double sinA = std::sin(a);
+
+      double diag = cosA + (1.0 - cosA) * k;
+      double p = k * (1.0 - cosA) - sqrtK * sinA;
+      double q = k * (1.0 - cosA) + sqrtK * sinA;
+
+      double m[9] = {
+        diag, p, q,
+        q, diag, p,
+        p, q, diag
+      };
+
+      for (int i = 0; i < 9; ++i) {
+        matrices[deg].m[i] = static_cast<int>(std::round(m[i] * scale));
+      }
+    }
+
+    return matrices;
+  }();
+
+  return matrices;
+}
+
+//===========================================
+// clampChannel
+//
+// Takes a fixed point value and returns it as an integer in the range [0, 255]. Written without
+// branches so the loops calling it can be vectorised.
+//===========================================
+inline static unsigned int clampChannel(int x) {
+  const int max = 255 << HUE_FRAC_BITS;
+
+  x = x < 0 ? 0 : x;
+  x = x > max ? max : x;
+
+  return static_cast<unsigned int>(x + (1 << (HUE_FRAC_BITS - 1))) >> HUE_FRAC_BITS;
+}
+
+//===========================================
+// rotateHueRow
+//===========================================
+static void rotateHueRow(QRgb* pixels, int w, const HueMatrix& mat) {
+  const int* m = mat.m;
+
+  for (int i = 0; i < w; ++i) {
+    int r = (pixels[i] >> 16) & 0xff;
+    int g = (pixels[i] >> 8) & 0xff;
+    int b = pixels[i] & 0xff;
+
+    unsigned int r_ = clampChannel(m[0] * r + m[1] * g + m[2] * b);
+    unsigned int g_ = clampChannel(m[3] * r + m[4] * g + m[5] * b);
+    unsigned int b_ = clampChannel(m[6] * r + m[7] * g + m[8] * b);
+
+    pixels[i] = 0xff000000 | (r_ << 16) | (g_ << 8) | b_;
+  }
+}
+
+//===========================================
+// colourizeRow
+//
+// Blends each pixel towards the colour (r, g, b) by weight / 256. Ignores alpha.
+//===========================================
+static void colourizeRow(QRgb* pixels, int w, int r, int g, int b, int weight) {
+  int inv = 256 - weight;
+
+  r *= weight;
+  g *= weight;
+  b *= weight;
+
+  for (int i = 0; i < w; ++i) {
+    unsigned int r_ = ((((pixels[i] >> 16) & 0xff) * inv) + r) >> 8;
+    unsigned int g_ = ((((pixels[i] >> 8) & 0xff) * inv) + g) >> 8;
+    unsigned int b_ = (((pixels[i] & 0xff) * inv) + b) >> 8;
+
+    pixels[i] = 0xff000000 | (r_ << 16) | (g_ << 8) | b_;
+  }
+}
+
+//===========================================
+// forEachRowRange
+//
+// Calls fn(from, to) over ranges of rows covering [0, h), splitting them across threads if the
+// image is large enough. The ranges must be independent of one another.
+//===========================================
+static void forEachRowRange(int w, int h, const function<void(int, int)>& fn) {
+#ifdef SINGLE_THREAD
+  fn(0, h);
+#else
+  int numThreads = std::thread::hardware_concurrency();
+  int maxThreads = static_cast<int>(static_cast<long>(w) * h / MIN_PIXELS_PER_THREAD);
+
+  numThreads = std::min(numThreads, std::min(maxThreads, h));
+
+  if (numThreads <= 1) {
+    fn(0, h);
+    return;
+  }
+
+  vector<std::thread> threads(numThreads - 1);
+
+  int perThread = h / numThreads;
+  int remainder = h % numThreads;
+
+  for (int i = 0; i < numThreads - 1; ++i) {
+    threads[i] = std::thread{fn, i * perThread, (i + 1) * perThread};
+  }
+
+  fn((numThreads - 1) * perThread, numThreads * perThread + remainder);
+
+  for (auto& t : threads) {
+    t.join();
+  }
+#endif
+}
+
+//===========================================
+// ensure32Bit
+//===========================================
+inline static void ensure32Bit(QImage& img) {
+  if (img.format() != QImage::Format_ARGB32 && img.format() != QImage::Format_RGB32) {
+    img = img.convertToFormat(QImage::Format_ARGB32);
+  }
+}
+
 //===========================================
 // rotateHue
 //===========================================
 void rotateHue(QImage& img, int deg) {
-  for (int i = 0; i < img.width(); ++i) {
-    for (int j = 0; j < img.height(); ++j) {
-      QColor c = img.pixel(i, j);
+  ensure32Bit(img);
 
-      c.setHsv((c.hue() + deg) % 360, c.saturation(), c.value());
-      img.setPixel(i, j, c.rgb());
+  const HueMatrix& mat = hueMatrices()[mod(deg, 360)];
+  int w = img.width();
+
+  // Detach here rather than from the worker threads
+  uchar* bits = img.bits();
+  int bytesPerLine = img.bytesPerLine();
+
+  forEachRowRange(w, img.height(), [=, &mat](int from, int to) {
+    for (int j = from; j < to; ++j) {
+      rotateHueRow(reinterpret_cast<QRgb*>(bits + j * bytesPerLine), w, mat);
     }
-  }
+  });
 }
 
 //===========================================
 // colourize
 //===========================================
 void colourize(QImage& img, const QColor& c, double x) {
+  if (x < 0.0 || x > 1.0) {
+    EXCEPTION("Tween val of " << x << " is out of range");
+  }
+
+  ensure32Bit(img);
+
   int w = img.width();
-  int h = img.height();
+  int weight = static_cast<int>(x * 256.0);
+  int r = c.red();
+  int g = c.green();
+  int b = c.blue();
 
-  for (int j = 0; j < h; ++j) {
-    for (int i = 0; i < w; ++i) {
-      img.setPixel(i, j, tweenColour(img.pixel(i, j), c, x).rgb());
+  uchar* bits = img.bits();
+  int bytesPerLine = img.bytesPerLine();
+
+  forEachRowRange(w, img.height(), [=](int from, int to) {
+    for (int j = from; j < to; ++j) {
+      colourizeRow(reinterpret_cast<QRgb*>(bits + j * bytesPerLine), w, r, g, b, weight);
     }
-  }
+  });
 }
 
 //===========================================
@@ -111,31 +286,70 @@ void setBackgroundImage(QWidget& widget, const QString& path) {
 
 //===========================================
 // garbleImage
+//
+// Shifts random bands of rows horizontally, then tints and hue-rotates the result, in a single
+// pass over each row
 //===========================================
-void garbleImage(const QImage& src, QImage& dest) {
-  if (src.size() != dest.size()) {
+void garbleImage(const QImage& src_, QImage& dest) {
+  if (src_.size() != dest.size()) {
     EXCEPTION("Source and destination images must be of same size");
   }
 
+  if (dest.format() != QImage::Format_ARGB32 && dest.format() != QImage::Format_RGB32) {
+    EXCEPTION("Destination image must be 32-bit");
+  }
+
+  QImage converted;
+  const QImage* src = &src_;
+
+  if (src_.format() != QImage::Format_ARGB32 && src_.format() != QImage::Format_RGB32) {
+    converted = src_.convertToFormat(QImage::Format_ARGB32);
+    src = &converted;
+  }
+
   int w = dest.width();
   int h = dest.height();
 
+  if (w == 0 || h == 0) {
+    return;
+  }
+
+  // The random numbers are drawn up front, on this thread, in the same order as always
   const double prob = 0.03;
   std::uniform_int_distribution<int> rollDie(0, 1.0 / prob);
   std::normal_distribution<double> randShift(0, 10);
   int shift = randShift(randEngine);
 
+  vector<int> shifts(h);
+
   for (int j = 0; j < h; ++j) {
     if (rollDie(randEngine) == 0) {
       shift = randShift(randEngine);
     }
 
-    for (int i = 0; i < w; ++i) {
-      dest.setPixel(i, j, src.pixel(mod(i + shift, w), j));
-    }
+    shifts[j] = mod(shift, w);
   }
 
   std::uniform_int_distribution<int> randHue(0, 359);
-  colourize(dest, QColor(255, 0, 0), 0.08);
-  rotateHue(dest, randHue(randEngine));
+  const HueMatrix& mat = hueMatrices()[randHue(randEngine)];
+
+  const QColor tint(255, 0, 0);
+  const int weight = static_cast<int>(0.08 * 256.0);
+
+  uchar* bits = dest.bits();
+  int bytesPerLine = dest.bytesPerLine();
+
+  forEachRowRange(w, h, [&](int from, int to) {
+    for (int j = from; j < to; ++j) {
+      const QRgb* srcRow = reinterpret_cast<const QRgb*>(src->constScanLine(j));
+      QRgb* destRow = reinterpret_cast<QRgb*>(bits + j * bytesPerLine);
+      int s = shifts[j];
+
+      memcpy(destRow, srcRow + s, (w - s) * sizeof(QRgb));
+      memcpy(destRow + w - s, srcRow, s * sizeof(QRgb));
+
+      colourizeRow(destRow, w, tint.red(), tint.green(), tint.blue(), weight);
+      rotateHueRow(destRow, w, mat);
+    }
+  });
 }
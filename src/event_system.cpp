@@ -6,7 +6,6 @@
 
 
 using std::string;
-using std::map;
 using std::vector;
 
 
@@ -36,6 +35,53 @@ bool EventSystem::event(QEvent* e) {
   return QObject::event(e);
 }
 
+//===========================================
+// EventSystem::EventSystem
+//===========================================
+EventSystem::EventSystem() {
+  // The root node, whose handlers receive every event
+  m_nodes.push_back(Node());
+  m_nodes[0].chain.push_back(0);
+  m_nodeIds[""] = 0;
+}
+
+//===========================================
+// EventSystem::nodeId
+//
+// Interns the name, along with each of its dotted prefixes
+//===========================================
+int EventSystem::nodeId(const string& name) {
+  auto it = m_nodeIds.find(name);
+  if (it != m_nodeIds.end()) {
+    return it->second;
+  }
+
+  size_t dot = name.find_last_of('.');
+  int parentId = dot == string::npos ? 0 : nodeId(name.substr(0, dot));
+
+  int id = static_cast<int>(m_nodes.size());
+
+  Node node;
+  node.chain = m_nodes[parentId].chain;
+  node.chain.push_back(id);
+
+  m_nodes.push_back(std::move(node));
+  m_nodeIds[name] = id;
+
+  return id;
+}
+
+//===========================================
+// EventSystem::add_
+//===========================================
+void EventSystem::add_(const string& name, int id, handlerFunc_t fn) {
+  int nId = nodeId(name);
+  Node& node = m_nodes[nId];
+
+  m_locations[id] = Location{nId, node.listeners.size()};
+  node.listeners.push_back(Listener{id, std::move(fn)});
+}
+
 //===========================================
 // EventSystem::listen
 //===========================================
@@ -43,22 +89,59 @@ EventSystem::Handle EventSystem::listen(const string& name, handlerFunc_t fn) {
   static int nextId = 0;
 
   if (m_processingEvent) {
-    m_pendingAddition[name][nextId] = fn;
+    m_pendingAddition.push_back(PendingAddition{name, nextId, fn});
   }
   else {
-    m_handlers[name][nextId] = fn;
+    add_(name, nextId, fn);
   }
 
   return Handle{shared_from_this(), nextId++};
 }
 
+//===========================================
+// EventSystem::compact
+//
+// Closes the gaps left by forgotten listeners, preserving the order of the rest
+//===========================================
+void EventSystem::compact(Node& node) {
+  size_t n = 0;
+
+  for (size_t i = 0; i < node.listeners.size(); ++i) {
+    if (node.listeners[i].fn) {
+      if (i != n) {
+        node.listeners[n] = std::move(node.listeners[i]);
+        m_locations[node.listeners[n].id].index = n;
+      }
+
+      ++n;
+    }
+  }
+
+  node.listeners.erase(node.listeners.begin() + n, node.listeners.end());
+  node.numForgotten = 0;
+}
+
 //===========================================
 // EventSystem::forget_
+//
+// Compaction is deferred until at least half the node's listeners have been forgotten, so the
+// cost is constant when amortised
 //===========================================
 void EventSystem::forget_(int id) {
-  for (auto it = m_handlers.begin(); it != m_handlers.end(); ++it) {
-    map<int, handlerFunc_t>& fns = it->second;
-    fns.erase(id);
+  auto it = m_locations.find(id);
+  if (it == m_locations.end()) {
+    return;
+  }
+
+  Node& node = m_nodes[it->second.node];
+
+  node.listeners[it->second.index].fn = nullptr;
+  ++node.numForgotten;
+
+  m_locations.erase(it);
+
+  if (node.numForgotten * 2 >= node.listeners.size()) {
+    compact(node);
   }
 }
 
@@ -71,7 +154,7 @@ void EventSystem::forget(Handle& handle) {
   }
 
   if (m_processingEvent) {
-    m_pendingForget.insert(handle.id);
+    m_pendingForget.push_back(handle.id);
   }
   else {
     forget_(handle.id);
@@ -84,16 +167,8 @@ void EventSystem::forget(Handle& handle) {
 // EventSystem::addPending
 //===========================================
 void EventSystem::addPending() {
-  for (auto it = m_pendingAddition.begin(); it != m_pendingAddition.end(); ++it) {
-    string name = it->first;
-    auto handlersById = it->second;
-
-    for (auto jt = handlersById.begin(); jt != handlersById.end(); ++jt) {
-      int id = jt->first;
-      auto handlerFn = jt->second;
-
-      m_handlers[name][id] = handlerFn;
-    }
+  for (auto& pending : m_pendingAddition) {
+    add_(pending.name, pending.id, std::move(pending.fn));
   }
 
   m_pendingAddition.clear();
@@ -103,8 +178,8 @@ void EventSystem::addPending() {
 // EventSystem::forgetPending
 //===========================================
 void EventSystem::forgetPending() {
-  for (auto it = m_pendingForget.begin(); it != m_pendingForget.end(); ++it) {
-    forget_(*it);
+  for (int id : m_pendingForget) {
+    forget_(id);
   }
 
   m_pendingForget.clear();
@@ -119,51 +194,57 @@ void EventSystem::processingStart() {
 
 //===========================================
 // EventSystem::processingEnd
+//
+// Handlers added during processing are added first, so that any forgotten during the same event
+// are forgotten
 //===========================================
 void EventSystem::processingEnd() {
-  forgetPending();
   addPending();
+  forgetPending();
 
   m_processingEvent = false;
 }
 
 //===========================================
-// EventSystem::processEvent_
+// EventSystem::processEvent
+//
+// Additions and removals made by handlers are deferred until the outermost call returns, so no
+// listener list changes while it's being walked. Nodes are still indexed rather than referenced,
+// as a nested call may intern new names.
 //===========================================
-void EventSystem::processEvent_(const string& name, const Event& event) {
-  DBG_PRINT("Calling handlers for: " << name << "\n");
-
-  auto it = m_handlers.find(name);
-  if (it != m_handlers.end()) {
-    const map<int, handlerFunc_t>& fns = it->second;
+void EventSystem::processEvent(const Event& event) {
+  int id = nodeId(event.name);
 
-    for (auto jt = fns.begin(); jt != fns.end(); ++jt) {
-      jt->second(event);
-    }
+  bool nested = m_processingEvent;
+  if (!nested) {
+    processingStart();
   }
-}
 
-//===========================================
-// EventSystem::processEvent
-//===========================================
-void EventSystem::processEvent(const Event& event) {
-  processingStart();
+  size_t depth = m_nodes[id].chain.size();
 
-  vector<string> v = splitString(event.name, '.');
-  string name;
+  for (size_t i = 0; i < depth; ++i) {
+    int n = m_nodes[id].chain[i];
+    size_t numListeners = m_nodes[n].listeners.size();
 
-  processEvent_(name, event);
+    for (size_t j = 0; j < numListeners; ++j) {
+      const Listener& listener = m_nodes[n].listeners[j];
 
-  for (auto it = v.begin(); it != v.end(); ++it) {
-    if (name.length() > 0) {
-      name.append(".");
+      if (listener.fn) {
+        listener.fn(event);
+      }
     }
-    name.append(*it);
+  }
 
-    processEvent_(name, event);
+  if (!nested) {
+    processingEnd();
   }
+}
 
-  processingEnd();
+//===========================================
+// EventSystem::isAppEvent
+//===========================================
+bool EventSystem::isAppEvent(const QEvent& event) {
+  return event.type() == CUSTOM_EVENT_TYPE;
 }
 
 //===========================================
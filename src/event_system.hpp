@@ -3,17 +3,27 @@
 
 
 #include <functional>
-#include <map>
-#include <set>
+#include <string>
+#include <vector>
+#include <unordered_map>
 #include <QObject>
 #include "event.hpp"
 
 
 typedef std::function<void(const Event&)> handlerFunc_t;
 
+// Handlers listening for an event name are also called for any event whose name extends it with
+// further dotted components, e.g. a handler for "a.b" receives "a.b.c".
+//
+// Each name is interned into a node that stores the chain of nodes for its dotted prefixes, so
+// dispatching an event is a single hash lookup followed by a walk over flat arrays. Once every
+// name in use has been seen, dispatch makes no heap allocations.
 class EventSystem : public QObject, public std::enable_shared_from_this<EventSystem> {
   Q_OBJECT
 
+  // So the tests can dispatch events without a Qt event loop
+  friend class EventSystemTest;
+
   public:
     class Handle {
       public:
@@ -61,25 +71,58 @@ class EventSystem : public QObject, public std::enable_shared_from_this<EventSys
         std::weak_ptr<EventSystem> m_eventSystem;
     };
 
+    EventSystem();
+
     Handle listen(const std::string& name, handlerFunc_t fn);
     void forget(Handle& handle);
     void fire(pEvent_t event);
 
+    // True for the events fire() posts, as opposed to Qt's own events sent to this object
+    static bool isAppEvent(const QEvent& event);
+
   private:
+    struct Listener {
+      int id;
+      handlerFunc_t fn;
+    };
+
+    struct Node {
+      // The root node, then the node for each dotted prefix of the name, ending with this node
+      std::vector<int> chain;
+      // In the order they were added. Forgotten listeners are left empty until compacted.
+      std::vector<Listener> listeners;
+      size_t numForgotten = 0;
+    };
+
+    struct Location {
+      int node;
+      size_t index;
+    };
+
+    struct PendingAddition {
+      std::string name;
+      int id;
+      handlerFunc_t fn;
+    };
+
     bool event(QEvent* event) override;
     void processEvent(const Event& event);
-    void processEvent_(const std::string& name, const Event& event);
+    int nodeId(const std::string& name);
+    void add_(const std::string& name, int id, handlerFunc_t fn);
     void forget_(int id);
+    void compact(Node& node);
     void processingStart();
     void processingEnd();
     void forgetPending();
     void addPending();
 
-    std::map<std::string, std::map<int, handlerFunc_t>> m_handlers;
+    std::vector<Node> m_nodes;
+    std::unordered_map<std::string, int> m_nodeIds;
+    std::unordered_map<int, Location> m_locations;
 
     bool m_processingEvent = false;
-    std::map<std::string, std::map<int, handlerFunc_t>> m_pendingAddition;
-    std::set<int> m_pendingForget;
+    std::vector<PendingAddition> m_pendingAddition;
+    std::vector<int> m_pendingForget;
 };
 
 typedef EventSystem::Handle EventHandle;
@@ -1,4 +1,5 @@
 #include <cassert>
+#include <chrono>
 #include "fragment.hpp"
 #include "fragment_spec.hpp"
 #include "fragment_factory.hpp"
@@ -46,7 +47,7 @@ const string& Fragment::name() const {
 //
 // Remove unused child fragments, recursively triggering their cleanUp methods
 //===========================================
-void Fragment::removeChildren(const FragmentSpec& spec, bool hardReset) {
+void Fragment::removeChildren(const FragmentSpec& spec, bool hardReset, RebuildStats& stats) {
   for (auto it = spec.specs().begin(); it != spec.specs().end(); ++it) {
     const string& chName = it->first;
     const FragmentSpec& chSpec = *it->second;
@@ -58,6 +59,8 @@ void Fragment::removeChildren(const FragmentSpec& spec, bool hardReset) {
 
         chFrag.detach();
         m_children.erase(jt);
+
+        ++stats.removed;
       }
     }
   }
@@ -68,7 +71,7 @@ void Fragment::removeChildren(const FragmentSpec& spec, bool hardReset) {
 //
 // Construct any newly enabled child fragments
 //===========================================
-void Fragment::constructNewChildren(const FragmentSpec& spec) {
+void Fragment::constructNewChildren(const FragmentSpec& spec, RebuildStats& stats) {
   for (auto it = spec.specs().begin(); it != spec.specs().end(); ++it) {
     const string& chName = it->first;
     const FragmentSpec& chSpec = *it->second;
@@ -77,6 +80,8 @@ void Fragment::constructNewChildren(const FragmentSpec& spec) {
       if (m_children.find(chName) == m_children.end()) {
         Fragment* frag = constructFragment(chSpec.type(), *this, m_ownData, commonData);
         m_children.insert(std::make_pair(chName, pFragment_t(frag)));
+
+        ++stats.constructed;
       }
     }
   }
@@ -84,24 +89,69 @@ void Fragment::constructNewChildren(const FragmentSpec& spec) {
 
 //===========================================
 // Fragment::rebuildChildren
+//
+// A child that has just been constructed has a disabled previous spec, so will be reloaded
 //===========================================
-void Fragment::rebuildChildren(const FragmentSpec& spec, bool hardReset) {
+void Fragment::rebuildChildren(const FragmentSpec& spec, const FragmentSpec* prevSpec,
+  bool hardReset, RebuildStats& stats) {
+
   for (auto it = m_children.begin(); it != m_children.end(); ++it) {
     const string& name = it->first;
     Fragment& frag = *it->second;
 
-    frag.rebuild(spec.spec(name), hardReset);
+    const FragmentSpec* chPrevSpec = prevSpec == nullptr ? nullptr : &prevSpec->spec(name);
+    frag.rebuild_(spec.spec(name), chPrevSpec, hardReset, stats);
+  }
+}
+
+//===========================================
+// Fragment::rebuild_
+//
+// Passing a null prevSpec forces a reload of this fragment and everything beneath it
+//===========================================
+void Fragment::rebuild_(const FragmentSpec& spec, const FragmentSpec* prevSpec, bool hardReset,
+  RebuildStats& stats) {
+
+  removeChildren(spec, hardReset, stats);
+
+  if (prevSpec == nullptr || !spec.sameAs(*prevSpec)) {
+    reload(spec);
+    ++stats.reloaded;
+
+    if (reloadInvalidatesChildren()) {
+      prevSpec = nullptr;
+    }
+  }
+  else {
+    ++stats.kept;
   }
+
+  constructNewChildren(spec, stats);
+  rebuildChildren(spec, prevSpec, hardReset, stats);
 }
 
 //===========================================
 // Fragment::rebuild
 //===========================================
-void Fragment::rebuild(const FragmentSpec& spec, bool hardReset) {
-  removeChildren(spec, hardReset);
-  reload(spec);
-  constructNewChildren(spec);
-  rebuildChildren(spec, hardReset);
+RebuildStats Fragment::rebuild(const FragmentSpec& spec, const FragmentSpec* prevSpec,
+  bool hardReset) {
+
+  auto start = std::chrono::steady_clock::now();
+
+  RebuildStats stats;
+  rebuild_(spec, hardReset ? nullptr : prevSpec, hardReset, stats);
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  stats.duration = elapsed.count();
+
+  return stats;
+}
+
+//===========================================
+// Fragment::reloadInvalidatesChildren
+//===========================================
+bool Fragment::reloadInvalidatesChildren() const {
+  return true;
 }
 
 //===========================================
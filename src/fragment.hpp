@@ -16,12 +16,14 @@ class FragmentData {
 
 class EventSystem;
 class UpdateLoop;
+class FrameScheduler;
 
 class CommonFragData {
   public:
     AppConfig& appConfig;
     EventSystem& eventSystem;
     UpdateLoop& updateLoop;
+    FrameScheduler& frameScheduler;
 };
 
 
@@ -30,6 +32,15 @@ class Fragment;
 
 typedef std::unique_ptr<Fragment> pFragment_t;
 
+// What a call to Fragment::rebuild() did to the fragment tree
+struct RebuildStats {
+  int constructed = 0;
+  int removed = 0;
+  int reloaded = 0;
+  int kept = 0;
+  double duration = 0;
+};
+
 class Fragment {
   public:
     // Use constructor to initialise the fragment and attach to / modify the parent
@@ -40,8 +51,11 @@ class Fragment {
       FragmentData& ownData, const CommonFragData& commonData);
 
     // Rebuild fragment tree by adding/removing children and calling their respective
-    // lifecycle functions
-    void rebuild(const FragmentSpec& spec, bool hardReset);
+    // lifecycle functions.
+    //
+    // If the spec the tree was last built from is given, fragments whose specs haven't changed
+    // are kept as they are rather than reloaded. A hard reset reconstructs everything.
+    RebuildStats rebuild(const FragmentSpec& spec, const FragmentSpec* prevSpec, bool hardReset);
 
     // Re-initialise fragment with new spec. Called when the app state changes and the
     // fragment tree is rebuilt
@@ -51,6 +65,10 @@ class Fragment {
     // from the fragment tree and destroyed
     virtual void cleanUp() = 0;
 
+    // Whether the children must be reloaded whenever this fragment is, e.g. because reload()
+    // replaces widgets they attach to
+    virtual bool reloadInvalidatesChildren() const;
+
     template<class T>
     T& parentFragData() {
       return dynamic_cast<T&>(*m_parentData);
@@ -77,9 +95,12 @@ class Fragment {
     std::map<std::string, pFragment_t> m_children;
 
     void detach();
-    void removeChildren(const FragmentSpec& spec, bool hardReset);
-    void constructNewChildren(const FragmentSpec& spec);
-    void rebuildChildren(const FragmentSpec& spec, bool hardReset);
+    void rebuild_(const FragmentSpec& spec, const FragmentSpec* prevSpec, bool hardReset,
+      RebuildStats& stats);
+    void removeChildren(const FragmentSpec& spec, bool hardReset, RebuildStats& stats);
+    void constructNewChildren(const FragmentSpec& spec, RebuildStats& stats);
+    void rebuildChildren(const FragmentSpec& spec, const FragmentSpec* prevSpec, bool hardReset,
+      RebuildStats& stats);
 };
 
 
@@ -34,6 +34,13 @@ bool FragmentSpec::isEnabled() const {
   return m_enabled;
 }
 
+//===========================================
+// FragmentSpec::sameAs
+//===========================================
+bool FragmentSpec::sameAs(const FragmentSpec& rhs) const {
+  return m_type == rhs.m_type && m_id == rhs.m_id && m_enabled == rhs.m_enabled;
+}
+
 //===========================================
 // FragmentSpec::specs
 //===========================================
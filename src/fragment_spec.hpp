@@ -19,6 +19,11 @@ class FragmentSpec {
     void setEnabled(bool b);
     bool isEnabled() const;
 
+    // Whether the fragment built from rhs would need reloading to match this spec. Child specs
+    // are compared separately, so only this spec's own members need to be considered. Overrides
+    // must compare every member they add.
+    virtual bool sameAs(const FragmentSpec& rhs) const;
+
     virtual ~FragmentSpec() = 0;
 
   private:
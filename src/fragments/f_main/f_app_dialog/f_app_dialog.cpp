@@ -51,6 +51,16 @@ void FAppDialog::closeEvent(QCloseEvent*) {
   commonData.eventSystem.fire(pEvent_t(new DialogClosedEvent(m_name)));
 }
 
+//===========================================
+// FAppDialog::reloadInvalidatesChildren
+//
+// Only the dialog's own properties are set on reload. The layout children attach to is
+// created once, in the constructor.
+//===========================================
+bool FAppDialog::reloadInvalidatesChildren() const {
+  return false;
+}
+
 //===========================================
 // FAppDialog::cleanUp
 //===========================================
@@ -32,6 +32,7 @@ class FAppDialog : public QDialog, public Fragment {
 
     virtual void reload(const FragmentSpec& spec) override;
     virtual void cleanUp() override;
+    virtual bool reloadInvalidatesChildren() const override;
 
     virtual ~FAppDialog() override;
 
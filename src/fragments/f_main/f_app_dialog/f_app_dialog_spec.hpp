@@ -51,6 +51,20 @@ struct FAppDialogSpec : public FragmentSpec {
   int width = 640;
   int height = 480;
   std::string showOnEvent = "doesNotExist";
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FAppDialogSpec&>(rhs_);
+
+    return name == rhs.name
+      && titleText == rhs.titleText
+      && width == rhs.width
+      && height == rhs.height
+      && showOnEvent == rhs.showOnEvent;
+  }
 };
 
 
@@ -57,7 +57,8 @@ void FConsole::reload(const FragmentSpec&) {
 
   m_commandsEntered = 0;
 
-  m_data.wgtConsole = makeQtObjPtr<ConsoleWidget>(commonData.appConfig, initialContent,
+  m_data.wgtConsole = makeQtObjPtr<ConsoleWidget>(commonData.appConfig,
+    commonData.frameScheduler, initialContent,
     vector<string>{});
   m_data.vbox->addWidget(m_data.wgtConsole.get());
 
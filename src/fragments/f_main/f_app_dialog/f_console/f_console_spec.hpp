@@ -16,6 +16,16 @@ struct FConsoleSpec : public FragmentSpec {
   FGlitchSpec glitchSpec;
 
   QString content;
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FConsoleSpec&>(rhs_);
+
+    return content == rhs.content;
+  }
 };
 
 
@@ -69,7 +69,8 @@ void FDoomsweeper::reload(const FragmentSpec&) {
 void FDoomsweeper::setupRaycastPage() {
   auto& page = m_data.raycastPage;
 
-  page.wgtRaycast = makeQtObjPtr<RaycastWidget>(commonData.appConfig, commonData.eventSystem);
+  page.wgtRaycast = makeQtObjPtr<RaycastWidget>(commonData.appConfig, commonData.eventSystem,
+    commonData.frameScheduler);
 
   auto& rootFactory = page.wgtRaycast->rootFactory();
   auto& timeService = page.wgtRaycast->timeService();
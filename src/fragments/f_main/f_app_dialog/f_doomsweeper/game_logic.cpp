@@ -34,7 +34,6 @@ namespace doomsweeper {
 
 static const int ROWS = 8;
 static const int COLS = 8;
-static std::mt19937 randEngine(randomSeed());
 
 
 //===========================================
@@ -44,6 +43,7 @@ GameLogic::GameLogic(EventSystem& eventSystem, EntityManager& entityManager,
   RootFactory& rootFactory, ObjectFactory& objectFactory, TimeService& timeService)
   : SystemAccessor(entityManager),
     m_initialised(false),
+    m_randEngine(randomSeed()),
     m_eventSystem(eventSystem),
     m_entityManager(entityManager),
     m_rootFactory(rootFactory),
@@ -210,8 +210,8 @@ void GameLogic::generateCommands() {
 
   size_t partsPerCommand = cmdParts.size() / progs.size();
 
-  std::shuffle(progs.begin(), progs.end(), randEngine);
-  std::shuffle(cmdParts.begin(), cmdParts.end(), randEngine);
+  std::shuffle(progs.begin(), progs.end(), m_randEngine);
+  std::shuffle(cmdParts.begin(), cmdParts.end(), m_randEngine);
 
   vector<vector<string>> commands;
 
@@ -311,7 +311,7 @@ std::future<void> GameLogic::initialise(const set<Coord>& mineCoords) {
 
     for (int i = 0; i < 3; ++i) {
       while (true) {
-        Coord c{randRow(randEngine), randCol(randEngine)};
+        Coord c{randRow(m_randEngine), randCol(m_randEngine)};
 
         if (clueCellCoords.count(c) == 0 && mineCoords.count(c) == 0
           && c != startCellCoords && c != endCellCoords) {
@@ -341,7 +341,7 @@ std::future<void> GameLogic::initialise(const set<Coord>& mineCoords) {
         string cellName;
 
         if (mineCoords.count(Coord{i, j})) {
-          protoCellId = unsafeCells[randomUnsafeCell(randEngine)];
+          protoCellId = unsafeCells[randomUnsafeCell(m_randEngine)];
 
           stringstream ss;
           ss << "cell_" << i << "_" << j;
@@ -357,7 +357,7 @@ std::future<void> GameLogic::initialise(const set<Coord>& mineCoords) {
           ++clueCellIdx;
         }
         else {
-          protoCellId = safeCells[randomSafeCell(randEngine)];
+          protoCellId = safeCells[randomSafeCell(m_randEngine)];
 
           stringstream ss;
           ss << "cell_" << i << "_" << j;
@@ -487,6 +487,8 @@ void GameLogic::sealDoor(entityId_t doorId) {
 
       join.topTexture = "slimy_bricks";
       join.bottomTexture = "slimy_bricks";
+
+      renderSys().markChanged(join);
     }
   }
 
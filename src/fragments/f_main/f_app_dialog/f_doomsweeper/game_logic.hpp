@@ -9,6 +9,7 @@
 #include <map>
 #include <list>
 #include <set>
+#include <random>
 #include "raycast/component.hpp"
 #include "raycast/system_accessor.hpp"
 #include "event_system.hpp"
@@ -97,6 +98,7 @@ class GameLogic : private SystemAccessor {
     void drawCommandScreens(const std::vector<std::vector<std::string>>& commands) const;
 
     std::atomic<bool> m_initialised;
+    std::mt19937 m_randEngine;
 
     EventSystem& m_eventSystem;
     EntityManager& m_entityManager;
@@ -138,6 +138,7 @@ bool ObjectFactory::constructJeff(entityId_t entityId, parser::Object& obj, enti
 
         spatialSys().relocateEntity(entityId, *spawnPoint.zone, spawnPoint.pos);
 
+        sprite.frameViews.reset();
         sprite.texViews = texViews;
       }
     }});
@@ -197,10 +197,11 @@ void GameLogic::useCovfefe() {
     double margin = 10.0;
     Point pos = playerBody.pos + player.dir() * distance;
 
-    vector<pIntersection_t> intersections = spatialSys().entitiesAlongRay(Vec2f{1, 0});
+    IntersectionBuffer buffer;
+    IntersectionSpan intersections = spatialSys().entitiesAlongRay(Vec2f{1, 0}, buffer);
 
-    if (intersections.front()->distanceFromOrigin - margin < distance) {
-      pos = intersections.front()->point_wld - player.dir() * margin;
+    if (intersections.front().distanceFromOrigin - margin < distance) {
+      pos = intersections.front().point_wld - player.dir() * margin;
     }
 
     spatialSys().relocateEntity(covfefeId, *playerBody.zone, pos);
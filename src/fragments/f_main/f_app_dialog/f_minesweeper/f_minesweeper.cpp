@@ -203,7 +203,8 @@ void MinesweeperCell::onPlayerClick() {
 FMinesweeper::FMinesweeper(Fragment& parent_, FragmentData& parentData_,
   const CommonFragData& commonData)
   : QWidget(nullptr),
-    Fragment("FMinesweeper", parent_, parentData_, m_data, commonData) {
+    Fragment("FMinesweeper", parent_, parentData_, m_data, commonData),
+    m_board(ROWS, COLS) {
 
   DBG_PRINT("FMinesweeper::FMinesweeper\n");
 }
@@ -222,110 +223,36 @@ void FMinesweeper::onInnerCellEntered(const Event& e_) {
     }
   }
 
-  set<const MinesweeperCell*> visited{};
-  clearNeighbours_r(*m_mainPage.cells[e.coords.row][e.coords.col], visited);
+  revealCells(e.coords);
 }
 
 //===========================================
 // FMinesweeper::placeMines
 //===========================================
-set<Coord> FMinesweeper::placeMines() {
-  vector<Coord> coords;
-  set<Coord> mineCoords;
+void FMinesweeper::placeMines() {
+  m_board.placeMines(MINES, {Coord{0, 0}, Coord{ROWS - 1, COLS - 1}}, randEngine);
 
   for (int i = 0; i < ROWS; ++i) {
     for (int j = 0; j < COLS; ++j) {
-      if (i == 0 && j == 0) {
-        continue;
-      }
-
-      if (i == ROWS - 1 && j == COLS - 1) {
-        continue;
-      }
+      Coord coord{i, j};
+      int value = m_board.isMine(coord) ? MINE : m_board.count(coord);
 
-      coords.push_back(Coord{i, j});
+      m_mainPage.cells[i][j]->setValue(value);
     }
   }
-
-  std::shuffle(coords.begin(), coords.end(), randEngine);
-
-  for (int i = 0; i < MINES; ++i) {
-    int row = coords[i].row;
-    int col = coords[i].col;
-
-    m_mainPage.cells[row][col]->setValue(MINE);
-
-    mineCoords.insert(coords[i]);
-  }
-
-  return mineCoords;
 }
 
 //===========================================
-// FMinesweeper::getNeighbours
+// FMinesweeper::revealCells
+//
+// Reveals the cell, and the region around it if it has no neighbouring mines
 //===========================================
-set<MinesweeperCell*> FMinesweeper::getNeighbours(const MinesweeperCell& cell) const {
-  set<MinesweeperCell*> neighbours;
+void FMinesweeper::revealCells(const Coord& coords) {
+  m_revealed.clear();
+  m_board.reveal(coords, &m_revealed);
 
-  for (int i = cell.row - 1; i <= cell.row + 1; ++i) {
-    for (int j = cell.col - 1; j <= cell.col + 1; ++j) {
-      if (i == cell.row && j == cell.col) {
-        continue;
-      }
-
-      if (i < 0 || i >= ROWS) {
-        continue;
-      }
-
-      if (j < 0 || j >= COLS) {
-        continue;
-      }
-
-      neighbours.insert(m_mainPage.cells[i][j].get());
-    }
-  }
-
-  return neighbours;
-}
-
-//===========================================
-// FMinesweeper::setNumbers
-//===========================================
-void FMinesweeper::setNumbers() {
-  for (int i = 0; i < ROWS; ++i) {
-    for (int j = 0; j < COLS; ++j) {
-      MinesweeperCell& cell = *m_mainPage.cells[i][j];
-
-      if (cell.value() == MINE) {
-        set<MinesweeperCell*> neighbours = getNeighbours(cell);
-
-        for (auto neighbour : neighbours) {
-          if (neighbour->value() != MINE) {
-            neighbour->setValue(neighbour->value() + 1);
-          }
-        }
-      }
-    }
-  }
-}
-
-//===========================================
-// FMinesweeper::clearNeighbours_r
-//===========================================
-void FMinesweeper::clearNeighbours_r(const MinesweeperCell& cell,
-  set<const MinesweeperCell*>& visited) {
-
-  if (cell.value() == 0) {
-    auto neighbours = getNeighbours(cell);
-    for (MinesweeperCell* neighbour : neighbours) {
-
-      if (visited.count(neighbour) == 0 && neighbour->hidden() && !neighbour->flagged()) {
-        neighbour->setHidden(false);
-        visited.insert(neighbour);
-
-        clearNeighbours_r(*neighbour, visited);
-      }
-    }
+  for (const Coord& c : m_revealed) {
+    m_mainPage.cells[c.row][c.col]->setHidden(false);
   }
 }
 
@@ -345,26 +272,14 @@ void FMinesweeper::onBtnClick(int id) {
   MinesweeperCell& cell = *m_mainPage.cells[row][col];
 
   if (cell.hidden() && !cell.flagged()) {
-    switch (cell.value()) {
-      case 0: {
-        set<const MinesweeperCell*> visited{};
-        clearNeighbours_r(cell, visited);
-        break;
-      }
-      case MINE: {
-        DBG_PRINT("Boom!\n");
-        cell.onPlayerClick();
-        commonData.eventSystem.fire(pEvent_t(new Event("doomsweeper/clickMine")));
-        m_dead = true;
-        break;
-      }
-      default: {
-        // Do nothing
-        break;
-      }
+    if (cell.value() == MINE) {
+      DBG_PRINT("Boom!\n");
+      cell.onPlayerClick();
+      commonData.eventSystem.fire(pEvent_t(new Event("doomsweeper/clickMine")));
+      m_dead = true;
     }
 
-    cell.setHidden(false);
+    revealCells(Coord{row, col});
   }
 }
 
@@ -385,6 +300,7 @@ void FMinesweeper::onBtnRightClick(int id) {
 
   if (cell->hidden()) {
     cell->setFlagged(!cell->flagged());
+    m_board.setFlagged(Coord{row, col}, cell->flagged());
   }
 }
 
@@ -428,8 +344,10 @@ void FMinesweeper::constructMainPage() {
   m_icons.noMine = QIcon(commonData.appConfig.dataPath("doomsweeper/no_mine.png").c_str());
   m_icons.player = QIcon(commonData.appConfig.dataPath("doomsweeper/player.png").c_str());
 
-  set<Coord> coords = placeMines();
-  setNumbers();
+  placeMines();
+
+  vector<Coord> mines = m_board.mines();
+  set<Coord> coords(mines.begin(), mines.end());
 
   m_hInnerCellEntered = commonData.eventSystem.listen("doomsweeper/innerCellEntered",
     std::bind(&FMinesweeper::onInnerCellEntered, this, std::placeholders::_1));
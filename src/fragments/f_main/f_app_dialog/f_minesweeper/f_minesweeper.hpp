@@ -3,7 +3,7 @@
 
 
 #include <array>
-#include <set>
+#include <vector>
 #include <QWidget>
 #include <QGridLayout>
 #include <QPushButton>
@@ -15,6 +15,7 @@
 #include "event_system.hpp"
 #include "qt_obj_ptr.hpp"
 #include "fragments/f_main/f_app_dialog/f_minesweeper/events.hpp"
+#include "fragments/f_main/f_app_dialog/f_minesweeper/minesweeper_board.hpp"
 
 
 class GoodButton : public QPushButton {
@@ -136,10 +137,8 @@ class FMinesweeper : public QWidget, public Fragment {
   private:
     void constructLoadingPage();
     void constructMainPage();
-    std::set<doomsweeper::Coord> placeMines();
-    void setNumbers();
-    std::set<MinesweeperCell*> getNeighbours(const MinesweeperCell& cell) const;
-    void clearNeighbours_r(const MinesweeperCell& cell, std::set<const MinesweeperCell*>& visited);
+    void placeMines();
+    void revealCells(const doomsweeper::Coord& coords);
     void onInnerCellEntered(const Event& e_);
 
     FMinesweeperData m_data;
@@ -157,6 +156,8 @@ class FMinesweeper : public QWidget, public Fragment {
     } m_mainPage;
 
     IconSet m_icons;
+    doomsweeper::MinesweeperBoard m_board;
+    std::vector<doomsweeper::Coord> m_revealed;
     EventHandle m_hInnerCellEntered;
     EventHandle m_hStart;
 
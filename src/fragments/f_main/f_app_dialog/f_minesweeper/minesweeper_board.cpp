@@ -0,0 +1,709 @@
+#include <algorithm>
+#include "fragments/f_main/f_app_dialog/f_minesweeper/minesweeper_board.hpp"
+#include "exception.hpp"
+
+
+using std::vector;
+
+
+namespace doomsweeper {
+
+
+// Number of random cells tried when looking for somewhere to move a mine to
+static const int RELOCATION_TRIES = 64;
+// Limits how long the solver keeps moving mines before giving up on a board
+static const int MAX_RELOCATIONS_PER_MINE = 4;
+
+
+//===========================================
+// testBit
+//===========================================
+static inline bool testBit(const vector<uint64_t>& bits, int i) {
+  return (bits[i >> 6] >> (i & 63)) & 1;
+}
+
+//===========================================
+// setBit
+//===========================================
+static inline void setBit(vector<uint64_t>& bits, int i) {
+  bits[i >> 6] |= uint64_t(1) << (i & 63);
+}
+
+//===========================================
+// clearBit
+//===========================================
+static inline void clearBit(vector<uint64_t>& bits, int i) {
+  bits[i >> 6] &= ~(uint64_t(1) << (i & 63));
+}
+
+//===========================================
+// numWords
+//===========================================
+static inline size_t numWords(int numBits) {
+  return (static_cast<size_t>(numBits) + 63) / 64;
+}
+
+//===========================================
+// MinesweeperBoard::MinesweeperBoard
+//===========================================
+MinesweeperBoard::MinesweeperBoard(int rows, int cols)
+  : m_rows(rows),
+    m_cols(cols) {
+
+  if (rows <= 0 || cols <= 0) {
+    EXCEPTION("Error constructing minesweeper board; Invalid dimensions");
+  }
+
+  clear();
+}
+
+//===========================================
+// MinesweeperBoard::clear
+//===========================================
+void MinesweeperBoard::clear() {
+  int n = m_rows * m_cols;
+
+  m_mines.assign(numWords(n), 0);
+  m_revealed.assign(numWords(n), 0);
+  m_flagged.assign(numWords(n), 0);
+  m_excluded.assign(numWords(n), 0);
+  m_counts.assign(n, 0);
+
+  m_numMines = 0;
+}
+
+//===========================================
+// MinesweeperBoard::neighbours
+//
+// Writes the indices of the (up to 8) cells around idx to out and returns how many there are
+//===========================================
+int MinesweeperBoard::neighbours(int idx, int* out) const {
+  int row = idx / m_cols;
+  int col = idx % m_cols;
+
+  int r0 = row > 0 ? row - 1 : row;
+  int r1 = row < m_rows - 1 ? row + 1 : row;
+  int c0 = col > 0 ? col - 1 : col;
+  int c1 = col < m_cols - 1 ? col + 1 : col;
+
+  int n = 0;
+  for (int r = r0; r <= r1; ++r) {
+    for (int c = c0; c <= c1; ++c) {
+      int i = r * m_cols + c;
+
+      if (i != idx) {
+        out[n++] = i;
+      }
+    }
+  }
+
+  return n;
+}
+
+//===========================================
+// MinesweeperBoard::addMine
+//===========================================
+void MinesweeperBoard::addMine(int idx) {
+  setBit(m_mines, idx);
+  ++m_numMines;
+
+  int nbs[8];
+  int n = neighbours(idx, nbs);
+
+  for (int i = 0; i < n; ++i) {
+    ++m_counts[nbs[i]];
+  }
+}
+
+//===========================================
+// MinesweeperBoard::removeMine
+//===========================================
+void MinesweeperBoard::removeMine(int idx) {
+  clearBit(m_mines, idx);
+  --m_numMines;
+
+  int nbs[8];
+  int n = neighbours(idx, nbs);
+
+  for (int i = 0; i < n; ++i) {
+    --m_counts[nbs[i]];
+  }
+}
+
+//===========================================
+// MinesweeperBoard::setExcluded
+//===========================================
+void MinesweeperBoard::setExcluded(const vector<Coord>& exclude) {
+  m_excluded.assign(numWords(m_rows * m_cols), 0);
+
+  for (const Coord& cell : exclude) {
+    if (cell.row >= 0 && cell.row < m_rows && cell.col >= 0 && cell.col < m_cols) {
+      setBit(m_excluded, index(cell));
+    }
+  }
+}
+
+//===========================================
+// MinesweeperBoard::placeMines_
+//
+// A partial Fisher-Yates shuffle of the cells that aren't excluded
+//===========================================
+void MinesweeperBoard::placeMines_(int numMines, std::mt19937& randEngine) {
+  int n = m_rows * m_cols;
+
+  m_candidates.clear();
+  for (int i = 0; i < n; ++i) {
+    if (!testBit(m_excluded, i)) {
+      m_candidates.push_back(i);
+    }
+  }
+
+  int numCandidates = static_cast<int>(m_candidates.size());
+
+  if (numMines > numCandidates) {
+    EXCEPTION("Error placing mines; Can't fit " << numMines << " mines in " << numCandidates
+      << " cells");
+  }
+
+  for (int i = 0; i < numMines; ++i) {
+    std::uniform_int_distribution<int> randIdx(i, numCandidates - 1);
+    std::swap(m_candidates[i], m_candidates[randIdx(randEngine)]);
+
+    addMine(m_candidates[i]);
+  }
+}
+
+//===========================================
+// MinesweeperBoard::placeMines
+//===========================================
+void MinesweeperBoard::placeMines(int numMines, const vector<Coord>& exclude,
+  std::mt19937& randEngine) {
+
+  clear();
+  setExcluded(exclude);
+  placeMines_(numMines, randEngine);
+}
+
+//===========================================
+// MinesweeperBoard::placeMinesNoGuess
+//
+// Random boards of any size almost always need a guess somewhere, so rather than generating
+// boards until one happens to be solvable, each attempt repairs its board as it goes. Whenever
+// the solver gets stuck, a mine bordering the revealed area is moved somewhere away from it,
+// which leaves everything deduced so far intact. An attempt fails if the board is still stuck
+// after a number of moves, which mostly happens when a deadlock forms right at the end.
+//===========================================
+bool MinesweeperBoard::placeMinesNoGuess(int numMines, const Coord& start,
+  const vector<Coord>& exclude, std::mt19937& randEngine, int maxAttempts) {
+
+  vector<Coord> excludeAll = exclude;
+  for (int r = start.row - 1; r <= start.row + 1; ++r) {
+    for (int c = start.col - 1; c <= start.col + 1; ++c) {
+      excludeAll.push_back(Coord{r, c});
+    }
+  }
+
+  for (int attempt = 0; attempt < maxAttempts; ++attempt) {
+    placeMines(numMines, excludeAll, randEngine);
+
+    if (solve(index(start), &randEngine)) {
+      return true;
+    }
+  }
+
+  clear();
+  return false;
+}
+
+//===========================================
+// MinesweeperBoard::isSolvable
+//===========================================
+bool MinesweeperBoard::isSolvable(const Coord& start) {
+  return solve(index(start), nullptr);
+}
+
+//===========================================
+// MinesweeperBoard::solverEnqueue
+//
+// Queues a revealed cell for the solver to look at
+//===========================================
+void MinesweeperBoard::solverEnqueue(int idx) {
+  if (testBit(m_solver.revealed, idx) && !testBit(m_solver.queued, idx)) {
+    setBit(m_solver.queued, idx);
+    m_solver.work.push_back(idx);
+  }
+}
+
+//===========================================
+// MinesweeperBoard::solverReveal
+//
+// Marks the (safe) cell as revealed to the solver, opening up the region around it if its count
+// is zero
+//===========================================
+void MinesweeperBoard::solverReveal(int idx) {
+  if (testBit(m_solver.revealed, idx)) {
+    return;
+  }
+
+  m_queue.clear();
+  m_queue.push_back(idx);
+  setBit(m_solver.revealed, idx);
+  ++m_solver.numRevealed;
+
+  int nbs[8];
+
+  for (size_t head = 0; head < m_queue.size(); ++head) {
+    int cell = m_queue[head];
+    int n = neighbours(cell, nbs);
+
+    solverEnqueue(cell);
+
+    for (int i = 0; i < n; ++i) {
+      int nb = nbs[i];
+
+      if (testBit(m_solver.revealed, nb)) {
+        solverEnqueue(nb);
+      }
+      else if (m_counts[cell] == 0) {
+        setBit(m_solver.revealed, nb);
+        ++m_solver.numRevealed;
+        m_queue.push_back(nb);
+      }
+      else {
+        m_solver.frontier.push_back(nb);
+      }
+    }
+  }
+}
+
+//===========================================
+// MinesweeperBoard::solverMarkMine
+//===========================================
+void MinesweeperBoard::solverMarkMine(int idx) {
+  setBit(m_solver.mines, idx);
+
+  int nbs[8];
+  int n = neighbours(idx, nbs);
+
+  for (int i = 0; i < n; ++i) {
+    solverEnqueue(nbs[i]);
+  }
+}
+
+//===========================================
+// MinesweeperBoard::solverDeduce
+//
+// Looks at a revealed cell's unknown neighbours. If its count is already met they're all safe,
+// and if it equals the number of unknowns they're all mines. Failing that, it's compared with
+// each nearby revealed cell. If one cell's unknowns are a subset of the other's, the difference
+// between their remaining counts must lie in the cells they don't share.
+//
+// Returns true if anything was deduced.
+//===========================================
+bool MinesweeperBoard::solverDeduce(int idx) {
+  // Gathers the unknown cells around a cell, returning the number of mines among them
+  auto unknowns = [this](int cell, int* out, int& numUnknown) {
+    int nbs[8];
+    int n = neighbours(cell, nbs);
+    int knownMines = 0;
+
+    numUnknown = 0;
+    for (int i = 0; i < n; ++i) {
+      if (testBit(m_solver.mines, nbs[i])) {
+        ++knownMines;
+      }
+      else if (!testBit(m_solver.revealed, nbs[i])) {
+        out[numUnknown++] = nbs[i];
+      }
+    }
+
+    return m_counts[cell] - knownMines;
+  };
+
+  // Whether every cell in a is in b
+  auto isSubset = [](const int* a, int numA, const int* b, int numB) {
+    for (int i = 0; i < numA; ++i) {
+      bool found = false;
+
+      for (int j = 0; j < numB; ++j) {
+        if (a[i] == b[j]) {
+          found = true;
+          break;
+        }
+      }
+
+      if (!found) {
+        return false;
+      }
+    }
+
+    return true;
+  };
+
+  // Given a's unknowns are a subset of b's, resolves b's remaining unknowns if possible
+  auto resolveDifference = [this](const int* a, int numA, int remA, const int* b, int numB,
+    int remB) {
+
+    int diff[8];
+    int numDiff = 0;
+
+    for (int j = 0; j < numB; ++j) {
+      bool shared = false;
+
+      for (int i = 0; i < numA; ++i) {
+        if (a[i] == b[j]) {
+          shared = true;
+          break;
+        }
+      }
+
+      if (!shared) {
+        diff[numDiff++] = b[j];
+      }
+    }
+
+    if (numDiff == 0) {
+      return false;
+    }
+
+    int remDiff = remB - remA;
+
+    if (remDiff == 0) {
+      for (int i = 0; i < numDiff; ++i) {
+        solverReveal(diff[i]);
+      }
+      return true;
+    }
+
+    if (remDiff == numDiff) {
+      for (int i = 0; i < numDiff; ++i) {
+        solverMarkMine(diff[i]);
+      }
+      return true;
+    }
+
+    return false;
+  };
+
+  int uA[8];
+  int numA = 0;
+  int remA = unknowns(idx, uA, numA);
+
+  if (numA == 0) {
+    return false;
+  }
+
+  if (remA == 0) {
+    for (int i = 0; i < numA; ++i) {
+      solverReveal(uA[i]);
+    }
+    return true;
+  }
+
+  if (remA == numA) {
+    for (int i = 0; i < numA; ++i) {
+      solverMarkMine(uA[i]);
+    }
+    return true;
+  }
+
+  int row = idx / m_cols;
+  int col = idx % m_cols;
+
+  // Only cells within two of this one can share unknowns with it
+  for (int r = std::max(0, row - 2); r <= std::min(m_rows - 1, row + 2); ++r) {
+    for (int c = std::max(0, col - 2); c <= std::min(m_cols - 1, col + 2); ++c) {
+      int other = r * m_cols + c;
+
+      if (other == idx || !testBit(m_solver.revealed, other) || m_counts[other] == 0) {
+        continue;
+      }
+
+      int uB[8];
+      int numB = 0;
+      int remB = unknowns(other, uB, numB);
+
+      if (numB == 0) {
+        continue;
+      }
+
+      if (isSubset(uA, numA, uB, numB) && resolveDifference(uA, numA, remA, uB, numB, remB)) {
+        solverEnqueue(idx);
+        return true;
+      }
+
+      if (isSubset(uB, numB, uA, numA) && resolveDifference(uB, numB, remB, uA, numA, remA)) {
+        solverEnqueue(idx);
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+//===========================================
+// MinesweeperBoard::relocateFrontierMine
+//
+// Moves a mine the solver hasn't identified from next to the revealed area to a random cell the
+// solver knows nothing about, preferably one away from the revealed area. Everything the solver
+// has deduced remains true. Returns false if there's no such mine or nowhere to put it.
+//===========================================
+bool MinesweeperBoard::relocateFrontierMine(std::mt19937& randEngine) {
+  int n = m_rows * m_cols;
+  std::uniform_int_distribution<int> randCell(0, n - 1);
+
+  auto isCandidate = [this](int cell) {
+    return !testBit(m_mines, cell) && !testBit(m_excluded, cell)
+      && !testBit(m_solver.revealed, cell);
+  };
+
+  auto bordersRevealed = [this](int cell) {
+    int nbs[8];
+    int numNbs = neighbours(cell, nbs);
+
+    for (int i = 0; i < numNbs; ++i) {
+      if (testBit(m_solver.revealed, nbs[i])) {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  int cell = -1;
+  while (!m_solver.frontier.empty()) {
+    int c = m_solver.frontier.back();
+    m_solver.frontier.pop_back();
+
+    if (testBit(m_mines, c) && !testBit(m_solver.mines, c)) {
+      cell = c;
+      break;
+    }
+  }
+
+  if (cell == -1) {
+    return false;
+  }
+
+  int dest = -1;
+  for (int t = 0; t < RELOCATION_TRIES; ++t) {
+    int c = randCell(randEngine);
+
+    if (isCandidate(c) && !bordersRevealed(c)) {
+      dest = c;
+      break;
+    }
+  }
+
+  // Near the end there may be nowhere away from the revealed area, so settle for anywhere
+  if (dest == -1) {
+    int offset = randCell(randEngine);
+
+    for (int i = 0; i < n; ++i) {
+      int c = (offset + i) % n;
+
+      if (c != cell && isCandidate(c)) {
+        dest = c;
+        break;
+      }
+    }
+  }
+
+  if (dest == -1) {
+    return false;
+  }
+
+  removeMine(cell);
+  addMine(dest);
+
+  int nbs[8];
+
+  int numNbs = neighbours(cell, nbs);
+  for (int i = 0; i < numNbs; ++i) {
+    solverEnqueue(nbs[i]);
+  }
+
+  numNbs = neighbours(dest, nbs);
+  for (int i = 0; i < numNbs; ++i) {
+    solverEnqueue(nbs[i]);
+  }
+
+  // The cell the mine was moved from is still unknown to the solver
+  m_solver.frontier.push_back(dest);
+
+  return true;
+}
+
+//===========================================
+// MinesweeperBoard::solve
+//
+// Reveals the start cell and deduces as much as possible from there. If a random engine is
+// given, mines are moved whenever deduction gets stuck.
+//===========================================
+bool MinesweeperBoard::solve(int start, std::mt19937* randEngine) {
+  int n = m_rows * m_cols;
+  int numSafe = n - m_numMines;
+
+  m_solver.revealed.assign(numWords(n), 0);
+  m_solver.mines.assign(numWords(n), 0);
+  m_solver.queued.assign(numWords(n), 0);
+  m_solver.work.clear();
+  m_solver.frontier.clear();
+  m_solver.numRevealed = 0;
+
+  if (testBit(m_mines, start)) {
+    return false;
+  }
+
+  solverReveal(start);
+
+  int relocations = 0;
+
+  while (true) {
+    while (!m_solver.work.empty()) {
+      int cell = m_solver.work.back();
+      m_solver.work.pop_back();
+      clearBit(m_solver.queued, cell);
+
+      solverDeduce(cell);
+    }
+
+    if (m_solver.numRevealed == numSafe) {
+      return true;
+    }
+
+    // Moving mines around can't always break a deadlock near the end, so give up eventually
+    if (randEngine == nullptr || relocations >= MAX_RELOCATIONS_PER_MINE * m_numMines
+      || !relocateFrontierMine(*randEngine)) {
+
+      return false;
+    }
+
+    ++relocations;
+  }
+}
+
+//===========================================
+// MinesweeperBoard::isMine
+//===========================================
+bool MinesweeperBoard::isMine(const Coord& cell) const {
+  return testBit(m_mines, index(cell));
+}
+
+//===========================================
+// MinesweeperBoard::isRevealed
+//===========================================
+bool MinesweeperBoard::isRevealed(const Coord& cell) const {
+  return testBit(m_revealed, index(cell));
+}
+
+//===========================================
+// MinesweeperBoard::isFlagged
+//===========================================
+bool MinesweeperBoard::isFlagged(const Coord& cell) const {
+  return testBit(m_flagged, index(cell));
+}
+
+//===========================================
+// MinesweeperBoard::numMines
+//===========================================
+int MinesweeperBoard::numMines() const {
+  return m_numMines;
+}
+
+//===========================================
+// MinesweeperBoard::mines
+//===========================================
+vector<Coord> MinesweeperBoard::mines() const {
+  vector<Coord> coords;
+  coords.reserve(m_numMines);
+
+  int n = m_rows * m_cols;
+
+  for (int i = 0; i < n; ++i) {
+    // Skip empty words
+    if ((i & 63) == 0 && m_mines[i >> 6] == 0) {
+      i += 63;
+      continue;
+    }
+
+    if (testBit(m_mines, i)) {
+      coords.push_back(coord(i));
+    }
+  }
+
+  return coords;
+}
+
+//===========================================
+// MinesweeperBoard::count
+//===========================================
+int MinesweeperBoard::count(const Coord& cell) const {
+  return m_counts[index(cell)];
+}
+
+//===========================================
+// MinesweeperBoard::setFlagged
+//===========================================
+void MinesweeperBoard::setFlagged(const Coord& cell, bool flagged) {
+  if (flagged) {
+    setBit(m_flagged, index(cell));
+  }
+  else {
+    clearBit(m_flagged, index(cell));
+  }
+}
+
+//===========================================
+// MinesweeperBoard::reveal
+//
+// The flood fill also runs if the cell was already revealed, so that cells unflagged since are
+// picked up
+//===========================================
+int MinesweeperBoard::reveal(const Coord& cell, vector<Coord>* revealed) {
+  int idx = index(cell);
+  int numRevealed = 0;
+
+  m_queue.clear();
+  m_queue.push_back(idx);
+
+  if (!testBit(m_revealed, idx)) {
+    setBit(m_revealed, idx);
+    ++numRevealed;
+
+    if (revealed != nullptr) {
+      revealed->push_back(cell);
+    }
+  }
+
+  int nbs[8];
+
+  for (size_t head = 0; head < m_queue.size(); ++head) {
+    int c = m_queue[head];
+
+    if (testBit(m_mines, c) || m_counts[c] != 0) {
+      continue;
+    }
+
+    int n = neighbours(c, nbs);
+    for (int i = 0; i < n; ++i) {
+      int nb = nbs[i];
+
+      if (!testBit(m_revealed, nb) && !testBit(m_flagged, nb)) {
+        setBit(m_revealed, nb);
+        ++numRevealed;
+        m_queue.push_back(nb);
+
+        if (revealed != nullptr) {
+          revealed->push_back(coord(nb));
+        }
+      }
+    }
+  }
+
+  return numRevealed;
+}
+
+
+}
@@ -0,0 +1,134 @@
+#ifndef __PROCALC_FRAGMENTS_F_MINESWEEPER_MINESWEEPER_BOARD_HPP__
+#define __PROCALC_FRAGMENTS_F_MINESWEEPER_MINESWEEPER_BOARD_HPP__
+
+
+#include <cstdint>
+#include <vector>
+#include <random>
+#include "fragments/f_main/f_app_dialog/f_minesweeper/events.hpp"
+
+
+namespace doomsweeper {
+
+
+// The minesweeper game state, independent of any widgets.
+//
+// Mines, revealed cells and flags are stored as bit masks, one bit per cell, and the number of
+// mines around each cell is kept up to date as mines are placed. Revealing a cell with no mines
+// around it opens the surrounding region with a queue rather than recursion, so large boards
+// can't overflow the stack.
+class MinesweeperBoard {
+  public:
+    MinesweeperBoard(int rows, int cols);
+
+    inline int rows() const;
+    inline int cols() const;
+
+    void clear();
+
+    // Places mines at random, avoiding the excluded cells
+    void placeMines(int numMines, const std::vector<Coord>& exclude, std::mt19937& randEngine);
+
+    // Places mines such that, starting from the given cell, every safe cell can be found by
+    // deduction alone. The start cell and its neighbours are kept clear. Returns false if no
+    // such board was found within the given number of attempts, leaving the board cleared.
+    bool placeMinesNoGuess(int numMines, const Coord& start, const std::vector<Coord>& exclude,
+      std::mt19937& randEngine, int maxAttempts = 10);
+
+    // Whether every safe cell can be found by deduction alone, starting from the given cell
+    bool isSolvable(const Coord& start);
+
+    bool isMine(const Coord& cell) const;
+    bool isRevealed(const Coord& cell) const;
+    bool isFlagged(const Coord& cell) const;
+    int numMines() const;
+    std::vector<Coord> mines() const;
+
+    // The number of mines around the cell
+    int count(const Coord& cell) const;
+
+    void setFlagged(const Coord& cell, bool flagged);
+
+    // Reveals the cell, even if flagged. If it has no mines around it, the surrounding cells are
+    // revealed too, and so on, stopping at flagged cells. Newly revealed cells are appended to
+    // revealed if given. Returns the number of cells revealed.
+    int reveal(const Coord& cell, std::vector<Coord>* revealed = nullptr);
+
+  private:
+    inline int index(const Coord& cell) const;
+    inline Coord coord(int idx) const;
+    int neighbours(int idx, int* out) const;
+    void setExcluded(const std::vector<Coord>& exclude);
+    void placeMines_(int numMines, std::mt19937& randEngine);
+    void addMine(int idx);
+    void removeMine(int idx);
+    bool solve(int start, std::mt19937* randEngine);
+    void solverReveal(int idx);
+    void solverMarkMine(int idx);
+    void solverEnqueue(int idx);
+    bool solverDeduce(int idx);
+    bool relocateFrontierMine(std::mt19937& randEngine);
+
+    int m_rows;
+    int m_cols;
+    int m_numMines = 0;
+
+    std::vector<uint64_t> m_mines;
+    std::vector<uint64_t> m_revealed;
+    std::vector<uint64_t> m_flagged;
+    std::vector<uint8_t> m_counts;
+
+    // Cells that mines mustn't be placed in
+    std::vector<uint64_t> m_excluded;
+
+    // Scratch space, kept between calls to avoid reallocating
+    std::vector<int> m_queue;
+    std::vector<int> m_candidates;
+
+    // What the solver knows about the board
+    struct {
+      std::vector<uint64_t> revealed;
+      std::vector<uint64_t> mines;
+      std::vector<uint64_t> queued;
+      // Revealed cells whose neighbourhood has changed since they were last looked at
+      std::vector<int> work;
+      // Cells that were unrevealed when a neighbour was revealed. May contain duplicates and
+      // cells that have since been revealed.
+      std::vector<int> frontier;
+      int numRevealed;
+    } m_solver;
+};
+
+//===========================================
+// MinesweeperBoard::rows
+//===========================================
+inline int MinesweeperBoard::rows() const {
+  return m_rows;
+}
+
+//===========================================
+// MinesweeperBoard::cols
+//===========================================
+inline int MinesweeperBoard::cols() const {
+  return m_cols;
+}
+
+//===========================================
+// MinesweeperBoard::index
+//===========================================
+inline int MinesweeperBoard::index(const Coord& cell) const {
+  return cell.row * m_cols + cell.col;
+}
+
+//===========================================
+// MinesweeperBoard::coord
+//===========================================
+inline Coord MinesweeperBoard::coord(int idx) const {
+  return Coord{idx / m_cols, idx % m_cols};
+}
+
+
+}
+
+
+#endif
@@ -195,7 +195,8 @@ void FProcalcSetup::setupPage2() {
 
   page.widget->setLayout(vbox);
 
-  page.wgtRaycast = makeQtObjPtr<RaycastWidget>(commonData.appConfig, commonData.eventSystem);
+  page.wgtRaycast = makeQtObjPtr<RaycastWidget>(commonData.appConfig, commonData.eventSystem,
+    commonData.frameScheduler);
   vbox->addWidget(page.wgtRaycast.get());
 
   page.wgtRaycast->initialise(commonData.appConfig.dataPath("making_progress/map.svg"));
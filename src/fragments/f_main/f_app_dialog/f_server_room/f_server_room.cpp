@@ -47,7 +47,8 @@ void FServerRoom::reload(const FragmentSpec&) {
     parentData.box->setContentsMargins(0, 0, 0, 0);
     parentData.box->addWidget(this);
 
-    m_data.wgtRaycast = makeQtObjPtr<RaycastWidget>(commonData.appConfig, commonData.eventSystem);
+    m_data.wgtRaycast = makeQtObjPtr<RaycastWidget>(commonData.appConfig, commonData.eventSystem,
+      commonData.frameScheduler);
 
     auto& rootFactory = m_data.wgtRaycast->rootFactory();
     auto& timeService = m_data.wgtRaycast->timeService();
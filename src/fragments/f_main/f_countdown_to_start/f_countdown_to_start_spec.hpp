@@ -10,6 +10,16 @@ struct FCountdownToStartSpec : public FragmentSpec {
     : FragmentSpec("FCountdownToStart", {}) {}
 
   int stateId;
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FCountdownToStartSpec&>(rhs_);
+
+    return stateId == rhs.stateId;
+  }
 };
 
 
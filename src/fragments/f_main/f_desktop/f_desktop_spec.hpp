@@ -13,6 +13,10 @@ struct FDesktopSpec : public FragmentSpec {
     std::string image;
     std::string text;
     std::string eventName;
+
+    bool operator==(const Icon& rhs) const {
+      return image == rhs.image && text == rhs.text && eventName == rhs.eventName;
+    }
   };
 
   FDesktopSpec()
@@ -22,6 +26,16 @@ struct FDesktopSpec : public FragmentSpec {
 
   FServerRoomInitSpec serverRoomInitSpec;
   std::vector<Icon> icons;
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FDesktopSpec&>(rhs_);
+
+    return icons == rhs.icons;
+  }
 };
 
 
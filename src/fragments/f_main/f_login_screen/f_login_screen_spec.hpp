@@ -11,6 +11,16 @@ struct FLoginScreenSpec : public FragmentSpec {
     : FragmentSpec("FLoginScreen", {}) {}
 
   QString backgroundImage;
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FLoginScreenSpec&>(rhs_);
+
+    return backgroundImage == rhs.backgroundImage;
+  }
 };
 
 
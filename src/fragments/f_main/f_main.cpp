@@ -95,6 +95,16 @@ void FMain::closeEvent(QCloseEvent*) {
   commonData.eventSystem.fire(pEvent_t(new Event("quit")));
 }
 
+//===========================================
+// FMain::reloadInvalidatesChildren
+//
+// Only the window's own properties are set on reload. The layout children attach to is
+// created once, in the constructor.
+//===========================================
+bool FMain::reloadInvalidatesChildren() const {
+  return false;
+}
+
 //===========================================
 // FMain::cleanUp
 //===========================================
@@ -34,6 +34,7 @@ class FMain : public QMainWindow, public Fragment {
 
     virtual void reload(const FragmentSpec& spec) override;
     virtual void cleanUp() override;
+    virtual bool reloadInvalidatesChildren() const override;
 
     virtual ~FMain();
 
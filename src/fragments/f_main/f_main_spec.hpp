@@ -70,6 +70,26 @@ struct FMainSpec : public FragmentSpec {
   QString aboutLabel = "About";
   QString aboutDialogTitle = "About";
   QString aboutDialogText;
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FMainSpec&>(rhs_);
+
+    return windowTitle == rhs.windowTitle
+      && width == rhs.width
+      && height == rhs.height
+      && bgColour == rhs.bgColour
+      && backgroundImage == rhs.backgroundImage
+      && fileLabel == rhs.fileLabel
+      && quitLabel == rhs.quitLabel
+      && helpLabel == rhs.helpLabel
+      && aboutLabel == rhs.aboutLabel
+      && aboutDialogTitle == rhs.aboutDialogTitle
+      && aboutDialogText == rhs.aboutDialogText;
+  }
 };
 
 
@@ -40,7 +40,7 @@ void FMaze3d::reload(const FragmentSpec& spec_) {
   setLayout(m_data.vbox.get());
 
   m_data.wgtRaycast = makeQtObjPtr<RaycastWidget>(commonData.appConfig, commonData.eventSystem,
-    spec.width, spec.height, spec.frameRate);
+    commonData.frameScheduler, spec.width, spec.height, spec.frameRate);
   m_data.vbox->addWidget(m_data.wgtRaycast.get());
 
 #if PROFILING_ON
@@ -13,6 +13,19 @@ struct FMaze3dSpec : public FragmentSpec {
   int width = 320;
   int height = 240;
   int frameRate = 60;
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FMaze3dSpec&>(rhs_);
+
+    return mapFile == rhs.mapFile
+      && width == rhs.width
+      && height == rhs.height
+      && frameRate == rhs.frameRate;
+  }
 };
 
 
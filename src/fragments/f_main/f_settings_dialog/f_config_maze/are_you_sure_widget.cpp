@@ -1,4 +1,3 @@
-#include <regex>
 #include <random>
 #include <cassert>
 #include <algorithm>
@@ -16,77 +15,6 @@ const int NUM_QUESTIONS = 8;
 static std::mt19937 randEngine(randomSeed());
 
 
-//===========================================
-// AreYouSureWidget::Template::generate_
-//===========================================
-string AreYouSureWidget::Template::generate_(const TemplateMap& templates, const string& text,
-  int maxDepth) const {
-
-  if (maxDepth < 0) {
-    return "";
-  }
-
-  std::regex rx("<(\\w+),(\\d+)-(\\d+)>");
-  auto begin = std::sregex_iterator(text.begin(), text.end(), rx);
-  auto end = std::sregex_iterator();
-
-  string result = text;
-  int offset = 0;
-
-  for (auto it = begin; it != end; ++it) {
-    std::smatch m = *it;
-    string name = m.str(1);
-    int minReps = std::atoi(m.str(2).c_str());
-    int maxReps = std::atoi(m.str(3).c_str());
-
-    std::uniform_int_distribution<int> randReps(minReps, maxReps);
-    int reps = randReps(randEngine);
-
-    string expanded;
-    for (int rep = 0; rep < reps; ++rep) {
-      string subresult = templates.at(name).generate(templates, maxDepth - 1);
-      if (subresult.length() == 0 && minReps > 0) {
-        return "";
-      }
-
-      expanded += subresult;
-    }
-
-    result.replace(m.position() + offset, m.length(), expanded);
-    offset += static_cast<int>(expanded.length() - m.length());
-  }
-
-  if (result.back() != ' ') {
-    result.push_back(' ');
-  }
-
-  return result;
-}
-
-//===========================================
-// AreYouSureWidget::Template::generate
-//===========================================
-string AreYouSureWidget::Template::generate(const TemplateMap& templates, int maxDepth) const {
-  string text = text1;
-
-  if (text2.length() > 0) {
-    std::uniform_int_distribution<int> flipCoin(0, 1);
-    int coin = flipCoin(randEngine);
-
-    text = (coin == 0 ? text1 : text2);
-    const string& altText = (coin == 1 ? text1 : text2);
-
-    string result = generate_(templates, text, maxDepth);
-    if (result.length() == 0) {
-      return generate_(templates, altText, maxDepth);
-    }
-    return result;
-  }
-  else {
-    return generate_(templates, text, maxDepth);
-  }
-}
-
 //===========================================
 // numOccurrences
 //===========================================
@@ -208,27 +136,27 @@ AreYouSureWidget::AreYouSureWidget(const AppConfig& appConfig)
 
   m_pages->addWidget(m_page2.widget.get());
 
-  // Setup templates
+  // Setup grammar
   //
 
-  m_templates["not"] = Template("not");
-  m_templates["sureYou"] = Template("<not,0-3>sure you");
-  m_templates["sureYouAre"] = Template("<sureYou,1-1>are");
-  m_templates["sureYou_"] = Template("<sureYouAre,0-1><sureYou,1-1>");
-  m_templates["sureYouWantTo"] = Template("<sureYou_,1-1>want to");
-  m_templates["continue"] = Template("continue", "proceed");
-  m_templates["verb"] = Template("<not,0-3><continue,1-1>", "<not,0-3>abort");
-  m_templates["continuing"] = Template("continuing", "proceeding");
-  m_templates["ing"] = Template("<not,0-3><continuing,1-1>", "<not,0-3>aborting");
-  m_templates["continueTo"] = Template("<continue,1-1><ingTo,1-1>", "<continueTo,1-1><verbTo,1-1>");
-  m_templates["verbTo"] = Template("<continueTo,1-1>", "abort <ingTo,1-1>");
-  m_templates["ingTo"] = Template("<ingIng,1-1><continuing,1-1>to");
-  m_templates["ingVerbIng"] = Template("<ingTo,1-1><verbIng,1-1>");
-  m_templates["ingIng"] = Template("<ing,1-2><ingVerbIng,0-1>");
-  m_templates["verbIng"] = Template("<verb,1-1><ingIng,1-1>");
-  m_templates["verbVerb"] = Template("<verbTo,1-1><verb,1-1>");
-  m_templates["verb_"] = Template("<verbIng,1-1>", "<verbVerb,1-1>");
-  m_templates["question"] = Template("Are you sure you are <sureYouWantTo,1-1><verb_,1-1>");
+  m_grammar.addRule("not", "not");
+  m_grammar.addRule("sureYou", "<not,0-3>sure you");
+  m_grammar.addRule("sureYouAre", "<sureYou,1-1>are");
+  m_grammar.addRule("sureYou_", "<sureYouAre,0-1><sureYou,1-1>");
+  m_grammar.addRule("sureYouWantTo", "<sureYou_,1-1>want to");
+  m_grammar.addRule("continue", "continue", "proceed");
+  m_grammar.addRule("verb", "<not,0-3><continue,1-1>", "<not,0-3>abort");
+  m_grammar.addRule("continuing", "continuing", "proceeding");
+  m_grammar.addRule("ing", "<not,0-3><continuing,1-1>", "<not,0-3>aborting");
+  m_grammar.addRule("continueTo", "<continue,1-1><ingTo,1-1>", "<continueTo,1-1><verbTo,1-1>");
+  m_grammar.addRule("verbTo", "<continueTo,1-1>", "abort <ingTo,1-1>");
+  m_grammar.addRule("ingTo", "<ingIng,1-1><continuing,1-1>to");
+  m_grammar.addRule("ingVerbIng", "<ingTo,1-1><verbIng,1-1>");
+  m_grammar.addRule("ingIng", "<ing,1-2><ingVerbIng,0-1>");
+  m_grammar.addRule("verbIng", "<verb,1-1><ingIng,1-1>");
+  m_grammar.addRule("verbVerb", "<verbTo,1-1><verb,1-1>");
+  m_grammar.addRule("verb_", "<verbIng,1-1>", "<verbVerb,1-1>");
+  m_grammar.addRule("question", "Are you sure you are <sureYouWantTo,1-1><verb_,1-1>");
 
   restart();
 }
@@ -255,7 +183,7 @@ void AreYouSureWidget::nextQuestion() {
     }
     else {
       while (question.length() == 0 || question.length() > 300) {
-        question = m_templates.at("question").generate(m_templates, 6 + m_count);
+        question = m_grammar.generate("question", randEngine, 6 + m_count);
         question.pop_back();
         question.push_back('?');
       }
@@ -2,13 +2,13 @@
 #define __PROCALC_FRAGMENTS_F_CONFIG_MAZE_ARE_YOU_SURE_WIDGET_HPP__
 
 
-#include <map>
 #include <QPushButton>
 #include <QLabel>
 #include <QStackedLayout>
 #include <QGridLayout>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
+#include "fragments/f_main/f_settings_dialog/f_config_maze/text_grammar.hpp"
 #include "evasive_button.hpp"
 #include "qt_obj_ptr.hpp"
 
@@ -38,29 +38,6 @@ class AreYouSureWidget : public QWidget {
   private:
     void nextQuestion();
 
-    class Template;
-    typedef std::map<std::string, Template> TemplateMap;
-
-    class Template {
-      public:
-        Template(const std::string& text1, const std::string& text2)
-          : text1(text1),
-            text2(text2) {}
-
-        explicit Template(const std::string& text1)
-          : text1(text1),
-            text2("") {}
-
-        Template() {}
-
-        std::string generate(const TemplateMap& templates, int maxDepth = 10) const;
-        std::string generate_(const TemplateMap& templates, const std::string& text,
-          int maxDepth) const;
-
-        std::string text1;
-        std::string text2;
-    };
-
     QtObjPtr<QStackedLayout> m_pages;
 
     struct {
@@ -81,7 +58,7 @@ class AreYouSureWidget : public QWidget {
       QtObjPtr<QLabel> wgtConsole;
     } m_page2;
 
-    TemplateMap m_templates;
+    TextGrammar m_grammar;
     int m_count;
 };
 
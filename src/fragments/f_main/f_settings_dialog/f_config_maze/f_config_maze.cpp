@@ -117,7 +117,8 @@ void FConfigMaze::constructConsolePage() {
     "> ";
 
   m_data.consolePage.widget = makeQtObjPtr<QWidget>();
-  m_data.consolePage.wgtConsole = makeQtObjPtr<ConsoleWidget>(commonData.appConfig, initialContent,
+  m_data.consolePage.wgtConsole = makeQtObjPtr<ConsoleWidget>(commonData.appConfig,
+    commonData.frameScheduler, initialContent,
     vector<string>{
       "logouut",
       string("chpwd ") + pwd
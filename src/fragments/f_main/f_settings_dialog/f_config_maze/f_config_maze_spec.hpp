@@ -10,6 +10,16 @@ struct FConfigMazeSpec : public FragmentSpec {
     : FragmentSpec("FConfigMaze", {}) {}
 
   std::string symbols = "1234567890.+-/*=C";
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FConfigMazeSpec&>(rhs_);
+
+    return symbols == rhs.symbols;
+  }
 };
 
 
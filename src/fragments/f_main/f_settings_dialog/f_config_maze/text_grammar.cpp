@@ -0,0 +1,311 @@
+#include <cctype>
+#include <cstdlib>
+#include "fragments/f_main/f_settings_dialog/f_config_maze/text_grammar.hpp"
+#include "exception.hpp"
+
+
+using std::string;
+
+
+//===========================================
+// isWordChar
+//===========================================
+static inline bool isWordChar(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+//===========================================
+// isDigit
+//===========================================
+static inline bool isDigit(char c) {
+  return std::isdigit(static_cast<unsigned char>(c));
+}
+
+//===========================================
+// matchReference
+//
+// Matches <name,min-max> at position i. On success, end is set to one past the closing bracket.
+//===========================================
+static bool matchReference(const string& text, size_t i, size_t& end, string& name,
+  int& minReps, int& maxReps) {
+
+  size_t j = i + 1;
+
+  size_t nameStart = j;
+  while (j < text.length() && isWordChar(text[j])) {
+    ++j;
+  }
+  if (j == nameStart || j >= text.length() || text[j] != ',') {
+    return false;
+  }
+  size_t nameEnd = j++;
+
+  size_t minStart = j;
+  while (j < text.length() && isDigit(text[j])) {
+    ++j;
+  }
+  if (j == minStart || j >= text.length() || text[j] != '-') {
+    return false;
+  }
+  ++j;
+
+  size_t maxStart = j;
+  while (j < text.length() && isDigit(text[j])) {
+    ++j;
+  }
+  if (j == maxStart || j >= text.length() || text[j] != '>') {
+    return false;
+  }
+
+  name = text.substr(nameStart, nameEnd - nameStart);
+  minReps = std::atoi(text.c_str() + minStart);
+  maxReps = std::atoi(text.c_str() + maxStart);
+  end = j + 1;
+
+  return true;
+}
+
+//===========================================
+// TextGrammar::ruleId
+//
+// Rules may be referenced before they're added
+//===========================================
+int TextGrammar::ruleId(const string& name) {
+  auto it = m_ruleIds.find(name);
+  if (it != m_ruleIds.end()) {
+    return it->second;
+  }
+
+  int id = static_cast<int>(m_rules.size());
+
+  m_rules.push_back(Rule());
+  m_ruleNames.push_back(name);
+  m_ruleIds[name] = id;
+
+  return id;
+}
+
+//===========================================
+// TextGrammar::addLiteral
+//===========================================
+void TextGrammar::addLiteral(const string& text, size_t from, size_t to) {
+  if (to > from) {
+    Op op;
+    op.literalStart = static_cast<int>(m_literals.length());
+    op.literalLength = static_cast<int>(to - from);
+    op.rule = -1;
+    op.minReps = 0;
+    op.maxReps = 0;
+
+    m_literals.append(text, from, to - from);
+    m_ops.push_back(op);
+  }
+}
+
+//===========================================
+// TextGrammar::parse
+//===========================================
+TextGrammar::Alternative TextGrammar::parse(const string& text) {
+  Alternative alt;
+  alt.firstOp = static_cast<int>(m_ops.size());
+
+  size_t literalStart = 0;
+  size_t i = 0;
+
+  while (i < text.length()) {
+    size_t end = 0;
+    string name;
+    int minReps = 0;
+    int maxReps = 0;
+
+    if (text[i] == '<' && matchReference(text, i, end, name, minReps, maxReps)) {
+      addLiteral(text, literalStart, i);
+
+      Op op;
+      op.literalStart = -1;
+      op.literalLength = 0;
+      op.rule = ruleId(name);
+      op.minReps = minReps;
+      op.maxReps = maxReps;
+
+      m_ops.push_back(op);
+
+      i = end;
+      literalStart = end;
+    }
+    else {
+      ++i;
+    }
+  }
+
+  addLiteral(text, literalStart, text.length());
+
+  alt.numOps = static_cast<int>(m_ops.size()) - alt.firstOp;
+
+  return alt;
+}
+
+//===========================================
+// TextGrammar::addRule
+//===========================================
+void TextGrammar::addRule(const string& name, const string& text1, const string& text2) {
+  int id = ruleId(name);
+
+  if (m_rules[id].defined) {
+    EXCEPTION("Error adding rule; Rule '" << name << "' already exists");
+  }
+
+  Rule rule;
+  rule.defined = true;
+  rule.numAlternatives = 1;
+  rule.alternatives[0] = parse(text1);
+
+  if (text2.length() > 0) {
+    rule.numAlternatives = 2;
+    rule.alternatives[1] = parse(text2);
+  }
+
+  m_rules[id] = rule;
+}
+
+//===========================================
+// TextGrammar::generate
+//===========================================
+string TextGrammar::generate(const string& rule, std::mt19937& randEngine, int maxDepth) const {
+  string out;
+  out.reserve(256);
+
+  generate(rule, randEngine, maxDepth, out);
+
+  return out;
+}
+
+//===========================================
+// TextGrammar::generate
+//
+// Each frame on the stack is the expansion of one rule. Rather than recursing, a frame that
+// needs a sub-expansion pushes a frame for it and is resumed once that frame is popped. The
+// stack never grows beyond maxDepth + 1 frames.
+//===========================================
+bool TextGrammar::generate(const string& rule, std::mt19937& randEngine, int maxDepth,
+  string& out) const {
+
+  auto it = m_ruleIds.find(rule);
+  if (it == m_ruleIds.end()) {
+    EXCEPTION("Error generating text; No rule called '" << rule << "'");
+  }
+
+  size_t start = out.length();
+
+  m_stack.clear();
+  m_stack.reserve(maxDepth > 0 ? maxDepth + 1 : 1);
+
+  // Draws the choice of alternative, then pushes a frame unless the depth limit has been reached
+  auto pushRule = [&](int ruleId, int depth) {
+    const Rule& r = m_rules[ruleId];
+
+    if (!r.defined) {
+      EXCEPTION("Error generating text; No rule called '" << m_ruleNames[ruleId] << "'");
+    }
+
+    Frame frame{ruleId, depth, 0, true, out.length(), 0, -1};
+
+    if (r.numAlternatives == 2) {
+      std::uniform_int_distribution<int> flipCoin(0, 1);
+      frame.alternative = flipCoin(randEngine);
+      frame.triedOther = false;
+    }
+
+    if (depth < 0) {
+      return false;
+    }
+
+    m_stack.push_back(frame);
+    return true;
+  };
+
+  bool childFinished = false;
+  bool childFailed = !pushRule(it->second, maxDepth);
+
+  while (!m_stack.empty()) {
+    Frame& frame = m_stack.back();
+    const Alternative& alt = m_rules[frame.rule].alternatives[frame.alternative];
+
+    bool failed = false;
+    bool pushed = false;
+
+    if (childFinished) {
+      childFinished = false;
+      failed = childFailed && m_ops[alt.firstOp + frame.op].minReps > 0;
+    }
+
+    while (!failed && !pushed && frame.op < alt.numOps) {
+      const Op& op = m_ops[alt.firstOp + frame.op];
+
+      if (op.literalStart != -1) {
+        out.append(m_literals, op.literalStart, op.literalLength);
+        ++frame.op;
+        continue;
+      }
+
+      if (frame.repsLeft == -1) {
+        std::uniform_int_distribution<int> randReps(op.minReps, op.maxReps);
+        frame.repsLeft = randReps(randEngine);
+      }
+
+      if (frame.repsLeft == 0) {
+        frame.repsLeft = -1;
+        ++frame.op;
+        continue;
+      }
+
+      --frame.repsLeft;
+
+      // The push invalidates frame, so stop touching it
+      if (pushRule(op.rule, frame.depth - 1)) {
+        pushed = true;
+      }
+      else {
+        failed = op.minReps > 0;
+      }
+    }
+
+    if (pushed) {
+      continue;
+    }
+
+    if (failed) {
+      out.resize(frame.outStart);
+
+      if (!frame.triedOther) {
+        frame.triedOther = true;
+        frame.alternative = 1 - frame.alternative;
+        frame.op = 0;
+        frame.repsLeft = -1;
+
+        continue;
+      }
+
+      m_stack.pop_back();
+      childFinished = true;
+      childFailed = true;
+
+      continue;
+    }
+
+    if (out.length() == frame.outStart || out.back() != ' ') {
+      out.push_back(' ');
+    }
+
+    m_stack.pop_back();
+    childFinished = true;
+    childFailed = false;
+  }
+
+  if (childFailed) {
+    out.resize(start);
+    return false;
+  }
+
+  return true;
+}
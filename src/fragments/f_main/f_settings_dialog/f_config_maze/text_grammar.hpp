@@ -0,0 +1,81 @@
+#ifndef __PROCALC_FRAGMENTS_F_CONFIG_MAZE_TEXT_GRAMMAR_HPP__
+#define __PROCALC_FRAGMENTS_F_CONFIG_MAZE_TEXT_GRAMMAR_HPP__
+
+
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+
+
+// Generates random text from a set of named rules.
+//
+// Each rule has one or two alternative texts, one of which is picked at random. A text may
+// contain references of the form <name,min-max>, each of which expands to between min and max
+// expansions of the named rule. Every expansion ends with a space.
+//
+// If the depth limit is reached, the expansion fails. A failed expansion causes its parent to
+// fail too, unless the reference allows zero repetitions. When the chosen alternative fails, the
+// other one is tried.
+//
+// Rule texts are parsed once, when added, into flat lists of literal spans and repeat ops. They
+// are expanded without recursion, directly into the output buffer.
+class TextGrammar {
+  public:
+    void addRule(const std::string& name, const std::string& text1,
+      const std::string& text2 = "");
+
+    // Returns an empty string if the expansion fails
+    std::string generate(const std::string& rule, std::mt19937& randEngine, int maxDepth) const;
+
+    // Appends to out, returning false (and leaving out unchanged) if the expansion fails
+    bool generate(const std::string& rule, std::mt19937& randEngine, int maxDepth,
+      std::string& out) const;
+
+  private:
+    struct Op {
+      // Into m_literals for literal spans; -1 for repeat ops
+      int literalStart;
+      int literalLength;
+      int rule;
+      int minReps;
+      int maxReps;
+    };
+
+    struct Alternative {
+      int firstOp;
+      int numOps;
+    };
+
+    struct Rule {
+      bool defined = false;
+      int numAlternatives = 0;
+      Alternative alternatives[2];
+    };
+
+    struct Frame {
+      int rule;
+      int depth;
+      int alternative;
+      bool triedOther;
+      size_t outStart;
+      int op;
+      int repsLeft;
+    };
+
+    int ruleId(const std::string& name);
+    Alternative parse(const std::string& text);
+    void addLiteral(const std::string& text, size_t from, size_t to);
+    bool beginAlternative(Frame& frame, std::string& out) const;
+
+    std::map<std::string, int> m_ruleIds;
+    std::vector<std::string> m_ruleNames;
+    std::vector<Rule> m_rules;
+    std::vector<Op> m_ops;
+    std::string m_literals;
+
+    mutable std::vector<Frame> m_stack;
+};
+
+
+#endif
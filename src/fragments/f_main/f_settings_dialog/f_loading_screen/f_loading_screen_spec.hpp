@@ -11,6 +11,16 @@ struct FLoadingScreenSpec : public FragmentSpec {
     : FragmentSpec("FLoadingScreen", {}) {}
 
   std::string targetValue;
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FLoadingScreenSpec&>(rhs_);
+
+    return targetValue == rhs.targetValue;
+  }
 };
 
 
@@ -25,6 +25,19 @@ struct FSettingsDialogSpec : public FragmentSpec {
   int width = 400;
   int height = 300;
   QString backgroundImage;
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FSettingsDialogSpec&>(rhs_);
+
+    return titleText == rhs.titleText
+      && width == rhs.width
+      && height == rhs.height
+      && backgroundImage == rhs.backgroundImage;
+  }
 };
 
 
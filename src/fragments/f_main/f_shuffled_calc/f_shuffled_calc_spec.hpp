@@ -14,6 +14,18 @@ struct FShuffledCalcSpec : public FragmentSpec {
   std::string targetValue = "";
   QColor displayColour = QColor(255, 255, 255);
   QString symbols = "1234567890.+-/*=C";
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FShuffledCalcSpec&>(rhs_);
+
+    return targetValue == rhs.targetValue
+      && displayColour == rhs.displayColour
+      && symbols == rhs.symbols;
+  }
 };
 
 
@@ -137,7 +137,7 @@ void FTroubleshooterDialog::setupTab3(int raycastWidth, int raycastHeight) {
   tab.vbox->setSpacing(0);
   tab.vbox->setContentsMargins(0, 0, 0, 0);
   tab.wgtRaycast = makeQtObjPtr<RaycastWidget>(commonData.appConfig, commonData.eventSystem,
-    raycastWidth, raycastHeight);
+    commonData.frameScheduler, raycastWidth, raycastHeight);
   tab.wgtRaycast->initialise(commonData.appConfig.dataPath("its_raining_tetrominos/map.svg"));
   tab.gameLogic.reset(new GameLogic(commonData.eventSystem, tab.wgtRaycast->entityManager()));
 
@@ -21,6 +21,18 @@ struct FTroubleshooterDialogSpec : public FragmentSpec {
   int raycastHeight = 240;
 
   QString titleText = "Troubleshooter";
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FTroubleshooterDialogSpec&>(rhs_);
+
+    return raycastWidth == rhs.raycastWidth
+      && raycastHeight == rhs.raycastHeight
+      && titleText == rhs.titleText;
+  }
 };
 
 
@@ -19,6 +19,16 @@ struct FCalculatorSpec : public FragmentSpec {
   FPartialCalcSpec partialCalcSpec;
 
   QColor displayColour = QColor(255, 255, 255);
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FCalculatorSpec&>(rhs_);
+
+    return displayColour == rhs.displayColour;
+  }
 };
 
 
@@ -14,6 +14,19 @@ struct FNormalCalcTriggerSpec : public FragmentSpec {
   QColor targetWindowColour;
   QColor targetDisplayColour;
   QString symbols = "1234567890.+-/*=C";
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FNormalCalcTriggerSpec&>(rhs_);
+
+    return stateId == rhs.stateId
+      && targetWindowColour == rhs.targetWindowColour
+      && targetDisplayColour == rhs.targetDisplayColour
+      && symbols == rhs.symbols;
+  }
 };
 
 
@@ -20,9 +20,9 @@ FGlitch::FGlitch(Fragment& parent_, FragmentData& parentData_, const CommonFragD
   setScaledContents(true);
   setAttribute(Qt::WA_TransparentForMouseEvents);
 
-  m_glitchTimer = makeQtObjPtr<QTimer>();
-
-  connect(m_glitchTimer.get(), SIGNAL(timeout()), this, SLOT(tick()));
+  m_hTick = commonData.frameScheduler.add("FGlitch", 0, [this]() {
+    tick();
+  }, FrameScheduler::PRIORITY_LOW, false);
 
   show();
 }
@@ -45,7 +45,8 @@ void FGlitch::reload(const FragmentSpec& spec_) {
   m_glitchFreqMax = spec.glitchFreqMax;
   m_glitchDuration = spec.glitchDuration;
 
-  m_glitchTimer->start(m_glitchFreqMin * 1000);
+  commonData.frameScheduler.setInterval(m_hTick, m_glitchFreqMin * 1000);
+  commonData.frameScheduler.setActive(m_hTick, true);
 }
 
 //===========================================
@@ -68,13 +69,13 @@ void FGlitch::tick() {
     setVisible(true);
     raise();
 
-    m_glitchTimer->setInterval(m_glitchDuration * 1000);
+    commonData.frameScheduler.setInterval(m_hTick, m_glitchDuration * 1000);
   }
   else {
     setVisible(false);
 
     std::uniform_int_distribution<int> dist(m_glitchFreqMin * 1000, m_glitchFreqMax * 1000);
-    m_glitchTimer->setInterval(dist(m_randEngine));
+    commonData.frameScheduler.setInterval(m_hTick, dist(m_randEngine));
   }
 }
 
@@ -5,9 +5,8 @@
 #include <random>
 #include <QLabel>
 #include <QImage>
-#include <QTimer>
 #include "fragment.hpp"
-#include "qt_obj_ptr.hpp"
+#include "frame_scheduler.hpp"
 
 
 struct FGlitchData : public FragmentData {};
@@ -23,9 +22,6 @@ class FGlitch : public QLabel, public Fragment {
 
     virtual ~FGlitch() override;
 
-  public slots:
-    void tick();
-
   private:
     FGlitchData m_data;
 
@@ -34,8 +30,10 @@ class FGlitch : public QLabel, public Fragment {
     double m_glitchDuration;
 
     std::unique_ptr<QImage> m_glitchBuffer;
-    QtObjPtr<QTimer> m_glitchTimer;
+    FrameScheduler::Handle m_hTick;
     std::mt19937 m_randEngine;
+
+    void tick();
 };
 
 
@@ -12,6 +12,18 @@ struct FGlitchSpec : public FragmentSpec {
   double glitchFreqMin = 0.1;
   double glitchFreqMax = 2.0;
   double glitchDuration = 0.1;
+
+  bool sameAs(const FragmentSpec& rhs_) const override {
+    if (!FragmentSpec::sameAs(rhs_)) {
+      return false;
+    }
+
+    auto& rhs = dynamic_cast<const FGlitchSpec&>(rhs_);
+
+    return glitchFreqMin == rhs.glitchFreqMin
+      && glitchFreqMax == rhs.glitchFreqMax
+      && glitchDuration == rhs.glitchDuration;
+  }
 };
 
 
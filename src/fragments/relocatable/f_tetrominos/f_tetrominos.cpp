@@ -1,7 +1,9 @@
 #include <vector>
 #include <array>
 #include <random>
+#include <cmath>
 #include <QPainter>
+#include <QPaintEvent>
 #include "fragments/relocatable/f_tetrominos/f_tetrominos.hpp"
 #include "fragments/relocatable/f_tetrominos/f_tetrominos_spec.hpp"
 #include "utils.hpp"
@@ -17,33 +19,150 @@ const double AVERAGE_ANGULAR_SPEED = 100.0; // Degrees per second
 const double AVERAGE_SPEED = 35.0; // Pixels per second
 const double SPEED_STD_DEVIATION = 7; // Average deviation from the average
 
+const int NUM_KINDS = 7;
+// Number of angles each tetromino is pre-rendered at
+const int ROTATION_STEPS = 64;
+// Large enough to hold a 4x4 block tetromino at any angle
+const int CELL_SIZE = 32;
+
 
 static std::mt19937 randEngine(randomSeed());
 
 
+struct TetrominoKind {
+  array<array<int, 4>, 4> matrix;
+  QColor colour;
+};
+
+// I, J, L, O, S, T, Z
+static const array<TetrominoKind, NUM_KINDS> KINDS = {{
+  // I
+  {{{
+    {{0, 1, 0, 0}},
+    {{0, 1, 0, 0}},
+    {{0, 1, 0, 0}},
+    {{0, 1, 0, 0}}
+  }}, QColor(230, 50, 50)},
+  // J
+  {{{
+    {{0, 0, 0, 0}},
+    {{0, 0, 1, 0}},
+    {{0, 0, 1, 0}},
+    {{0, 1, 1, 0}}
+  }}, QColor(250, 40, 200)},
+  // L
+  {{{
+    {{0, 0, 0, 0}},
+    {{0, 1, 0, 0}},
+    {{0, 1, 0, 0}},
+    {{0, 1, 1, 0}}
+  }}, QColor(250, 250, 0)},
+  // O
+  {{{
+    {{0, 0, 0, 0}},
+    {{0, 1, 1, 0}},
+    {{0, 1, 1, 0}},
+    {{0, 0, 0, 0}}
+  }}, QColor(100, 220, 250)},
+  // S
+  {{{
+    {{0, 0, 0, 0}},
+    {{0, 1, 1, 0}},
+    {{1, 1, 0, 0}},
+    {{0, 0, 0, 0}}
+  }}, QColor(20, 20, 200)},
+  // T
+  {{{
+    {{0, 0, 0, 0}},
+    {{1, 1, 1, 0}},
+    {{0, 1, 0, 0}},
+    {{0, 0, 0, 0}}
+  }}, QColor(160, 160, 160)},
+  // Z
+  {{{
+    {{0, 0, 0, 0}},
+    {{0, 1, 1, 0}},
+    {{0, 0, 1, 1}},
+    {{0, 0, 0, 0}}
+  }}, QColor(50, 250, 50)}
+}};
+
 //===========================================
-// makeTetromino
+// spriteSheet
+//
+// One row per kind of tetromino and one column per angle, each tetromino centred in its cell
 //===========================================
-static void makeTetromino(const array<array<int, 4>, 4>& matrix, array<QPolygon, 4>& blocks) {
-  const int W = BLOCK_SIZE;
-  int idx = 0;
+static const QImage& spriteSheet() {
+  static const QImage sheet = []() {
+    const int W = BLOCK_SIZE;
+
+    QImage sheet(CELL_SIZE * ROTATION_STEPS, CELL_SIZE * NUM_KINDS,
+      QImage::Format_ARGB32_Premultiplied);
+    sheet.fill(Qt::GlobalColor::transparent);
+
+    QPainter painter;
+    painter.begin(&sheet);
+
+    for (int k = 0; k < NUM_KINDS; ++k) {
+      const TetrominoKind& kind = KINDS[k];
+      painter.setBrush(kind.colour);
+
+      for (int r = 0; r < ROTATION_STEPS; ++r) {
+        double angle = 360.0 * r / ROTATION_STEPS;
+
+        painter.setTransform(QTransform()
+          .translate(r * CELL_SIZE + CELL_SIZE / 2, k * CELL_SIZE + CELL_SIZE / 2)
+          .rotate(angle)
+          .translate(-W * 2, -W * 2));
+
+        for (int i = 0; i < 4; ++i) {
+          for (int j = 0; j < 4; ++j) {
+            if (kind.matrix[i][j]) {
+              painter.drawRect(i * W, j * W, W, W);
+            }
+          }
+        }
+      }
+    }
 
-  for (int i = 0; i < 4; ++i) {
-    for (int j = 0; j < 4; ++j) {
-      if (matrix[i][j]) {
-        QPolygon poly;
+    painter.end();
 
-        poly << QPoint(0, 0)
-             << QPoint(W, 0)
-             << QPoint(W, W)
-             << QPoint(0, W);
+    return sheet;
+  }();
 
-        QTransform t = QTransform().translate(i * W, j * W);
+  return sheet;
+}
 
-        blocks[idx++] = t.map(poly);
-      }
-    }
-  }
+//===========================================
+// rotationStep
+//===========================================
+static int rotationStep(double angle) {
+  int step = static_cast<int>(std::floor(angle * ROTATION_STEPS / 360.0 + 0.5)) % ROTATION_STEPS;
+  return step < 0 ? step + ROTATION_STEPS : step;
+}
+
+//===========================================
+// FTetrominos::Tetrominos::clear
+//===========================================
+void FTetrominos::Tetrominos::clear() {
+  kind.clear();
+  x.clear();
+  y.clear();
+  a.clear();
+  dy.clear();
+  da.clear();
+}
+
+//===========================================
+// FTetrominos::Tetrominos::add
+//===========================================
+void FTetrominos::Tetrominos::add(int kind_, double x_, double y_, double dy_, double da_) {
+  kind.push_back(static_cast<uint8_t>(kind_));
+  x.push_back(x_);
+  y.push_back(y_);
+  a.push_back(0);
+  dy.push_back(dy_);
+  da.push_back(da_);
 }
 
 //===========================================
@@ -51,7 +170,7 @@ static void makeTetromino(const array<array<int, 4>, 4>& matrix, array<QPolygon,
 //===========================================
 FTetrominos::FTetrominos(Fragment& parent_, FragmentData& parentData_,
   const CommonFragData& commonData)
-  : QLabel(nullptr),
+  : QWidget(nullptr),
     Fragment("FTetrominos", parent_, parentData_, m_data, commonData) {
 
   DBG_PRINT("FTetrominos::FTetrominos\n");
@@ -60,12 +179,13 @@ FTetrominos::FTetrominos(Fragment& parent_, FragmentData& parentData_,
 
   setParent(&parent);
 
-  setScaledContents(true);
   setAttribute(Qt::WA_TransparentForMouseEvents);
 
-  m_data.timer = makeQtObjPtr<QTimer>();
+  int interval = static_cast<int>(std::round(1000.0 / FRAME_RATE));
 
-  connect(m_data.timer.get(), SIGNAL(timeout()), this, SLOT(tick()));
+  m_hTick = commonData.frameScheduler.add("FTetrominos", interval, [this]() {
+    tick();
+  }, FrameScheduler::PRIORITY_LOW, false);
 
   constructTetrominos(1.0, 25.0);
 
@@ -106,87 +226,14 @@ void FTetrominos::constructTetrominos(double speedMultiplier, double percentageF
         continue;
       }
 
-      auto kind = static_cast<Tetromino::kind_t>(rand() % 7);
+      int kind = rand() % NUM_KINDS;
       double da = randAngle(randEngine);
 
-      Tetromino t{kind, (i + 0.5) * tetroSz, winH - j * tetroSz, 0, dy, da, {{}}, QColor{}};
-
-      switch (kind) {
-        case Tetromino::I: {
-          t.colour = QColor(230, 50, 50);
-          makeTetromino({{
-            {{0, 1, 0, 0}},
-            {{0, 1, 0, 0}},
-            {{0, 1, 0, 0}},
-            {{0, 1, 0, 0}}
-          }}, t.blocks);
-          break;
-        }
-        case Tetromino::J: {
-          t.colour = QColor(250, 40, 200);
-          makeTetromino({{
-            {{0, 0, 0, 0}},
-            {{0, 0, 1, 0}},
-            {{0, 0, 1, 0}},
-            {{0, 1, 1, 0}}
-          }}, t.blocks);
-          break;
-        }
-        case Tetromino::L: {
-          t.colour = QColor(250, 250, 0);
-          makeTetromino({{
-            {{0, 0, 0, 0}},
-            {{0, 1, 0, 0}},
-            {{0, 1, 0, 0}},
-            {{0, 1, 1, 0}}
-          }}, t.blocks);
-          break;
-        }
-        case Tetromino::O: {
-          t.colour = QColor(100, 220, 250);
-          makeTetromino({{
-            {{0, 0, 0, 0}},
-            {{0, 1, 1, 0}},
-            {{0, 1, 1, 0}},
-            {{0, 0, 0, 0}}
-          }}, t.blocks);
-          break;
-        }
-        case Tetromino::S: {
-          t.colour = QColor(20, 20, 200);
-          makeTetromino({{
-            {{0, 0, 0, 0}},
-            {{0, 1, 1, 0}},
-            {{1, 1, 0, 0}},
-            {{0, 0, 0, 0}}
-          }}, t.blocks);
-          break;
-        }
-        case Tetromino::T: {
-          t.colour = QColor(160, 160, 160);
-          makeTetromino({{
-            {{0, 0, 0, 0}},
-            {{1, 1, 1, 0}},
-            {{0, 1, 0, 0}},
-            {{0, 0, 0, 0}}
-          }}, t.blocks);
-          break;
-        }
-        case Tetromino::Z: {
-          t.colour = QColor(50, 250, 50);
-          makeTetromino({{
-            {{0, 0, 0, 0}},
-            {{0, 1, 1, 0}},
-            {{0, 0, 1, 1}},
-            {{0, 0, 0, 0}}
-          }}, t.blocks);
-          break;
-        }
-      }
-
-      m_tetrominos.push_back(t);
+      m_tetrominos.add(kind, (i + 0.5) * tetroSz, winH - j * tetroSz, dy, da);
     }
   }
+
+  update();
 }
 
 //===========================================
@@ -200,50 +247,75 @@ void FTetrominos::reload(const FragmentSpec&) {
   move(0, 0);
   resize(parent.size());
 
-  m_buffer.reset(new QImage(parent.size(), QImage::Format_ARGB32));
-
-  m_data.timer->start(1000.0 / FRAME_RATE);
+  commonData.frameScheduler.setActive(m_hTick, true);
 }
 
 //===========================================
-// FTetrominos::drawTetrominos
+// FTetrominos::spriteRect
+//
+// The area of the widget covered by the tetromino's cell in the sprite sheet
 //===========================================
-void FTetrominos::drawTetrominos(QImage& buffer) {
-  QPainter painter;
-  painter.begin(&buffer);
+QRect FTetrominos::spriteRect(size_t i) const {
+  int x = static_cast<int>(std::floor(m_tetrominos.x[i])) - CELL_SIZE / 2;
+  int y = static_cast<int>(std::floor(m_tetrominos.y[i])) - CELL_SIZE / 2;
+
+  return QRect(x, y, CELL_SIZE, CELL_SIZE);
+}
 
-  buffer.fill(Qt::GlobalColor::transparent);
+//===========================================
+// FTetrominos::paintEvent
+//===========================================
+void FTetrominos::paintEvent(QPaintEvent* event) {
+  const QImage& sheet = spriteSheet();
+  const QRect& dirty = event->rect();
 
-  for (auto it = m_tetrominos.begin(); it != m_tetrominos.end(); ++it) {
-    const Tetromino& t = *it;
+  QPainter painter;
+  painter.begin(this);
 
-    int offset = -BLOCK_SIZE * 2.0;
-    QTransform transform = QTransform().translate(t.x, t.y).rotate(t.a).translate(offset, offset);
+  for (size_t i = 0; i < m_tetrominos.size(); ++i) {
+    QRect dest = spriteRect(i);
 
-    painter.setBrush(t.colour);
+    if (dest.intersects(dirty)) {
+      QRect src(rotationStep(m_tetrominos.a[i]) * CELL_SIZE, m_tetrominos.kind[i] * CELL_SIZE,
+        CELL_SIZE, CELL_SIZE);
 
-    for (int i = 0; i < 4; ++i) {
-      painter.drawPolygon(transform.map(t.blocks[i]));
+      painter.drawImage(dest.topLeft(), sheet, src);
     }
-  };
+  }
 
   painter.end();
 }
 
 //===========================================
 // FTetrominos::moveTetrominos
+//
+// Schedules a repaint of the areas each tetromino moves out of and into
 //===========================================
 void FTetrominos::moveTetrominos() {
-  for (auto it = m_tetrominos.begin(); it != m_tetrominos.end(); ++it) {
-    Tetromino& t = *it;
+  auto& parent = parentFrag<QWidget>();
+  double maxY = parent.size().height() + BLOCK_SIZE;
 
-    t.y += t.dy;
-    t.a += t.da;
+  for (size_t i = 0; i < m_tetrominos.size(); ++i) {
+    QRect before = spriteRect(i);
+    int stepBefore = rotationStep(m_tetrominos.a[i]);
 
-    auto& parent = parentFrag<QWidget>();
+    m_tetrominos.y[i] += m_tetrominos.dy[i];
+    m_tetrominos.a[i] += m_tetrominos.da[i];
 
-    if (t.y > parent.size().height() + BLOCK_SIZE) {
-      t.y = -BLOCK_SIZE;
+    bool wrapped = false;
+    if (m_tetrominos.y[i] > maxY) {
+      m_tetrominos.y[i] = -BLOCK_SIZE;
+      wrapped = true;
+    }
+
+    QRect after = spriteRect(i);
+
+    if (wrapped) {
+      update(before);
+      update(after);
+    }
+    else if (after != before || rotationStep(m_tetrominos.a[i]) != stepBefore) {
+      update(before.united(after));
     }
   }
 }
@@ -253,10 +325,6 @@ void FTetrominos::moveTetrominos() {
 //===========================================
 void FTetrominos::tick() {
   moveTetrominos();
-  drawTetrominos(*m_buffer);
-
-  setPixmap(QPixmap::fromImage(*m_buffer));
-
   raise();
 }
 
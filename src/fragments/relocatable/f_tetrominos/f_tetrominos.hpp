@@ -2,22 +2,24 @@
 #define __PROCALC_FRAGMENTS_F_TETROMINOS_HPP__
 
 
-#include <list>
-#include <array>
-#include <QLabel>
-#include <QTimer>
+#include <vector>
+#include <cstdint>
+#include <QWidget>
 #include <QImage>
-#include <QPolygon>
+#include <QRect>
 #include "fragment.hpp"
 #include "event_system.hpp"
-#include "qt_obj_ptr.hpp"
+#include "frame_scheduler.hpp"
 
 
-struct FTetrominosData : public FragmentData {
-  QtObjPtr<QTimer> timer;
-};
+struct FTetrominosData : public FragmentData {};
 
-class FTetrominos : public QLabel, public Fragment {
+// Draws tetrominos falling over the parent widget.
+//
+// Each kind of tetromino is rasterised once, at a fixed number of angles, into a shared sprite
+// sheet. Each tick only the areas the tetrominos have moved out of and into are repainted, by
+// blitting from the sheet.
+class FTetrominos : public QWidget, public Fragment {
   Q_OBJECT
 
   public:
@@ -28,42 +30,41 @@ class FTetrominos : public QLabel, public Fragment {
 
     virtual ~FTetrominos() override;
 
-  private slots:
-    void tick();
+  protected:
+    void paintEvent(QPaintEvent* event) override;
 
   private:
-    struct Tetromino {
-      enum kind_t {
-        I = 0,
-        J = 1,
-        L = 2,
-        O = 3,
-        S = 4,
-        T = 5,
-        Z = 6
-      };
-
-      kind_t kind;
-      double x;
-      double y;
-      double a;
-
-      double dy;
-      double da;
-
-      std::array<QPolygon, 4> blocks;
-      QColor colour;
+    // One element per tetromino in each array
+    struct Tetrominos {
+      std::vector<uint8_t> kind;
+      std::vector<double> x;
+      std::vector<double> y;
+      std::vector<double> a;
+      std::vector<double> dy;
+      std::vector<double> da;
+
+      void clear();
+      void add(int kind, double x, double y, double dy, double da);
+      inline size_t size() const;
     };
 
     FTetrominosData m_data;
-    std::list<Tetromino> m_tetrominos;
-    std::unique_ptr<QImage> m_buffer;
+    Tetrominos m_tetrominos;
     EventHandle m_hIncTetroRain;
+    FrameScheduler::Handle m_hTick;
 
+    void tick();
     void constructTetrominos(double speedMultiplier, double percentageFill);
     void moveTetrominos();
-    void drawTetrominos(QImage& buffer);
+    QRect spriteRect(size_t i) const;
 };
 
+//===========================================
+// FTetrominos::Tetrominos::size
+//===========================================
+inline size_t FTetrominos::Tetrominos::size() const {
+  return kind.size();
+}
+
 
 #endif
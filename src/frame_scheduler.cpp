@@ -0,0 +1,275 @@
+#include <algorithm>
+#include "frame_scheduler.hpp"
+#include "exception.hpp"
+
+
+using std::string;
+using std::function;
+using std::vector;
+
+
+// Clients due within this many milliseconds of each other are run on the same wake-up
+static const qint64 COALESCE_WINDOW = 4;
+
+
+//===========================================
+// FrameScheduler::FrameScheduler
+//
+// The frame budget is in seconds
+//===========================================
+FrameScheduler::FrameScheduler(double frameBudget)
+  : m_frameBudget(frameBudget) {
+
+  m_timer = makeQtObjPtr<QTimer>();
+  m_timer->setSingleShot(true);
+  m_timer->setTimerType(Qt::PreciseTimer);
+  connect(m_timer.get(), SIGNAL(timeout()), this, SLOT(tick()));
+
+  m_clock.start();
+}
+
+//===========================================
+// FrameScheduler::add
+//
+// The interval is in milliseconds. An interval of zero runs the client on every wake-up, with
+// the scheduler waking as often as the event loop allows.
+//===========================================
+FrameScheduler::Handle FrameScheduler::add(const string& name, int interval,
+  function<void()> fn, int priority, bool active) {
+
+  int id = m_nextId++;
+
+  Client client{id, interval, priority, fn, active, false, false,
+    m_clock.elapsed() + interval, ClientStats()};
+  client.stats.name = name;
+
+  m_clients.insert(std::make_pair(id, std::move(client)));
+
+  reschedule();
+
+  return Handle(*this, id);
+}
+
+//===========================================
+// FrameScheduler::remove
+//
+// If called from a client while ticking, the removed client may be the one running, so it is only
+// deactivated here and erased at the end of the tick
+//===========================================
+void FrameScheduler::remove(int id) {
+  if (m_ticking) {
+    auto it = m_clients.find(id);
+    if (it != m_clients.end()) {
+      it->second.active = false;
+      m_removed.push_back(id);
+    }
+
+    return;
+  }
+
+  m_clients.erase(id);
+  reschedule();
+}
+
+//===========================================
+// FrameScheduler::setActive
+//
+// A client that is made active is first run one interval from now
+//===========================================
+void FrameScheduler::setActive(const Handle& handle, bool active) {
+  auto it = m_clients.find(handle.id);
+  if (it == m_clients.end()) {
+    EXCEPTION("Error setting client active state; No client with id " << handle.id);
+  }
+
+  Client& client = it->second;
+
+  if (active && !client.active) {
+    client.nextDue = m_clock.elapsed() + client.interval;
+    client.deferred = false;
+  }
+
+  client.active = active;
+
+  reschedule();
+}
+
+//===========================================
+// FrameScheduler::isActive
+//===========================================
+bool FrameScheduler::isActive(const Handle& handle) const {
+  auto it = m_clients.find(handle.id);
+  return it != m_clients.end() && it->second.active;
+}
+
+//===========================================
+// FrameScheduler::setInterval
+//
+// Like QTimer::setInterval(), the client is next run one new interval from now
+//===========================================
+void FrameScheduler::setInterval(const Handle& handle, int interval) {
+  auto it = m_clients.find(handle.id);
+  if (it == m_clients.end()) {
+    EXCEPTION("Error setting client interval; No client with id " << handle.id);
+  }
+
+  Client& client = it->second;
+
+  client.interval = interval;
+  client.nextDue = m_clock.elapsed() + interval;
+  client.rescheduled = true;
+
+  reschedule();
+}
+
+//===========================================
+// FrameScheduler::numActive
+//===========================================
+int FrameScheduler::numActive() const {
+  int n = 0;
+
+  for (auto& entry : m_clients) {
+    if (entry.second.active) {
+      ++n;
+    }
+  }
+
+  return n;
+}
+
+//===========================================
+// FrameScheduler::stats
+//===========================================
+vector<FrameScheduler::ClientStats> FrameScheduler::stats() const {
+  vector<ClientStats> stats;
+
+  for (auto& entry : m_clients) {
+    stats.push_back(entry.second.stats);
+  }
+
+  return stats;
+}
+
+//===========================================
+// FrameScheduler::reschedule
+//
+// Sets the timer for when the next client is due, or stops it if there are no active clients
+//===========================================
+void FrameScheduler::reschedule() {
+  if (m_ticking) {
+    return;
+  }
+
+  bool any = false;
+  qint64 nextDue = 0;
+
+  for (auto& entry : m_clients) {
+    const Client& client = entry.second;
+
+    if (client.active) {
+      qint64 due = client.deferred ? 0 : client.nextDue;
+
+      if (!any || due < nextDue) {
+        nextDue = due;
+        any = true;
+      }
+    }
+  }
+
+  if (!any) {
+    m_timer->stop();
+    return;
+  }
+
+  qint64 delay = std::max<qint64>(0, nextDue - m_clock.elapsed());
+  m_timer->start(static_cast<int>(delay));
+}
+
+//===========================================
+// FrameScheduler::endTick
+//
+// Erases the clients removed during the tick
+//===========================================
+void FrameScheduler::endTick() {
+  for (int id : m_removed) {
+    m_clients.erase(id);
+  }
+  m_removed.clear();
+
+  m_ticking = false;
+}
+
+//===========================================
+// FrameScheduler::tick
+//
+// Clients may add, remove or deactivate clients (including themselves) while being run
+//===========================================
+void FrameScheduler::tick() {
+  qint64 wakeTime = m_clock.elapsed();
+
+  m_due.clear();
+  for (auto& entry : m_clients) {
+    const Client& client = entry.second;
+
+    if (client.active && (client.deferred || client.nextDue <= wakeTime + COALESCE_WINDOW)) {
+      m_due.push_back(std::make_pair(-client.priority, client.id));
+    }
+  }
+
+  std::sort(m_due.begin(), m_due.end());
+
+  m_ticking = true;
+
+  {
+    // Ends the tick even if a client throws. Otherwise m_ticking would stay set, and from then on
+    // remove() would never erase and reschedule() would never set the timer.
+    struct TickGuard {
+      FrameScheduler& scheduler;
+
+      ~TickGuard() {
+        scheduler.endTick();
+      }
+    } guard{*this};
+
+    for (auto& due : m_due) {
+      auto it = m_clients.find(due.second);
+      if (it == m_clients.end() || !it->second.active) {
+        continue;
+      }
+
+      Client& client = it->second;
+
+      double used = static_cast<double>(m_clock.elapsed() - wakeTime) / 1000.0;
+
+      if (used > m_frameBudget && client.priority < PRIORITY_HIGH && !client.deferred) {
+        client.deferred = true;
+        ++client.stats.deferred;
+        continue;
+      }
+
+      client.deferred = false;
+      client.rescheduled = false;
+
+      qint64 start = m_clock.nsecsElapsed();
+      client.fn();
+      double elapsed = static_cast<double>(m_clock.nsecsElapsed() - start) * 1e-9;
+
+      // Clients removed during the tick are still in the map, and clients added during it don't
+      // invalidate the reference, so the client is still valid here even if it removed itself
+
+      ++client.stats.frames;
+      client.stats.totalTime += elapsed;
+      client.stats.maxTime = std::max(client.stats.maxTime, elapsed);
+
+      if (!client.rescheduled) {
+        // Don't try to catch up on missed frames
+        client.nextDue += client.interval;
+        if (client.nextDue < wakeTime) {
+          client.nextDue = wakeTime + client.interval;
+        }
+      }
+    }
+  }
+
+  reschedule();
+}
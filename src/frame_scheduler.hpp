@@ -0,0 +1,142 @@
+#ifndef __PROCALC_FRAME_SCHEDULER_HPP__
+#define __PROCALC_FRAME_SCHEDULER_HPP__
+
+
+#include <string>
+#include <functional>
+#include <map>
+#include <vector>
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "qt_obj_ptr.hpp"
+
+
+// Drives everything in the app that runs periodically from a single timer.
+//
+// Each client has an interval and a priority. The timer is set for whenever the next client is
+// due, and every client due within a few milliseconds of that runs on the same wake-up, highest
+// priority first. Once a wake-up has used up the frame budget, any remaining clients below
+// PRIORITY_HIGH are put off until the next one, though never twice in a row. When no clients
+// are active the timer is stopped.
+class FrameScheduler : public QObject {
+  Q_OBJECT
+
+  public:
+    static const int PRIORITY_LOW = -10;
+    static const int PRIORITY_NORMAL = 0;
+    static const int PRIORITY_HIGH = 10;
+
+    struct ClientStats {
+      std::string name;
+      unsigned long frames = 0;
+      unsigned long deferred = 0;
+      double totalTime = 0;
+      double maxTime = 0;
+
+      double averageTime() const {
+        return frames > 0 ? totalTime / frames : 0.0;
+      }
+    };
+
+    // Removes the client from the scheduler when destroyed
+    class Handle {
+      public:
+        Handle()
+          : id(-1),
+            m_scheduler(nullptr) {}
+
+        Handle(FrameScheduler& scheduler, int id)
+          : id(id),
+            m_scheduler(&scheduler) {}
+
+        Handle(const Handle& cpy) = delete;
+        Handle& operator=(const Handle& rhs) = delete;
+
+        Handle(Handle&& cpy)
+          : id(-1),
+            m_scheduler(nullptr) {
+
+          *this = std::move(cpy);
+        }
+
+        Handle& operator=(Handle&& rhs) {
+          if (this == &rhs) {
+            return *this;
+          }
+
+          forget();
+
+          id = rhs.id;
+          m_scheduler = rhs.m_scheduler;
+
+          rhs.id = -1;
+
+          return *this;
+        }
+
+        void forget() {
+          if (m_scheduler != nullptr && id != -1) {
+            m_scheduler->remove(id);
+          }
+
+          id = -1;
+        }
+
+        int id;
+
+        ~Handle() {
+          forget();
+        }
+
+      private:
+        FrameScheduler* m_scheduler;
+    };
+
+    FrameScheduler(double frameBudget = 0.016);
+
+    Handle add(const std::string& name, int interval, std::function<void()> fn,
+      int priority = PRIORITY_NORMAL, bool active = true);
+
+    void setActive(const Handle& handle, bool active);
+    bool isActive(const Handle& handle) const;
+    void setInterval(const Handle& handle, int interval);
+
+    int numActive() const;
+    std::vector<ClientStats> stats() const;
+
+  private slots:
+    void tick();
+
+  private:
+    struct Client {
+      int id;
+      int interval;
+      int priority;
+      std::function<void()> fn;
+      bool active;
+      bool deferred;
+      bool rescheduled;
+      qint64 nextDue;
+      ClientStats stats;
+    };
+
+    void remove(int id);
+    void reschedule();
+    void endTick();
+
+    double m_frameBudget;
+    int m_nextId = 0;
+    std::map<int, Client> m_clients;
+    QtObjPtr<QTimer> m_timer;
+    QElapsedTimer m_clock;
+    bool m_ticking = false;
+
+    // Scratch space for tick()
+    std::vector<std::pair<int, int>> m_due;
+    // Clients removed while ticking, to be erased once it's over
+    std::vector<int> m_removed;
+};
+
+
+#endif
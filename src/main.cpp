@@ -8,6 +8,7 @@
 #include "f_main_spec_factory.hpp"
 #include "event_system.hpp"
 #include "update_loop.hpp"
+#include "frame_scheduler.hpp"
 #include "utils.hpp"
 #include "fragments/f_main/f_main.hpp"
 #include "fragments/f_main/f_main_spec.hpp"
@@ -38,12 +39,13 @@ int main(int argc, char** argv) {
     DBG_PRINT("Hardware concurrency: " << std::thread::hardware_concurrency() << "\n");
 
     std::shared_ptr<EventSystem> eventSystem{new EventSystem};
-    UpdateLoop updateLoop(50);
+    FrameScheduler frameScheduler;
+    UpdateLoop updateLoop(frameScheduler, 50);
 
     unique_ptr<FMainSpec> mainSpec(makeFMainSpec(appConfig));
 
-    FMain mainFragment({appConfig, *eventSystem, updateLoop});
-    mainFragment.rebuild(*mainSpec, false);
+    FMain mainFragment({appConfig, *eventSystem, updateLoop, frameScheduler});
+    mainFragment.rebuild(*mainSpec, nullptr, false);
     mainFragment.show();
 
     EventHandle hQuit = eventSystem->listen("quit", [](const Event&) {
@@ -53,22 +55,40 @@ int main(int argc, char** argv) {
     EventHandle hSetConfigParam = eventSystem->listen("setConfigParam", [&](const Event& e_) {
       auto& e = dynamic_cast<const SetConfigParamEvent&>(e_);
       appConfig.setParam(e.name, e.value);
+      appConfig.persistState();
     });
 
     EventHandle hStateChange = eventSystem->listen("requestStateChange", [&](const Event& e_) {
       const RequestStateChangeEvent& e = dynamic_cast<const RequestStateChangeEvent&>(e_);
+
+      // Re-entering the current state restarts it, so everything must be reloaded
+      bool restart = e.stateId == appConfig.stateId;
       appConfig.stateId = e.stateId;
+      appConfig.persistState();
 
       updateLoop.finishAll();
       app.processEvents();
 
+      unique_ptr<FMainSpec> prevSpec = std::move(mainSpec);
       mainSpec.reset(makeFMainSpec(appConfig));
-      mainFragment.rebuild(*mainSpec, e.hardReset);
+
+      RebuildStats stats = mainFragment.rebuild(*mainSpec, restart ? nullptr : prevSpec.get(),
+        e.hardReset);
+
+      DBG_PRINT("Entered state " << e.stateId << " in " << stats.duration * 1000.0 << "ms ("
+        << stats.constructed << " constructed, " << stats.removed << " removed, "
+        << stats.reloaded << " reloaded, " << stats.kept << " kept)\n");
     });
 
     int code = app.exec();
     appConfig.persistState();
 
+    for (auto& client : frameScheduler.stats()) {
+      DBG_PRINT("Frame client " << client.name << ": " << client.frames << " frames, "
+        << client.deferred << " deferred, avg " << client.averageTime() * 1000.0 << "ms, max "
+        << client.maxTime * 1000.0 << "ms\n");
+    }
+
     return code;
   }
   catch (std::exception& e) {
@@ -21,9 +21,6 @@ static const double AGENT_SPEED = 120.0;
 static const double REACTION_SPEED = 0.25;
 
 
-static std::mt19937 randEngine(randomSeed());
-
-
 //===========================================
 // indexOfClosestPoint
 //===========================================
@@ -77,7 +74,7 @@ void CAgent::setState(state_t state) {
 // CAgent::hasLineOfSight
 //===========================================
 bool CAgent::hasLineOfSight(Matrix& m, Vec2f& ray, double& hAngle, double& vAngle,
-  double& height) const {
+  double& height) {
 
   CVRect& body = dynamic_cast<CVRect&>(spatialSys().getComponent(entityId()));
   const Player& player = *spatialSys().sg.player;
@@ -88,8 +85,7 @@ bool CAgent::hasLineOfSight(Matrix& m, Vec2f& ray, double& hAngle, double& vAngl
   Vec2f v = target_wld - body.pos;
   hAngle = atan2(v.y, v.x);
 
-  Matrix t(hAngle, body.pos);
-  m = t.inverse();
+  m = RigidTransform(hAngle, body.pos).inverse().matrix();
 
   Point target_rel = m * target_wld;
   ray = normalise(target_rel);
@@ -101,11 +97,11 @@ bool CAgent::hasLineOfSight(Matrix& m, Vec2f& ray, double& hAngle, double& vAngl
     return false;
   }
 
-  vector<pIntersection_t> intersections = spatialSys().entitiesAlong3dRay(*body.zone, ray * 0.1,
-    height, ray, vAngle, m);
+  IntersectionSpan intersections = spatialSys().entitiesAlong3dRay(*body.zone, ray * 0.1, height,
+    ray, vAngle, m, m_rayBuffer);
 
   if (intersections.size() > 0) {
-    entityId_t id = intersections.front()->entityId;
+    entityId_t id = intersections.front().entityId;
     if (id == player.body) {
       return true;
     }
@@ -117,12 +113,27 @@ bool CAgent::hasLineOfSight(Matrix& m, Vec2f& ray, double& hAngle, double& vAngl
 //===========================================
 // CAgent::CAgent
 //===========================================
-CAgent::CAgent(entityId_t entityId, EntityManager& entityManager)
+CAgent::CAgent(entityId_t entityId, EntityManager& entityManager, const TimeService& timeService)
   : Component(entityId, ComponentKind::C_AGENT),
     SystemAccessor(entityManager),
-    m_entityManager(entityManager) {
+    m_entityManager(entityManager),
+    m_randEngine(randomSeed()) {
+
+  m_gunfireTiming.reset(new TRandomIntervals(timeService, 400, 4000));
+}
 
-  m_gunfireTiming.reset(new TRandomIntervals(400, 4000));
+//===========================================
+// CAgent::reset
+//
+// Returns the agent to the state it was constructed in
+//===========================================
+void CAgent::reset() {
+  m_state = ST_STATIONARY;
+  m_targetObject = -1;
+  m_path.clear();
+  m_pathClosed = true;
+  m_waypointIdx = -1;
+  m_onFinish = nullptr;
 }
 
 //===========================================
@@ -165,7 +176,7 @@ void CAgent::followPath(TimeService& timeService) {
 
   double speed = AGENT_SPEED / timeService.frameRate;
   Vec2f v = normalise(target - body.pos) * speed;
-  body.angle = atan2(v.y, v.x);
+  spatialSys().setAngle(body, atan2(v.y, v.x));
 
   spatialSys().moveEntity(entityId(), v);
 
@@ -199,7 +210,7 @@ void CAgent::attemptShot(TimeService& timeService, AudioService& audioService) {
     double height = 0;
 
     if (hasLineOfSight(m, ray, hAngle, vAngle, height)) {
-      body.angle = hAngle;
+      spatialSys().setAngle(body, hAngle);
       entityId_t id = entityId();
       state_t prevState = m_state;
       setState(ST_SHOOTING);
@@ -216,8 +227,8 @@ void CAgent::attemptShot(TimeService& timeService, AudioService& audioService) {
 
       std::normal_distribution<double> dist(0, DEG_TO_RAD(1.4));
 
-      double vDa = dist(randEngine);
-      double hDa = dist(randEngine);
+      double vDa = dist(m_randEngine);
+      double hDa = dist(m_randEngine);
 
       Matrix rot(hDa, Vec2f(0, 0));
       ray = rot * ray;
@@ -311,7 +322,9 @@ void CAgent::onDamage() {
 //===========================================
 void AgentSystem::update() {
   for (auto& c : m_components) {
-    c.second->update(m_timeService, m_audioService);
+    if (c.second->m_active) {
+      c.second->update(m_timeService, m_audioService);
+    }
   }
 }
 
@@ -320,7 +333,9 @@ void AgentSystem::update() {
 //===========================================
 void AgentSystem::handleEvent(const GameEvent& event) {
   for (auto& c : m_components) {
-    c.second->handleEvent(event);
+    if (c.second->m_active) {
+      c.second->handleEvent(event);
+    }
   }
 }
 
@@ -335,6 +350,21 @@ void AgentSystem::navigateTo(entityId_t entityId, const Point& point) {
   });
 }
 
+//===========================================
+// AgentSystem::setActive
+//
+// Inactive agents are neither updated nor sent events. Reactivating an agent resets it.
+//===========================================
+void AgentSystem::setActive(entityId_t entityId, bool active) {
+  CAgent& agent = *m_components.at(entityId);
+
+  if (active && !agent.m_active) {
+    agent.reset();
+  }
+
+  agent.m_active = active;
+}
+
 //===========================================
 // AgentSystem::hasComponent
 //===========================================
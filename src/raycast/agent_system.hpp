@@ -11,6 +11,7 @@
 #include "raycast/geometry.hpp"
 #include "raycast/timing.hpp"
 #include "raycast/system_accessor.hpp"
+#include "raycast/intersection.hpp"
 
 
 class TimeService;
@@ -24,7 +25,7 @@ class CAgent : public Component, private SystemAccessor {
   friend class AgentSystem;
 
   public:
-    CAgent(entityId_t entityId, EntityManager& entityManager);
+    CAgent(entityId_t entityId, EntityManager& entityManager, const TimeService& timeService);
 
     bool isHostile = true;
     entityId_t patrolPath = -1;
@@ -45,18 +46,22 @@ class CAgent : public Component, private SystemAccessor {
 
     state_t m_state = ST_STATIONARY;
     std::unique_ptr<TimePattern> m_gunfireTiming;
+    std::mt19937 m_randEngine;
     entityId_t m_targetObject = -1;
     std::vector<Point> m_path;
     bool m_pathClosed = true;
     int m_waypointIdx = -1;
     std::function<void(CAgent&)> m_onFinish;
+    bool m_active = true;
+    IntersectionBuffer m_rayBuffer;
 
+    void reset();
     void navigateTo(const Point& p, std::function<void(CAgent&)> onFinish);
     void startPatrol();
     void startChase();
 
     bool hasLineOfSight(Matrix& m, Vec2f& ray, double& hAngle, double& vAngle,
-      double& height) const;
+      double& height);
 
     void followPath(TimeService& timeService);
     void attemptShot(TimeService& timeService, AudioService& audioService);
@@ -91,6 +96,7 @@ class AgentSystem : public System {
     void removeEntity(entityId_t id) override;
 
     void navigateTo(entityId_t entityId, const Point& point);
+    void setActive(entityId_t entityId, bool active);
 
   private:
     TimeService& m_timeService;
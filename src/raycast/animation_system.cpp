@@ -6,26 +6,40 @@
 using std::vector;
 using std::set;
 using std::pair;
+using std::map;
+using std::tuple;
 
 
 //===========================================
 // constructFrames
+//
+// Entities of the same type request the same frames, so the results are memoised, allowing every
+// such entity to share one set of views
 //===========================================
 vector<AnimationFrame> constructFrames(int W, int H, const vector<int>& rows) {
+  static map<tuple<int, int, vector<int>>, vector<AnimationFrame>> memo;
+
+  auto key = std::make_tuple(W, H, rows);
+  auto it = memo.find(key);
+  if (it != memo.end()) {
+    return it->second;
+  }
+
   double w = 1.0 / W;
   double h = 1.0 / H;
 
   vector<AnimationFrame> frames;
   for (int f : rows) {
-    AnimationFrame frame;
+    vector<QRectF> texViews;
 
     for (int v = 0; v < W; ++v) {
-      frame.texViews.push_back(QRectF(w * v, h * f, w, h));
+      texViews.push_back(QRectF(w * v, h * f, w, h));
     }
 
-    frames.push_back(frame);
+    frames.push_back(AnimationFrame(texViews));
   }
 
+  memo.insert(std::make_pair(key, frames));
   return frames;
 }
 
@@ -93,9 +107,9 @@ void AnimationSystem::playAnimation(entityId_t entityId, const std::string& name
   if (it != m_components.end()) {
     CAnimation& component = *it->second;
 
-    auto jt = component.m_animations.find(name);
-    if (jt != component.m_animations.end()) {
-      pair<pAnimation_t, pAnimation_t>& anims = jt->second;
+    auto jt = component.m_clipIds.find(name);
+    if (jt != component.m_clipIds.end()) {
+      pair<pAnimation_t, pAnimation_t>& anims = component.m_clips[jt->second];
 
       stopAnimation(entityId, false);
 
@@ -106,7 +120,9 @@ void AnimationSystem::playAnimation(entityId_t entityId, const std::string& name
         anims.second->start(loop);
       }
 
-      component.m_active = name;
+      component.m_active = jt->second;
+      component.m_boundFrame[0] = -1;
+      component.m_boundFrame[1] = -1;
     }
   }
 
@@ -125,8 +141,8 @@ void AnimationSystem::stopAnimation(entityId_t entityId, bool recurseIntoChildre
   if (it != m_components.end()) {
     CAnimation& component = *it->second;
 
-    if (component.m_active != "") {
-      auto& anims = component.m_animations[component.m_active];
+    if (component.m_active != -1) {
+      auto& anims = component.m_clips[component.m_active];
       if (anims.first) {
         anims.first->stop();
       }
@@ -146,74 +162,88 @@ void AnimationSystem::stopAnimation(entityId_t entityId, bool recurseIntoChildre
 }
 
 //===========================================
-// AnimationSystem::updateAnimations
+// AnimationSystem::bindFrame
 //===========================================
-void AnimationSystem::updateAnimation(CAnimation& c, int which) {
-  if (c.m_active == "") {
-    return;
-  }
-
-  entityId_t entityId = c.entityId();
+void AnimationSystem::bindFrame(CRender& render, const AnimationFrame& frame, int which) const {
+  const QRectF& texRect = frame.texViews->front();
 
-  Animation* anim = nullptr;
-  auto& anims = c.m_animations[c.m_active];
-
-  if (which == 0) {
-    anim = anims.first.get();
-  }
-  else if (which == 1) {
-    anim = anims.second.get();
-  }
-
-  if (anim != nullptr) {
-    bool justFinished = anim->update();
-
-    RenderSystem& renderSystem = m_entityManager.system<RenderSystem>(ComponentKind::C_RENDER);
-    CRender& render = renderSystem.getComponent(entityId);
-
-    if (render.kind == CRenderKind::SPRITE) {
-      CSprite& sprite = dynamic_cast<CSprite&>(render);
-      sprite.texViews = anim->currentFrame().texViews;
+  switch (render.kind) {
+    case CRenderKind::SPRITE: {
+      DYNAMIC_CAST<CSprite&>(render).frameViews = frame.texViews;
+      break;
     }
-    else if (render.kind == CRenderKind::OVERLAY) {
-      COverlay& overlay = dynamic_cast<COverlay&>(render);
+    case CRenderKind::OVERLAY: {
+      COverlay& overlay = DYNAMIC_CAST<COverlay&>(render);
 
       if (overlay.kind == COverlayKind::IMAGE) {
-        CImageOverlay& imgOverlay = dynamic_cast<CImageOverlay&>(render);
-        imgOverlay.texRect = anim->currentFrame().texViews[0];
+        DYNAMIC_CAST<CImageOverlay&>(overlay).texRect = texRect;
       }
+      break;
     }
-    else if (render.kind == CRenderKind::WALL_DECAL) {
-      CWallDecal& decal = dynamic_cast<CWallDecal&>(render);
-      decal.texRect = anim->currentFrame().texViews[0];
+    case CRenderKind::WALL_DECAL: {
+      DYNAMIC_CAST<CWallDecal&>(render).texRect = texRect;
+      break;
     }
-    else if (render.kind == CRenderKind::WALL) {
-      CWall& wall = dynamic_cast<CWall&>(render);
-      wall.texRect = anim->currentFrame().texViews[0];
+    case CRenderKind::WALL: {
+      DYNAMIC_CAST<CWall&>(render).texRect = texRect;
+      break;
     }
-    else if (render.kind == CRenderKind::JOIN) {
-      CJoin& join = dynamic_cast<CJoin&>(render);
+    case CRenderKind::JOIN: {
+      CJoin& join = DYNAMIC_CAST<CJoin&>(render);
 
       if (which == 0) {
-        join.bottomTexRect = anim->currentFrame().texViews[0];
+        join.bottomTexRect = texRect;
       }
       else {
-        join.topTexRect = anim->currentFrame().texViews[0];
+        join.topTexRect = texRect;
       }
+      break;
     }
-    else if (render.kind == CRenderKind::REGION) {
-      CRegion& region = dynamic_cast<CRegion&>(render);
+    case CRenderKind::REGION: {
+      CRegion& region = DYNAMIC_CAST<CRegion&>(render);
 
       if (which == 0) {
-        region.floorTexRect = anim->currentFrame().texViews[0];
+        region.floorTexRect = texRect;
       }
       else {
-        region.ceilingTexRect = anim->currentFrame().texViews[0];
+        region.ceilingTexRect = texRect;
       }
+      break;
+    }
+    default: break;
+  }
+}
+
+//===========================================
+// AnimationSystem::updateAnimation
+//
+// The render component is only touched when the frame index has changed since it was last bound
+//===========================================
+void AnimationSystem::updateAnimation(CAnimation& c, int which, RenderSystem& renderSystem) {
+  if (c.m_active == -1) {
+    return;
+  }
+
+  entityId_t entityId = c.entityId();
+
+  auto& anims = c.m_clips[c.m_active];
+  Animation* anim = which == 0 ? anims.first.get() : anims.second.get();
+
+  if (anim != nullptr) {
+    bool justFinished = anim->update();
+
+    int frameIdx = static_cast<int>(anim->currentFrameIdx());
+    if (frameIdx != c.m_boundFrame[which] && !anim->frames.empty()) {
+      CRender& render = renderSystem.getComponent(entityId);
+
+      bindFrame(render, anim->currentFrame(), which);
+      renderSystem.markChanged(render);
+
+      c.m_boundFrame[which] = frameIdx;
     }
 
     if (anim->state() == AnimState::STOPPED) {
-      c.m_active = "";
+      c.m_active = -1;
     }
 
     if (justFinished) {
@@ -226,9 +256,11 @@ void AnimationSystem::updateAnimation(CAnimation& c, int which) {
 // AnimationSystem::update
 //===========================================
 void AnimationSystem::update() {
+  RenderSystem& renderSystem = m_entityManager.system<RenderSystem>(ComponentKind::C_RENDER);
+
   for (auto it = m_components.begin(); it != m_components.end(); ++it) {
-    updateAnimation(*it->second, 0);
-    updateAnimation(*it->second, 1);
+    updateAnimation(*it->second, 0, renderSystem);
+    updateAnimation(*it->second, 1, renderSystem);
   }
 }
 
@@ -4,13 +4,20 @@
 
 #include <map>
 #include <vector>
+#include <memory>
 #include <QRectF>
 #include "raycast/system.hpp"
+#include "raycast/render_components.hpp"
 #include "exception.hpp"
 
 
+// The views are immutable and shared with the sprites displaying the frame, so binding a frame to
+// a render component doesn't copy them
 struct AnimationFrame {
-  std::vector<QRectF> texViews;
+  AnimationFrame(const std::vector<QRectF>& texViews)
+    : texViews(std::make_shared<const std::vector<QRectF>>(texViews)) {}
+
+  pTexViews_t texViews;
 };
 
 enum class AnimState {
@@ -38,6 +45,10 @@ class Animation {
       return frames[m_currentFrameIdx];
     }
 
+    unsigned int currentFrameIdx() const {
+      return m_currentFrameIdx;
+    }
+
     AnimState state() const {
       return m_state;
     }
@@ -76,25 +87,40 @@ class CAnimation : public Component {
     // For CRegions, anim1 and anim2 are for floors and ceilings, respectively.
     // For CJoins, anim1 and anim2 are for the bottom wall and the top wall, respectively.
     void addAnimation(pAnimation_t anim1, pAnimation_t anim2 = nullptr) {
-      m_animations[anim1->name].first = std::move(anim1);
+      if (anim2 && anim2->name != anim1->name) {
+        EXCEPTION("Pair of animations '" << anim1->name << "' and '" << anim2->name
+          << "' do not have same name");
+      }
+
+      auto it = m_clipIds.find(anim1->name);
+      if (it == m_clipIds.end()) {
+        it = m_clipIds.insert(std::make_pair(anim1->name, static_cast<int>(m_clips.size())))
+          .first;
+        m_clips.emplace_back();
+      }
+
+      auto& clip = m_clips[it->second];
+      clip.first = std::move(anim1);
 
       if (anim2) {
-        if (anim2->name != anim1->name) {
-          EXCEPTION("Pair of animations '" << anim1->name << "' and '" << anim2->name
-            << "' do not have same name");
-        }
-        m_animations[anim2->name].second = std::move(anim2);
+        clip.second = std::move(anim2);
       }
     }
 
   private:
-    std::string m_active;
-    std::map<std::string, std::pair<pAnimation_t, pAnimation_t>> m_animations;
+    // Animations are looked up by name once, when played, and by index thereafter
+    int m_active = -1;
+    std::map<std::string, int> m_clipIds;
+    std::vector<std::pair<pAnimation_t, pAnimation_t>> m_clips;
+
+    // The frame index last written to the render component for each of the pair, or -1
+    int m_boundFrame[2] = { -1, -1 };
 };
 
 typedef std::unique_ptr<CAnimation> pCAnimation_t;
 
 class EntityManager;
+class RenderSystem;
 
 class AnimationSystem : public System {
   public:
@@ -119,13 +145,18 @@ class AnimationSystem : public System {
     EntityManager& m_entityManager;
     std::map<entityId_t, pCAnimation_t> m_components;
 
-    void updateAnimation(CAnimation& c, int which);
+    void updateAnimation(CAnimation& c, int which, RenderSystem& renderSystem);
+    void bindFrame(CRender& render, const AnimationFrame& frame, int which) const;
 };
 
+//===========================================
+// AnimationSystem::animationState
+//===========================================
 inline AnimState AnimationSystem::animationState(entityId_t entityId,
   const std::string& name) const {
 
-  return m_components.at(entityId)->m_animations.at(name).first->state();
+  const CAnimation& c = *m_components.at(entityId);
+  return c.m_clips[c.m_clipIds.at(name)].first->state();
 }
 
 std::vector<AnimationFrame> constructFrames(int W, int H, const std::vector<int>& rows);
@@ -7,12 +7,83 @@
 using std::set;
 
 
+//===========================================
+// CBehaviour::wake
+//===========================================
+void CBehaviour::wake() {
+  if (m_system != nullptr) {
+    m_system->setAwake(*this, true);
+  }
+  else {
+    m_awake = true;
+  }
+}
+
+//===========================================
+// CBehaviour::sleep
+//===========================================
+void CBehaviour::sleep() {
+  if (m_system != nullptr) {
+    m_system->setAwake(*this, false);
+  }
+  else {
+    m_awake = false;
+  }
+}
+
+//===========================================
+// CBehaviour::isAwake
+//===========================================
+bool CBehaviour::isAwake() const {
+  return m_awake;
+}
+
+//===========================================
+// BehaviourSystem::setAwake
+//
+// Sleeping swaps the last awake behaviour into the vacated slot, so both directions are O(1)
+//===========================================
+void BehaviourSystem::setAwake(CBehaviour& c, bool awake) {
+  if (c.m_awake == awake) {
+    return;
+  }
+
+  c.m_awake = awake;
+
+  if (awake) {
+    c.m_awakeIdx = static_cast<int>(m_awake.size());
+    m_awake.push_back(&c);
+  }
+  else {
+    CBehaviour* last = m_awake.back();
+
+    m_awake[c.m_awakeIdx] = last;
+    last->m_awakeIdx = c.m_awakeIdx;
+
+    m_awake.pop_back();
+    c.m_awakeIdx = -1;
+  }
+}
+
+//===========================================
+// BehaviourSystem::numAwake
+//===========================================
+int BehaviourSystem::numAwake() const {
+  return static_cast<int>(m_awake.size());
+}
+
 //===========================================
 // BehaviourSystem::update
+//
+// Behaviours woken during the update are first updated next frame
 //===========================================
 void BehaviourSystem::update() {
-  for (auto it = m_components.begin(); it != m_components.end(); ++it) {
-    it->second->update();
+  m_updating.assign(m_awake.begin(), m_awake.end());
+
+  for (CBehaviour* c : m_updating) {
+    if (c->m_awake) {
+      c->update();
+    }
   }
 }
 
@@ -20,8 +91,10 @@ void BehaviourSystem::update() {
 // BehaviourSystem::handleEvent
 //===========================================
 void BehaviourSystem::handleEvent(const GameEvent& event, const set<entityId_t>& entities) {
-  for (auto it = m_components.begin(); it != m_components.end(); ++it) {
-    if (entities.count(it->first)) {
+  for (entityId_t id : entities) {
+    auto it = m_components.find(id);
+
+    if (it != m_components.end()) {
       CBehaviour& c = *it->second;
       c.handleTargetedEvent(event);
     }
@@ -61,12 +134,26 @@ void BehaviourSystem::addComponent(pComponent_t component) {
   }
 
   CBehaviour* p = dynamic_cast<CBehaviour*>(component.release());
-  m_components.insert(std::make_pair(p->entityId(), pCBehaviour_t(p)));
+  auto result = m_components.insert(std::make_pair(p->entityId(), pCBehaviour_t(p)));
+
+  if (result.second) {
+    p->m_system = this;
+
+    if (p->m_awake) {
+      p->m_awake = false;
+      setAwake(*p, true);
+    }
+  }
 }
 
 //===========================================
 // BehaviourSystem::removeEntity
 //===========================================
 void BehaviourSystem::removeEntity(entityId_t entityId) {
-  m_components.erase(entityId);
+  auto it = m_components.find(entityId);
+
+  if (it != m_components.end()) {
+    setAwake(*it->second, false);
+    m_components.erase(it);
+  }
 }
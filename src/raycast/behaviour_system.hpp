@@ -5,10 +5,16 @@
 #include <functional>
 #include <memory>
 #include <map>
+#include <vector>
 #include "raycast/system.hpp"
 #include "raycast/component.hpp"
 
 
+class BehaviourSystem;
+
+// Behaviours are awake when created. A sleeping behaviour isn't updated each frame but still
+// receives events, so a behaviour with nothing to do should sleep and wake itself when an event
+// or timeout gives it something to do.
 struct CBehaviour : public Component {
   CBehaviour(entityId_t entityId)
     : Component(entityId, ComponentKind::C_BEHAVIOUR) {}
@@ -16,6 +22,18 @@ struct CBehaviour : public Component {
   virtual void update() = 0;
   virtual void handleBroadcastedEvent(const GameEvent& event) = 0;
   virtual void handleTargetedEvent(const GameEvent& event) = 0;
+
+  void wake();
+  void sleep();
+  bool isAwake() const;
+
+  private:
+    friend class BehaviourSystem;
+
+    BehaviourSystem* m_system = nullptr;
+    bool m_awake = true;
+    // Position in the system's list of awake behaviours
+    int m_awakeIdx = -1;
 };
 
 typedef std::unique_ptr<CBehaviour> pCBehaviour_t;
@@ -31,8 +49,19 @@ class BehaviourSystem : public System {
     CBehaviour& getComponent(entityId_t entityId) const override;
     void removeEntity(entityId_t id) override;
 
+    int numAwake() const;
+
   private:
+    friend struct CBehaviour;
+
+    void setAwake(CBehaviour& c, bool awake);
+
     std::map<entityId_t, pCBehaviour_t> m_components;
+
+    // Only these are updated each frame
+    std::vector<CBehaviour*> m_awake;
+    // Scratch copy of m_awake, so behaviours can wake and sleep during the update
+    std::vector<CBehaviour*> m_updating;
 };
 
 
@@ -20,7 +20,7 @@ CDoorBehaviour::CDoorBehaviour(entityId_t entityId, EntityManager& entityManager
     m_entityManager(entityManager),
     m_timeService(timeService),
     m_audioService(audioService),
-    m_timer(5.0) {
+    m_timer(timeService, m_pauseTime) {
 
   CZone& zone = entityManager.getComponent<CZone>(entityId, ComponentKind::C_SPATIAL);
 
@@ -28,13 +28,39 @@ CDoorBehaviour::CDoorBehaviour(entityId_t entityId, EntityManager& entityManager
   m_y1 = zone.ceilingHeight;
 
   zone.ceilingHeight = zone.floorHeight + 0.1;
+  entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL).markChanged(zone);
+
+  sleep();
 }
 
 //===========================================
 // CDoorBehaviour::setPauseTime
 //===========================================
 void CDoorBehaviour::setPauseTime(double t) {
-  m_timer = Debouncer{t};
+  m_pauseTime = t;
+  m_timer = Debouncer{m_timeService, t};
+}
+
+//===========================================
+// CDoorBehaviour::sleepWhileOpen
+//
+// The door is looked up again when the timeout fires in case it's been deleted in the meantime
+//===========================================
+void CDoorBehaviour::sleepWhileOpen() {
+  sleep();
+
+  if (closeAutomatically) {
+    EntityManager& entityManager = m_entityManager;
+    entityId_t id = entityId();
+
+    m_timeService.onTimeout([&entityManager, id]() {
+      auto& behaviourSystem = entityManager.system<BehaviourSystem>(ComponentKind::C_BEHAVIOUR);
+
+      if (behaviourSystem.hasComponent(id)) {
+        behaviourSystem.getComponent(id).wake();
+      }
+    }, m_pauseTime);
+  }
 }
 
 //===========================================
@@ -68,10 +94,14 @@ void CDoorBehaviour::update() {
 
   switch (m_state) {
     case ST_CLOSED: {
+      sleep();
       return;
     }
     case ST_OPEN: {
-      if (closeAutomatically && m_timer.ready()) {
+      if (!closeAutomatically) {
+        sleep();
+      }
+      else if (m_timer.ready()) {
         m_state = ST_CLOSING;
         playSound();
 
@@ -82,10 +112,12 @@ void CDoorBehaviour::update() {
     }
     case ST_OPENING: {
       zone.ceilingHeight += dy;
+      spatialSystem.markChanged(zone);
 
       if (zone.ceilingHeight + dy >= m_y1) {
         m_state = ST_OPEN;
         stopSound();
+        sleepWhileOpen();
 
         m_entityManager.fireEvent(EDoorOpenFinish{entityId()}, { entityId() });
         m_entityManager.broadcastEvent(EDoorOpenFinish{entityId()});
@@ -98,6 +130,7 @@ void CDoorBehaviour::update() {
     }
     case ST_CLOSING: {
       zone.ceilingHeight -= dy;
+      spatialSystem.markChanged(zone);
 
       if (player.region() == entityId()) {
         if (zone.ceilingHeight - dy <= player.headHeight()) {
@@ -109,6 +142,7 @@ void CDoorBehaviour::update() {
       else if (zone.ceilingHeight - dy <= m_y0) {
         m_state = ST_CLOSED;
         stopSound();
+        sleep();
         m_entityManager.fireEvent(EDoorCloseFinish{entityId()}, { entityId() });
         m_entityManager.broadcastEvent(EDoorCloseFinish{entityId()});
       }
@@ -126,6 +160,7 @@ void CDoorBehaviour::handleBroadcastedEvent(const GameEvent& e) {
     if (m_state != ST_OPEN) {
       m_state = ST_OPENING;
       playSound();
+      wake();
     }
   }
 }
@@ -153,6 +188,8 @@ void CDoorBehaviour::handleTargetedEvent(const GameEvent& e) {
   }
 
   if (EVENT_NAMES.count(e.name)) {
+    wake();
+
     switch (m_state) {
       case ST_CLOSED: {
         m_state = ST_OPENING;
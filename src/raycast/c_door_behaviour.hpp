@@ -72,11 +72,13 @@ class CDoorBehaviour : public CBehaviour {
     state_t m_state = ST_CLOSED;
     double m_y0;
     double m_y1;
+    double m_pauseTime = 5.0;
     Debouncer m_timer;
     int m_soundId = -1;
 
     void playSound();
     void stopSound() const;
+    void sleepWhileOpen();
 };
 
 
@@ -4,6 +4,7 @@
 #include "raycast/c_switch_behaviour.hpp"
 #include "raycast/entity_manager.hpp"
 #include "raycast/spatial_components.hpp"
+#include "raycast/spatial_system.hpp"
 #include "raycast/audio_service.hpp"
 #include "event.hpp"
 #include "exception.hpp"
@@ -38,6 +39,9 @@ CElevatorBehaviour::CElevatorBehaviour(entityId_t entityId, EntityManager& entit
 
   CZone& zone = m_entityManager.getComponent<CZone>(this->entityId(), ComponentKind::C_SPATIAL);
   zone.floorHeight = m_levels[m_target];
+  m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL).markChanged(zone);
+
+  sleep();
 }
 
 //===========================================
@@ -76,6 +80,7 @@ void CElevatorBehaviour::update() {
 
   switch (m_state) {
     case ST_STOPPED: {
+      sleep();
       return;
     }
     case ST_MOVING: {
@@ -84,10 +89,12 @@ void CElevatorBehaviour::update() {
       double dy = dir * m_speed / m_frameRate;
 
       zone.floorHeight += dy;
+      m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL).markChanged(zone);
 
       if (fabs(zone.floorHeight + dy - targetY) < fabs(dy)) {
         m_state = ST_STOPPED;
         zone.floorHeight = targetY;
+        sleep();
 
         m_entityManager.broadcastEvent(EElevatorStopped(entityId()));
 
@@ -108,6 +115,7 @@ void CElevatorBehaviour::move(int level) {
   if (m_state == ST_STOPPED) {
     m_state = ST_MOVING;
     playSound();
+    wake();
   }
 }
 
@@ -137,6 +145,7 @@ void CElevatorBehaviour::handleTargetedEvent(const GameEvent& e) {
 
       m_state = ST_MOVING;
       playSound();
+      wake();
     }
   }
 }
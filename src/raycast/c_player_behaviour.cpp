@@ -17,7 +17,10 @@ CPlayerBehaviour::CPlayerBehaviour(entityId_t entityId, EntityManager& entityMan
   : CBehaviour(entityId),
     SystemAccessor(entityManager),
     m_entityManager(entityManager),
-    m_timeService(timeService) {}
+    m_timeService(timeService) {
+
+  sleep();
+}
 
 //===========================================
 // CPlayerBehaviour::update
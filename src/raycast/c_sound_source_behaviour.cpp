@@ -12,7 +12,10 @@ CSoundSourceBehaviour::CSoundSourceBehaviour(entityId_t entityId, const std::str
     name(name),
     pos(pos),
     radius(radius),
-    m_audioService(audioService) {}
+    m_audioService(audioService) {
+
+  sleep();
+}
 
 //===========================================
 // CSoundSourceBehaviour::handleBroadcastedEvent
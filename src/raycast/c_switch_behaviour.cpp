@@ -26,9 +26,10 @@ CSwitchBehaviour::CSwitchBehaviour(entityId_t entityId, EntityManager& entityMan
     m_message(message),
     m_state(initialState),
     m_toggleable(toggleable),
-    m_timer(toggleDelay) {
+    m_timer(timeService, toggleDelay) {
 
   setDecal();
+  sleep();
 }
 
 //===========================================
@@ -71,6 +72,7 @@ void CSwitchBehaviour::setDecal() {
   CWallDecal* decal = getDecal();
   if (decal != nullptr) {
     decal->texRect = texRect;
+    m_entityManager.system<RenderSystem>(ComponentKind::C_RENDER).markChanged(*decal);
   }
 }
 
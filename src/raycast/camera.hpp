@@ -42,6 +42,10 @@ class Camera {
       return Matrix(m_body.angle, Vec2f(m_body.pos.x, m_body.pos.y));
     }
 
+    RigidTransform transform() const {
+      return RigidTransform(m_body.angle, Vec2f(m_body.pos.x, m_body.pos.y));
+    }
+
     double angle() const {
       return m_body.angle;
     }
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cmath>
+#include "raycast/collectable_index.hpp"
+#include "exception.hpp"
+
+
+using std::vector;
+
+
+static const double MAX_VERTICAL_DISTANCE = 40.0;
+
+
+//===========================================
+// CollectableIndex::insert
+//===========================================
+void CollectableIndex::insert(const CVRect& body, entityId_t zoneId) {
+  if (contains(body.entityId())) {
+    EXCEPTION("Error indexing collectable; Entity " << body.entityId() << " already indexed");
+  }
+
+  vector<const CVRect*>& bodies = m_zones[zoneId];
+
+  m_locations[body.entityId()] = Location{zoneId, static_cast<int>(bodies.size())};
+  bodies.push_back(&body);
+}
+
+//===========================================
+// CollectableIndex::move
+//===========================================
+void CollectableIndex::move(entityId_t entityId, entityId_t zoneId) {
+  auto it = m_locations.find(entityId);
+  if (it == m_locations.end() || it->second.zoneId == zoneId) {
+    return;
+  }
+
+  const CVRect& body = *m_zones[it->second.zoneId][it->second.idx];
+
+  remove(entityId);
+  insert(body, zoneId);
+}
+
+//===========================================
+// CollectableIndex::remove
+//
+// The last collectable in the zone takes the removed one's place
+//===========================================
+void CollectableIndex::remove(entityId_t entityId) {
+  auto it = m_locations.find(entityId);
+  if (it == m_locations.end()) {
+    return;
+  }
+
+  Location loc = it->second;
+  m_locations.erase(it);
+
+  vector<const CVRect*>& bodies = m_zones[loc.zoneId];
+  const CVRect* last = bodies.back();
+
+  bodies[loc.idx] = last;
+  bodies.pop_back();
+
+  if (last->entityId() != entityId) {
+    m_locations[last->entityId()].idx = loc.idx;
+  }
+}
+
+//===========================================
+// CollectableIndex::contains
+//===========================================
+bool CollectableIndex::contains(entityId_t entityId) const {
+  return m_locations.find(entityId) != m_locations.end();
+}
+
+//===========================================
+// CollectableIndex::size
+//===========================================
+int CollectableIndex::size() const {
+  return static_cast<int>(m_locations.size());
+}
+
+//===========================================
+// CollectableIndex::findInZone
+//===========================================
+void CollectableIndex::findInZone(const CZone& zone, const CVRect& collector, double radius,
+  vector<entityId_t>& out) const {
+
+  auto it = m_zones.find(zone.entityId());
+  if (it == m_zones.end()) {
+    return;
+  }
+
+  double y1 = collector.zone->floorHeight + collector.y;
+
+  for (const CVRect* body : it->second) {
+    double reach = radius + 0.5 * body->size.x;
+
+    if (distance(collector.pos, body->pos) <= reach) {
+      double y2 = zone.floorHeight + body->y + 0.5 * body->size.y;
+
+      if (fabs(y1 - y2) <= MAX_VERTICAL_DISTANCE) {
+        out.push_back(body->entityId());
+      }
+    }
+  }
+}
+
+//===========================================
+// CollectableIndex::findNear
+//
+// Searches the collector's zone, its parent and children, and the zones on the other side of its
+// soft edges
+//===========================================
+void CollectableIndex::findNear(const CVRect& collector, double radius,
+  vector<entityId_t>& out) const {
+
+  if (collector.zone == nullptr) {
+    return;
+  }
+
+  const CZone& zone = *collector.zone;
+
+  m_searchZones.clear();
+
+  auto addZone = [this](const CZone* z) {
+    if (z != nullptr
+      && std::find(m_searchZones.begin(), m_searchZones.end(), z) == m_searchZones.end()) {
+
+      m_searchZones.push_back(z);
+    }
+  };
+
+  addZone(&zone);
+  addZone(zone.parent);
+
+  for (auto& child : zone.children) {
+    addZone(child.get());
+  }
+
+  for (auto& edge : zone.edges) {
+    if (edge->kind == CSpatialKind::SOFT_EDGE) {
+      const CSoftEdge& se = dynamic_cast<const CSoftEdge&>(*edge);
+
+      addZone(se.zoneA);
+      addZone(se.zoneB);
+    }
+  }
+
+  size_t first = out.size();
+
+  for (const CZone* z : m_searchZones) {
+    findInZone(*z, collector, radius, out);
+  }
+
+  std::sort(out.begin() + first, out.end());
+}
@@ -0,0 +1,47 @@
+#ifndef __PROCALC_RAYCAST_COLLECTABLE_INDEX_HPP_
+#define __PROCALC_RAYCAST_COLLECTABLE_INDEX_HPP_
+
+
+#include <vector>
+#include <unordered_map>
+#include "raycast/spatial_components.hpp"
+
+
+// Collectables grouped by the zone they're in, so a collector need only look at the collectables
+// in its own zone and the zones next to it.
+//
+// Only the collector's zone, its parent and children, and the zones across its soft edges are
+// searched. A collectable any further away isn't found, even if it's within reach, e.g. one just
+// across the corner where four zones meet. The reach should be small next to the zones.
+//
+// Positions are read from the collectables' bodies on each search, so a collectable needs
+// re-filing only when it changes zone.
+class CollectableIndex {
+  public:
+    void insert(const CVRect& body, entityId_t zoneId);
+    void move(entityId_t entityId, entityId_t zoneId);
+    void remove(entityId_t entityId);
+    bool contains(entityId_t entityId) const;
+    int size() const;
+
+    // Appends to out the IDs of the collectables within reach of the collector, in ID order
+    void findNear(const CVRect& collector, double radius, std::vector<entityId_t>& out) const;
+
+  private:
+    struct Location {
+      entityId_t zoneId;
+      int idx;
+    };
+
+    void findInZone(const CZone& zone, const CVRect& collector, double radius,
+      std::vector<entityId_t>& out) const;
+
+    std::unordered_map<entityId_t, std::vector<const CVRect*>> m_zones;
+    std::unordered_map<entityId_t, Location> m_locations;
+
+    // Scratch space, kept between calls to avoid reallocating
+    mutable std::vector<const CZone*> m_searchZones;
+};
+
+
+#endif
@@ -0,0 +1,173 @@
+#include <functional>
+#include "raycast/column_cache.hpp"
+#include "raycast/camera.hpp"
+#include "raycast/spatial_system.hpp"
+#include "raycast/render_system.hpp"
+#include "raycast/render_graph.hpp"
+
+
+using std::vector;
+using std::set;
+using std::string;
+
+
+//===========================================
+// hashCombine
+//===========================================
+template<class T>
+static void hashCombine(size_t& seed, const T& value) {
+  seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+//===========================================
+// hashRect
+//===========================================
+static void hashRect(size_t& seed, const QRectF& rect) {
+  hashCombine(seed, rect.x());
+  hashCombine(seed, rect.y());
+  hashCombine(seed, rect.width());
+  hashCombine(seed, rect.height());
+}
+
+//===========================================
+// hashTextures
+//===========================================
+static size_t hashTextures(const RenderGraph& rg) {
+  size_t seed = 0;
+
+  for (auto it = rg.textures.begin(); it != rg.textures.end(); ++it) {
+    hashCombine(seed, it->first);
+    hashCombine(seed, it->second.image.cacheKey());
+    hashCombine(seed, it->second.size_wd.x);
+    hashCombine(seed, it->second.size_wd.y);
+  }
+
+  return seed;
+}
+
+//===========================================
+// hashOverlays
+//===========================================
+static size_t hashOverlays(const RenderGraph& rg) {
+  size_t seed = 0;
+
+  for (auto it = rg.overlays.begin(); it != rg.overlays.end(); ++it) {
+    const COverlay& overlay = **it;
+
+    hashCombine(seed, overlay.entityId());
+    hashCombine(seed, static_cast<int>(overlay.kind));
+    hashCombine(seed, overlay.pos.x);
+    hashCombine(seed, overlay.pos.y);
+    hashCombine(seed, overlay.zIndex);
+
+    switch (overlay.kind) {
+      case COverlayKind::IMAGE: {
+        const CImageOverlay& imgOverlay = DYNAMIC_CAST<const CImageOverlay&>(overlay);
+        hashCombine(seed, imgOverlay.texture);
+        hashRect(seed, imgOverlay.texRect);
+        hashCombine(seed, imgOverlay.size.x);
+        hashCombine(seed, imgOverlay.size.y);
+        break;
+      }
+      case COverlayKind::TEXT: {
+        const CTextOverlay& textOverlay = DYNAMIC_CAST<const CTextOverlay&>(overlay);
+        hashCombine(seed, textOverlay.text);
+        hashCombine(seed, textOverlay.height);
+        hashCombine(seed, textOverlay.colour.rgba());
+        break;
+      }
+      case COverlayKind::COLOUR: {
+        const CColourOverlay& colOverlay = DYNAMIC_CAST<const CColourOverlay&>(overlay);
+        hashCombine(seed, colOverlay.colour.rgba());
+        hashCombine(seed, colOverlay.size.x);
+        hashCombine(seed, colOverlay.size.y);
+        break;
+      }
+    }
+  }
+
+  return seed;
+}
+
+//===========================================
+// ColumnCache::CameraPose::operator==
+//===========================================
+bool ColumnCache::CameraPose::operator==(const CameraPose& rhs) const {
+  return x == rhs.x && y == rhs.y && angle == rhs.angle && vAngle == rhs.vAngle
+    && height == rhs.height && hFov == rhs.hFov && vFov == rhs.vFov && zone == rhs.zone;
+}
+
+//===========================================
+// ColumnCache::addZoneDependency
+//
+// A zone's ancestors are included, as entities belonging to them may be visible from within it
+//===========================================
+void ColumnCache::addZoneDependency(const CZone& zone, vector<entityId_t>& dependencies) {
+  for (const CZone* z = &zone; z != nullptr; z = z->parent) {
+    dependencies.push_back(z->entityId());
+  }
+}
+
+//===========================================
+// ColumnCache::update
+//
+// Call once per frame before drawing, after which the systems' changes can be cleared. Returns the
+// number of dirty columns.
+//===========================================
+int ColumnCache::update(const Camera& cam, const SpatialSystem& spatialSystem,
+  const RenderSystem& renderSystem, const RenderGraph& rg, int numColumns) {
+
+  CameraPose pose;
+  pose.x = cam.pos().x;
+  pose.y = cam.pos().y;
+  pose.angle = cam.angle();
+  pose.vAngle = cam.vAngle;
+  pose.height = cam.height;
+  pose.hFov = cam.hFov;
+  pose.vFov = cam.vFov;
+  pose.zone = &cam.zone();
+
+  size_t texturesHash = hashTextures(rg);
+  size_t overlaysHash = hashOverlays(rg);
+
+  bool invalidateAll = !(pose == m_pose)
+    || texturesHash != m_texturesHash
+    || static_cast<int>(m_dirty.size()) != numColumns;
+
+  int numDirty = 0;
+
+  if (invalidateAll) {
+    m_dirty.assign(numColumns, true);
+    m_dependencies.assign(numColumns, vector<entityId_t>());
+
+    numDirty = numColumns;
+  }
+  else {
+    const set<entityId_t>& spatialChanges = spatialSystem.changedEntities();
+    const set<entityId_t>& renderChanges = renderSystem.changedEntities();
+
+    bool anyChanges = !spatialChanges.empty() || !renderChanges.empty();
+
+    for (int i = 0; i < numColumns; ++i) {
+      m_dirty[i] = false;
+
+      if (anyChanges) {
+        for (entityId_t id : m_dependencies[i]) {
+          if (spatialChanges.count(id) || renderChanges.count(id)) {
+            m_dirty[i] = true;
+            ++numDirty;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  m_overlaysChanged = invalidateAll || overlaysHash != m_overlaysHash;
+
+  m_pose = pose;
+  m_texturesHash = texturesHash;
+  m_overlaysHash = overlaysHash;
+
+  return numDirty;
+}
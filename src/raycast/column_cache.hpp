@@ -0,0 +1,78 @@
+#ifndef __PROCALC_RAYCAST_COLUMN_CACHE_HPP__
+#define __PROCALC_RAYCAST_COLUMN_CACHE_HPP__
+
+
+#include <set>
+#include <vector>
+#include "raycast/component.hpp"
+
+
+class Camera;
+class CZone;
+class SpatialSystem;
+class RenderSystem;
+struct RenderGraph;
+
+// Tracks which screen columns need to be redrawn between frames.
+//
+// The spatial and render systems record which entities have been added, removed or changed since
+// the last frame. The renderer records which entities each column depends on as it draws it, and
+// a column is only redrawn if one of those entities has changed. Any change to the camera pose,
+// textures or resolution invalidates everything.
+class ColumnCache {
+  public:
+    int update(const Camera& cam, const SpatialSystem& spatialSystem,
+      const RenderSystem& renderSystem, const RenderGraph& rg, int numColumns);
+
+    inline bool isDirty(int column) const;
+    inline bool overlaysChanged() const;
+    inline std::vector<entityId_t>& dependencies(int column);
+
+    static void addZoneDependency(const CZone& zone, std::vector<entityId_t>& dependencies);
+
+  private:
+    struct CameraPose {
+      double x = 0;
+      double y = 0;
+      double angle = 0;
+      double vAngle = 0;
+      double height = 0;
+      double hFov = 0;
+      double vFov = 0;
+      const CZone* zone = nullptr;
+
+      bool operator==(const CameraPose& rhs) const;
+    };
+
+    CameraPose m_pose;
+    size_t m_texturesHash = 0;
+    size_t m_overlaysHash = 0;
+    bool m_overlaysChanged = true;
+
+    std::vector<char> m_dirty;
+    std::vector<std::vector<entityId_t>> m_dependencies;
+};
+
+//===========================================
+// ColumnCache::isDirty
+//===========================================
+inline bool ColumnCache::isDirty(int column) const {
+  return m_dirty[column];
+}
+
+//===========================================
+// ColumnCache::overlaysChanged
+//===========================================
+inline bool ColumnCache::overlaysChanged() const {
+  return m_overlaysChanged;
+}
+
+//===========================================
+// ColumnCache::dependencies
+//===========================================
+inline std::vector<entityId_t>& ColumnCache::dependencies(int column) {
+  return m_dependencies[column];
+}
+
+
+#endif
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include "raycast/damage_system.hpp"
 #include "raycast/spatial_system.hpp"
 #include "raycast/entity_manager.hpp"
@@ -5,6 +7,7 @@
 
 using std::vector;
 using std::set;
+using std::pair;
 using std::make_pair;
 
 
@@ -81,40 +84,65 @@ static void fireDestroyedEvents(const EntityManager& entityManager, entityId_t i
 }
 
 //===========================================
-// DamageSystem::damageEntity
+// DamageSystem::collectDamageable_
+//
+// Appends the entity and any of its ancestors that can be damaged, each paired with the given
+// damage. Walks the parent chain directly rather than building a set of ancestors.
 //===========================================
-void DamageSystem::damageEntity(entityId_t entityId, int damage) {
-  set<entityId_t> entities = spatialSys().getAncestors(entityId);
-  entities.insert(entityId);
+void DamageSystem::collectDamageable_(entityId_t entityId, int damage,
+  vector<pair<entityId_t, int>>& targets) const {
 
-  for (entityId_t id : entities) {
-    auto it = m_components.find(id);
-    if (it != m_components.end()) {
-      DBG_PRINT("Damaging entity " << id << "\n");
-      CDamage& component = *it->second;
+  const SpatialSystem& spatialSystem = spatialSys();
 
-      if (component.health > 0 || damage < 0) {
-        int prevHealth = component.health;
-        component.health -= damage;
+  for (entityId_t id = entityId; id != -1; id = spatialSystem.getComponent(id).parentId) {
+    if (m_components.count(id)) {
+      targets.push_back(make_pair(id, damage));
+    }
+  }
+}
 
-        if (component.health < 0) {
-          component.health = 0;
-        }
+//===========================================
+// DamageSystem::applyDamage_
+//===========================================
+void DamageSystem::applyDamage_(entityId_t id, int damage) {
+  auto it = m_components.find(id);
+  if (it != m_components.end()) {
+    DBG_PRINT("Damaging entity " << id << "\n");
+    CDamage& component = *it->second;
+
+    if (component.health > 0 || damage < 0) {
+      int prevHealth = component.health;
+      component.health -= damage;
+
+      if (component.health < 0) {
+        component.health = 0;
+      }
 
-        if (component.health > component.maxHealth) {
-          component.health = component.maxHealth;
-        }
+      if (component.health > component.maxHealth) {
+        component.health = component.maxHealth;
+      }
 
-        fireDamagedEvents(m_entityManager, id, component.health, prevHealth);
+      fireDamagedEvents(m_entityManager, id, component.health, prevHealth);
 
-        if (component.health == 0) {
-          fireDestroyedEvents(m_entityManager, id);
-        }
+      if (component.health == 0) {
+        fireDestroyedEvents(m_entityManager, id);
       }
     }
   }
 }
 
+//===========================================
+// DamageSystem::damageEntity
+//===========================================
+void DamageSystem::damageEntity(entityId_t entityId, int damage) {
+  vector<pair<entityId_t, int>> targets;
+  collectDamageable_(entityId, damage, targets);
+
+  for (auto& target : targets) {
+    applyDamage_(target.first, target.second);
+  }
+}
+
 //===========================================
 // DamageSystem::getHealth
 //===========================================
@@ -129,18 +157,58 @@ int DamageSystem::getMaxHealth(entityId_t entityId) const {
   return m_components.at(entityId)->maxHealth;
 }
 
+//===========================================
+// attenuate
+//===========================================
+static int attenuate(int damage, double distance, double radius, AttenuationCurve curve) {
+  switch (curve) {
+    case AttenuationCurve::CONSTANT:
+      return damage;
+    case AttenuationCurve::LINEAR:
+      return static_cast<int>(std::round(damage * (1.0 - clipNumber(distance / radius,
+        Range(0, 1)))));
+  }
+
+  return damage;
+}
+
 //===========================================
 // DamageSystem::damageWithinRadius
+//
+// Each damageable entity is damaged once, by the largest amount owed to it by itself or any of
+// its descendants in range
 //===========================================
 void DamageSystem::damageWithinRadius(const CZone& zone, const Point& pos, double radius,
-  int damage, AttenuationCurve) {
+  int damage, AttenuationCurve attenuation) {
+
+  spatialSys().entitiesInRadius(zone, pos, radius, 0.0, m_radiusHits);
+
+  // Event handlers may trigger further explosions, so the targets are local
+  vector<pair<entityId_t, int>> targets;
+
+  for (const RadiusHit& hit : m_radiusHits) {
+    int d = attenuate(damage, hit.distance, radius, attenuation);
+
+    if (d != 0) {
+      collectDamageable_(hit.entityId, d, targets);
+    }
+  }
 
-  // TODO: Attenuation
+  // Order by ID then by decreasing damage, and keep the first for each ID
+  std::sort(targets.begin(), targets.end(), [](const pair<entityId_t, int>& a,
+    const pair<entityId_t, int>& b) {
 
-  set<entityId_t> entities = spatialSys().entitiesInRadius(zone, pos, radius);
+    return a.first < b.first || (a.first == b.first && std::abs(a.second) > std::abs(b.second));
+  });
 
-  for (auto it = entities.begin(); it != entities.end(); ++it) {
-    damageEntity(*it, damage);
+  targets.erase(std::unique(targets.begin(), targets.end(),
+    [](const pair<entityId_t, int>& a, const pair<entityId_t, int>& b) {
+
+    return a.first == b.first;
+  }), targets.end());
+
+  for (auto& target : targets) {
+    applyDamage_(target.first, target.second);
   }
 }
 
@@ -148,10 +216,12 @@ void DamageSystem::damageWithinRadius(const CZone& zone, const Point& pos, doubl
 // DamageSystem::damageAtIntersection_
 //===========================================
 void DamageSystem::damageAtIntersection_(const Intersection& X, int damage) {
-  set<entityId_t> entities = spatialSys().getAncestors(X.entityId);
-  entities.insert(X.entityId);
+  vector<pair<entityId_t, int>> targets;
+  collectDamageable_(X.entityId, damage, targets);
+
+  for (auto& target : targets) {
+    entityId_t id = target.first;
 
-  for (entityId_t id : entities) {
     auto it = m_components.find(id);
     if (it != m_components.end()) {
       CDamage& component = *it->second;
@@ -177,23 +247,41 @@ void DamageSystem::damageAtIntersection_(const Intersection& X, int damage) {
 }
 
 //===========================================
-// DamageSystem::damageAtIntersection
+// DamageSystem::damageNearestIntersections_
+//
+// Damages the nearest intersection and anything within the penetration distance behind it
 //===========================================
-void DamageSystem::damageAtIntersection(const Vec2f& ray, double camSpaceVAngle, int damage) {
-  vector<pIntersection_t> intersections = spatialSys().entitiesAlong3dRay(ray, camSpaceVAngle);
+void DamageSystem::damageNearestIntersections_(const IntersectionSpan& intersections, int damage) {
+  if (intersections.empty()) {
+    return;
+  }
 
-  if (intersections.size() > 0) {
-    double dist = intersections.front()->distanceFromOrigin;
+  double dist = intersections.front().distanceFromOrigin;
 
-    for (auto& i : intersections) {
-      if (i->distanceFromOrigin <= dist + PENETRATION_DISTANCE) {
-        damageAtIntersection_(*i, damage);
-      }
-      else {
-        break;
-      }
+  // Handlers of the damage events may cast rays of their own, re-using the buffer the span
+  // refers to, so take copies first
+  vector<Intersection> hits;
+
+  for (auto& X : intersections) {
+    if (X.distanceFromOrigin <= dist + PENETRATION_DISTANCE) {
+      hits.push_back(X);
+    }
+    else {
+      break;
     }
   }
+
+  for (auto& X : hits) {
+    damageAtIntersection_(X, damage);
+  }
+}
+
+//===========================================
+// DamageSystem::damageAtIntersection
+//===========================================
+void DamageSystem::damageAtIntersection(const Vec2f& ray, double camSpaceVAngle, int damage) {
+  damageNearestIntersections_(spatialSys().entitiesAlong3dRay(ray, camSpaceVAngle, m_rayBuffer),
+    damage);
 }
 
 //===========================================
@@ -202,19 +290,6 @@ void DamageSystem::damageAtIntersection(const Vec2f& ray, double camSpaceVAngle,
 void DamageSystem::damageAtIntersection(const CZone& zone, const Point& pos, double height,
   const Vec2f& dir, double vAngle, const Matrix& matrix, int damage) {
 
-  vector<pIntersection_t> intersections = spatialSys().entitiesAlong3dRay(zone, pos, height, dir,
-    vAngle, matrix);
-
-  if (intersections.size() > 0) {
-    double dist = intersections.front()->distanceFromOrigin;
-
-    for (auto& i : intersections) {
-      if (i->distanceFromOrigin <= dist + PENETRATION_DISTANCE) {
-        damageAtIntersection_(*i, damage);
-      }
-      else {
-        break;
-      }
-    }
-  }
+  damageNearestIntersections_(spatialSys().entitiesAlong3dRay(zone, pos, height, dir, vAngle,
+    matrix, m_rayBuffer), damage);
 }
@@ -5,10 +5,13 @@
 #include <functional>
 #include <memory>
 #include <map>
+#include <vector>
 #include "raycast/system.hpp"
 #include "raycast/component.hpp"
 #include "raycast/geometry.hpp"
 #include "raycast/system_accessor.hpp"
+#include "raycast/intersection.hpp"
+#include "raycast/spatial_system.hpp"
 
 
 struct EEntityDestroyed : public GameEvent {
@@ -58,7 +61,6 @@ enum class AttenuationCurve {
 
 class EntityManager;
 class CZone;
-struct Intersection;
 
 class DamageSystem : public System, private SystemAccessor {
   public:
@@ -91,8 +93,14 @@ class DamageSystem : public System, private SystemAccessor {
   private:
     EntityManager& m_entityManager;
     std::map<entityId_t, pCDamage_t> m_components;
+    IntersectionBuffer m_rayBuffer;
+    std::vector<RadiusHit> m_radiusHits;
 
+    void collectDamageable_(entityId_t entityId, int damage,
+      std::vector<std::pair<entityId_t, int>>& targets) const;
+    void applyDamage_(entityId_t id, int damage);
     void damageAtIntersection_(const Intersection& X, int damage);
+    void damageNearestIntersections_(const IntersectionSpan& intersections, int damage);
 };
 
 
@@ -19,10 +19,21 @@ void EntityManager::addSystem(ComponentKind kind, pSystem_t system) {
   m_systems[kind] = std::move(system);
 }
 
+#ifdef DEBUG
+//===========================================
+// EntityManager::setOwningThread
+//===========================================
+void EntityManager::setOwningThread(std::thread::id id) {
+  m_owner.store(id, std::memory_order_relaxed);
+}
+#endif
+
 //===========================================
 // EntityManager::hasComponent
 //===========================================
 bool EntityManager::hasComponent(entityId_t entityId, ComponentKind kind) const {
+  checkAccess();
+
   auto it = m_systems.find(kind);
   if (it == m_systems.end()) {
     return false;
@@ -36,6 +47,8 @@ bool EntityManager::hasComponent(entityId_t entityId, ComponentKind kind) const
 // EntityManager::addComponent
 //===========================================
 void EntityManager::addComponent(pComponent_t component) {
+  checkAccess();
+
   System& system = *m_systems.at(component->kind());
   system.addComponent(std::move(component));
 }
@@ -44,6 +57,8 @@ void EntityManager::addComponent(pComponent_t component) {
 // EntityManager::deleteEntity
 //===========================================
 void EntityManager::deleteEntity(entityId_t entityId) {
+  checkAccess();
+
   m_pendingDelete.insert(entityId);
 
   EEntityDeleted e{entityId};
@@ -56,6 +71,8 @@ void EntityManager::deleteEntity(entityId_t entityId) {
 // EntityManager::purgeEntities
 //===========================================
 void EntityManager::purgeEntities() {
+  checkAccess();
+
   for (entityId_t id : m_pendingDelete) {
     for (auto it = m_systems.begin(); it != m_systems.end(); ++it) {
       it->second->removeEntity(id);
@@ -69,6 +86,8 @@ void EntityManager::purgeEntities() {
 // EntityManager::update
 //===========================================
 void EntityManager::update() {
+  checkAccess();
+
   for (auto it = m_systems.begin(); it != m_systems.end(); ++it) {
     System& system = *it->second;
     system.update();
@@ -79,6 +98,8 @@ void EntityManager::update() {
 // EntityManager::broadcastEvent
 //===========================================
 void EntityManager::broadcastEvent(const GameEvent& event) const {
+  checkAccess();
+
   for (auto it = m_systems.begin(); it != m_systems.end(); ++it) {
     System& system = *it->second;
     system.handleEvent(event);
@@ -89,6 +110,8 @@ void EntityManager::broadcastEvent(const GameEvent& event) const {
 // EntityManager::fireEvent
 //===========================================
 void EntityManager::fireEvent(const GameEvent& event, const set<entityId_t>& entities) const {
+  checkAccess();
+
   for (auto it = m_systems.begin(); it != m_systems.end(); ++it) {
     System& system = *it->second;
     system.handleEvent(event, entities);
@@ -6,6 +6,11 @@
 #include <set>
 #include "raycast/component.hpp"
 #include "raycast/system.hpp"
+#ifdef DEBUG
+#  include <atomic>
+#  include <cassert>
+#  include <thread>
+#endif
 
 
 class EEntityDeleted : public GameEvent {
@@ -30,8 +35,17 @@ class EntityManager {
     void fireEvent(const GameEvent& event, const std::set<entityId_t>& entities) const;
     void update();
 
+#ifdef DEBUG
+    // The thread currently allowed to access the systems, or a default constructed ID if any
+    // thread may. The owner hands this over when it passes the systems to another thread (e.g.
+    // the renderer) and takes it back once that thread is finished with them.
+    void setOwningThread(std::thread::id id);
+#endif
+
     template<class T>
     T& getComponent(entityId_t entityId, ComponentKind kind) const {
+      checkAccess();
+
       System& sys = *m_systems.at(kind);
       Component& c = sys.getComponent(entityId);
 
@@ -40,13 +54,32 @@ class EntityManager {
 
     template<class T>
     T& system(ComponentKind kind) const {
+      checkAccess();
+
       return dynamic_cast<T&>(*m_systems.at(kind));
     }
 
   private:
     std::map<ComponentKind, pSystem_t> m_systems;
     std::set<entityId_t> m_pendingDelete;
+#ifdef DEBUG
+    std::atomic<std::thread::id> m_owner{std::thread::id()};
+#endif
+
+    inline void checkAccess() const;
 };
 
+//===========================================
+// EntityManager::checkAccess
+//
+// Does nothing in release builds
+//===========================================
+inline void EntityManager::checkAccess() const {
+#ifdef DEBUG
+  std::thread::id owner = m_owner.load(std::memory_order_relaxed);
+  assert(owner == std::thread::id() || owner == std::this_thread::get_id());
+#endif
+}
+
 
 #endif
@@ -69,7 +69,7 @@ void FocusSystem::update() {
   CTextOverlay& toolTip = dynamic_cast<CTextOverlay&>(renderSystem.getComponent(m_toolTipId));
   toolTip.text = "";
 
-  vector<pIntersection_t> intersections = spatialSys().entitiesAlong3dRay(Vec2f(1.0, 0), 0,
+  IntersectionSpan intersections = spatialSys().entitiesAlong3dRay(Vec2f(1.0, 0), 0, m_rayBuffer,
     m_focusDistance);
 
   if (intersections.size() > 0) {
@@ -77,20 +77,20 @@ void FocusSystem::update() {
 
     int highestZ = -9999;
     for (auto it = intersections.begin(); it != intersections.end(); ++it) {
-      if (!isWallDecal(renderSystem, **it)) {
+      if (!isWallDecal(renderSystem, *it)) {
         break;
       }
 
-      int z = getZIndex(renderSystem, **it);
+      int z = getZIndex(renderSystem, *it);
       if (z > highestZ) {
         highestZ = z;
         first = it;
       }
     }
 
-    pIntersection_t& X = *first;
+    const Intersection& X = *first;
 
-    auto it = m_components.find(X->entityId);
+    auto it = m_components.find(X.entityId);
     if (it != m_components.end()) {
       CFocus& c = *it->second;
 
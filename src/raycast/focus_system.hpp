@@ -8,6 +8,7 @@
 #include "raycast/system.hpp"
 #include "raycast/component.hpp"
 #include "raycast/system_accessor.hpp"
+#include "raycast/intersection.hpp"
 
 
 struct CFocus : public Component {
@@ -56,6 +57,7 @@ class FocusSystem : public System, private SystemAccessor {
     long m_captionTimeoutId = -1;
 
     std::map<entityId_t, pCFocus_t> m_components;
+    IntersectionBuffer m_rayBuffer;
 };
 
 
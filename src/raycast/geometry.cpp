@@ -1,9 +1,10 @@
-#include <cassert>
 #include <algorithm>
 #include "raycast/geometry.hpp"
 #include "utils.hpp"
 
 
+using std::vector;
+
 #ifdef DEBUG
 using std::ostream;
 
@@ -49,46 +50,62 @@ ostream& operator<<(ostream& os, const Range& range) {
 
 
 //===========================================
-// lineIntersect
+// lineSegmentIntersections
+//
+// Does the same as lineSegmentIntersect for each segment, with the work that only depends on
+// lseg done once
 //===========================================
-Point lineIntersect(const Line& l0, const Line& l1, int depth) {
-  assert(depth <= 1);
+void lineSegmentIntersections(const LineSegment& lseg, const LineSegment* lsegs, size_t n,
+  vector<SegmentHit>& hits) {
+
+  double minX = smallest(lseg.A.x, lseg.B.x);
+  double maxX = largest(lseg.A.x, lseg.B.x);
+  double minY = smallest(lseg.A.y, lseg.B.y);
+  double maxY = largest(lseg.A.y, lseg.B.y);
+
+  Vec2f r = lseg.B - lseg.A;
+  double tolerance = 0.00001 / largest(fabs(r.x), fabs(r.y));
 
-  if (l0.hasSteepGradient() || l1.hasSteepGradient()) {
-    Vec3f l0params(l0.a, l0.b, l0.c);
-    Vec3f l1params(l1.a, l1.b, l1.c);
+  for (size_t i = 0; i < n; ++i) {
+    const LineSegment& other = lsegs[i];
 
-    static Matrix m(0.25 * PI, Vec2f(0, 0));
-    static Matrix m_inv = m.inverse();
+    if (maxX < smallest(other.A.x, other.B.x) || maxY < smallest(other.A.y, other.B.y)
+      || largest(other.A.x, other.B.x) < minX || largest(other.A.y, other.B.y) < minY) {
 
-    Vec3f l0params_ = l0params * m_inv;
-    Vec3f l1params_ = l1params * m_inv;
+      continue;
+    }
 
-    Line l0_(l0params_.x, l0params_.y, l0params_.z);
-    Line l1_(l1params_.x, l1params_.y, l1params_.z);
+    Vec2f s = other.B - other.A;
 
-    if (l0_.hasSteepGradient() || l1_.hasSteepGradient()) {
-      Point p = lineIntersect(l0_, l1_, depth + 1);
-      Vec3f p_(p.x, p.y, 0);
-      p_ = p_ * m;
-      return Point(p_.x, p_.y);
+    double denom = crossProduct(r, s);
+    if (denom == 0.0) {
+      continue;
     }
 
-    Vec3f p;
-    p.x = (l1_.b * l0_.c - l0_.b * l1_.c) / (l0_.b * l1_.a - l1_.b * l0_.a);
-    p.y = (-l0_.a * p.x - l0_.c) / l0_.b;
-    p.z = 0;
+    Vec2f q = other.A - lseg.A;
+    double t = crossProduct(q, s) / denom;
 
-    p = p * m;
+    if (t < -tolerance || t > 1.0 + tolerance) {
+      continue;
+    }
 
-    return Point(p.x, p.y);
+    if (withinUnitRange(crossProduct(q, r) / denom, s)) {
+      hits.push_back(SegmentHit{i, t, lseg.A + t * r});
+    }
   }
-  else {
-    Point p;
-    p.x = (l1.b * l0.c - l0.b * l1.c) / (l0.b * l1.a - l1.b * l0.a);
-    p.y = (-l0.a * p.x - l0.c) / l0.b;
+}
 
-    return p;
+//===========================================
+// raySegmentIntersections
+//===========================================
+void raySegmentIntersections(const Point& origin, const Vec2f& dir, const LineSegment* lsegs,
+  size_t n, vector<SegmentHit>& hits) {
+
+  for (size_t i = 0; i < n; ++i) {
+    double t = 0;
+    if (raySegmentIntersect(origin, dir, lsegs[i], t)) {
+      hits.push_back(SegmentHit{i, t, origin + t * dir});
+    }
   }
 }
 
@@ -147,7 +147,7 @@ inline Matrix::Matrix(double a, Vec2f t)
     }} {}
 
 inline double Matrix::minor(int row, int col) const {
-  int r1, r2, c1, c2;
+  int r1 = 0, r2 = 0, c1 = 0, c2 = 0;
 
   switch (row) {
     case 0: {
@@ -192,9 +192,24 @@ inline double Matrix::determinant() const {
   return data[0][0] * minor(0, 0) - data[0][1] * minor(0, 1) + data[0][2] * minor(0, 2);
 }
 
+// Every matrix in the engine is a rotation and translation, or some other affine transform, so
+// the bottom row is nearly always (0, 0, 1) and the inverse can be written down directly
 inline Matrix Matrix::inverse() const {
   Matrix m;
 
+  if (data[2][0] == 0.0 && data[2][1] == 0.0 && data[2][2] == 1.0) {
+    double det_rp = 1.0 / (data[0][0] * data[1][1] - data[0][1] * data[1][0]);
+
+    m[0][0] = data[1][1] * det_rp;
+    m[0][1] = -data[0][1] * det_rp;
+    m[1][0] = -data[1][0] * det_rp;
+    m[1][1] = data[0][0] * det_rp;
+    m[0][2] = -m[0][0] * data[0][2] - m[0][1] * data[1][2];
+    m[1][2] = -m[1][0] * data[0][2] - m[1][1] * data[1][2];
+
+    return m;
+  }
+
   double det_rp = 1.0 / determinant();
 
   for (int row = 0; row < 3; ++row) {
@@ -208,19 +223,6 @@ inline Matrix Matrix::inverse() const {
   return m;
 }
 
-// Old, cheap inverse function that works for rotation + translation matrices, but not scale
-/*
-inline Matrix Matrix::inverse() const {
-  Matrix m;
-  m.data = {{
-    {{data[0][0], data[1][0], -data[0][0] * data[0][2] - data[1][0] * data[1][2]}},
-    {{data[0][1], data[1][1], -data[0][1] * data[0][2] - data[1][1] * data[1][2]}},
-    {{0.0, 0.0, 1.0}}
-  }};
-  return m;
-}
-*/
-
 struct Range {
   Range()
     : a(0), b(0) {}
@@ -280,6 +282,50 @@ inline Vec3f operator*(const Vec3f& lhs, const Matrix& rhs) {
   return p;
 }
 
+// A rotation followed by a translation. Cheaper to apply, combine and invert than a Matrix.
+struct RigidTransform {
+  RigidTransform()
+    : c(1.0), s(0.0), t(0, 0) {}
+
+  RigidTransform(double a, Vec2f t)
+    : c(cos(a)), s(sin(a)), t(t) {}
+
+  RigidTransform(double c, double s, Vec2f t)
+    : c(c), s(s), t(t) {}
+
+  // Cosine and sine of the angle of rotation
+  double c;
+  double s;
+  Vec2f t;
+
+  double a() const {
+    return atan2(s, c);
+  }
+
+  RigidTransform inverse() const {
+    return RigidTransform(c, -s, Vec2f(-c * t.x - s * t.y, s * t.x - c * t.y));
+  }
+
+  Matrix matrix() const {
+    Matrix m;
+    m.data = {{
+      {{c, -s, t.x}},
+      {{s, c, t.y}},
+      {{0.0, 0.0, 1.0}}
+    }};
+
+    return m;
+  }
+};
+
+inline Point operator*(const RigidTransform& lhs, const Point& rhs) {
+  return Point(lhs.c * rhs.x - lhs.s * rhs.y + lhs.t.x, lhs.s * rhs.x + lhs.c * rhs.y + lhs.t.y);
+}
+
+inline RigidTransform operator*(const RigidTransform& A, const RigidTransform& B) {
+  return RigidTransform(A.c * B.c - A.s * B.s, A.s * B.c + A.c * B.s, A * B.t);
+}
+
 inline bool operator<(const Point& lhs, const Point& rhs) {
   return lhs.x * lhs.x + lhs.y * lhs.y < rhs.x * rhs.x + rhs.y * rhs.y;
 }
@@ -304,6 +350,11 @@ inline double dotProduct(const Vec2f& A, const Vec2f& B) {
   return A.x * B.x + A.y * B.y;
 }
 
+// The z component of the 3D cross product
+inline double crossProduct(const Vec2f& A, const Vec2f& B) {
+  return A.x * B.y - A.y * B.x;
+}
+
 inline double angle(const Vec2f& A, const Vec2f& B) {
     return acos(dotProduct(A, B) / (length(A) * length(B)));
 }
@@ -380,21 +431,92 @@ inline bool isBetween(double x, double a, double b, double delta = 0.00001) {
   return x >= b - delta && x <= a + delta;
 }
 
-Point lineIntersect(const Line& l0, const Line& l1, int depth = 0);
 bool lineSegmentCircleIntersect(const Circle& circle, const LineSegment& lseg);
 
+// Solves the two line equations directly, which works whatever their gradients. Parallel lines
+// give non-finite coordinates.
+inline Point lineIntersect(const Line& l0, const Line& l1) {
+  double det_rp = 1.0 / (l0.a * l1.b - l1.a * l0.b);
+
+  return Point((l0.b * l1.c - l1.b * l0.c) * det_rp, (l1.a * l0.c - l0.a * l1.c) * det_rp);
+}
+
+// True if the parameter t of a point A + tv lies in [0, 1], allowing for the same error in
+// either coordinate as isBetween()
+inline bool withinUnitRange(double t, const Vec2f& v, double delta = 0.00001) {
+  double tolerance = delta / largest(fabs(v.x), fabs(v.y));
+  return t >= -tolerance && t <= 1.0 + tolerance;
+}
+
+// Writing the segments as l0.A + tr and l1.A + us, they intersect where both parameters lie in
+// [0, 1]. Parallel segments never intersect.
 inline bool lineSegmentIntersect(const LineSegment& l0, const LineSegment& l1, Point& p) {
   if (largest(l0.A.x, l0.B.x) < smallest(l1.A.x, l1.B.x)
-    || largest(l0.A.y, l0.B.y) < smallest(l1.A.y, l1.B.y)) {
+    || largest(l0.A.y, l0.B.y) < smallest(l1.A.y, l1.B.y)
+    || largest(l1.A.x, l1.B.x) < smallest(l0.A.x, l0.B.x)
+    || largest(l1.A.y, l1.B.y) < smallest(l0.A.y, l0.B.y)) {
 
     return false;
   }
 
-  p = lineIntersect(l0.line(), l1.line());
-  return (isBetween(p.x, l0.A.x, l0.B.x) && isBetween(p.x, l1.A.x, l1.B.x))
-    && (isBetween(p.y, l0.A.y, l0.B.y) && isBetween(p.y, l1.A.y, l1.B.y));
+  Vec2f r = l0.B - l0.A;
+  Vec2f s = l1.B - l1.A;
+
+  double denom = crossProduct(r, s);
+  if (denom == 0.0) {
+    return false;
+  }
+
+  Vec2f q = l1.A - l0.A;
+  double t = crossProduct(q, s) / denom;
+  double u = crossProduct(q, r) / denom;
+
+  if (!withinUnitRange(t, r) || !withinUnitRange(u, s)) {
+    return false;
+  }
+
+  p = l0.A + t * r;
+  return true;
 }
 
+// The ray is origin + t * dir for t >= 0
+inline bool raySegmentIntersect(const Point& origin, const Vec2f& dir, const LineSegment& lseg,
+  double& t) {
+
+  Vec2f s = lseg.B - lseg.A;
+
+  double denom = crossProduct(dir, s);
+  if (denom == 0.0) {
+    return false;
+  }
+
+  Vec2f q = lseg.A - origin;
+  double u = crossProduct(q, dir) / denom;
+
+  if (!withinUnitRange(u, s)) {
+    return false;
+  }
+
+  t = crossProduct(q, s) / denom;
+  return t >= 0.0;
+}
+
+struct SegmentHit {
+  // Index into the array of segments
+  size_t idx;
+  // Parameter of the hit along the query segment or ray
+  double t;
+  Point point;
+};
+
+// Appends a hit for each of the n segments that lseg intersects
+void lineSegmentIntersections(const LineSegment& lseg, const LineSegment* lsegs, size_t n,
+  std::vector<SegmentHit>& hits);
+
+// Appends a hit for each of the n segments that the ray intersects
+void raySegmentIntersections(const Point& origin, const Vec2f& dir, const LineSegment* lsegs,
+  size_t n, std::vector<SegmentHit>& hits);
+
 inline LineSegment transform(const LineSegment& lseg, const Matrix& m) {
   return LineSegment(m * lseg.A, m * lseg.B);
 }
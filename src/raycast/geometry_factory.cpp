@@ -26,19 +26,44 @@ const double SNAP_DISTANCE = 1.0;
 
 
 //===========================================
-// snapEndpoint
+// GeometryFactory::snapEndpoint
+//
+// Moves pt onto the nearest endpoint within SNAP_DISTANCE, marking it connected, or records pt as
+// a new endpoint if there isn't one
 //===========================================
-static void snapEndpoint(map<Point, bool>& endpoints, Point& pt) {
-  for (auto it = endpoints.begin(); it != endpoints.end(); ++it) {
-    if (distance(pt, it->first) <= SNAP_DISTANCE) {
-      pt = it->first;
-      it->second = true;
-      return;
+void GeometryFactory::snapEndpoint(Point& pt) {
+  long cellX = static_cast<long>(floor(pt.x / SNAP_DISTANCE));
+  long cellY = static_cast<long>(floor(pt.y / SNAP_DISTANCE));
+
+  Endpoint* nearest = nullptr;
+  double nearestDist = 0;
+
+  for (long i = cellX - 1; i <= cellX + 1; ++i) {
+    for (long j = cellY - 1; j <= cellY + 1; ++j) {
+      auto it = m_endpoints.find(std::make_pair(i, j));
+      if (it == m_endpoints.end()) {
+        continue;
+      }
+
+      for (Endpoint& endpoint : it->second) {
+        double d = distance(pt, endpoint.pt);
+
+        if (d <= SNAP_DISTANCE && (nearest == nullptr || d < nearestDist)) {
+          nearest = &endpoint;
+          nearestDist = d;
+        }
+      }
     }
   }
 
-  endpoints[pt] = false;
-};
+  if (nearest != nullptr) {
+    pt = nearest->pt;
+    nearest->connected = true;
+  }
+  else {
+    m_endpoints[std::make_pair(cellX, cellY)].push_back(Endpoint{pt, false});
+  }
+}
 
 //===========================================
 // GeometryFactory::constructPath
@@ -191,8 +216,8 @@ bool GeometryFactory::constructWalls(parser::Object& obj, entityId_t parentId,
 
     edges.push_back(edge);
 
-    snapEndpoint(m_endpoints, edge->lseg.A);
-    snapEndpoint(m_endpoints, edge->lseg.B);
+    snapEndpoint(edge->lseg.A);
+    snapEndpoint(edge->lseg.B);
 
     spatialSys().addComponent(pComponent_t(edge));
 
@@ -274,8 +299,8 @@ bool GeometryFactory::constructPortal(parser::Object& obj, entityId_t parentId,
   edge->lseg = transform(edge->lseg, parentTransform * obj.groupTransform * obj.pathTransform);
   edge->isPortal = true;
 
-  snapEndpoint(m_endpoints, edge->lseg.A);
-  snapEndpoint(m_endpoints, edge->lseg.B);
+  snapEndpoint(edge->lseg.A);
+  snapEndpoint(edge->lseg.B);
 
   spatialSys().addComponent(pComponent_t(edge));
 
@@ -322,8 +347,8 @@ bool GeometryFactory::constructBoundaries(entityId_t entityId, parser::Object& o
     edge->lseg.B = obj.path.points[i];
     edge->lseg = transform(edge->lseg, parentTransform * obj.groupTransform * obj.pathTransform);
 
-    snapEndpoint(m_endpoints, edge->lseg.A);
-    snapEndpoint(m_endpoints, edge->lseg.B);
+    snapEndpoint(edge->lseg.A);
+    snapEndpoint(edge->lseg.B);
 
     edges.push_back(edge);
 
@@ -493,8 +518,10 @@ bool GeometryFactory::constructRootRegion(parser::Object& obj) {
 
   if (constructRegion_r(-1, obj, -1, m)) {
     for (auto it = m_endpoints.begin(); it != m_endpoints.end(); ++it) {
-      if (it->second == false) {
-        EXCEPTION("There are unconnected endpoints");
+      for (const Endpoint& endpoint : it->second) {
+        if (!endpoint.connected) {
+          EXCEPTION("There are unconnected endpoints");
+        }
       }
     }
 
@@ -3,6 +3,7 @@
 
 
 #include <map>
+#include <utility>
 #include <vector>
 #include "raycast/game_object_factory.hpp"
 #include "raycast/geometry.hpp"
@@ -25,9 +26,18 @@ class GeometryFactory : public GameObjectFactory, private SystemAccessor {
       entityId_t parentId, const Matrix& parentTransform) override;
 
   private:
+    struct Endpoint {
+      Point pt;
+      bool connected;
+    };
+
     RootFactory& m_rootFactory;
 
-    std::map<Point, bool> m_endpoints;
+    // Edge endpoints, bucketed by the cell they fall in of a grid whose cells are SNAP_DISTANCE
+    // wide, so only those in the 3x3 cells around a point can be within SNAP_DISTANCE of it
+    std::map<std::pair<long, long>, std::vector<Endpoint>> m_endpoints;
+
+    void snapEndpoint(Point& pt);
 
     bool constructVRect(entityId_t, parser::Object& obj, entityId_t parentId,
       const Matrix& parentTransform);
@@ -0,0 +1,160 @@
+#include <cstring>
+#include "raycast/input_log.hpp"
+#include "exception.hpp"
+
+
+using std::string;
+
+
+static const char MAGIC[4] = { 'P', 'C', 'I', 'N' };
+static const uint32_t VERSION = 1;
+
+static const uint8_t HAS_KEYS = 1 << 0;
+static const uint8_t MOUSE_BUTTON = 1 << 1;
+static const uint8_t HAS_CURSOR = 1 << 2;
+static const uint8_t HAS_EVENTS = 1 << 3;
+
+
+//===========================================
+// write
+//===========================================
+template<class T>
+static void write(std::ostream& os, T value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+//===========================================
+// read
+//===========================================
+template<class T>
+static T read(std::istream& is) {
+  T value;
+  is.read(reinterpret_cast<char*>(&value), sizeof(value));
+  return value;
+}
+
+//===========================================
+// InputRecorder::InputRecorder
+//===========================================
+InputRecorder::InputRecorder(const string& filePath, long seed)
+  : m_out(filePath, std::ofstream::binary) {
+
+  if (!m_out.good()) {
+    EXCEPTION("Error recording input; Could not open file '" << filePath << "'");
+  }
+
+  m_out.write(MAGIC, sizeof(MAGIC));
+  write<uint32_t>(m_out, VERSION);
+  write<int64_t>(m_out, seed);
+}
+
+//===========================================
+// InputRecorder::record
+//===========================================
+void InputRecorder::record(const TickInput& input) {
+  uint8_t flags = 0;
+
+  if (input.keysHeld != m_keysHeld) {
+    flags |= HAS_KEYS;
+  }
+  if (input.mouseButton) {
+    flags |= MOUSE_BUTTON;
+  }
+  if (input.cursorDx != 0 || input.cursorDy != 0) {
+    flags |= HAS_CURSOR;
+  }
+  if (!input.events.empty()) {
+    flags |= HAS_EVENTS;
+  }
+
+  write<uint8_t>(m_out, flags);
+
+  if (flags & HAS_KEYS) {
+    write<uint32_t>(m_out, input.keysHeld);
+    m_keysHeld = input.keysHeld;
+  }
+
+  if (flags & HAS_CURSOR) {
+    write<int16_t>(m_out, input.cursorDx);
+    write<int16_t>(m_out, input.cursorDy);
+  }
+
+  if (flags & HAS_EVENTS) {
+    write<uint16_t>(m_out, input.events.size());
+
+    for (auto& event : input.events) {
+      write<uint8_t>(m_out, event.kind);
+      write<int32_t>(m_out, event.key);
+    }
+  }
+
+  // So the log is usable if the app crashes
+  m_out.flush();
+}
+
+//===========================================
+// InputReplayer::InputReplayer
+//===========================================
+InputReplayer::InputReplayer(const string& filePath)
+  : m_in(filePath, std::ifstream::binary) {
+
+  if (!m_in.good()) {
+    EXCEPTION("Error replaying input; Could not open file '" << filePath << "'");
+  }
+
+  char magic[sizeof(MAGIC)];
+  m_in.read(magic, sizeof(magic));
+  uint32_t version = read<uint32_t>(m_in);
+
+  if (!m_in.good() || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION) {
+    EXCEPTION("Error replaying input; '" << filePath << "' is not an input log");
+  }
+
+  m_seed = read<int64_t>(m_in);
+}
+
+//===========================================
+// InputReplayer::next
+//
+// Returns false when the log is exhausted
+//===========================================
+bool InputReplayer::next(TickInput& input) {
+  uint8_t flags = read<uint8_t>(m_in);
+
+  if (!m_in.good()) {
+    return false;
+  }
+
+  if (flags & HAS_KEYS) {
+    m_keysHeld = read<uint32_t>(m_in);
+  }
+
+  input.keysHeld = m_keysHeld;
+  input.mouseButton = flags & MOUSE_BUTTON;
+  input.cursorDx = 0;
+  input.cursorDy = 0;
+  input.events.clear();
+
+  if (flags & HAS_CURSOR) {
+    input.cursorDx = read<int16_t>(m_in);
+    input.cursorDy = read<int16_t>(m_in);
+  }
+
+  if (flags & HAS_EVENTS) {
+    uint16_t n = read<uint16_t>(m_in);
+
+    for (uint16_t i = 0; i < n; ++i) {
+      InputEvent event;
+      event.kind = static_cast<InputEvent::kind_t>(read<uint8_t>(m_in));
+      event.key = read<int32_t>(m_in);
+
+      input.events.push_back(event);
+    }
+  }
+
+  if (m_in.fail()) {
+    EXCEPTION("Error replaying input; Log is truncated");
+  }
+
+  return true;
+}
@@ -0,0 +1,69 @@
+#ifndef __PROCALC_RAYCAST_INPUT_LOG_HPP__
+#define __PROCALC_RAYCAST_INPUT_LOG_HPP__
+
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+
+
+struct InputEvent {
+  enum kind_t : uint8_t {
+    KEY_PRESSED,
+    MOUSE_CAPTURED,
+    MOUSE_UNCAPTURED
+  };
+
+  kind_t kind;
+  int key;
+};
+
+// The player's input for one tick
+struct TickInput {
+  // Bit i is set if the i-th of the keys polled each tick is held down
+  uint32_t keysHeld = 0;
+  bool mouseButton = false;
+  int cursorDx = 0;
+  int cursorDy = 0;
+  std::vector<InputEvent> events;
+};
+
+// Writes one record per tick. Most ticks are a single byte, as held keys are only written when
+// they change and cursor movement and events only when there are any.
+class InputRecorder {
+  public:
+    InputRecorder(const std::string& filePath, long seed);
+
+    void record(const TickInput& input);
+
+  private:
+    std::ofstream m_out;
+    uint32_t m_keysHeld = 0;
+};
+
+class InputReplayer {
+  public:
+    InputReplayer(const std::string& filePath);
+
+    inline long seed() const;
+
+    bool next(TickInput& input);
+
+  private:
+    std::ifstream m_in;
+    long m_seed = 0;
+    uint32_t m_keysHeld = 0;
+};
+
+//===========================================
+// InputReplayer::seed
+//
+// The session seed the log was recorded with
+//===========================================
+inline long InputReplayer::seed() const {
+  return m_seed;
+}
+
+
+#endif
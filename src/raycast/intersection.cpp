@@ -0,0 +1,151 @@
+#include <algorithm>
+#include "raycast/intersection.hpp"
+
+
+//===========================================
+// IntersectionBuffer::clear
+//===========================================
+void IntersectionBuffer::clear() {
+  m_records.clear();
+  m_order.clear();
+}
+
+//===========================================
+// IntersectionBuffer::zoneSlot
+//
+// Maps a zone ID to a small index. A ray only passes through a handful of zones, so a linear
+// search beats hashing.
+//===========================================
+int IntersectionBuffer::zoneSlot(entityId_t zoneId) {
+  for (size_t i = 0; i < m_zoneIds.size(); ++i) {
+    if (m_zoneIds[i] == zoneId) {
+      return static_cast<int>(i);
+    }
+  }
+
+  m_zoneIds.push_back(zoneId);
+  return static_cast<int>(m_zoneIds.size()) - 1;
+}
+
+//===========================================
+// IntersectionBuffer::orderByZoneChain
+//
+// Sorts the records by distance then walks from the start zone, each step taking the nearest
+// remaining intersection that touches the current zone and moving into the zone on its other
+// side. The walk ends when the current zone has nothing left or a hard edge is reached.
+// Intersections that are never reached are left out of the results.
+//
+// Each zone keeps a list of the (sorted) positions of the intersections touching it, with a
+// cursor that only moves forwards, so the walk is linear in the number of intersections.
+//===========================================
+void IntersectionBuffer::orderByZoneChain(entityId_t startZone) {
+  int n = static_cast<int>(m_records.size());
+
+  m_order.clear();
+  m_startZone = startZone;
+
+  m_keys.resize(n);
+  m_sorted.resize(n);
+  for (int i = 0; i < n; ++i) {
+    m_keys[i] = m_records[i].distanceFromOrigin;
+    m_sorted[i] = i;
+  }
+
+  std::sort(m_sorted.begin(), m_sorted.end(), [this](int a, int b) {
+    return m_keys[a] < m_keys[b];
+  });
+
+  m_zoneIds.clear();
+  m_slotA.resize(n);
+  m_slotB.resize(n);
+
+  for (int p = 0; p < n; ++p) {
+    const Intersection& X = m_records[m_sorted[p]];
+
+    m_slotA[p] = zoneSlot(X.zoneA);
+    m_slotB[p] = zoneSlot(X.zoneB);
+  }
+
+  int numZones = static_cast<int>(m_zoneIds.size());
+
+  // Bucket the positions by zone, preserving distance order within each bucket
+  m_chainOffsets.assign(numZones + 1, 0);
+  for (int p = 0; p < n; ++p) {
+    ++m_chainOffsets[m_slotA[p] + 1];
+    if (m_slotB[p] != m_slotA[p]) {
+      ++m_chainOffsets[m_slotB[p] + 1];
+    }
+  }
+
+  for (int z = 0; z < numZones; ++z) {
+    m_chainOffsets[z + 1] += m_chainOffsets[z];
+  }
+
+  m_cursors.assign(m_chainOffsets.begin(), m_chainOffsets.end() - 1);
+  m_chains.resize(m_chainOffsets[numZones]);
+
+  for (int p = 0; p < n; ++p) {
+    m_chains[m_cursors[m_slotA[p]]++] = p;
+    if (m_slotB[p] != m_slotA[p]) {
+      m_chains[m_cursors[m_slotB[p]]++] = p;
+    }
+  }
+
+  m_cursors.assign(m_chainOffsets.begin(), m_chainOffsets.end() - 1);
+  m_taken.assign(n, false);
+
+  int zone = -1;
+  for (int z = 0; z < numZones; ++z) {
+    if (m_zoneIds[z] == startZone) {
+      zone = z;
+      break;
+    }
+  }
+
+  while (zone != -1) {
+    int& cursor = m_cursors[zone];
+    int end = m_chainOffsets[zone + 1];
+
+    while (cursor < end && m_taken[m_chains[cursor]]) {
+      ++cursor;
+    }
+
+    if (cursor == end) {
+      break;
+    }
+
+    int p = m_chains[cursor++];
+    m_taken[p] = true;
+
+    const Intersection& X = m_records[m_sorted[p]];
+    m_order.push_back(m_sorted[p]);
+
+    if (X.kind == CSpatialKind::HARD_EDGE) {
+      break;
+    }
+
+    zone = zone == m_slotA[p] ? m_slotB[p] : m_slotA[p];
+  }
+}
+
+//===========================================
+// IntersectionBuffer::assignResults
+//
+// Replaces the contents with what the query that filled src would have produced had it been cast
+// with maxDistance as its limit, i.e. every intersection no farther than that, ordered by zone
+// chain from the same start zone. src must have been ordered with orderByZoneChain().
+//
+// The chain order isn't sorted by distance, so each intersection is checked individually and the
+// chain is walked again, rather than the results being cut at the first one that's too far.
+//===========================================
+void IntersectionBuffer::assignResults(const IntersectionBuffer& src, double maxDistance) {
+  clear();
+
+  for (const Intersection& X : src.m_records) {
+    if (X.distanceFromOrigin <= maxDistance) {
+      m_records.push_back(X);
+    }
+  }
+
+  orderByZoneChain(src.m_startZone);
+}
@@ -0,0 +1,227 @@
+#ifndef __PROCALC_RAYCAST_INTERSECTION_HPP__
+#define __PROCALC_RAYCAST_INTERSECTION_HPP__
+
+
+#include <cstddef>
+#include <vector>
+#include <iterator>
+#include "raycast/spatial_components.hpp"
+
+
+struct Intersection {
+  Intersection(CSpatialKind kind, CSpatialKind parentKind)
+    : kind(kind),
+      parentKind(parentKind) {}
+
+  CSpatialKind kind;
+  CSpatialKind parentKind;
+  entityId_t entityId;
+  Point point_rel;
+  Point point_wld;
+  Point viewPoint;
+  double distanceFromOrigin;
+  double distanceAlongTarget;
+  entityId_t zoneB;
+  entityId_t zoneA;
+
+  double height = 0;
+  std::pair<Range, Range> heightRanges;
+};
+
+// A read-only view of the results of a ray query. Only valid until the buffer it refers to is
+// used for another query.
+class IntersectionSpan {
+  public:
+    class iterator {
+      public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef const Intersection value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const Intersection* pointer;
+        typedef const Intersection& reference;
+
+        iterator(const Intersection* records, const int* idx)
+          : m_records(records),
+            m_idx(idx) {}
+
+        const Intersection& operator*() const {
+          return m_records[*m_idx];
+        }
+
+        const Intersection* operator->() const {
+          return &m_records[*m_idx];
+        }
+
+        iterator& operator++() {
+          ++m_idx;
+          return *this;
+        }
+
+        bool operator==(const iterator& rhs) const {
+          return m_idx == rhs.m_idx;
+        }
+
+        bool operator!=(const iterator& rhs) const {
+          return m_idx != rhs.m_idx;
+        }
+
+      private:
+        const Intersection* m_records;
+        const int* m_idx;
+    };
+
+    IntersectionSpan(const Intersection* records, const int* indices, size_t size)
+      : m_records(records),
+        m_indices(indices),
+        m_size(size) {}
+
+    size_t size() const {
+      return m_size;
+    }
+
+    bool empty() const {
+      return m_size == 0;
+    }
+
+    const Intersection& operator[](size_t i) const {
+      return m_records[m_indices[i]];
+    }
+
+    const Intersection& front() const {
+      return m_records[m_indices[0]];
+    }
+
+    iterator begin() const {
+      return iterator(m_records, m_indices);
+    }
+
+    iterator end() const {
+      return iterator(m_records, m_indices + m_size);
+    }
+
+  private:
+    const Intersection* m_records;
+    const int* m_indices;
+    size_t m_size;
+};
+
+class IntersectionBuffer;
+
+// Working storage for SpatialSystem's ray casts. Owned by the caller, like IntersectionBuffer, so a
+// thread can cast ray after ray without allocating. Single rays use the scratch in the buffer
+// they're cast into.
+class RayScratch {
+  friend class SpatialSystem;
+
+  private:
+    struct RayState {
+      LineSegment lseg;
+      IntersectionBuffer* buffer;
+      // Index into m_visited
+      size_t visited;
+      double cullNearerThan;
+      double cullFartherThan;
+    };
+
+    struct ActiveRay {
+      int ray;
+      Point pt;
+    };
+
+    std::vector<RayState> m_rays;
+    // Stack of subsets of rays, one per level of recursion
+    std::vector<ActiveRay> m_active;
+    // Stack of visited lists. One per ray, then a fresh one for each ray passing through a portal.
+    // Only the first m_numVisited are in use.
+    std::vector<std::vector<entityId_t>> m_visited;
+    size_t m_numVisited = 0;
+    // Stack of the states of rays passing through portals, restored on the way out
+    std::vector<RayState> m_saved;
+
+    size_t pushVisited() {
+      if (m_numVisited == m_visited.size()) {
+        m_visited.emplace_back();
+      }
+
+      m_visited[m_numVisited].clear();
+      return m_numVisited++;
+    }
+};
+
+// Storage for the results of ray queries, owned by the caller so it can be re-used from one
+// query to the next without allocating.
+//
+// Records are stored by value. Sorting and chaining only touch the sort keys and zone IDs, which
+// are extracted into parallel arrays, and are done on indices so the records never move.
+class IntersectionBuffer {
+  friend class SpatialSystem;
+
+  public:
+    void clear();
+    inline void add(const Intersection& X);
+
+    void orderByZoneChain(entityId_t startZone);
+    void assignResults(const IntersectionBuffer& src, double maxDistance);
+
+    template<class F>
+    void retainResults(F predicate);
+
+    inline IntersectionSpan results() const;
+
+  private:
+    std::vector<Intersection> m_records;
+    std::vector<int> m_order;
+    entityId_t m_startZone = -1;
+
+    // Scratch space for orderByZoneChain()
+    std::vector<double> m_keys;
+    std::vector<int> m_sorted;
+    std::vector<int> m_slotA;
+    std::vector<int> m_slotB;
+    std::vector<entityId_t> m_zoneIds;
+    std::vector<int> m_chainOffsets;
+    std::vector<int> m_chains;
+    std::vector<int> m_cursors;
+    std::vector<char> m_taken;
+
+    // Scratch space for single rays cast into this buffer
+    RayScratch m_rayScratch;
+
+    int zoneSlot(entityId_t zoneId);
+};
+
+//===========================================
+// IntersectionBuffer::add
+//===========================================
+inline void IntersectionBuffer::add(const Intersection& X) {
+  m_records.push_back(X);
+}
+
+//===========================================
+// IntersectionBuffer::retainResults
+//
+// Drops results for which the predicate returns false, preserving the order of the rest. The
+// predicate may modify the record.
+//===========================================
+template<class F>
+void IntersectionBuffer::retainResults(F predicate) {
+  size_t n = 0;
+
+  for (size_t i = 0; i < m_order.size(); ++i) {
+    if (predicate(m_records[m_order[i]])) {
+      m_order[n++] = m_order[i];
+    }
+  }
+
+  m_order.resize(n);
+}
+
+//===========================================
+// IntersectionBuffer::results
+//===========================================
+inline IntersectionSpan IntersectionBuffer::results() const {
+  return IntersectionSpan(m_records.data(), m_order.data(), m_order.size());
+}
+
+
+#endif
@@ -1,4 +1,5 @@
 #include <cassert>
+#include <unordered_map>
 #include "raycast/inventory_system.hpp"
 #include "raycast/spatial_system.hpp"
 #include "raycast/render_system.hpp"
@@ -11,37 +12,123 @@ using std::make_pair;
 using std::string;
 using std::set;
 using std::map;
+using std::vector;
 
 
+//===========================================
+// getCollectableTypeId
+//===========================================
+collectableTypeId_t getCollectableTypeId(const string& collectableType) {
+  static std::unordered_map<string, collectableTypeId_t> ids;
+
+  auto it = ids.find(collectableType);
+  if (it != ids.end()) {
+    return it->second;
+  }
+
+  collectableTypeId_t id = static_cast<collectableTypeId_t>(ids.size());
+  ids[collectableType] = id;
+
+  return id;
+}
+
 //===========================================
 // Bucket::~Bucket
 //===========================================
 Bucket::~Bucket() {}
 
 //===========================================
-// InventorySystem::update
+// CCollector::addBucket
+//===========================================
+void CCollector::addBucket(const string& collectableType, pBucket_t bucket) {
+  collectableTypeId_t id = getCollectableTypeId(collectableType);
+
+  if (static_cast<int>(m_buckets.size()) <= id) {
+    m_buckets.resize(id + 1);
+  }
+
+  m_buckets[id] = std::move(bucket);
+}
+
 //===========================================
-void InventorySystem::update() {}
+// CCollector::getBucket
+//===========================================
+Bucket* CCollector::getBucket(collectableTypeId_t collectableType) const {
+  if (collectableType < 0 || collectableType >= static_cast<int>(m_buckets.size())) {
+    return nullptr;
+  }
+
+  return m_buckets[collectableType].get();
+}
 
 //===========================================
-// InventorySystem::handleEvent
+// CCollector::getBucket
+//===========================================
+Bucket* CCollector::getBucket(const string& collectableType) const {
+  return getBucket(getCollectableTypeId(collectableType));
+}
+
+//===========================================
+// InventorySystem::update
+//
+// Collectors that have moved since the last frame pick up whatever is within reach
 //===========================================
-void InventorySystem::handleEvent(const GameEvent& event, const set<entityId_t>& entities) {
-  // TODO: Should listen for movement of all collectors, not just the player
-  if (event.name == "player_move") {
-    const EPlayerMove& e = dynamic_cast<const EPlayerMove&>(event);
+void InventorySystem::update() {
+  SpatialSystem& spatialSystem = m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
 
-    for (auto it = m_collectables.begin(); it != m_collectables.end(); ++it) {
-      CCollectable& collectable = *it->second;
-      entityId_t id = it->first;
+  for (auto it = m_collectors.begin(); it != m_collectors.end(); ++it) {
+    entityId_t collectorId = it->first;
+    const CCollector& collector = *it->second;
 
-      if (entities.count(id)) {
-        addToBucket(e.player.body, collectable);
+    if (!spatialSystem.hasComponent(collectorId)) {
+      continue;
+    }
+
+    const CSpatial& spatial = spatialSystem.getComponent(collectorId);
+    if (spatial.kind != CSpatialKind::V_RECT) {
+      continue;
+    }
+
+    const CVRect& body = dynamic_cast<const CVRect&>(spatial);
+
+    auto jt = m_collectorPositions.find(collectorId);
+    if (jt != m_collectorPositions.end()) {
+      CollectorPosition& prev = jt->second;
+
+      if (prev.zone == body.zone && prev.pos == body.pos) {
+        continue;
+      }
+
+      prev.zone = body.zone;
+      prev.pos = body.pos;
+    }
+    else {
+      m_collectorPositions[collectorId] = CollectorPosition{body.zone, body.pos};
+    }
+
+    m_found.clear();
+    m_index.findNear(body, collector.collectionRadius, m_found);
+
+    for (entityId_t id : m_found) {
+      auto kt = m_collectables.find(id);
+
+      if (kt != m_collectables.end() && m_index.contains(id)) {
+        addToBucket(collectorId, *kt->second);
       }
     }
   }
 }
 
+//===========================================
+// InventorySystem::handleEvent
+//===========================================
+void InventorySystem::handleEvent(const GameEvent& event) {
+  if (event.name == "entity_changed_zone") {
+    const EChangedZone& e = dynamic_cast<const EChangedZone&>(event);
+    m_index.move(e.entityId, e.newZone);
+  }
+}
+
 //===========================================
 // InventorySystem::addComponent
 //===========================================
@@ -74,6 +161,20 @@ void InventorySystem::addCollectable(CInventory* component) {
   assert(ptr != nullptr);
 
   m_collectables.insert(make_pair(ptr->entityId(), pCCollectable_t(ptr)));
+
+  SpatialSystem& spatialSystem = m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
+
+  if (spatialSystem.hasComponent(ptr->entityId())) {
+    const CSpatial& spatial = spatialSystem.getComponent(ptr->entityId());
+
+    if (spatial.kind == CSpatialKind::V_RECT) {
+      const CVRect& body = dynamic_cast<const CVRect&>(spatial);
+
+      if (body.zone != nullptr && !m_index.contains(ptr->entityId())) {
+        m_index.insert(body, body.zone->entityId());
+      }
+    }
+  }
 }
 
 //===========================================
@@ -103,12 +204,31 @@ void InventorySystem::removeEntity(entityId_t id) {
   auto it = m_collectors.find(id);
   if (it != m_collectors.end()) {
     m_collectors.erase(it);
+    m_collectorPositions.erase(id);
   }
   else {
     m_collectables.erase(id);
+    m_index.remove(id);
   }
 }
 
+//===========================================
+// InventorySystem::getBucket
+//===========================================
+Bucket& InventorySystem::getBucket(entityId_t collectorId, const string& collectableType) const {
+  auto it = m_collectors.find(collectorId);
+  if (it == m_collectors.end()) {
+    EXCEPTION("No such collector with ID '" << collectorId << "'");
+  }
+
+  Bucket* bucket = it->second->getBucket(collectableType);
+  if (bucket == nullptr) {
+    EXCEPTION("Entity does not collect items of type '" << collectableType << "'");
+  }
+
+  return *bucket;
+}
+
 //===========================================
 // InventorySystem::addToBucket
 //
@@ -123,13 +243,13 @@ void InventorySystem::addToBucket(entityId_t collectorId, const CCollectable& it
 
   CCollector& collector = *it->second;
 
-  auto jt = collector.buckets.find(item.collectableType);
-  if (jt == collector.buckets.end()) {
+  Bucket* pBucket = collector.getBucket(item.collectableTypeId);
+  if (pBucket == nullptr) {
     m_entityManager.fireEvent(ECollectableEncountered{collectorId, item}, { collectorId });
     return;
   }
 
-  Bucket& b = *jt->second;
+  Bucket& b = *pBucket;
 
   switch (b.bucketKind) {
     case BucketKind::COUNTER_BUCKET: {
@@ -146,6 +266,8 @@ void InventorySystem::addToBucket(entityId_t collectorId, const CCollectable& it
         m_entityManager.fireEvent(EBucketCountChange(collectorId, item.collectableType, bucket,
           prev), { collectorId });
 
+        // Deletion is deferred, so take it out of reach now
+        m_index.remove(item.entityId());
         m_entityManager.deleteEntity(item.entityId());
       }
 
@@ -172,7 +294,8 @@ void InventorySystem::addToBucket(entityId_t collectorId, const CCollectable& it
 
         if (spatial.kind == CSpatialKind::V_RECT) {
           CVRect& vRect = dynamic_cast<CVRect&>(spatial);
-          vRect.pos = Point(10000, 10000);
+          m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL)
+            .setPosition(vRect, Point(10000, 10000));
         }
       }
 
@@ -187,19 +310,7 @@ void InventorySystem::addToBucket(entityId_t collectorId, const CCollectable& it
 const map<string, entityId_t>& InventorySystem::getBucketItems(entityId_t collectorId,
   const string& collectableType) const {
 
-  auto it = m_collectors.find(collectorId);
-  if (it == m_collectors.end()) {
-    EXCEPTION("No such collector with ID '" << collectorId << "'");
-  }
-
-  CCollector& collector = *it->second;
-
-  auto jt = collector.buckets.find(collectableType);
-  if (jt == collector.buckets.end()) {
-    EXCEPTION("Entity does not collect items of type '" << collectableType << "'");
-  }
-
-  const Bucket& b = *jt->second;
+  const Bucket& b = getBucket(collectorId, collectableType);
 
   if (b.bucketKind != BucketKind::ITEM_BUCKET) {
     EXCEPTION("Cannot retrieve items from bucket; Bucket is not of type ItemBucket");
@@ -216,19 +327,7 @@ const map<string, entityId_t>& InventorySystem::getBucketItems(entityId_t collec
 void InventorySystem::removeFromBucket(entityId_t collectorId, const string& collectableType,
   const string& name) {
 
-  auto it = m_collectors.find(collectorId);
-  if (it == m_collectors.end()) {
-    EXCEPTION("No such collector with ID '" << collectorId << "'");
-  }
-
-  CCollector& collector = *it->second;
-
-  auto jt = collector.buckets.find(collectableType);
-  if (jt == collector.buckets.end()) {
-    EXCEPTION("Entity does not collect items of type '" << collectableType << "'");
-  }
-
-  Bucket& b = *jt->second;
+  Bucket& b = getBucket(collectorId, collectableType);
 
   if (b.bucketKind != BucketKind::ITEM_BUCKET) {
     EXCEPTION("Cannot remove item from bucket; Bucket is not of type ItemBucket");
@@ -249,19 +348,7 @@ void InventorySystem::removeFromBucket(entityId_t collectorId, const string& col
 int InventorySystem::subtractFromBucket(entityId_t collectorId, const string& collectableType,
   int value) {
 
-  auto it = m_collectors.find(collectorId);
-  if (it == m_collectors.end()) {
-    EXCEPTION("No such collector with ID '" << collectorId << "'");
-  }
-
-  CCollector& collector = *it->second;
-
-  auto jt = collector.buckets.find(collectableType);
-  if (jt == collector.buckets.end()) {
-    EXCEPTION("Entity does not collect items of type '" << collectableType << "'");
-  }
-
-  Bucket& b = *jt->second;
+  Bucket& b = getBucket(collectorId, collectableType);
 
   if (b.bucketKind != BucketKind::COUNTER_BUCKET) {
     EXCEPTION("Cannot subtract from bucket; Bucket is not of type CounterBucket");
@@ -285,19 +372,7 @@ int InventorySystem::subtractFromBucket(entityId_t collectorId, const string& co
 // InventorySystem::getBucketValue
 //===========================================
 int InventorySystem::getBucketValue(entityId_t collectorId, const string& collectableType) const {
-  auto it = m_collectors.find(collectorId);
-  if (it == m_collectors.end()) {
-    EXCEPTION("No such collector with ID '" << collectorId << "'");
-  }
-
-  CCollector& collector = *it->second;
-
-  auto jt = collector.buckets.find(collectableType);
-  if (jt == collector.buckets.end()) {
-    EXCEPTION("Entity does not collect items of type '" << collectableType << "'");
-  }
-
-  const Bucket& b = *jt->second;
+  const Bucket& b = getBucket(collectorId, collectableType);
 
   if (b.bucketKind != BucketKind::COUNTER_BUCKET) {
     EXCEPTION("Cannot retrieve bucket value; Bucket is not of type CounterBucket");
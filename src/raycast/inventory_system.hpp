@@ -6,8 +6,10 @@
 #include <memory>
 #include <map>
 #include <set>
+#include <vector>
 #include "raycast/system.hpp"
 #include "raycast/component.hpp"
+#include "raycast/collectable_index.hpp"
 
 
 enum class CInventoryKind {
@@ -41,11 +43,25 @@ struct Bucket {
 
 typedef std::unique_ptr<Bucket> pBucket_t;
 
+// Collectable types are interned, so that buckets can be looked up by index
+typedef int collectableTypeId_t;
+
+collectableTypeId_t getCollectableTypeId(const std::string& collectableType);
+
 struct CCollector : public CInventory {
   CCollector(entityId_t entityId)
     : CInventory(CInventoryKind::COLLECTOR, entityId) {}
 
-  std::map<std::string, pBucket_t> buckets;
+  double collectionRadius = 50.0;
+
+  void addBucket(const std::string& collectableType, pBucket_t bucket);
+  // Returns nullptr if there's no bucket for the type
+  Bucket* getBucket(collectableTypeId_t collectableType) const;
+  Bucket* getBucket(const std::string& collectableType) const;
+
+  private:
+    // Indexed by collectable type ID
+    std::vector<pBucket_t> m_buckets;
 };
 
 typedef std::unique_ptr<CCollector> pCCollector_t;
@@ -53,9 +69,11 @@ typedef std::unique_ptr<CCollector> pCCollector_t;
 struct CCollectable : public CInventory {
   CCollectable(entityId_t entityId, const std::string& collectableType)
     : CInventory(CInventoryKind::COLLECTABLE, entityId),
-      collectableType(collectableType) {}
+      collectableType(collectableType),
+      collectableTypeId(getCollectableTypeId(collectableType)) {}
 
   std::string collectableType;
+  collectableTypeId_t collectableTypeId;
   int value = 1;
   std::string name;
 };
@@ -143,8 +161,8 @@ class InventorySystem : public System {
       : m_entityManager(entityManager) {}
 
     void update() override;
-    void handleEvent(const GameEvent&) override {};
-    void handleEvent(const GameEvent& event, const std::set<entityId_t>& entities) override;
+    void handleEvent(const GameEvent& event) override;
+    void handleEvent(const GameEvent&, const std::set<entityId_t>&) override {}
 
     void addComponent(pComponent_t component) override;
     bool hasComponent(entityId_t entityId) const override;
@@ -164,12 +182,24 @@ class InventorySystem : public System {
       const std::string& name);
 
   private:
+    struct CollectorPosition {
+      const CZone* zone;
+      Point pos;
+    };
+
     EntityManager& m_entityManager;
     std::map<entityId_t, pCCollector_t> m_collectors;
     std::map<entityId_t, pCCollectable_t> m_collectables;
+    CollectableIndex m_index;
+
+    // Where each collector was when it last looked for collectables
+    std::map<entityId_t, CollectorPosition> m_collectorPositions;
+    // Scratch space, kept between frames to avoid reallocating
+    std::vector<entityId_t> m_found;
 
     void addCollector(CInventory* component);
     void addCollectable(CInventory* component);
+    Bucket& getBucket(entityId_t collectorId, const std::string& collectableType) const;
 };
 
 
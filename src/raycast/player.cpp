@@ -41,7 +41,7 @@ Player::Player(EntityManager& entityManager, AudioService& audioService, TimeSer
     m_entityManager(entityManager),
     m_audioService(audioService),
     m_timeService(timeService),
-    m_shootTimer(0.5) {
+    m_shootTimer(timeService, 0.5) {
 
   constructPlayer(obj, parentId, parentTransform);
   constructInventory();
@@ -467,8 +467,9 @@ void Player::setupHudBackground() {
 //===========================================
 void Player::constructInventory() {
   CCollector* inventory = new CCollector(this->body);
-  inventory->buckets["ammo"] = pBucket_t(new CounterBucket(50));
-  inventory->buckets["item"] = pBucket_t(new ItemBucket(5));
+  inventory->collectionRadius = collectionRadius;
+  inventory->addBucket("ammo", pBucket_t(new CounterBucket(50)));
+  inventory->addBucket("item", pBucket_t(new ItemBucket(5)));
   inventorySys().addComponent(pComponent_t(inventory));
 
   setupItemsDisplay();
@@ -1,4 +1,5 @@
 #include <list>
+#include <array>
 #include <regex>
 #include <cassert>
 #include <QMessageBox>
@@ -6,6 +7,7 @@
 #include <QPainter>
 #include <QBrush>
 #include <QPaintEvent>
+#include <QMetaObject>
 #include "event_system.hpp"
 #include "raycast/raycast_widget.hpp"
 #include "raycast/spatial_system.hpp"
@@ -24,6 +26,7 @@
 #include "raycast/geometry_factory.hpp"
 #include "raycast/game_event.hpp"
 #include "app_config.hpp"
+#include "utils.hpp"
 
 
 #ifdef DEBUG
@@ -37,22 +40,42 @@ using std::list;
 static const int BUFFER_W = 320;
 static const int BUFFER_H = 240;
 
+// Fraction of the frame period the renderer may use before the resolution is lowered. The rest
+// is left for the simulation, which the next frame has to wait on.
+static const double RENDER_BUDGET = 0.8;
+
 static const double PLAYER_SPEED = 350.0;
 static const double MOUSE_LOOK_SPEED = 0.0006;
 static const double KEY_LOOK_SPEED = 1.2;
 
+// Keys whose state is read each tick, as recorded in TickInput::keysHeld
+static const std::array<int, 10> POLLED_KEYS = {
+  Qt::Key_E,
+  Qt::Key_Space,
+  Qt::Key_A,
+  Qt::Key_D,
+  Qt::Key_W,
+  Qt::Key_Up,
+  Qt::Key_S,
+  Qt::Key_Down,
+  Qt::Key_Left,
+  Qt::Key_Right
+};
+
 
 //===========================================
 // RaycastWidget::RaycastWidget
 //===========================================
-RaycastWidget::RaycastWidget(const AppConfig& appConfig, EventSystem& eventSystem, int width,
-  int height, int frameRate)
+RaycastWidget::RaycastWidget(const AppConfig& appConfig, EventSystem& eventSystem,
+  FrameScheduler& frameScheduler, int width, int height, int frameRate)
   : QWidget(nullptr),
     m_appConfig(appConfig),
     m_eventSystem(eventSystem),
+    m_frameScheduler(frameScheduler),
     m_timeService(frameRate),
     m_audioService(m_entityManager, m_timeService),
-    m_frameRate(frameRate) {
+    m_frameRate(frameRate),
+    m_resolutionController(RENDER_BUDGET / frameRate, BUFFER_W, BUFFER_H) {
 
   setFixedSize(width, height);
 }
@@ -191,7 +214,11 @@ void RaycastWidget::setupSystems() {
   SpatialSystem* spatialSystem = new SpatialSystem(m_entityManager, m_timeService, m_frameRate);
   m_entityManager.addSystem(ComponentKind::C_SPATIAL, pSystem_t(spatialSystem));
 
-  RenderSystem* renderSystem = new RenderSystem(m_appConfig, m_entityManager, m_buffer);
+  // The renderer takes its initial size from the frame
+  RenderSystem* renderSystem = nullptr;
+  m_renderThread->editFrame([&](QImage& frame) {
+    renderSystem = new RenderSystem(m_appConfig, m_entityManager, frame);
+  });
   m_entityManager.addSystem(ComponentKind::C_RENDER, pSystem_t(renderSystem));
 
   AnimationSystem* animationSystem = new AnimationSystem(m_entityManager);
@@ -220,29 +247,90 @@ void RaycastWidget::setupSystems() {
 // RaycastWidget::drawLoadingText
 //===========================================
 void RaycastWidget::drawLoadingText() {
-  QPainter painter;
-  painter.begin(&m_buffer);
+  m_renderThread->editFrame([](QImage& buffer) {
+    QPainter painter;
+    painter.begin(&buffer);
 
-  int h = 20;
+    int h = 20;
 
-  QFont font;
-  font.setPixelSize(h);
+    QFont font;
+    font.setPixelSize(h);
 
-  m_buffer.fill(Qt::black);
+    buffer.fill(Qt::black);
 
-  painter.setFont(font);
-  painter.setPen(Qt::white);
-  painter.drawText((BUFFER_W - 100) / 2, (BUFFER_H - h) / 2, "Loading...");
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    painter.drawText((buffer.width() - 100) / 2, (buffer.height() - h) / 2, "Loading...");
 
-  painter.end();
+    painter.end();
+  });
 }
 
 //===========================================
 // RaycastWidget::setupTimer
 //===========================================
 void RaycastWidget::setupTimer() {
-  m_timer = makeQtObjPtr<QTimer>(this);
-  connect(m_timer.get(), SIGNAL(timeout()), this, SLOT(tick()));
+  m_hTick = m_frameScheduler.add("RaycastWidget", 1000 / m_frameRate, [this]() {
+    tick();
+  }, FrameScheduler::PRIORITY_HIGH, false);
+}
+
+//===========================================
+// RaycastWidget::setupRenderThread
+//
+// Frames are drawn on the render thread while the GUI thread is free to handle input and
+// present the previous frame. The entity manager is handed to the render thread at the end of
+// each tick and taken back (see takeEntityManager) before anything on the GUI thread touches it
+// again, so the renderer always sees the state as it was at the end of a tick.
+//
+// Game logic reaches the entity manager from app event handlers, so those are held back until
+// the frame is finished too. Which handlers do isn't known here, so it's every app event, but
+// not Qt's own events to the event system.
+//===========================================
+void RaycastWidget::setupRenderThread() {
+  m_renderThread.reset(new RenderThread(BUFFER_W, BUFFER_H, [this](QImage& target) {
+    auto& renderSystem = m_entityManager.system<RenderSystem>(ComponentKind::C_RENDER);
+    return renderSystem.render(target);
+  }, [this]() {
+    QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
+  }));
+
+  m_eventSystem.installEventFilter(this);
+}
+
+//===========================================
+// RaycastWidget::takeEntityManager
+//
+// Waits for the in-flight frame, if any
+//===========================================
+void RaycastWidget::takeEntityManager() {
+  m_renderThread->waitForFrame();
+
+#ifdef DEBUG
+  m_entityManager.setOwningThread(std::this_thread::get_id());
+#endif
+}
+
+//===========================================
+// RaycastWidget::submitFrame
+//===========================================
+void RaycastWidget::submitFrame() {
+#ifdef DEBUG
+  m_entityManager.setOwningThread(m_renderThread->threadId());
+#endif
+
+  m_renderThread->submitFrame();
+}
+
+//===========================================
+// RaycastWidget::eventFilter
+//===========================================
+bool RaycastWidget::eventFilter(QObject* watched, QEvent* event) {
+  if (watched == &m_eventSystem && m_renderThread && EventSystem::isAppEvent(*event)) {
+    takeEntityManager();
+  }
+
+  return QWidget::eventFilter(watched, event);
 }
 
 //===========================================
@@ -266,6 +354,36 @@ void RaycastWidget::setupEventHandlers() {
   eventHandlerSystem.addComponent(pComponent_t(events));
 }
 
+//===========================================
+// RaycastWidget::setupInputLog
+//
+// Set PROCALC_RECORD_INPUT to a file path to record the player's input, or PROCALC_REPLAY_INPUT
+// to replay a recording. The game's RNGs are seeded from a session seed that's stored in the log
+// and all timing is counted in ticks, so a replay reproduces the session exactly. Replays run as
+// fast as possible and quit the app when finished; run with QT_QPA_PLATFORM=offscreen for no
+// window. Each new raycast session overwrites the recording.
+//===========================================
+void RaycastWidget::setupInputLog() {
+  string replayPath = qgetenv("PROCALC_REPLAY_INPUT").toStdString();
+  string recordPath = qgetenv("PROCALC_RECORD_INPUT").toStdString();
+
+  long seed = randomSeed();
+
+  if (!replayPath.empty()) {
+    m_inputReplayer.reset(new InputReplayer(replayPath));
+    seed = m_inputReplayer->seed();
+
+    DBG_PRINT("Replaying input from " << replayPath << "\n");
+  }
+  else if (!recordPath.empty()) {
+    m_inputRecorder.reset(new InputRecorder(recordPath, seed));
+
+    DBG_PRINT("Recording input to " << recordPath << "\n");
+  }
+
+  setSessionSeed(seed);
+}
+
 //===========================================
 // RaycastWidget::setCameraInRenderer
 //===========================================
@@ -289,8 +407,10 @@ void RaycastWidget::initialise(const string& mapFile) {
   m_cursorCaptured = false;
   m_mouseBtnState = false;
 
-  m_buffer = QImage(BUFFER_W, BUFFER_H, QImage::Format_ARGB32);
+  // Before anything that seeds an RNG
+  setupInputLog();
 
+  setupRenderThread();
   setupSystems();
 
   m_audioService.initialise();
@@ -312,21 +432,18 @@ void RaycastWidget::initialise(const string& mapFile) {
 void RaycastWidget::start() {
   m_eventSystem.fire(pEvent_t{new Event{"raycast/start"}});
 
-  m_timer->start(1000 / m_frameRate);
+  // Replays aren't tied to real time
+  m_frameScheduler.setInterval(m_hTick, m_inputReplayer ? 0 : 1000 / m_frameRate);
+  m_frameScheduler.setActive(m_hTick, true);
 }
 
 //===========================================
 // RaycastWidget::paintEvent
 //===========================================
 void RaycastWidget::paintEvent(QPaintEvent*) {
-  if (m_timer->isActive()) {
-    auto& renderSystem = m_entityManager.system<RenderSystem>(ComponentKind::C_RENDER);
-    renderSystem.render();
-  }
-
   QPainter painter;
   painter.begin(this);
-  painter.drawImage(rect(), m_buffer);
+  painter.drawImage(rect(), m_renderThread->currentFrame());
   painter.end();
 }
 
@@ -334,13 +451,17 @@ void RaycastWidget::paintEvent(QPaintEvent*) {
 // RaycastWidget::keyPressEvent
 //===========================================
 void RaycastWidget::keyPressEvent(QKeyEvent* event) {
+  if (m_inputReplayer) {
+    return;
+  }
+
   m_keyStates[event->key()] = true;
 
-  if (!m_timer->isActive()) {
+  if (!m_frameScheduler.isActive(m_hTick)) {
     return;
   }
 
-  m_entityManager.broadcastEvent(EKeyPressed{event->key()});
+  queueInputEvent(InputEvent::KEY_PRESSED, event->key());
 
   if (event->key() == Qt::Key_F) {
     DBG_PRINT("Frame rate = " << m_measuredFrameRate << "\n");
@@ -357,13 +478,17 @@ void RaycastWidget::uncaptureCursor() {
   m_cursorCaptured = false;
   setCursor(m_defaultCursor);
 
-  m_entityManager.broadcastEvent(EMouseUncaptured{});
+  queueInputEvent(InputEvent::MOUSE_UNCAPTURED);
 }
 
 //===========================================
 // RaycastWidget::keyReleaseEvent
 //===========================================
 void RaycastWidget::keyReleaseEvent(QKeyEvent* event) {
+  if (m_inputReplayer) {
+    return;
+  }
+
   m_keyStates[event->key()] = false;
 }
 
@@ -371,11 +496,15 @@ void RaycastWidget::keyReleaseEvent(QKeyEvent* event) {
 // RaycastWidget::mousePressEvent
 //===========================================
 void RaycastWidget::mousePressEvent(QMouseEvent* event) {
+  if (m_inputReplayer) {
+    return;
+  }
+
   if (m_cursorCaptured && event->button() == Qt::LeftButton) {
     m_mouseBtnState = true;
   }
 
-  if (!m_timer->isActive() || m_playerImmobilised) {
+  if (!m_frameScheduler.isActive(m_hTick) || m_playerImmobilised) {
     return;
   }
 
@@ -385,7 +514,7 @@ void RaycastWidget::mousePressEvent(QMouseEvent* event) {
 
     setCursor(Qt::BlankCursor);
 
-    m_entityManager.broadcastEvent(EMouseCaptured{});
+    queueInputEvent(InputEvent::MOUSE_CAPTURED);
     m_cursorCaptured = true;
   }
 }
@@ -416,8 +545,16 @@ void RaycastWidget::leaveEvent(QEvent*) {
 
 //===========================================
 // RaycastWidget::handleCursorMovement
+//
+// The movement is applied on the next tick
 //===========================================
 void RaycastWidget::handleCursorMovement(int x, int y) {
+  if (m_inputReplayer) {
+    return;
+  }
+
+  takeEntityManager();
+
   SpatialSystem& spatialSystem = m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
   Player& player = *spatialSystem.sg.player;
 
@@ -437,16 +574,98 @@ void RaycastWidget::handleCursorMovement(int x, int y) {
       QCursor::setPos(mapToGlobal(QPoint(centre.x, centre.y)));
     }
 
-    if (fabs(v.x) > 0) {
-      double da = MOUSE_LOOK_SPEED * PI * v.x;
-      spatialSystem.hRotateCamera(da);
+    m_pendingInput.cursorDx += static_cast<int>(v.x);
+    m_pendingInput.cursorDy += static_cast<int>(v.y);
+  }
+}
+
+//===========================================
+// RaycastWidget::queueInputEvent
+//
+// Input events are applied at the start of the next tick, so they can be recorded
+//===========================================
+void RaycastWidget::queueInputEvent(InputEvent::kind_t kind, int key) {
+  if (!m_inputReplayer) {
+    m_pendingInput.events.push_back(InputEvent{kind, key});
+  }
+}
+
+//===========================================
+// RaycastWidget::collectInput
+//
+// Takes the input for this tick from the replay log if there is one, otherwise from the input
+// received since the last tick
+//===========================================
+TickInput RaycastWidget::collectInput() {
+  TickInput input;
+
+  if (m_inputReplayer) {
+    if (!m_inputReplayer->next(input)) {
+      DBG_PRINT("Input replay finished\n");
+
+      m_inputReplayer.reset();
+      m_eventSystem.fire(pEvent_t{new Event{"quit"}});
     }
 
-    if (fabs(v.y) > 0) {
-      double da = MOUSE_LOOK_SPEED * PI * v.y;
-      spatialSystem.vRotateCamera(da);
+    return input;
+  }
+
+  input = std::move(m_pendingInput);
+  m_pendingInput = TickInput();
+
+  for (size_t i = 0; i < POLLED_KEYS.size(); ++i) {
+    if (m_keyStates[POLLED_KEYS[i]]) {
+      input.keysHeld |= 1u << i;
     }
   }
+
+  input.mouseButton = m_mouseBtnState;
+
+  if (m_inputRecorder) {
+    m_inputRecorder->record(input);
+  }
+
+  return input;
+}
+
+//===========================================
+// RaycastWidget::applyInput
+//===========================================
+void RaycastWidget::applyInput(const TickInput& input) {
+  SpatialSystem& spatialSystem = m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
+  Player& player = *spatialSystem.sg.player;
+
+  for (size_t i = 0; i < POLLED_KEYS.size(); ++i) {
+    m_keyStates[POLLED_KEYS[i]] = (input.keysHeld & (1u << i)) != 0;
+  }
+
+  m_mouseBtnState = input.mouseButton;
+
+  for (auto& event : input.events) {
+    switch (event.kind) {
+      case InputEvent::KEY_PRESSED:
+        m_entityManager.broadcastEvent(EKeyPressed{event.key});
+        break;
+      case InputEvent::MOUSE_CAPTURED:
+        m_entityManager.broadcastEvent(EMouseCaptured{});
+        break;
+      case InputEvent::MOUSE_UNCAPTURED:
+        m_entityManager.broadcastEvent(EMouseUncaptured{});
+        break;
+    }
+  }
+
+  if (!player.alive || m_playerImmobilised) {
+    return;
+  }
+
+  if (input.cursorDx != 0) {
+    spatialSystem.hRotateCamera(MOUSE_LOOK_SPEED * PI * input.cursorDx);
+  }
+
+  if (input.cursorDy != 0) {
+    spatialSystem.vRotateCamera(MOUSE_LOOK_SPEED * PI * input.cursorDy);
+  }
 }
 
 //===========================================
@@ -533,6 +752,35 @@ void RaycastWidget::handleMouseButtonsState() {
   }
 }
 
+//===========================================
+// RaycastWidget::adjustResolution
+//
+// Only frames in which every column was drawn are representative. Profiling builds and replays
+// stay at the native resolution so runs are comparable.
+//===========================================
+void RaycastWidget::adjustResolution() {
+#ifndef PROFILING_ON
+  if (m_inputReplayer) {
+    return;
+  }
+
+  auto& renderSystem = m_entityManager.system<RenderSystem>(ComponentKind::C_RENDER);
+  double frameTime = m_renderThread->lastFrameTime();
+
+  if (!renderSystem.lastFrameFull()) {
+    return;
+  }
+
+  if (frameTime > 0 && m_resolutionController.update(frameTime)) {
+    DBG_PRINT("Render resolution = " << m_resolutionController.width() << "x"
+      << m_resolutionController.height() << "\n");
+
+    m_renderThread->setResolution(m_resolutionController.width(),
+      m_resolutionController.height());
+  }
+#endif
+}
+
 //===========================================
 // RaycastWidget::tick
 //===========================================
@@ -541,9 +789,13 @@ void RaycastWidget::tick() {
   measureFrameRate();
 #endif
 
+  takeEntityManager();
+
   SpatialSystem& spatialSystem = m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
   Player& player = *spatialSystem.sg.player;
 
+  applyInput(collectInput());
+
   m_entityManager.purgeEntities();
   m_entityManager.update();
 
@@ -552,10 +804,15 @@ void RaycastWidget::tick() {
   if (player.alive && !m_playerImmobilised) {
     handleKeyboardState();
     handleMouseButtonsState();
-    recaptureLostCursor();
+
+    if (!m_inputReplayer) {
+      recaptureLostCursor();
+    }
   }
 
-  update();
+  adjustResolution();
+
+  submitFrame();
 }
 
 //===========================================
@@ -563,4 +820,10 @@ void RaycastWidget::tick() {
 //===========================================
 RaycastWidget::~RaycastWidget() {
   DBG_PRINT("RaycastWidget::~RaycastWidget\n");
+
+  m_renderThread.reset();
+
+#ifdef DEBUG
+  m_entityManager.setOwningThread(std::thread::id());
+#endif
 }
@@ -5,13 +5,16 @@
 #include <memory>
 #include <map>
 #include <QWidget>
-#include <QTimer>
 #include <QImage>
 #include "raycast/entity_manager.hpp"
 #include "raycast/audio_service.hpp"
 #include "raycast/geometry.hpp"
 #include "raycast/time_service.hpp"
 #include "raycast/root_factory.hpp"
+#include "raycast/render_thread.hpp"
+#include "raycast/resolution_controller.hpp"
+#include "raycast/input_log.hpp"
+#include "frame_scheduler.hpp"
 #include "qt_obj_ptr.hpp"
 #ifdef DEBUG
 #  include <chrono>
@@ -28,8 +31,8 @@ class RaycastWidget : public QWidget {
   Q_OBJECT
 
   public:
-    RaycastWidget(const AppConfig& appConfig, EventSystem& eventSystem, int width = 400,
-      int height = 300, int frameRate = 60);
+    RaycastWidget(const AppConfig& appConfig, EventSystem& eventSystem,
+      FrameScheduler& frameScheduler, int width = 400, int height = 300, int frameRate = 60);
 
     void initialise(const std::string& mapFile);
     void start();
@@ -60,6 +63,7 @@ class RaycastWidget : public QWidget {
     void mousePressEvent(QMouseEvent* event) override;
     void mouseReleaseEvent(QMouseEvent* event) override;
     void leaveEvent(QEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
 
   private slots:
     void tick();
@@ -68,7 +72,11 @@ class RaycastWidget : public QWidget {
     void setupSystems();
     void setupObjectFactories();
     void setupTimer();
+    void setupRenderThread();
+    void takeEntityManager();
+    void submitFrame();
     void setupEventHandlers();
+    void setupInputLog();
     void setCameraInRenderer();
     void drawLoadingText();
     void loadMap(const std::string& mapFilePath);
@@ -79,23 +87,33 @@ class RaycastWidget : public QWidget {
     void loadTextures(RenderGraph& rg, const parser::Object& obj);
     void uncaptureCursor();
     void handleCursorMovement(int x, int y);
+    void queueInputEvent(InputEvent::kind_t kind, int key = -1);
+    TickInput collectInput();
+    void applyInput(const TickInput& input);
     void handleKeyboardState();
     void handleMouseButtonsState();
     void recaptureLostCursor();
+    void adjustResolution();
 #ifdef DEBUG
     void measureFrameRate();
 #endif
 
     const AppConfig& m_appConfig;
     EventSystem& m_eventSystem;
+    FrameScheduler& m_frameScheduler;
 
     EntityManager m_entityManager;
     TimeService m_timeService;
     AudioService m_audioService;
     RootFactory m_rootFactory;
     int m_frameRate;
-    QtObjPtr<QTimer> m_timer;
-    QImage m_buffer;
+    FrameScheduler::Handle m_hTick;
+    std::unique_ptr<RenderThread> m_renderThread;
+    ResolutionController m_resolutionController;
+    std::unique_ptr<InputRecorder> m_inputRecorder;
+    std::unique_ptr<InputReplayer> m_inputReplayer;
+    // Input received since the last tick
+    TickInput m_pendingInput;
     std::map<int, bool> m_keyStates;
     bool m_mouseBtnState;
     bool m_cursorCaptured;
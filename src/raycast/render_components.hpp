@@ -5,6 +5,7 @@
 #include <string>
 #include <list>
 #include <memory>
+#include <vector>
 #include <QImage>
 #include <QColor>
 #include "raycast/geometry.hpp"
@@ -19,6 +20,9 @@ struct Texture {
   Size size_wd;
 };
 
+// An immutable list of views, which may be shared between many sprites
+typedef std::shared_ptr<const std::vector<QRectF>> pTexViews_t;
+
 enum class CRenderKind {
   REGION,
   WALL,
@@ -120,22 +124,30 @@ class CSprite : public CRender {
       : CRender(CRenderKind::SPRITE, entityId, parentId),
         texture(texture) {}
 
+    const std::vector<QRectF>& views() const {
+      return frameViews ? *frameViews : texViews;
+    }
+
     const QRectF& getView(const CVRect& vRect, const Point& camPos) const {
-      if (texViews.empty()) {
+      const std::vector<QRectF>& views = this->views();
+
+      if (views.empty()) {
         EXCEPTION("Cannot get view; texViews is empty");
       }
 
       Vec2f v = vRect.pos - camPos;
       double a = PI - atan2(v.y, v.x) + vRect.angle;
-      size_t n = texViews.size();
+      size_t n = views.size();
       double da = 2.0 * PI / n;
       int idx = static_cast<int>(round(normaliseAngle(a) / da)) % n;
 
-      return texViews[idx];
+      return views[idx];
     }
 
     std::string texture;
     std::vector<QRectF> texViews;
+    // Bound by the animation system to the current frame. Takes precedence over texViews.
+    pTexViews_t frameViews;
 };
 
 typedef std::unique_ptr<CSprite> pCSprite_t;
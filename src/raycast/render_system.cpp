@@ -1,6 +1,7 @@
 #include <cassert>
 #include <list>
 #include <set>
+#include <map>
 #include <ostream>
 #include <QImage>
 #include "raycast/render_system.hpp"
@@ -18,6 +19,8 @@ using std::unique_ptr;
 using std::ostream;
 using std::function;
 using std::make_pair;
+using std::map;
+using std::pair;
 
 
 static const double VIEWPORT_W = 10.0 * 320.0 / 240.0;
@@ -100,10 +103,15 @@ void RenderSystem::centreTextOverlay(CTextOverlay& overlay) const {
 }
 
 //===========================================
-// connectSubregions
+// RenderSystem::connectSubregions
+//
+// Each join is paired with the first join, in region order, from an earlier region whose soft edge
+// has the same join ID. Joins from earlier regions are kept in a map keyed by that ID, so each
+// lookup doesn't have to walk every preceding region.
 //===========================================
-static void connectSubregions(const SpatialSystem& spatialSystem, CRegion& region) {
-  int i = 0;
+void RenderSystem::connectSubregions(const SpatialSystem& spatialSystem, CRegion& region) {
+  map<entityId_t, pair<CJoin*, CRegion*>> earlier;
+
   forEachRegion(region, [&](CRegion& r) {
     for (auto jt = r.boundaries.begin(); jt != r.boundaries.end(); ++jt) {
       if ((*jt)->kind == CRenderKind::JOIN) {
@@ -112,46 +120,32 @@ static void connectSubregions(const SpatialSystem& spatialSystem, CRegion& regio
 
         entityId_t id1 = getSoftEdge(spatialSystem, *je).joinId;
 
-        bool hasTwin = false;
-        int j = 0;
-        forEachRegion(region, [&](CRegion& r_) {
-          if (j >= i) {
-            return false;
-          }
-
-          for (auto lt = r_.boundaries.begin(); lt != r_.boundaries.end(); ++lt) {
-            if ((*lt)->kind == CRenderKind::JOIN) {
-              CJoin* other = DYNAMIC_CAST<CJoin*>(*lt);
-
-              entityId_t id2 = getSoftEdge(spatialSystem, *other).joinId;
-
-              if (id1 == id2) {
-                hasTwin = true;
-
-                je->joinId = other->joinId;
-                je->regionA = other->regionA = &r;
-                je->regionB = other->regionB = &r_;
+        auto it = earlier.find(id1);
+        if (it != earlier.end()) {
+          CJoin* other = it->second.first;
+          CRegion& r_ = *it->second.second;
 
-                je->mergeIn(*other);
-                other->mergeIn(*je);
+          je->joinId = other->joinId;
+          je->regionA = other->regionA = &r;
+          je->regionB = other->regionB = &r_;
 
-                return false;
-              }
-            }
-          }
-
-          ++j;
-          return true;
-        });
-
-        if (!hasTwin) {
+          je->mergeIn(*other);
+          other->mergeIn(*je);
+        }
+        else {
           je->regionA = &r;
           je->regionB = &region;
         }
       }
     }
 
-    ++i;
+    for (auto jt = r.boundaries.begin(); jt != r.boundaries.end(); ++jt) {
+      if ((*jt)->kind == CRenderKind::JOIN) {
+        CJoin* je = DYNAMIC_CAST<CJoin*>(*jt);
+        earlier.insert(make_pair(getSoftEdge(spatialSystem, *je).joinId, make_pair(je, &r)));
+      }
+    }
+
     return true;
   });
 }
@@ -171,8 +165,8 @@ void RenderSystem::connectRegions() {
 //===========================================
 // RenderSystem::render
 //===========================================
-void RenderSystem::render() {
-  m_renderer.renderScene();
+bool RenderSystem::render(QImage& target) {
+  return m_renderer.renderScene(target);
 }
 
 //===========================================
@@ -433,6 +427,19 @@ CRender& RenderSystem::getComponent(entityId_t entityId) const {
   return *m_components.at(entityId);
 }
 
+//===========================================
+// RenderSystem::markChanged
+//
+// Decals are drawn as part of the wall or floor they're on, so that's marked too
+//===========================================
+void RenderSystem::markChanged(const CRender& c) {
+  m_changed.insert(c.entityId());
+
+  if (c.kind == CRenderKind::WALL_DECAL || c.kind == CRenderKind::FLOOR_DECAL) {
+    m_changed.insert(c.parentId);
+  }
+}
+
 //===========================================
 // RenderSystem::addComponent
 //===========================================
@@ -484,6 +491,8 @@ void RenderSystem::addComponent(pComponent_t component) {
   }
 
   m_components.insert(make_pair(ptr->entityId(), ptr));
+
+  markChanged(*ptr);
 }
 
 //===========================================
@@ -528,6 +537,8 @@ void RenderSystem::removeEntity(entityId_t id) {
   }
 
   CRender& c = *it->second;
+  markChanged(c);
+
   auto jt = m_components.find(c.parentId);
 
   if (jt != m_components.end()) {
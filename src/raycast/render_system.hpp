@@ -11,6 +11,7 @@ class EntityManager;
 class Player;
 class AppConfig;
 class Camera;
+class SpatialSystem;
 
 class RenderSystem : public System {
   public:
@@ -25,7 +26,10 @@ class RenderSystem : public System {
     inline void setCamera(const Camera* cam);
 
     void connectRegions();
-    void render();
+    bool render(QImage& target);
+    inline bool lastFrameFull() const;
+    inline int lastFrameColumns() const;
+    inline void setNumWorkerThreads(int n);
 
     void update() override {}
     void handleEvent(const GameEvent& event) override;
@@ -38,9 +42,21 @@ class RenderSystem : public System {
 
     inline const std::set<entityId_t>& children(entityId_t entityId) const;
 
+    // Entities added, removed or changed since the renderer last looked. Changes made through the
+    // render system are recorded automatically; anything else, e.g. swapping a wall's texture,
+    // must call markChanged.
+    void markChanged(const CRender& c);
+    inline const std::set<entityId_t>& changedEntities() const;
+    inline void clearChanges();
+
     double textOverlayWidth(const CTextOverlay& overlay) const;
     void centreTextOverlay(CTextOverlay& overlay) const;
 
+  protected:
+    // Pairs each join under region with its twin. Virtual so tests can check it against a
+    // simpler search.
+    virtual void connectSubregions(const SpatialSystem& spatialSystem, CRegion& region);
+
   private:
     const AppConfig& m_appConfig;
     EntityManager& m_entityManager;
@@ -48,6 +64,7 @@ class RenderSystem : public System {
 
     std::map<entityId_t, CRender*> m_components;
     std::map<entityId_t, std::set<entityId_t>> m_entityChildren;
+    std::set<entityId_t> m_changed;
 
     bool isRoot(const CRender& c) const;
     void removeEntity_r(entityId_t id);
@@ -75,6 +92,27 @@ inline Size RenderSystem::worldUnit_px() const {
   return m_renderer.worldUnit_px();
 }
 
+//===========================================
+// RenderSystem::lastFrameFull
+//===========================================
+inline bool RenderSystem::lastFrameFull() const {
+  return m_renderer.lastFrameFull();
+}
+
+//===========================================
+// RenderSystem::lastFrameColumns
+//===========================================
+inline int RenderSystem::lastFrameColumns() const {
+  return m_renderer.lastFrameColumns();
+}
+
+//===========================================
+// RenderSystem::setNumWorkerThreads
+//===========================================
+inline void RenderSystem::setNumWorkerThreads(int n) {
+  m_renderer.setNumWorkerThreads(n);
+}
+
 //===========================================
 // RenderSystem::setCamera
 //===========================================
@@ -92,5 +130,19 @@ inline const std::set<entityId_t>& RenderSystem::children(entityId_t entityId) c
   return it != m_entityChildren.end() ? it->second : emptySet;
 }
 
+//===========================================
+// RenderSystem::changedEntities
+//===========================================
+inline const std::set<entityId_t>& RenderSystem::changedEntities() const {
+  return m_changed;
+}
+
+//===========================================
+// RenderSystem::clearChanges
+//===========================================
+inline void RenderSystem::clearChanges() {
+  m_changed.clear();
+}
+
 
 #endif
@@ -0,0 +1,224 @@
+#include <chrono>
+#include "raycast/render_thread.hpp"
+
+
+namespace chrono = std::chrono;
+
+using std::mutex;
+using std::unique_lock;
+using std::lock_guard;
+
+
+//===========================================
+// RenderThread::RenderThread
+//===========================================
+RenderThread::RenderThread(int width, int height, renderFn_t render, frameReadyFn_t onFrameReady)
+  : m_render(render),
+    m_onFrameReady(onFrameReady),
+    m_width(width),
+    m_height(height) {
+
+  for (auto& buffer : m_buffers) {
+    buffer = QImage(width, height, QImage::Format_ARGB32);
+    buffer.fill(Qt::black);
+  }
+
+#ifndef SINGLE_THREAD
+  m_thread = std::thread{&RenderThread::loop, this};
+#endif
+}
+
+//===========================================
+// RenderThread::currentFrame
+//
+// The most recently completed frame. Safe to read while the next frame is being drawn.
+//===========================================
+QImage RenderThread::currentFrame() const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_buffers[m_front];
+}
+
+//===========================================
+// RenderThread::editFrame
+//
+// Calls fn with the front buffer, once any frame in flight is finished, for drawing over the
+// current frame in place. The lock is held throughout, so fn mustn't call back into this object.
+//===========================================
+void RenderThread::editFrame(const std::function<void(QImage&)>& fn) {
+  waitForFrame();
+
+  lock_guard<mutex> lock(m_mutex);
+  fn(m_buffers[m_front]);
+}
+
+//===========================================
+// RenderThread::renderBackBuffer
+//
+// Only ever called from the render thread (or inline in single threaded builds), so m_front
+// can be read without taking the lock; it's only written here.
+//===========================================
+void RenderThread::renderBackBuffer() {
+  int back = 1 - m_front;
+  QImage& buffer = m_buffers[back];
+
+  int width = 0;
+  int height = 0;
+  {
+    lock_guard<mutex> lock(m_mutex);
+    width = m_width;
+    height = m_height;
+  }
+
+  if (buffer.width() != width || buffer.height() != height) {
+    buffer = QImage(width, height, QImage::Format_ARGB32);
+    buffer.fill(Qt::black);
+  }
+
+  std::exception_ptr error;
+  bool drawn = false;
+  auto t0 = chrono::high_resolution_clock::now();
+
+  try {
+    drawn = m_render(buffer);
+  }
+  catch (...) {
+    error = std::current_exception();
+  }
+
+  auto t1 = chrono::high_resolution_clock::now();
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+
+    if (drawn && !error) {
+      m_front = back;
+      m_lastFrameTime = chrono::duration_cast<chrono::duration<double>>(t1 - t0).count();
+    }
+
+    m_error = error;
+    m_pending = false;
+  }
+
+  m_cond.notify_all();
+
+  if (drawn && !error) {
+    m_onFrameReady();
+  }
+}
+
+//===========================================
+// RenderThread::loop
+//===========================================
+void RenderThread::loop() {
+  while (true) {
+    {
+      unique_lock<mutex> lock(m_mutex);
+      m_cond.wait(lock, [this]() { return m_pending || m_quit; });
+
+      if (m_quit) {
+        return;
+      }
+    }
+
+    renderBackBuffer();
+  }
+}
+
+//===========================================
+// RenderThread::submitFrame
+//
+// Begins drawing the next frame into the back buffer, first waiting for any frame already in
+// flight
+//===========================================
+void RenderThread::submitFrame() {
+  waitForFrame();
+
+#ifdef SINGLE_THREAD
+  m_pending = true;
+  renderBackBuffer();
+  waitForFrame();
+#else
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_pending = true;
+  }
+
+  m_cond.notify_all();
+#endif
+}
+
+//===========================================
+// RenderThread::waitForFrame
+//
+// Blocks until the in-flight frame (if any) has been drawn. Exceptions thrown while rendering
+// are re-thrown here, on the calling thread. Calls from the render thread itself return
+// immediately.
+//===========================================
+void RenderThread::waitForFrame() {
+#ifndef SINGLE_THREAD
+  if (std::this_thread::get_id() == m_thread.get_id()) {
+    return;
+  }
+#endif
+
+  unique_lock<mutex> lock(m_mutex);
+  m_cond.wait(lock, [this]() { return !m_pending; });
+
+  if (m_error) {
+    std::exception_ptr error = m_error;
+    m_error = nullptr;
+
+    std::rethrow_exception(error);
+  }
+}
+
+//===========================================
+// RenderThread::setResolution
+//
+// Takes effect from the next submitted frame. The current frame keeps its old size until it's
+// replaced.
+//===========================================
+void RenderThread::setResolution(int width, int height) {
+  lock_guard<mutex> lock(m_mutex);
+
+  m_width = width;
+  m_height = height;
+}
+
+//===========================================
+// RenderThread::lastFrameTime
+//
+// Seconds spent drawing the most recently completed frame, or 0 if there isn't one yet
+//===========================================
+double RenderThread::lastFrameTime() const {
+  lock_guard<mutex> lock(m_mutex);
+  return m_lastFrameTime;
+}
+
+//===========================================
+// RenderThread::threadId
+//
+// In single threaded builds frames are drawn inline on the thread that submits them
+//===========================================
+std::thread::id RenderThread::threadId() const {
+#ifdef SINGLE_THREAD
+  return std::this_thread::get_id();
+#else
+  return m_thread.get_id();
+#endif
+}
+
+//===========================================
+// RenderThread::~RenderThread
+//===========================================
+RenderThread::~RenderThread() {
+#ifndef SINGLE_THREAD
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_quit = true;
+  }
+
+  m_cond.notify_all();
+  m_thread.join();
+#endif
+}
@@ -0,0 +1,69 @@
+#ifndef __PROCALC_RAYCAST_RENDER_THREAD_HPP__
+#define __PROCALC_RAYCAST_RENDER_THREAD_HPP__
+
+
+#include <array>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+#include <QImage>
+
+
+// Renders frames on a dedicated thread into a pair of buffers. The front buffer always holds the
+// most recently completed frame and is never written to while the back buffer is being drawn.
+//
+// The render function returns false if the frame would be identical to the last one, in which
+// case the buffers aren't swapped and no notification is sent.
+//
+// The caller is responsible for not mutating anything the render function reads while a frame
+// is in flight; waitForFrame() is the synchronisation point. threadId() gives the thread frames
+// are drawn on, for callers that want to check this in debug builds.
+//
+// currentFrame() returns a copy, which shares the buffer's pixels until either is written to, so
+// it stays valid however many frames are drawn after it's taken.
+class RenderThread {
+  public:
+    typedef std::function<bool(QImage&)> renderFn_t;
+    typedef std::function<void()> frameReadyFn_t;
+
+    RenderThread(int width, int height, renderFn_t render, frameReadyFn_t onFrameReady);
+
+    void submitFrame();
+    void waitForFrame();
+    void setResolution(int width, int height);
+    double lastFrameTime() const;
+    std::thread::id threadId() const;
+
+    QImage currentFrame() const;
+    void editFrame(const std::function<void(QImage&)>& fn);
+
+    ~RenderThread();
+
+  private:
+    void loop();
+    void renderBackBuffer();
+
+    renderFn_t m_render;
+    frameReadyFn_t m_onFrameReady;
+
+    std::array<QImage, 2> m_buffers;
+    int m_front = 0;
+    int m_width;
+    int m_height;
+    double m_lastFrameTime = 0;
+
+    bool m_pending = false;
+    bool m_quit = false;
+    std::exception_ptr m_error;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cond;
+#ifndef SINGLE_THREAD
+    std::thread m_thread;
+#endif
+};
+
+
+#endif
@@ -1,5 +1,6 @@
 #include <cmath>
 #include <cassert>
+#include <cstring>
 #include <limits>
 #include <set>
 #include <vector>
@@ -78,16 +79,16 @@ static inline QRgb applyShade(const QRgb& c, double distance) {
 void Renderer::drawImage(const QRect& trgRect, const QImage& tex, const QRect& srcRect,
   double distance) const {
 
-  int y0 = clipNumber(trgRect.y(), Range(0, m_target.height()));
-  int y1 = clipNumber(trgRect.y() + trgRect.height(), Range(0, m_target.height()));
-  int x0 = clipNumber(trgRect.x(), Range(0, m_target.width()));
-  int x1 = clipNumber(trgRect.x() + trgRect.width(), Range(0, m_target.width()));
+  int y0 = clipNumber(trgRect.y(), Range(0, m_target->height()));
+  int y1 = clipNumber(trgRect.y() + trgRect.height(), Range(0, m_target->height()));
+  int x0 = clipNumber(trgRect.x(), Range(0, m_target->width()));
+  int x1 = clipNumber(trgRect.x() + trgRect.width(), Range(0, m_target->width()));
 
   double trgW_rp = 1.0 / trgRect.width();
   double trgH_rp = 1.0 / trgRect.height();
 
   for (int j = y0; j < y1; ++j) {
-    QRgb* pixels = reinterpret_cast<QRgb*>(m_target.scanLine(j));
+    QRgb* pixels = reinterpret_cast<QRgb*>(m_target->scanLine(j));
     double y = static_cast<double>(j - trgRect.y()) * trgH_rp;
     int srcY = srcRect.y() + y * srcRect.height();
 
@@ -109,28 +110,26 @@ void Renderer::drawImage(const QRect& trgRect, const QImage& tex, const QRect& s
 // Renderer::constructXWrapper
 //===========================================
 Renderer::XWrapper* Renderer::constructXWrapper(const SpatialSystem& spatialSystem,
-  const RenderSystem& renderSystem, pIntersection_t X) const {
+  const RenderSystem& renderSystem, const Intersection& X) const {
 
-  Intersection* pX = X.get();
-
-  switch (pX->kind) {
+  switch (X.kind) {
     case CSpatialKind::HARD_EDGE: {
-      WallX* wrapper = new WallX(std::move(X));
-      wrapper->hardEdge = DYNAMIC_CAST<const CHardEdge*>(&spatialSystem.getComponent(pX->entityId));
-      wrapper->wall = DYNAMIC_CAST<const CWall*>(&renderSystem.getComponent(pX->entityId));
+      WallX* wrapper = new WallX(X);
+      wrapper->hardEdge = DYNAMIC_CAST<const CHardEdge*>(&spatialSystem.getComponent(X.entityId));
+      wrapper->wall = DYNAMIC_CAST<const CWall*>(&renderSystem.getComponent(X.entityId));
       return wrapper;
     }
     case CSpatialKind::SOFT_EDGE: {
-      JoinX* wrapper = new JoinX(std::move(X));
-      wrapper->softEdge = DYNAMIC_CAST<const CSoftEdge*>(&spatialSystem.getComponent(pX->entityId));
-      wrapper->join = DYNAMIC_CAST<const CJoin*>(&renderSystem.getComponent(pX->entityId));
+      JoinX* wrapper = new JoinX(X);
+      wrapper->softEdge = DYNAMIC_CAST<const CSoftEdge*>(&spatialSystem.getComponent(X.entityId));
+      wrapper->join = DYNAMIC_CAST<const CJoin*>(&renderSystem.getComponent(X.entityId));
       return wrapper;
     }
     case CSpatialKind::V_RECT: {
-      if (pX->parentKind == CSpatialKind::ZONE) {
-        SpriteX* wrapper = new SpriteX(std::move(X));
-        wrapper->vRect = DYNAMIC_CAST<const CVRect*>(&spatialSystem.getComponent(pX->entityId));
-        wrapper->sprite = DYNAMIC_CAST<const CSprite*>(&renderSystem.getComponent(pX->entityId));
+      if (X.parentKind == CSpatialKind::ZONE) {
+        SpriteX* wrapper = new SpriteX(X);
+        wrapper->vRect = DYNAMIC_CAST<const CVRect*>(&spatialSystem.getComponent(X.entityId));
+        wrapper->sprite = DYNAMIC_CAST<const CSprite*>(&renderSystem.getComponent(X.entityId));
         return wrapper;
       }
     }
@@ -202,26 +201,22 @@ Renderer::Slice Renderer::computeSlice(const LineSegment& rotProjPlane, const Li
 // Renderer::castRay
 //===========================================
 void Renderer::castRay(const SpatialSystem& spatialSystem, const RenderSystem& renderSystem,
-  const Vec2f& dir, CastResult& result) const {
+  const IntersectionSpan& intersections, CastResult& result) const {
 
   LineSegment rotProjPlane = projectionPlane();
 
-  vector<pIntersection_t> intersections = spatialSystem.entitiesAlongRay(dir);
-
   LineSegment projRay0(Point(0, 0), rotProjPlane.A * 9999.9);
   LineSegment projRay1(Point(0, 0), rotProjPlane.B * 9999.9);
   double subview0 = 0;
   double subview1 = m_viewport.y;
 
   const CZone* zone = &m_cam->zone();
-  int last = -1;
   for (auto it = intersections.begin(); it != intersections.end(); ++it) {
-    if (!renderSystem.hasComponent((*it)->entityId)) {
+    if (!renderSystem.hasComponent(it->entityId)) {
       continue;
     }
 
-    ++last;
-    XWrapper* X = constructXWrapper(spatialSystem, renderSystem, std::move(*it));
+    XWrapper* X = constructXWrapper(spatialSystem, renderSystem, *it);
     if (X == nullptr) {
       continue;
     }
@@ -332,10 +327,6 @@ void Renderer::castRay(const SpatialSystem& spatialSystem, const RenderSystem& r
       break;
     }
   }
-
-  if (intersections.size() > 0) {
-    intersections.resize(last + 1);
-  }
 }
 
 //===========================================
@@ -345,8 +336,8 @@ void Renderer::drawSkySlice(const ScreenSlice& slice, int screenX_px) const {
   const Texture& skyTex = m_rg.textures.at("sky");
   Size tileSz_px(skyTex.image.rect().width(), skyTex.image.rect().height());
 
-  int W_px = m_target.rect().width();
-  int H_px = m_target.rect().height();
+  int W_px = m_target->rect().width();
+  int H_px = m_target->rect().height();
 
   double hPxAngle = m_cam->hFov / W_px;
   double vPxAngle = m_cam->vFov / H_px;
@@ -368,10 +359,10 @@ void Renderer::drawSkySlice(const ScreenSlice& slice, int screenX_px) const {
     double s = 1.0 - normaliseAngle(vAngle - minVAngle) / vAngleRange;
     assert(isBetween(s, 0.0, 1.0));
 
-    assert(isBetween(screenX_px, 0, m_target.width() - 1) && isBetween(j, 0,
-      m_target.height() - 1));
+    assert(isBetween(screenX_px, 0, m_target->width() - 1) && isBetween(j, 0,
+      m_target->height() - 1));
 
-    QRgb* pixels = reinterpret_cast<QRgb*>(m_target.scanLine(j));
+    QRgb* pixels = reinterpret_cast<QRgb*>(m_target->scanLine(j));
     pixels[screenX_px] = pixel(skyTex.image, x, s * tileSz_px.y);
   }
 }
@@ -420,7 +411,7 @@ void Renderer::drawCeilingSlice(const Intersection& X, const CRegion& region, do
   double cosHAngle_rp = 1.0 / cos(hAngle);
 
   for (int j = slice.sliceTop_px; j >= slice.viewportTop_px; --j) {
-    QRgb* pixels = reinterpret_cast<QRgb*>(m_target.scanLine(j));
+    QRgb* pixels = reinterpret_cast<QRgb*>(m_target->scanLine(j));
 
     double projY_wd = (m_screenH_px * 0.5 - j) * vWorldUnit_px_rp;
     double vAngle = fastATan(projY_wd * F_rp) + m_cam->vAngle;
@@ -484,7 +475,7 @@ void Renderer::drawFloorSlice(const SpatialSystem& spatialSystem, const Intersec
   double cosHAngle_rp = 1.0 / cos(hAngle);
 
   for (int j = slice.sliceBottom_px; j <= slice.viewportBottom_px; ++j) {
-    QRgb* pixels = reinterpret_cast<QRgb*>(m_target.scanLine(j));
+    QRgb* pixels = reinterpret_cast<QRgb*>(m_target->scanLine(j));
 
     double projY_wd = (j - m_screenH_px * 0.5) * vWorldUnit_px_rp;
     double vAngle = fastATan(projY_wd * F_rp) - m_cam->vAngle;
@@ -661,10 +652,10 @@ Renderer::ScreenSlice Renderer::drawSlice(const Intersection& X, const Slice& sl
   double viewportTop_px = floor((m_viewport.y - slice.viewportTop_wd) * m_vWorldUnit_px);
 
   return ScreenSlice{
-    static_cast<int>(clipNumber(screenSliceBottom_px, Range(0, m_target.height() - 1))),
-    static_cast<int>(clipNumber(screenSliceTop_px, Range(0, m_target.height() - 1))),
-    static_cast<int>(clipNumber(viewportBottom_px, Range(0, m_target.height() - 1))),
-    static_cast<int>(clipNumber(viewportTop_px, Range(0, m_target.height() - 1)))};
+    static_cast<int>(clipNumber(screenSliceBottom_px, Range(0, m_target->height() - 1))),
+    static_cast<int>(clipNumber(screenSliceTop_px, Range(0, m_target->height() - 1))),
+    static_cast<int>(clipNumber(viewportBottom_px, Range(0, m_target->height() - 1))),
+    static_cast<int>(clipNumber(viewportTop_px, Range(0, m_target->height() - 1)))};
 }
 
 //===========================================
@@ -791,6 +782,18 @@ void Renderer::drawTextOverlay(QPainter& painter, const CTextOverlay& overlay) c
   painter.drawText(x, y, overlay.text.c_str());
 }
 
+//===========================================
+// Renderer::computePixelMetrics
+//
+// Derives the pixel dimensions and world unit ratios from the current target
+//===========================================
+void Renderer::computePixelMetrics() {
+  m_viewport_px = Size(m_target->width(), m_target->height());
+  m_hWorldUnit_px = m_viewport_px.x / m_viewport.x;
+  m_vWorldUnit_px = m_viewport_px.y / m_viewport.y;
+  m_screenH_px = m_viewport.y * m_vWorldUnit_px;
+}
+
 //===========================================
 // Renderer::Renderer
 //===========================================
@@ -798,14 +801,11 @@ Renderer::Renderer(const AppConfig& appConfig, EntityManager& entityManager, QIm
   const RenderGraph& rg, const Size& viewport)
   : m_appConfig(appConfig),
     m_entityManager(entityManager),
-    m_target(target),
+    m_target(&target),
     m_rg(rg),
     m_viewport(viewport) {
 
-  m_viewport_px = Size(m_target.width(), m_target.height());
-  m_hWorldUnit_px = m_viewport_px.x / m_viewport.x;
-  m_vWorldUnit_px = m_viewport_px.y / m_viewport.y;
-  m_screenH_px = m_viewport.y * m_vWorldUnit_px;
+  computePixelMetrics();
 
   for (unsigned int i = 0; i < m_tanMap_rp.size(); ++i) {
     m_tanMap_rp[i] = 1.0 / tan(2.0 * PI * static_cast<double>(i)
@@ -817,12 +817,18 @@ Renderer::Renderer(const AppConfig& appConfig, EntityManager& entityManager, QIm
     m_atanMap[i] = atan(ATAN_MIN + dx * static_cast<double>(i));
   }
 
-  m_numWorkerThreads = std::thread::hardware_concurrency() - 1;
-  if (m_numWorkerThreads < 0) {
-    m_numWorkerThreads = 0;
-  }
+  setNumWorkerThreads(std::thread::hardware_concurrency() - 1);
+}
 
+//===========================================
+// Renderer::setNumWorkerThreads
+//
+// Threads used in addition to the calling thread. Must not be called during a render.
+//===========================================
+void Renderer::setNumWorkerThreads(int n) {
+  m_numWorkerThreads = n < 0 ? 0 : n;
   m_threads = vector<std::thread>(m_numWorkerThreads);
+  m_rayScratch = vector<RayScratch>(m_numWorkerThreads + 1);
 }
 
 //===========================================
@@ -857,23 +863,61 @@ static vector<CWallDecal*> getWallDecals(const SpatialSystem& spatialSystem, con
 // Renderer::renderColumns
 //===========================================
 void Renderer::renderColumns(const SpatialSystem& spatialSystem, const RenderSystem& renderSystem,
-  int from, int to) const {
+  RayScratch& scratch, int from, int to) {
+
+  auto projX = [this](int screenX_px) {
+    return static_cast<double>(screenX_px - m_viewport_px.x / 2) / m_hWorldUnit_px;
+  };
+
+  // Cast the rays for all the dirty columns in one batch. Cast results point into these buffers,
+  // so they're kept for the whole frame.
+  vector<Vec2f> rays;
+  vector<IntersectionBuffer*> buffers;
+
+  for (int screenX_px = from; screenX_px < to; ++screenX_px) {
+    if (m_columnCache.isDirty(screenX_px)) {
+      rays.push_back(Vec2f(m_cam->F, projX(screenX_px)));
+      buffers.push_back(&m_columnBuffers[screenX_px]);
+    }
+  }
+
+  spatialSystem.entitiesAlongRays(m_cam->zone(), Point(0, 0), rays, m_camInverse, buffers,
+    scratch);
+
+  IntersectionBuffer walkBackBuffer;
 
   CastResult prev;
+  int prevX_px = -1;
 
   for (int screenX_px = from; screenX_px < to; ++screenX_px) {
-    double projX_wd = static_cast<double>(screenX_px - m_viewport_px.x / 2) / m_hWorldUnit_px;
+    if (!m_columnCache.isDirty(screenX_px)) {
+      continue;
+    }
 
-    Vec2f ray(m_cam->F, projX_wd);
+    double projX_wd = projX(screenX_px);
 
     CastResult result;
-    castRay(spatialSystem, renderSystem, ray, result);
+    castRay(spatialSystem, renderSystem, m_columnBuffers[screenX_px].results(), result);
 
     // Hack to fill gaps where regions don't connect properly
     if (result.intersections.size() == 0) {
+      // If the previous column wasn't redrawn, walk back to find one to borrow from
+      if (prevX_px != screenX_px - 1) {
+        prev = CastResult();
+
+        for (int x = screenX_px - 1; x >= from && prev.intersections.empty(); --x) {
+          castRay(spatialSystem, renderSystem, spatialSystem.entitiesAlongRay(m_cam->zone(),
+            Point(0, 0), Vec2f(m_cam->F, projX(x)), m_camInverse, walkBackBuffer), prev);
+        }
+      }
+
       result = std::move(prev);
     }
 
+    vector<entityId_t>& dependencies = m_columnCache.dependencies(screenX_px);
+    dependencies.clear();
+    recordDependencies(result, dependencies);
+
     for (auto it = result.intersections.rbegin(); it != result.intersections.rend(); ++it) {
       XWrapper& X = **it;
 
@@ -957,6 +1001,34 @@ void Renderer::renderColumns(const SpatialSystem& spatialSystem, const RenderSys
     }
 
     prev = std::move(result);
+    prevX_px = screenX_px;
+  }
+}
+
+//===========================================
+// Renderer::recordDependencies
+//
+// Notes the entities a column's pixels were derived from, so the column can be re-used until
+// one of them changes. Decals and floor decals are accounted for by their walls and zones.
+//===========================================
+void Renderer::recordDependencies(const CastResult& result,
+  vector<entityId_t>& dependencies) const {
+
+  ColumnCache::addZoneDependency(m_cam->zone(), dependencies);
+
+  for (auto it = result.intersections.begin(); it != result.intersections.end(); ++it) {
+    const XWrapper& X = **it;
+    dependencies.push_back(X.X->entityId);
+
+    if (X.kind == XWrapperKind::WALL) {
+      const WallX& wallX = DYNAMIC_CAST<const WallX&>(X);
+      ColumnCache::addZoneDependency(*wallX.nearZone, dependencies);
+    }
+    else if (X.kind == XWrapperKind::JOIN) {
+      const JoinX& joinX = DYNAMIC_CAST<const JoinX&>(X);
+      ColumnCache::addZoneDependency(*joinX.nearZone, dependencies);
+      ColumnCache::addZoneDependency(*joinX.farZone, dependencies);
+    }
   }
 }
 
@@ -965,7 +1037,7 @@ void Renderer::renderColumns(const SpatialSystem& spatialSystem, const RenderSys
 //===========================================
 void Renderer::drawOverlays() const {
   QPainter painter;
-  painter.begin(&m_target);
+  painter.begin(m_target);
 
   for (auto it = m_rg.overlays.begin(); it != m_rg.overlays.end(); ++it) {
     const COverlay& overlay = **it;
@@ -991,22 +1063,55 @@ void Renderer::drawOverlays() const {
 
 //===========================================
 // Renderer::renderScene
+//
+// The target may change size between frames. Returns false if nothing has changed since the
+// last frame, in which case the target is left untouched.
 //===========================================
-void Renderer::renderScene() {
+bool Renderer::renderScene(QImage& target) {
   if (m_cam == nullptr) {
     EXCEPTION("Error rendering scene; No camera set");
   }
 
+  if (target.width() != m_viewport_px.x || target.height() != m_viewport_px.y) {
+    m_target = &target;
+    computePixelMetrics();
+  }
+
+  if (m_scene.size() != target.size()) {
+    m_scene = QImage(target.width(), target.height(), target.format());
+  }
+
   auto& spatialSystem = m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
   auto& renderSystem = m_entityManager.system<RenderSystem>(ComponentKind::C_RENDER);
 
   const int W = m_viewport_px.x;
 
+  m_camInverse = m_cam->transform().inverse().matrix();
+
+  if (static_cast<int>(m_columnBuffers.size()) != W) {
+    m_columnBuffers.resize(W);
+  }
+
+  int numDirty = m_columnCache.update(*m_cam, spatialSystem, renderSystem, m_rg, W);
+  spatialSystem.clearChanges();
+  renderSystem.clearChanges();
+
+  m_lastFrameFull = numDirty == W;
+  m_lastFrameColumns = numDirty;
+
+  if (numDirty == 0 && !m_columnCache.overlaysChanged()) {
+    return false;
+  }
+
+  // Columns are drawn into the scene buffer, which is then copied to the target for the overlays
+  // to be drawn on top
+  m_target = &m_scene;
+
 #ifdef SINGLE_THREAD
-  renderColumns(spatialSystem, renderSystem, 0, W);
+  renderColumns(spatialSystem, renderSystem, m_rayScratch.back(), 0, W);
 #else
   if (m_numWorkerThreads == 0) {
-    renderColumns(spatialSystem, renderSystem, 0, W);
+    renderColumns(spatialSystem, renderSystem, m_rayScratch.back(), 0, W);
   }
   else {
     int perThread = W / (m_numWorkerThreads + 1);
@@ -1017,12 +1122,12 @@ void Renderer::renderScene() {
       int to = from + perThread;
 
       m_threads[i] = std::thread{&Renderer::renderColumns, this,
-        std::ref(spatialSystem), std::ref(renderSystem), from, to};
+        std::ref(spatialSystem), std::ref(renderSystem), std::ref(m_rayScratch[i]), from, to};
     }
 
     int from = m_numWorkerThreads * perThread;
     int to = from + perThread + remainder;
-    renderColumns(spatialSystem, renderSystem, from, to);
+    renderColumns(spatialSystem, renderSystem, m_rayScratch.back(), from, to);
 
     for (auto& t : m_threads) {
       t.join();
@@ -1030,5 +1135,22 @@ void Renderer::renderScene() {
   }
 #endif
 
+  // When the viewport is an even number of pixels wide, the centre column is cast straight ahead.
+  // This is the ray gameplay systems use for focus and shooting, so it's offered to the spatial
+  // system's cache. It's done here, once the workers have finished, as the cache may only be
+  // touched by the thread that owns the entity manager.
+  int centreX_px = W / 2;
+  if (centreX_px == m_viewport_px.x / 2 && m_columnCache.isDirty(centreX_px)) {
+    spatialSystem.cacheCameraRay(Vec2f(m_cam->F, 0), m_columnBuffers[centreX_px]);
+  }
+
+  m_target = &target;
+
+  for (int j = 0; j < m_scene.height(); ++j) {
+    memcpy(target.scanLine(j), m_scene.constScanLine(j), m_scene.bytesPerLine());
+  }
+
   drawOverlays();
+
+  return true;
 }
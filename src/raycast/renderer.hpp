@@ -9,6 +9,7 @@
 #include <QPainter>
 #include "raycast/spatial_system.hpp"
 #include "raycast/render_graph.hpp"
+#include "raycast/column_cache.hpp"
 #include "app_config.hpp"
 
 
@@ -27,8 +28,12 @@ class Renderer {
     inline const Size& viewport() const;
     inline const Size& viewport_px() const;
     inline Size worldUnit_px() const;
+    inline bool lastFrameFull() const;
+    inline int lastFrameColumns() const;
 
-    void renderScene();
+    void setNumWorkerThreads(int n);
+
+    bool renderScene(QImage& target);
 
   private:
     struct Slice {
@@ -55,12 +60,13 @@ class Renderer {
     };
 
     struct XWrapper {
-      XWrapper(XWrapperKind kind, pIntersection_t X)
+      XWrapper(XWrapperKind kind, const Intersection& X)
         : kind(kind),
-          X(std::move(X)) {}
+          X(&X) {}
 
       XWrapperKind kind;
-      pIntersection_t X;
+      // Points into the IntersectionBuffer the ray was cast with
+      const Intersection* X;
 
       virtual ~XWrapper() {}
     };
@@ -72,8 +78,8 @@ class Renderer {
     };
 
     struct JoinX : public XWrapper {
-      JoinX(pIntersection_t X)
-        : XWrapper(XWrapperKind::JOIN, std::move(X)) {}
+      JoinX(const Intersection& X)
+        : XWrapper(XWrapperKind::JOIN, X) {}
 
       const CSoftEdge* softEdge = nullptr;
       const CJoin* join = nullptr;
@@ -86,8 +92,8 @@ class Renderer {
     };
 
     struct WallX : public XWrapper {
-      WallX(pIntersection_t X)
-        : XWrapper(XWrapperKind::WALL, std::move(X)) {}
+      WallX(const Intersection& X)
+        : XWrapper(XWrapperKind::WALL, X) {}
 
       const CHardEdge* hardEdge = nullptr;
       const CWall* wall = nullptr;
@@ -98,8 +104,8 @@ class Renderer {
     };
 
     struct SpriteX : public XWrapper {
-      SpriteX(pIntersection_t X)
-        : XWrapper(XWrapperKind::SPRITE, std::move(X)) {}
+      SpriteX(const Intersection& X)
+        : XWrapper(XWrapperKind::SPRITE, X) {}
 
       const CVRect* vRect = nullptr;
       const CSprite* sprite = nullptr;
@@ -108,11 +114,12 @@ class Renderer {
       virtual ~SpriteX() override {}
     };
 
-    AppConfig m_appConfig;
+    const AppConfig& m_appConfig;
     EntityManager& m_entityManager;
-    QImage& m_target;
+    QImage* m_target;
     const RenderGraph& m_rg;
     const Camera* m_cam = nullptr;
+    Matrix m_camInverse;
 
     const double ATAN_MIN = -10.0;
     const double ATAN_MAX = 10.0;
@@ -132,8 +139,21 @@ class Renderer {
     std::vector<std::thread> m_threads;
     int m_numWorkerThreads;
 
+    // The scene without overlays, from which unchanged columns are re-used
+    QImage m_scene;
+    ColumnCache m_columnCache;
+    bool m_lastFrameFull = false;
+    int m_lastFrameColumns = 0;
+    // One per screen column. Worker threads only touch the columns in their own range.
+    std::vector<IntersectionBuffer> m_columnBuffers;
+    // One per thread, the calling thread's last
+    std::vector<RayScratch> m_rayScratch;
+
     void renderColumns(const SpatialSystem& spatialSystem, const RenderSystem& renderSystem,
-      int from, int to) const;
+      RayScratch& scratch, int from, int to);
+
+    void recordDependencies(const CastResult& result,
+      std::vector<entityId_t>& dependencies) const;
 
     void drawImage(const QRect& trgRect, const QImage& tex, const QRect& srcRect,
       double distance = 0) const;
@@ -171,14 +191,16 @@ class Renderer {
       double y_wd) const;
 
     XWrapper* constructXWrapper(const SpatialSystem& spatialSystem,
-      const RenderSystem& renderSystem, pIntersection_t X) const;
+      const RenderSystem& renderSystem, const Intersection& X) const;
 
     Slice computeSlice(const LineSegment& rotProjPlane, const LineSegment& wall, double subview0,
       double subview1, const LineSegment& projRay0, const LineSegment& projRay1, Point& projX0,
       Point& projX1) const;
 
     void castRay(const SpatialSystem& spatialSystem, const RenderSystem& renderSystem,
-      const Vec2f& dir, CastResult& result) const;
+      const IntersectionSpan& intersections, CastResult& result) const;
+
+    void computePixelMetrics();
 
     LineSegment projectionPlane() const;
     inline double projToScreenY(double y) const;
@@ -193,6 +215,24 @@ inline void Renderer::setCamera(const Camera* cam) {
   m_cam = cam;
 }
 
+//===========================================
+// Renderer::lastFrameFull
+//
+// Whether every column was drawn in the last call to renderScene
+//===========================================
+inline bool Renderer::lastFrameFull() const {
+  return m_lastFrameFull;
+}
+
+//===========================================
+// Renderer::lastFrameColumns
+//
+// The number of columns drawn in the last call to renderScene
+//===========================================
+inline int Renderer::lastFrameColumns() const {
+  return m_lastFrameColumns;
+}
+
 //===========================================
 // Renderer::viewport
 //===========================================
@@ -0,0 +1,86 @@
+#include <cmath>
+#include "raycast/resolution_controller.hpp"
+
+
+// Multiples of the native width and height
+static const std::vector<std::pair<double, double>> LEVEL_SCALES = {
+  { 0.5, 0.5 },
+  { 0.75, 0.5 },
+  { 0.75, 0.75 },
+  { 1.0, 0.75 },
+  { 1.0, 1.0 },
+  { 1.5, 1.0 },
+  { 1.5, 1.5 },
+  { 2.0, 1.5 },
+  { 2.0, 2.0 }
+};
+
+static const unsigned int NATIVE_LEVEL = 4;
+
+// Weight given to the previous average when smoothing frame times
+static const double SMOOTHING = 0.9;
+
+// Frames to wait after a change before considering another, so the average can settle
+static const int SETTLE_FRAMES = 30;
+
+// Only step up if the next level is predicted to use less than this fraction of the budget
+static const double HEADROOM = 0.75;
+
+
+//===========================================
+// ResolutionController::ResolutionController
+//===========================================
+ResolutionController::ResolutionController(double frameBudget, int nativeW, int nativeH)
+  : m_frameBudget(frameBudget),
+    m_level(NATIVE_LEVEL) {
+
+  for (auto& scale : LEVEL_SCALES) {
+    m_levels.push_back(Level{static_cast<int>(std::round(scale.first * nativeW)),
+      static_cast<int>(std::round(scale.second * nativeH))});
+  }
+}
+
+//===========================================
+// ResolutionController::setLevel
+//===========================================
+void ResolutionController::setLevel(unsigned int level) {
+  // Assume cost is proportional to pixel count until new measurements come in
+  m_avgFrameTime *= pixels(level) / pixels(m_level);
+
+  m_level = level;
+  m_framesSinceChange = 0;
+}
+
+//===========================================
+// ResolutionController::update
+//
+// Takes the time spent rendering the last frame. Returns true if the resolution has changed.
+//===========================================
+bool ResolutionController::update(double frameTime) {
+  if (m_avgFrameTime < 0) {
+    m_avgFrameTime = frameTime;
+  }
+  else {
+    m_avgFrameTime = SMOOTHING * m_avgFrameTime + (1.0 - SMOOTHING) * frameTime;
+  }
+
+  if (++m_framesSinceChange < SETTLE_FRAMES) {
+    return false;
+  }
+
+  if (m_avgFrameTime > m_frameBudget && m_level > 0) {
+    setLevel(m_level - 1);
+    return true;
+  }
+
+  if (m_level + 1 < m_levels.size()) {
+    double predicted = m_avgFrameTime * pixels(m_level + 1) / pixels(m_level);
+
+    if (predicted < m_frameBudget * HEADROOM) {
+      setLevel(m_level + 1);
+      return true;
+    }
+  }
+
+  return false;
+}
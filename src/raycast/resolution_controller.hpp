@@ -0,0 +1,59 @@
+#ifndef __PROCALC_RAYCAST_RESOLUTION_CONTROLLER_HPP__
+#define __PROCALC_RAYCAST_RESOLUTION_CONTROLLER_HPP__
+
+
+#include <vector>
+
+
+// Picks a render resolution from a ladder of levels around the native resolution, stepping down
+// when frames take longer than the budget and back up when there's room to spare. Levels
+// alternate between changing the column count and the row count, and extend above native for
+// machines that can afford it.
+class ResolutionController {
+  public:
+    ResolutionController(double frameBudget, int nativeW, int nativeH);
+
+    bool update(double frameTime);
+
+    inline int width() const;
+    inline int height() const;
+
+  private:
+    struct Level {
+      int w;
+      int h;
+    };
+
+    inline double pixels(unsigned int level) const;
+    void setLevel(unsigned int level);
+
+    double m_frameBudget;
+    std::vector<Level> m_levels;
+    unsigned int m_level;
+    double m_avgFrameTime = -1;
+    int m_framesSinceChange = 0;
+};
+
+//===========================================
+// ResolutionController::width
+//===========================================
+inline int ResolutionController::width() const {
+  return m_levels[m_level].w;
+}
+
+//===========================================
+// ResolutionController::height
+//===========================================
+inline int ResolutionController::height() const {
+  return m_levels[m_level].h;
+}
+
+//===========================================
+// ResolutionController::pixels
+//===========================================
+inline double ResolutionController::pixels(unsigned int level) const {
+  return static_cast<double>(m_levels[level].w) * static_cast<double>(m_levels[level].h);
+}
+
+
+#endif
@@ -6,6 +6,7 @@
 #include <vector>
 #include <iterator>
 #include <deque>
+#include <cmath>
 #include "raycast/spatial_system.hpp"
 #include "raycast/damage_system.hpp"
 #include "raycast/geometry.hpp"
@@ -36,6 +37,7 @@ static const double GRID_CELL_SIZE = 25.0;
 static const double SNAP_DISTANCE = 4.0;
 static const int MAX_ANCESTOR_SEARCH = 2;
 static const double ACCELERATION_DUE_TO_GRAVITY = -600.0;
+static const size_t MAX_CACHED_RAYS = 8;
 
 
 ostream& operator<<(ostream& os, CSpatialKind kind) {
@@ -584,93 +586,171 @@ bool SpatialSystem::areTwins(const CSoftEdge& se1, const CSoftEdge& se2) const {
     !(isAncestor(se1.parentId, se2.parentId) || isAncestor(se2.parentId, se1.parentId));
 }
 
+//===========================================
+// midpointCell
+//
+// Twins' end points are within SNAP_DISTANCE of each other, so their midpoints are too, and lie
+// in the same or neighbouring cells of a grid SNAP_DISTANCE wide
+//===========================================
+static pair<long, long> midpointCell(const LineSegment& lseg) {
+  Point m = (lseg.A + lseg.B) * 0.5;
+  return make_pair(static_cast<long>(floor(m.x / SNAP_DISTANCE)),
+    static_cast<long>(floor(m.y / SNAP_DISTANCE)));
+}
+
 //===========================================
 // SpatialSystem::connectSubzones
+//
+// Each soft edge is paired with the first soft edge, in zone order, that is either its twin or
+// shares its join ID. The search covers the zones up to and including the one after the edge's
+// own, then the next sibling of each of that zone's ancestors, which is as far as the exhaustive
+// search this replaced would reach. Rather than comparing every pair of soft edges, candidates are
+// found by the grid cell of their midpoint and by join ID.
 //===========================================
 void SpatialSystem::connectSubzones(CZone& zone) {
-  int i = 0;
+  struct Entry {
+    CSoftEdge* se;
+    CZone* zone;
+    int zoneIdx;
+  };
+
+  vector<CZone*> zones;
+  map<const CZone*, CZone*> nextSibling;
+  vector<Entry> entries;
+  map<pair<long, long>, vector<size_t>> byCell;
+  map<entityId_t, vector<size_t>> byJoinId;
+
   forEachZone(zone, [&](CZone& r) {
+    for (size_t c = 0; c + 1 < r.children.size(); ++c) {
+      nextSibling[r.children[c].get()] = r.children[c + 1].get();
+    }
+
     for (auto it = r.edges.begin(); it != r.edges.end(); ++it) {
       if ((*it)->kind == CSpatialKind::SOFT_EDGE) {
         CSoftEdge* se = DYNAMIC_CAST<CSoftEdge*>(it->get());
         assert(se != nullptr);
 
-        bool hasTwin = false;
-        int j = 0;
-        forEachZone(zone, [&](CZone& r_) {
-          for (auto lt = r_.edges.begin(); lt != r_.edges.end(); ++lt) {
-            if ((*lt)->kind == CSpatialKind::SOFT_EDGE) {
-              CSoftEdge* other = DYNAMIC_CAST<CSoftEdge*>(lt->get());
-
-              if (other != se) {
-                if (areTwins(*se, *other)) {
-                  hasTwin = true;
-
-                  se->joinId = other->joinId;
-                  se->zoneA = &r;
-                  se->zoneB = &r_;
-                  se->lseg = other->lseg;
-                  se->twinId = other->entityId();
-
-                  other->zoneA = &r_;
-                  other->zoneB = &r;
-                  other->twinId = se->entityId();
-
-                  return false;
-                }
-
-                // If they're already joined by id (i.e. portals)
-                if (se->joinId != -1 && se->joinId == other->joinId) {
-                  hasTwin = true;
-
-                  se->zoneA = &r;
-                  se->zoneB = &r_;
-                  se->twinId = other->entityId();
-
-                  double a1 = se->lseg.angle();
-                  double a2 = other->lseg.angle();
-                  double a = a2 - a1;
-
-                  Matrix toOrigin(0, -se->lseg.A);
-                  Matrix rotate(a, Vec2f(0, 0));
-                  Matrix translate(0, other->lseg.A);
-                  Matrix m = translate * rotate * toOrigin;
-
-                  se->toTwin = m;
-
-                  other->zoneA = &r_;
-                  other->zoneB = &r;
-                  other->twinId = se->entityId();
-                  other->toTwin = m.inverse();
-                  other->lseg.A = m * se->lseg.A;
-                  other->lseg.B = m * se->lseg.B;
-
-                  return false;
-                }
-              }
-            }
-          }
+        byCell[midpointCell(se->lseg)].push_back(entries.size());
+        byJoinId[se->joinId].push_back(entries.size());
+        entries.push_back(Entry{se, &r, static_cast<int>(zones.size())});
+      }
+    }
 
-          if (j > i) {
-            return false;
-          }
+    zones.push_back(&r);
+    return true;
+  });
+
+  vector<size_t> candidates;
+  vector<const CZone*> beyond;
 
-          ++j;
-          return true;
-        });
+  for (size_t k = 0; k < entries.size(); ++k) {
+    CSoftEdge* se = entries[k].se;
+    CZone& r = *entries[k].zone;
+    int i = entries[k].zoneIdx;
 
-        if (!hasTwin) {
-          assert(r.parent != nullptr);
+    beyond.clear();
+    if (i + 1 < static_cast<int>(zones.size())) {
+      for (const CZone* z = zones[i + 1]->parent; z != nullptr && z->parent != nullptr;
+        z = z->parent) {
 
-          se->zoneA = &r;
-          se->zoneB = r.parent;
+        auto it = nextSibling.find(z);
+        if (it != nextSibling.end()) {
+          beyond.push_back(it->second);
         }
       }
     }
 
-    ++i;
-    return true;
-  });
+    candidates.clear();
+
+    pair<long, long> cell = midpointCell(se->lseg);
+    for (long x = cell.first - 1; x <= cell.first + 1; ++x) {
+      for (long y = cell.second - 1; y <= cell.second + 1; ++y) {
+        auto it = byCell.find(make_pair(x, y));
+        if (it != byCell.end()) {
+          candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+        }
+      }
+    }
+
+    if (se->joinId != -1) {
+      auto it = byJoinId.find(se->joinId);
+      if (it != byJoinId.end()) {
+        candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+      }
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    bool hasTwin = false;
+
+    for (size_t c = 0; c < candidates.size() && !hasTwin; ++c) {
+      size_t l = candidates[c];
+      CSoftEdge* other = entries[l].se;
+      CZone& r_ = *entries[l].zone;
+
+      if (other == se) {
+        continue;
+      }
+
+      if (entries[l].zoneIdx > i + 1
+        && std::find(beyond.begin(), beyond.end(), &r_) == beyond.end()) {
+
+        continue;
+      }
+
+      if (areTwins(*se, *other)) {
+        hasTwin = true;
+
+        se->joinId = other->joinId;
+        se->zoneA = &r;
+        se->zoneB = &r_;
+        se->lseg = other->lseg;
+        se->twinId = other->entityId();
+
+        other->zoneA = &r_;
+        other->zoneB = &r;
+        other->twinId = se->entityId();
+
+        byCell[midpointCell(se->lseg)].push_back(k);
+        byJoinId[se->joinId].push_back(k);
+      }
+      // If they're already joined by id (i.e. portals)
+      else if (se->joinId != -1 && se->joinId == other->joinId) {
+        hasTwin = true;
+
+        se->zoneA = &r;
+        se->zoneB = &r_;
+        se->twinId = other->entityId();
+
+        double a1 = se->lseg.angle();
+        double a2 = other->lseg.angle();
+        double a = a2 - a1;
+
+        Matrix toOrigin(0, -se->lseg.A);
+        Matrix rotate(a, Vec2f(0, 0));
+        Matrix translate(0, other->lseg.A);
+        Matrix m = translate * rotate * toOrigin;
+
+        se->toTwin = m;
+
+        other->zoneA = &r_;
+        other->zoneB = &r;
+        other->twinId = se->entityId();
+        other->toTwin = m.inverse();
+        other->lseg.A = m * se->lseg.A;
+        other->lseg.B = m * se->lseg.B;
+
+        byCell[midpointCell(other->lseg)].push_back(l);
+      }
+    }
+
+    if (!hasTwin) {
+      assert(r.parent != nullptr);
+
+      se->zoneA = &r;
+      se->zoneB = r.parent;
+    }
+  }
 }
 
 //===========================================
@@ -697,9 +777,10 @@ void SpatialSystem::handleEvent(const GameEvent& event) {
 
     e.inRadius = entitiesInRadius(zone, sg.player->pos(), sg.player->activationRadius, y);
 
-    auto vec = entitiesAlong3dRay(Vec2f{1, 0}, 0.0, sg.player->activationRadius);
-    for (auto& pX : vec) {
-      e.lookingAt.insert(pX->entityId);
+    auto intersections = entitiesAlong3dRay(Vec2f{1, 0}, 0.0, m_rayBuffer,
+      sg.player->activationRadius);
+    for (auto& X : intersections) {
+      e.lookingAt.insert(X.entityId);
     }
 
     set<entityId_t> entities;
@@ -779,10 +860,74 @@ void SpatialSystem::relocateEntity(entityId_t id, CZone& zone, const Point& poin
 
       body.zone = &zone;
       body.pos = point;
+
+      growBounds(zone, point);
+      markChanged(body);
     }
   }
 }
 
+//===========================================
+// SpatialSystem::setPosition
+//===========================================
+void SpatialSystem::setPosition(CVRect& body, const Point& pos) {
+  body.pos = pos;
+  markChanged(body);
+}
+
+//===========================================
+// SpatialSystem::setAngle
+//===========================================
+void SpatialSystem::setAngle(CVRect& body, double angle) {
+  body.angle = angle;
+  markChanged(body);
+}
+
+//===========================================
+// SpatialSystem::detachEntity
+//
+// Takes the entity out of the scene graph without destroying it, so it can't be seen or found by
+// queries. Its component can still be looked up by ID.
+//===========================================
+void SpatialSystem::detachEntity(entityId_t id) {
+  auto it = m_components.find(id);
+  if (it == m_components.end() || m_detached.count(id)) {
+    return;
+  }
+
+  CSpatial& c = *it->second;
+
+  if (c.kind != CSpatialKind::V_RECT) {
+    EXCEPTION("Error detaching entity " << id << "; Only V_RECTs can be detached");
+  }
+
+  CVRect& body = DYNAMIC_CAST<CVRect&>(c);
+  markChanged(body);
+
+  if (removeChildFromComponent(*body.zone, c, true)) {
+    m_detached.insert(std::make_pair(id, pCSpatial_t(&c)));
+  }
+}
+
+//===========================================
+// SpatialSystem::attachEntity
+//
+// Returns a detached entity to the scene graph at the given position
+//===========================================
+void SpatialSystem::attachEntity(entityId_t id, CZone& zone, const Point& point) {
+  auto it = m_detached.find(id);
+  if (it == m_detached.end()) {
+    EXCEPTION("Error attaching entity " << id << "; Entity is not detached");
+  }
+
+  CVRect& body = DYNAMIC_CAST<CVRect&>(*it->second);
+
+  addChildToComponent(*body.zone, std::move(it->second));
+  m_detached.erase(it);
+
+  relocateEntity(id, zone, point);
+}
+
 //===========================================
 // SpatialSystem::moveEntity
 //===========================================
@@ -868,6 +1013,9 @@ void SpatialSystem::moveEntity(entityId_t id, Vec2f dv, double heightAboveFloor)
       body.pos = body.pos + dv;
       body.pos = m * body.pos;
       body.angle += m.a();
+
+      growBounds(*body.zone, body.pos);
+      markChanged(body);
     }
   }
 }
@@ -997,6 +1145,8 @@ void SpatialSystem::buoyancy() {
   if (diff > 0.0) {
     double dy = smallest<double>(diff, 150.0 / m_frameRate);
     sg.player->changeHeight(currentZone, dy);
+
+    forgetCachedRays(sg.player->body);
   }
 }
 
@@ -1005,22 +1155,48 @@ void SpatialSystem::buoyancy() {
 //===========================================
 void SpatialSystem::connectZones() {
   connectSubzones(*sg.rootZone);
+  clearRayCache();
+  m_zoneBoundsDirty = true;
+
+  // Any soft edge may now lead somewhere else
+  for (auto it = m_components.begin(); it != m_components.end(); ++it) {
+    m_changed.insert(it->first);
+  }
 }
 
 //===========================================
 // SpatialSystem::findIntersections_r
 //
-// point and dir are in the space given by matrix. i.e. if matrix is the camera matrix, point and
-// dir are in camera space.
+// Traces the active rays, scratch.m_active[first] to scratch.m_active[last - 1], through the
+// given zone or edge. point and the rays are in the space given by matrix. i.e. if matrix is the
+// camera matrix, they're in camera space.
+//
+// Each ray keeps its own culling distances and visited list, and is only passed down to the
+// children it hits, so it sees exactly the same sequence of tests it would if traced alone. What
+// the rays share is the work that doesn't depend on the ray: inverting the matrix and
+// transforming each edge and vRect into ray space.
 //===========================================
-void SpatialSystem::findIntersections_r(const Point& point, const Vec2f& dir, const Matrix& matrix,
-  const CZone& zone, const CSpatial& parent, vector<pIntersection_t>& intersections,
-  vector<entityId_t>& visited, double cullNearerThan, double& cullFartherThan) const {
+void SpatialSystem::findIntersections_r(const Point& point, const Matrix& matrix,
+  const CZone& zone, const CSpatial& parent, RayScratch& scratch, size_t first, size_t last) const {
+
+  typedef RayScratch::RayState RayState;
+
+  auto& rays = scratch.m_rays;
+  auto& active = scratch.m_active;
+  auto& visited = scratch.m_visited;
+
+  // Subsets of the active rays are pushed onto the end of scratch.m_active before recursing and
+  // popped afterwards, so elements are always accessed by index, never by reference
+  auto pushActive = [&active](int ray, const Point& pt) {
+    active.push_back(RayScratch::ActiveRay{ray, pt});
+  };
 
   Matrix invMatrix = matrix.inverse();
+  Point viewPoint = invMatrix * point;
 
-  LineSegment ray(point + Vec2f(0.01, 0), 10000.0 * dir);
-  visited.push_back(parent.entityId());
+  for (size_t i = first; i < last; ++i) {
+    visited[rays[active[i].ray].visited].push_back(parent.entityId());
+  }
 
   auto& children = GET_VALUE(m_entityChildren, parent.entityId());
   for (const CSpatial* pChild : children) {
@@ -1028,10 +1204,20 @@ void SpatialSystem::findIntersections_r(const Point& point, const Vec2f& dir, co
 
     switch (c.kind) {
       case CSpatialKind::ZONE: {
-        if (!contains(visited, c.entityId())) {
-          findIntersections_r(point, dir, matrix, DYNAMIC_CAST<const CZone&>(c), c, intersections,
-            visited, cullNearerThan, cullFartherThan);
+        size_t subset = active.size();
+
+        for (size_t i = first; i < last; ++i) {
+          if (!contains(visited[rays[active[i].ray].visited], c.entityId())) {
+            pushActive(active[i].ray, Point());
+          }
+        }
+
+        if (active.size() > subset) {
+          findIntersections_r(point, matrix, DYNAMIC_CAST<const CZone&>(c), c, scratch, subset,
+            active.size());
         }
+
+        active.resize(subset);
         break;
       }
       case CSpatialKind::V_RECT: {
@@ -1042,23 +1228,29 @@ void SpatialSystem::findIntersections_r(const Point& point, const Vec2f& dir, co
           double w = vRect.size.x;
           LineSegment lseg(Point(pos.x, pos.y - 0.5 * w), Point(pos.x, pos.y + 0.5 * w));
 
-          Point pt;
-          if (lineSegmentIntersect(ray, lseg, pt)) {
-            if (pt.x < cullNearerThan || pt.x > cullFartherThan) {
-              continue;
-            }
+          auto heightRanges = make_pair(Range(vRect.zone->floorHeight + vRect.y,
+            vRect.zone->floorHeight + vRect.y + vRect.size.y), Range(0, 0));
 
-            pIntersection_t X(new Intersection(CSpatialKind::V_RECT, parent.kind));
-            X->entityId = vRect.entityId();
-            X->point_rel = pt;
-            X->point_wld = invMatrix * pt;
-            X->viewPoint = invMatrix * point;
-            X->distanceFromOrigin = pt.x;
-            X->distanceAlongTarget = distance(lseg.A, pt);
-            X->zoneA = X->zoneB = zone.entityId();
-            X->heightRanges = make_pair(Range(vRect.zone->floorHeight + vRect.y,
-              vRect.zone->floorHeight + vRect.y + vRect.size.y), Range(0, 0));
-            intersections.push_back(std::move(X));
+          for (size_t i = first; i < last; ++i) {
+            RayState& ray = rays[active[i].ray];
+
+            Point pt;
+            if (lineSegmentIntersect(ray.lseg, lseg, pt)) {
+              if (pt.x < ray.cullNearerThan || pt.x > ray.cullFartherThan) {
+                continue;
+              }
+
+              Intersection X(CSpatialKind::V_RECT, parent.kind);
+              X.entityId = vRect.entityId();
+              X.point_rel = pt;
+              X.point_wld = invMatrix * pt;
+              X.viewPoint = viewPoint;
+              X.distanceFromOrigin = pt.x;
+              X.distanceAlongTarget = distance(lseg.A, pt);
+              X.zoneA = X.zoneB = zone.entityId();
+              X.heightRanges = heightRanges;
+              ray.buffer->add(X);
+            }
           }
         }
         else if (parent.kind == CSpatialKind::HARD_EDGE || parent.kind == CSpatialKind::SOFT_EDGE) {
@@ -1071,34 +1263,38 @@ void SpatialSystem::findIntersections_r(const Point& point, const Vec2f& dir, co
           double w = vRect.size.x;
           LineSegment lseg(pos, pos + w * v);
 
-          Point pt;
-          if (lineSegmentIntersect(ray, lseg, pt)) {
-            if (pt.x < cullNearerThan || pt.x > cullFartherThan) {
-              continue;
-            }
+          double vRectFloorH = vRect.zone->floorHeight;
+          if (edge.kind == CSpatialKind::SOFT_EDGE) {
+            const CSoftEdge& se = DYNAMIC_CAST<const CSoftEdge&>(edge);
+            vRectFloorH = smallest(se.zoneA->floorHeight, se.zoneB->floorHeight);
+          }
+          double y0 = vRectFloorH + vRect.pos.y;
+          double y1 = y0 + vRect.size.y;
+
+          for (size_t i = first; i < last; ++i) {
+            RayState& ray = rays[active[i].ray];
 
-            assert(parent.parentId == zone.entityId());
+            Point pt;
+            if (lineSegmentIntersect(ray.lseg, lseg, pt)) {
+              if (pt.x < ray.cullNearerThan || pt.x > ray.cullFartherThan) {
+                continue;
+              }
 
-            pt.x -= 0.01;
+              assert(parent.parentId == zone.entityId());
 
-            double vRectFloorH = vRect.zone->floorHeight;
-            if (edge.kind == CSpatialKind::SOFT_EDGE) {
-              const CSoftEdge& se = DYNAMIC_CAST<const CSoftEdge&>(edge);
-              vRectFloorH = smallest(se.zoneA->floorHeight, se.zoneB->floorHeight);
+              pt.x -= 0.01;
+
+              Intersection X(CSpatialKind::V_RECT, parent.kind);
+              X.entityId = vRect.entityId();
+              X.point_rel = pt;
+              X.point_wld = invMatrix * pt;
+              X.viewPoint = viewPoint;
+              X.distanceFromOrigin = pt.x;
+              X.distanceAlongTarget = distance(lseg.A, pt);
+              X.zoneA = X.zoneB = zone.entityId();
+              X.heightRanges = make_pair(Range(y0, y1), Range(0, 0));
+              ray.buffer->add(X);
             }
-            double y0 = vRectFloorH + vRect.pos.y;
-            double y1 = y0 + vRect.size.y;
-
-            pIntersection_t X(new Intersection(CSpatialKind::V_RECT, parent.kind));
-            X->entityId = vRect.entityId();
-            X->point_rel = pt;
-            X->point_wld = invMatrix * pt;
-            X->viewPoint = invMatrix * point;
-            X->distanceFromOrigin = pt.x;
-            X->distanceAlongTarget = distance(lseg.A, pt);
-            X->zoneA = X->zoneB = zone.entityId();
-            X->heightRanges = make_pair(Range(y0, y1), Range(0, 0));
-            intersections.push_back(std::move(X));
           }
         }
         break;
@@ -1108,75 +1304,145 @@ void SpatialSystem::findIntersections_r(const Point& point, const Vec2f& dir, co
         const CEdge& edge = DYNAMIC_CAST<const CEdge&>(c);
         LineSegment lseg = transform(edge.lseg, matrix);
 
-        Point pt;
-        if (lineSegmentIntersect(ray, lseg, pt)) {
-          if (pt.x < cullNearerThan || pt.x > cullFartherThan) {
-            continue;
-          }
+        // The rays that hit the edge, with their points of intersection
+        size_t hits = active.size();
+
+        for (size_t i = first; i < last; ++i) {
+          RayState& ray = rays[active[i].ray];
 
-          if (c.kind == CSpatialKind::HARD_EDGE && pt.x < cullFartherThan) {
-            // Add a small offset in case there's something very close to the wall that we
-            // don't want to get culled
-            cullFartherThan = pt.x + 1.0;
+          Point pt;
+          if (lineSegmentIntersect(ray.lseg, lseg, pt)) {
+            if (pt.x < ray.cullNearerThan || pt.x > ray.cullFartherThan) {
+              continue;
+            }
+
+            if (c.kind == CSpatialKind::HARD_EDGE && pt.x < ray.cullFartherThan) {
+              // Add a small offset in case there's something very close to the wall that we
+              // don't want to get culled
+              ray.cullFartherThan = pt.x + 1.0;
+            }
+
+            pushActive(active[i].ray, pt);
           }
+        }
+
+        size_t hitsEnd = active.size();
+
+        if (hitsEnd == hits) {
+          break;
+        }
 
-          if (!contains(visited, c.entityId())) {
-            findIntersections_r(point, dir, matrix, zone, c, intersections, visited, cullNearerThan,
-              cullFartherThan);
+        size_t subset = active.size();
+
+        for (size_t i = hits; i < hitsEnd; ++i) {
+          if (!contains(visited[rays[active[i].ray].visited], c.entityId())) {
+            pushActive(active[i].ray, Point());
           }
+        }
+
+        if (active.size() > subset) {
+          findIntersections_r(point, matrix, zone, c, scratch, subset, active.size());
+        }
+
+        active.resize(subset);
 
-          pIntersection_t X(new Intersection(edge.kind, parent.kind));
-          X->entityId = edge.entityId();
-          X->point_rel = pt;
-          X->point_wld = invMatrix * pt;
-          X->viewPoint = invMatrix * point;
-          X->distanceFromOrigin = pt.x;
-          X->distanceAlongTarget = distance(lseg.A, pt);
-          X->zoneA = zone.entityId();
-
-          if (edge.kind == CSpatialKind::HARD_EDGE) {
-            X->zoneB = zone.parent != nullptr ? zone.parent->entityId() : X->zoneA;
-            X->heightRanges = make_pair(Range(-10000, 10000), Range(0, 0)); // TODO
-            intersections.push_back(std::move(X));
+        Intersection X(edge.kind, parent.kind);
+        X.entityId = edge.entityId();
+        X.viewPoint = viewPoint;
+        X.zoneA = zone.entityId();
+
+        if (edge.kind == CSpatialKind::HARD_EDGE) {
+          X.zoneB = zone.parent != nullptr ? zone.parent->entityId() : X.zoneA;
+          X.heightRanges = make_pair(Range(-10000, 10000), Range(0, 0)); // TODO
+
+          for (size_t i = hits; i < hitsEnd; ++i) {
+            const Point& pt = active[i].pt;
+
+            X.point_rel = pt;
+            X.point_wld = invMatrix * pt;
+            X.distanceFromOrigin = pt.x;
+            X.distanceAlongTarget = distance(lseg.A, pt);
+            rays[active[i].ray].buffer->add(X);
           }
-          else if (edge.kind == CSpatialKind::SOFT_EDGE) {
-            const CSoftEdge& se = DYNAMIC_CAST<const CSoftEdge&>(edge);
-            const CZone& next = se.zoneA == &zone ? *se.zoneB : *se.zoneA;
+        }
+        else if (edge.kind == CSpatialKind::SOFT_EDGE) {
+          const CSoftEdge& se = DYNAMIC_CAST<const CSoftEdge&>(edge);
+          const CZone& next = se.zoneA == &zone ? *se.zoneB : *se.zoneA;
 
-            if (contains(visited, se.joinId)) {
+          X.zoneB = next.entityId();
+          X.heightRanges = make_pair(Range(se.zoneA->floorHeight, se.zoneB->floorHeight),
+            Range(se.zoneA->ceilingHeight, se.zoneB->ceilingHeight));
+
+          Matrix mat = se.isPortal ? (se.toTwin * invMatrix).inverse() : matrix;
+
+          for (size_t i = hits; i < hitsEnd; ++i) {
+            RayState& ray = rays[active[i].ray];
+            const Point& pt = active[i].pt;
+
+            if (contains(visited[ray.visited], se.joinId)) {
               continue;
             }
 
-            visited.push_back(se.joinId);
+            visited[ray.visited].push_back(se.joinId);
 
-            X->zoneB = next.entityId();
-            X->heightRanges = make_pair(Range(se.zoneA->floorHeight, se.zoneB->floorHeight),
-              Range(se.zoneA->ceilingHeight, se.zoneB->ceilingHeight));
+            X.point_rel = pt;
+            X.point_wld = invMatrix * pt;
+            X.distanceFromOrigin = pt.x;
+            X.distanceAlongTarget = distance(lseg.A, pt);
+            ray.buffer->add(X);
 
-            Matrix mat = matrix;
-            double cullNearerThan_ = cullNearerThan;
+            if (se.isPortal) {
+              pushActive(active[i].ray, pt);
+            }
+            else if (!contains(visited[ray.visited], next.entityId())) {
+              pushActive(active[i].ray, pt);
+            }
+          }
 
-            vector<entityId_t> visited_{se.joinId};
-            vector<entityId_t>* pVisited = &visited;
+          size_t subsetEnd = active.size();
 
+          if (subsetEnd > subset) {
             if (se.isPortal) {
-              mat = (se.toTwin * invMatrix).inverse();
-              cullNearerThan_ = X->distanceFromOrigin;
-              cullFartherThan = 10000;
-              pVisited = &visited_;
-            }
+              // Rays passing through a portal start afresh on the other side, and are restored
+              // afterwards
+              auto& saved = scratch.m_saved;
+              size_t savedBase = saved.size();
+              size_t visitedBase = scratch.m_numVisited;
+
+              for (size_t i = subset; i < subsetEnd; ++i) {
+                RayState& ray = rays[active[i].ray];
+                saved.push_back(ray);
+
+                ray.visited = scratch.pushVisited();
+                visited[ray.visited].push_back(se.joinId);
 
-            intersections.push_back(std::move(X));
+                ray.cullNearerThan = active[i].pt.x;
+                ray.cullFartherThan = 10000;
+              }
+
+              findIntersections_r(point, mat, next, next, scratch, subset, subsetEnd);
 
-            if (!contains(visited, next.entityId()) || se.isPortal) {
-              findIntersections_r(point, dir, mat, next, next, intersections, *pVisited,
-                cullNearerThan_, cullFartherThan);
+              for (size_t i = subset; i < subsetEnd; ++i) {
+                RayState& ray = rays[active[i].ray];
+                ray.visited = saved[savedBase + i - subset].visited;
+                ray.cullNearerThan = saved[savedBase + i - subset].cullNearerThan;
+              }
+
+              saved.resize(savedBase);
+              scratch.m_numVisited = visitedBase;
+            }
+            else {
+              findIntersections_r(point, mat, next, next, scratch, subset, subsetEnd);
             }
           }
-          else {
-            EXCEPTION("Unexpected intersection type");
-          }
+
+          active.resize(subset);
         }
+        else {
+          EXCEPTION("Unexpected intersection type");
+        }
+
+        active.resize(hits);
         break;
       }
       default: break;
@@ -1187,138 +1453,395 @@ void SpatialSystem::findIntersections_r(const Point& point, const Vec2f& dir, co
 //===========================================
 // SpatialSystem::entitiesAlongRay
 //===========================================
-vector<pIntersection_t> SpatialSystem::entitiesAlongRay(const Vec2f& ray, double distance) const {
+IntersectionSpan SpatialSystem::entitiesAlongRay(const Vec2f& ray, IntersectionBuffer& buffer,
+  double distance) const {
+
+  syncRayCache();
+
+  const CachedRay* cached = findCachedRay(ray, distance);
+  if (cached != nullptr) {
+    ++m_rayCacheStats.hits;
+
+    buffer.assignResults(cached->results, distance);
+    return buffer.results();
+  }
+
+  ++m_rayCacheStats.misses;
+
   const Camera& camera = sg.player->camera();
 
-  Matrix matrix = camera.matrix().inverse();
-  vector<pIntersection_t> intersections = entitiesAlongRay(getCurrentZone(), Point(0, 0), ray,
-    matrix, distance);
+  Matrix matrix = camera.transform().inverse().matrix();
+  entitiesAlongRay(getCurrentZone(), Point(0, 0), ray, matrix, buffer, distance);
+
+  cacheCameraRay(ray, buffer, distance);
 
-  return intersections;
+  return buffer.results();
 }
 
 //===========================================
-// SpatialSystem::entitiesAlongRay
+// SpatialSystem::syncRayCache
+//
+// Empties the cache if the camera has moved since it was filled
 //===========================================
-vector<pIntersection_t> SpatialSystem::entitiesAlongRay(const CZone& zone, const Point& pos,
-  const Vec2f& dir, const Matrix& matrix, double distance) const {
+void SpatialSystem::syncRayCache() const {
+  const Camera& camera = sg.player->camera();
+  const CZone* zone = &getCurrentZone();
 
-  vector<pIntersection_t> intersections;
-  intersections.reserve(20);
+  RayCache& cache = m_rayCache;
 
-  vector<entityId_t> visited;
-  visited.reserve(30);
+  if (cache.zone != zone || cache.x != camera.pos().x || cache.y != camera.pos().y
+    || cache.angle != camera.angle()) {
 
-  double cullFartherThan = distance;
+    cache.zone = zone;
+    cache.x = camera.pos().x;
+    cache.y = camera.pos().y;
+    cache.angle = camera.angle();
+    cache.size = 0;
+  }
+}
+
+//===========================================
+// SpatialSystem::findCachedRay
+//===========================================
+const SpatialSystem::CachedRay* SpatialSystem::findCachedRay(const Vec2f& dir,
+  double distance) const {
 
-  findIntersections_r(pos, dir, matrix, zone, zone, intersections, visited, 0, cullFartherThan);
+  Vec2f d = normalise(dir);
 
-  std::sort(intersections.begin(), intersections.end(),
-    [](const pIntersection_t& a, const pIntersection_t& b) {
+  for (size_t i = 0; i < m_rayCache.size; ++i) {
+    const CachedRay& ray = m_rayCache.rays[i];
 
-    return a->distanceFromOrigin < b->distanceFromOrigin;
-  });
+    if (ray.dir == d && ray.distance >= distance) {
+      return &ray;
+    }
+  }
 
-  std::vector<pIntersection_t> Xs;
-  std::vector<pIntersection_t> excluded;
-  entityId_t currentZone = zone.entityId();
+  return nullptr;
+}
 
-  while (!intersections.empty()) {
-    const auto& X = intersections.front();
+//===========================================
+// SpatialSystem::cacheCameraRay
+//
+// Stores the results of a camera-space ray query (as returned by entitiesAlongRay with the
+// camera's zone and inverse matrix) for re-use until the camera moves or something the ray
+// depends on changes
+//===========================================
+void SpatialSystem::cacheCameraRay(const Vec2f& dir, const IntersectionBuffer& results,
+  double distance) const {
 
-    if (X->zoneA == currentZone || X->zoneB == currentZone) {
-      auto other = currentZone == X->zoneA ? X->zoneB : X->zoneA;
+  syncRayCache();
 
-      Xs.push_back(std::move(intersections.front()));
-      intersections.erase(intersections.begin());
+  Vec2f d = normalise(dir);
+  RayCache& cache = m_rayCache;
 
-      currentZone = other;
+  CachedRay* entry = nullptr;
 
-      for (auto ex = excluded.rbegin(); ex != excluded.rend(); ++ex) {
-        intersections.insert(intersections.begin(), std::move(*ex));
+  for (size_t i = 0; i < cache.size; ++i) {
+    if (cache.rays[i].dir == d) {
+      if (cache.rays[i].distance >= distance) {
+        return;
       }
-      excluded.clear();
+
+      entry = &cache.rays[i];
+      break;
+    }
+  }
+
+  if (entry == nullptr) {
+    if (cache.size == MAX_CACHED_RAYS) {
+      return;
+    }
+
+    if (cache.size == cache.rays.size()) {
+      cache.rays.emplace_back();
+    }
+
+    entry = &cache.rays[cache.size++];
+  }
+
+  entry->dir = d;
+  entry->distance = distance;
+  entry->results.assignResults(results, distance);
+
+  auto& dependencies = entry->dependencies;
+  dependencies.clear();
+  dependencies.push_back(cache.zone->entityId());
+
+  auto depend = [&dependencies](entityId_t id) {
+    if (!contains(dependencies, id)) {
+      dependencies.push_back(id);
+    }
+  };
+
+  for (const Intersection& X : entry->results.results()) {
+    depend(X.entityId);
+    depend(X.zoneA);
+    depend(X.zoneB);
+  }
+}
+
+//===========================================
+// SpatialSystem::forgetCachedRays
+//
+// Drops the cached rays that passed through or hit the given entity
+//===========================================
+void SpatialSystem::forgetCachedRays(entityId_t id) {
+  RayCache& cache = m_rayCache;
+
+  for (size_t i = 0; i < cache.size;) {
+    if (contains(cache.rays[i].dependencies, id)) {
+      // Swap rather than assign, so the entries keep their storage
+      std::swap(cache.rays[i], cache.rays[--cache.size]);
     }
     else {
-      excluded.push_back(std::move(intersections.front()));
-      intersections.erase(intersections.begin());
+      ++i;
+    }
+  }
+}
+
+//===========================================
+// SpatialSystem::clearRayCache
+//===========================================
+void SpatialSystem::clearRayCache() {
+  m_rayCache.size = 0;
+}
+
+//===========================================
+// SpatialSystem::markChanged
+//
+// Also drops any cached rays that depend on what changed. A moved vRect or hRect may now be seen
+// from columns that didn't see it before, so its zone is marked too. Wall decals are drawn as
+// part of their wall, so that's marked instead.
+//===========================================
+void SpatialSystem::markChanged(const CSpatial& c) {
+  auto mark = [this](entityId_t id) {
+    m_changed.insert(id);
+    forgetCachedRays(id);
+  };
+
+  mark(c.entityId());
+
+  if (c.kind == CSpatialKind::V_RECT) {
+    const CVRect& vRect = DYNAMIC_CAST<const CVRect&>(c);
+    auto it = m_components.find(c.parentId);
+
+    if (it != m_components.end() && it->second->kind != CSpatialKind::ZONE) {
+      mark(c.parentId);
+    }
+    else if (vRect.zone != nullptr) {
+      mark(vRect.zone->entityId());
     }
   }
+  else if (c.kind == CSpatialKind::H_RECT) {
+    mark(c.parentId);
+  }
+}
+
+//===========================================
+// SpatialSystem::entitiesAlongRay
+//
+// Results are ordered by distance, following the chain of zones the ray passes through, and end
+// at the first hard edge
+//===========================================
+IntersectionSpan SpatialSystem::entitiesAlongRay(const CZone& zone, const Point& pos,
+  const Vec2f& dir, const Matrix& matrix, IntersectionBuffer& buffer, double distance) const {
 
-  if (excluded.size() > 0) {
-    // TODO: Find out why this happens
-    //DBG_PRINT("Warning: Bad intersections omitted\n");
+  IntersectionBuffer* pBuffer = &buffer;
+  castRays(zone, pos, &dir, &pBuffer, 1, matrix, buffer.m_rayScratch, distance);
+
+  return buffer.results();
+}
+
+//===========================================
+// SpatialSystem::entitiesAlongRays
+//
+// Casts a batch of rays sharing an origin and transform, walking the zone graph once for all of
+// them. The results for dirs[i] are written to buffers[i], ordered as for entitiesAlongRay.
+//===========================================
+void SpatialSystem::entitiesAlongRays(const CZone& zone, const Point& pos,
+  const vector<Vec2f>& dirs, const Matrix& matrix, const vector<IntersectionBuffer*>& buffers,
+  RayScratch& scratch, double distance) const {
+
+  if (buffers.size() != dirs.size()) {
+    EXCEPTION("Error casting rays; Expected one buffer per ray");
   }
 
-  auto it = find_if(Xs.begin(), Xs.end(), [](const pIntersection_t& i) {
-    return i->kind == CSpatialKind::HARD_EDGE;
-  });
+  castRays(zone, pos, dirs.data(), buffers.data(), dirs.size(), matrix, scratch, distance);
+}
+
+//===========================================
+// SpatialSystem::castRays
+//===========================================
+void SpatialSystem::castRays(const CZone& zone, const Point& pos, const Vec2f* dirs,
+  IntersectionBuffer* const* buffers, size_t n, const Matrix& matrix, RayScratch& scratch,
+  double distance) const {
+
+  scratch.m_rays.resize(n);
+  scratch.m_active.clear();
+  scratch.m_saved.clear();
+  scratch.m_numVisited = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    buffers[i]->clear();
 
-  if (it != Xs.end()) {
-    Xs.erase(++it, Xs.end());
+    RayScratch::RayState& ray = scratch.m_rays[i];
+    ray.lseg = LineSegment(pos + Vec2f(0.01, 0), 10000.0 * dirs[i]);
+    ray.buffer = buffers[i];
+    ray.visited = scratch.pushVisited();
+    ray.cullNearerThan = 0;
+    ray.cullFartherThan = distance;
+
+    scratch.m_active.push_back(RayScratch::ActiveRay{static_cast<int>(i), Point()});
+  }
+
+  if (n > 0) {
+    findIntersections_r(pos, matrix, zone, zone, scratch, 0, n);
   }
 
-  return Xs;
+  for (size_t i = 0; i < n; ++i) {
+    buffers[i]->orderByZoneChain(zone.entityId());
+  }
 }
 
 //===========================================
 // SpatialSystem::entitiesAlong3dRay
 //===========================================
-vector<pIntersection_t> SpatialSystem::entitiesAlong3dRay(const CZone& zone, const Point& pos,
-  double height, const Vec2f& dir, double vAngle, const Matrix& matrix, double distance) const {
+IntersectionSpan SpatialSystem::entitiesAlong3dRay(const CZone& zone, const Point& pos,
+  double height, const Vec2f& dir, double vAngle, const Matrix& matrix,
+  IntersectionBuffer& buffer, double distance) const {
+
+  entitiesAlongRay(zone, pos, dir, matrix, buffer, distance);
+  return retainAtHeight(buffer, height, vAngle);
+}
 
-  vector<pIntersection_t> intersections = entitiesAlongRay(zone, pos, dir, matrix, distance);
+//===========================================
+// SpatialSystem::retainAtHeight
+//
+// Drops the results the ray passes above or below, given its height at the origin and vertical
+// angle
+//===========================================
+IntersectionSpan SpatialSystem::retainAtHeight(IntersectionBuffer& buffer, double height,
+  double vAngle) {
 
-  for (auto it = intersections.begin(); it != intersections.end();) {
-    Intersection& X = **it;
+  double tanVAngle = tan(vAngle);
 
-    double y = height + X.distanceFromOrigin * tan(vAngle);
+  buffer.retainResults([height, tanVAngle](Intersection& X) {
+    double y = height + X.distanceFromOrigin * tanVAngle;
 
     if (!isBetween(y, X.heightRanges.first.a, X.heightRanges.first.b)
       && !isBetween(y, X.heightRanges.second.a, X.heightRanges.second.b)) {
 
-      it = intersections.erase(it);
-    }
-    else {
-      X.height = y - X.heightRanges.first.a;
-      ++it;
+      return false;
     }
-  }
 
-  return intersections;
+    X.height = y - X.heightRanges.first.a;
+    return true;
+  });
+
+  return buffer.results();
 }
 
 //===========================================
 // SpatialSystem::entitiesAlong3dRay
 //===========================================
-vector<pIntersection_t> SpatialSystem::entitiesAlong3dRay(const Vec2f& ray, double camSpaceVAngle,
-  double distance) const {
+IntersectionSpan SpatialSystem::entitiesAlong3dRay(const Vec2f& ray, double camSpaceVAngle,
+  IntersectionBuffer& buffer, double distance) const {
 
   const Camera& camera = sg.player->camera();
-  double height = camera.height;
-  double vAngle = camSpaceVAngle + camera.vAngle;
-  Matrix matrix = camera.matrix().inverse();
 
-  vector<pIntersection_t> intersections = entitiesAlong3dRay(getCurrentZone(), Point(0, 0), height,
-    ray, vAngle, matrix, distance);
+  entitiesAlongRay(ray, buffer, distance);
+  return retainAtHeight(buffer, camera.height, camSpaceVAngle + camera.vAngle);
+}
+
+//===========================================
+// SpatialSystem::ZoneBounds::include
+//===========================================
+void SpatialSystem::ZoneBounds::include(const Point& p) {
+  min.x = smallest(min.x, p.x);
+  min.y = smallest(min.y, p.y);
+  max.x = largest(max.x, p.x);
+  max.y = largest(max.y, p.y);
+}
+
+//===========================================
+// SpatialSystem::ZoneBounds::include
+//===========================================
+void SpatialSystem::ZoneBounds::include(const ZoneBounds& b) {
+  include(b.min);
+  include(b.max);
+}
+
+//===========================================
+// SpatialSystem::ZoneBounds::overlaps
+//===========================================
+bool SpatialSystem::ZoneBounds::overlaps(const Circle& circle) const {
+  return circle.pos.x + circle.radius >= min.x && circle.pos.x - circle.radius <= max.x
+    && circle.pos.y + circle.radius >= min.y && circle.pos.y - circle.radius <= max.y;
+}
+
+//===========================================
+// SpatialSystem::rebuildBounds_r
+//===========================================
+const SpatialSystem::ZoneBounds& SpatialSystem::rebuildBounds_r(const CZone& zone) const {
+  ZoneBounds bounds;
+
+  for (auto& edge : zone.edges) {
+    bounds.include(edge->lseg.A);
+    bounds.include(edge->lseg.B);
+  }
+
+  for (auto& vRect : zone.vRects) {
+    bounds.include(vRect->pos);
+  }
+
+  for (auto& child : zone.children) {
+    bounds.include(rebuildBounds_r(*child));
+  }
+
+  ZoneBounds& entry = m_zoneBounds[zone.entityId()];
+  entry = bounds;
+
+  return entry;
+}
+
+//===========================================
+// SpatialSystem::growBounds
+//
+// Called when a vRect moves, so the boxes of its zone and the zone's ancestors still contain it
+//===========================================
+void SpatialSystem::growBounds(const CZone& zone, const Point& p) {
+  if (m_zoneBoundsDirty) {
+    return;
+  }
 
-  return intersections;
+  for (const CZone* z = &zone; z != nullptr; z = z->parent) {
+    m_zoneBounds[z->entityId()].include(p);
+  }
 }
 
 //===========================================
-// entitiesInRadius_r
+// SpatialSystem::entitiesInRadius_r
+//
+// Entities may appear more than once in hits
 //===========================================
-static void entitiesInRadius_r(const CZone& searchZone, const CZone& zone, const Circle& circle,
-  double heightAboveFloor, set<entityId_t>& entities) {
+void SpatialSystem::entitiesInRadius_r(const CZone& searchZone, const CZone& zone,
+  const Circle& circle, double heightAboveFloor, vector<RadiusHit>& hits) const {
 
   const double MAX_VERTICAL_DISTANCE = 40.0;
 
+  auto bt = m_zoneBounds.find(searchZone.entityId());
+  if (bt != m_zoneBounds.end() && !bt->second.overlaps(circle)) {
+    return;
+  }
+
   for (auto it = searchZone.edges.begin(); it != searchZone.edges.end(); ++it) {
     const CEdge& edge = **it;
 
     if (overlapsCircle(circle, edge)) {
-      entities.insert(edge.entityId());
-      entities.insert(searchZone.entityId());
+      double d = distance(circle.pos, clipToLineSegment(circle.pos, edge.lseg));
+
+      hits.push_back(RadiusHit{edge.entityId(), d});
+      hits.push_back(RadiusHit{searchZone.entityId(), d});
 
       if (edge.kind == CSpatialKind::HARD_EDGE || edge.kind == CSpatialKind::SOFT_EDGE) {
         for (auto jt = edge.vRects.begin(); jt != edge.vRects.end(); ++jt) {
@@ -1333,7 +1856,9 @@ static void entitiesInRadius_r(const CZone& searchZone, const CZone& zone, const
             double y2 = vRectFloorH + vRect.pos.y + 0.5 * vRect.size.y;
 
             if (fabs(y1 - y2) <= MAX_VERTICAL_DISTANCE) {
-              entities.insert(vRect.entityId());
+              Vec2f v = normalise(edge.lseg.B - edge.lseg.A);
+              hits.push_back(RadiusHit{vRect.entityId(),
+                distance(circle.pos, edge.lseg.A + v * vRect.pos.x)});
             }
           }
         }
@@ -1351,20 +1876,53 @@ static void entitiesInRadius_r(const CZone& searchZone, const CZone& zone, const
       double y2 = vRect.zone->floorHeight + vRect.y + 0.5 * vRect.size.y;
 
       if (fabs(y1 - y2) <= MAX_VERTICAL_DISTANCE) {
-        entities.insert(vRect.entityId());
+        hits.push_back(RadiusHit{vRect.entityId(), distance(circle.pos, vRect.pos)});
       }
     }
   }
 
   for (auto it = searchZone.hRects.begin(); it != searchZone.hRects.end(); ++it) {
     if (overlapsCircle(circle, **it)) {
-      entities.insert((*it)->entityId());
+      const Matrix& m = (*it)->transform;
+      hits.push_back(RadiusHit{(*it)->entityId(), distance(circle.pos, Point(m.tx(), m.ty()))});
     }
   }
 
   for (auto it = searchZone.children.begin(); it != searchZone.children.end(); ++it) {
-    entitiesInRadius_r(**it, zone, circle, heightAboveFloor, entities);
+    entitiesInRadius_r(**it, zone, circle, heightAboveFloor, hits);
+  }
+}
+
+//===========================================
+// SpatialSystem::entitiesInRadius
+//
+// Fills hits with the entities within radius of pos, each with its distance from pos, ordered by
+// entity ID. The search covers the zone's nearby ancestors and all their descendants, skipping
+// subtrees whose bounding boxes don't overlap the circle.
+//===========================================
+void SpatialSystem::entitiesInRadius(const CZone& zone, const Point& pos, double radius,
+  double heightAboveFloor, vector<RadiusHit>& hits) const {
+
+  if (m_zoneBoundsDirty) {
+    m_zoneBounds.clear();
+    rebuildBounds_r(*sg.rootZone);
+    m_zoneBoundsDirty = false;
   }
+
+  hits.clear();
+  Circle circle{pos, radius};
+
+  entitiesInRadius_r(nthConstAncestor(zone, MAX_ANCESTOR_SEARCH), zone, circle, heightAboveFloor,
+    hits);
+
+  // Keep the nearest hit for each entity
+  std::sort(hits.begin(), hits.end(), [](const RadiusHit& a, const RadiusHit& b) {
+    return a.entityId < b.entityId || (a.entityId == b.entityId && a.distance < b.distance);
+  });
+
+  hits.erase(std::unique(hits.begin(), hits.end(), [](const RadiusHit& a, const RadiusHit& b) {
+    return a.entityId == b.entityId;
+  }), hits.end());
 }
 
 //===========================================
@@ -1373,11 +1931,13 @@ static void entitiesInRadius_r(const CZone& searchZone, const CZone& zone, const
 set<entityId_t> SpatialSystem::entitiesInRadius(const CZone& zone, const Point& pos, double radius,
   double heightAboveFloor) const {
 
-  set<entityId_t> entities;
-  Circle circle{pos, radius};
+  vector<RadiusHit> hits;
+  entitiesInRadius(zone, pos, radius, heightAboveFloor, hits);
 
-  entitiesInRadius_r(nthConstAncestor(getCurrentZone(), MAX_ANCESTOR_SEARCH), zone, circle,
-    heightAboveFloor, entities);
+  set<entityId_t> entities;
+  for (auto& hit : hits) {
+    entities.insert(entities.end(), hit.entityId);
+  }
 
   return entities;
 }
@@ -1405,6 +1965,9 @@ void SpatialSystem::addComponent(pComponent_t component) {
     EXCEPTION("Component is not of kind C_SPATIAL");
   }
 
+  clearRayCache();
+  m_zoneBoundsDirty = true;
+
   CSpatial* ptr = DYNAMIC_CAST<CSpatial*>(component.release());
   pCSpatial_t c(ptr);
 
@@ -1436,6 +1999,8 @@ void SpatialSystem::addComponent(pComponent_t component) {
 
   m_entityChildren[ptr->entityId()];
   m_components.insert(make_pair(ptr->entityId(), ptr));
+
+  markChanged(*ptr);
 }
 
 //===========================================
@@ -1501,7 +2066,11 @@ void SpatialSystem::removeEntity(entityId_t id) {
     return;
   }
 
+  clearRayCache();
+
   CSpatial& c = *it->second;
+  markChanged(c);
+
   auto jt = m_components.find(c.parentId);
 
   if (jt != m_components.end()) {
@@ -1510,4 +2079,5 @@ void SpatialSystem::removeEntity(entityId_t id) {
   }
 
   removeEntity_r(id);
+  m_detached.erase(id);
 }
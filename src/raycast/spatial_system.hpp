@@ -11,34 +11,13 @@
 #include <QImage>
 #include "raycast/scene_graph.hpp"
 #include "raycast/system.hpp"
+#include "raycast/intersection.hpp"
 
 
 namespace tinyxml2 { class XMLElement; }
 namespace parser { struct Object; }
 
 
-struct Intersection {
-  Intersection(CSpatialKind kind, CSpatialKind parentKind)
-    : kind(kind),
-      parentKind(parentKind) {}
-
-  CSpatialKind kind;
-  CSpatialKind parentKind;
-  entityId_t entityId;
-  Point point_rel;
-  Point point_wld;
-  Point viewPoint;
-  double distanceFromOrigin;
-  double distanceAlongTarget;
-  entityId_t zoneB;
-  entityId_t zoneA;
-
-  double height = 0;
-  std::pair<Range, Range> heightRanges;
-};
-
-typedef std::unique_ptr<Intersection> pIntersection_t;
-
 struct EChangedZone : public GameEvent {
   EChangedZone(entityId_t entityId, entityId_t oldZone, entityId_t newZone,
     const std::set<entityId_t>& zonesLeft, const std::set<entityId_t>& zonesEntered)
@@ -77,6 +56,20 @@ struct EPlayerActivateEntity : public GameEvent {
 class EntityManager;
 class TimeService;
 
+struct RadiusHit {
+  entityId_t entityId;
+  double distance;
+};
+
+struct RayCacheStats {
+  unsigned long hits = 0;
+  unsigned long misses = 0;
+
+  double hitRate() const {
+    return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0;
+  }
+};
+
 class SpatialSystem : public System {
   public:
     SpatialSystem(EntityManager& entityManager, TimeService& timeService, double frameRate);
@@ -95,19 +88,42 @@ class SpatialSystem : public System {
 
     void moveEntity(entityId_t id, Vec2f dv, double heightAboveFloor = 0);
     void relocateEntity(entityId_t id, CZone& zone, const Point& point);
+    void detachEntity(entityId_t id);
+    void attachEntity(entityId_t id, CZone& zone, const Point& point);
+    // Change the body in place, within its current zone, and record the change
+    void setPosition(CVRect& body, const Point& pos);
+    void setAngle(CVRect& body, double angle);
 
     std::set<entityId_t> entitiesInRadius(const CZone& zone, const Point& pos, double radius,
       double heightAboveFloor = 0.0) const;
+    void entitiesInRadius(const CZone& zone, const Point& pos, double radius,
+      double heightAboveFloor, std::vector<RadiusHit>& hits) const;
 
-    std::vector<pIntersection_t> entitiesAlongRay(const CZone& zone, const Point& pos,
-      const Vec2f& dir, const Matrix& matrix, double distance = 10000) const;
-    std::vector<pIntersection_t> entitiesAlongRay(const Vec2f& dir, double distance = 10000) const;
+    IntersectionSpan entitiesAlongRay(const CZone& zone, const Point& pos, const Vec2f& dir,
+      const Matrix& matrix, IntersectionBuffer& buffer, double distance = 10000) const;
+    IntersectionSpan entitiesAlongRay(const Vec2f& dir, IntersectionBuffer& buffer,
+      double distance = 10000) const;
+    void entitiesAlongRays(const CZone& zone, const Point& pos, const std::vector<Vec2f>& dirs,
+      const Matrix& matrix, const std::vector<IntersectionBuffer*>& buffers, RayScratch& scratch,
+      double distance = 10000) const;
 
-    std::vector<pIntersection_t> entitiesAlong3dRay(const CZone& zone, const Point& pos,
-      double height, const Vec2f& dir, double vAngle, const Matrix& matrix,
+    IntersectionSpan entitiesAlong3dRay(const CZone& zone, const Point& pos, double height,
+      const Vec2f& dir, double vAngle, const Matrix& matrix, IntersectionBuffer& buffer,
       double distance = 10000) const;
-    std::vector<pIntersection_t> entitiesAlong3dRay(const Vec2f& dir, double camSpaceVAngle,
+    IntersectionSpan entitiesAlong3dRay(const Vec2f& dir, double camSpaceVAngle,
+      IntersectionBuffer& buffer, double distance = 10000) const;
+
+    // Not safe to call from the renderer's worker threads; see CachedRay
+    void cacheCameraRay(const Vec2f& dir, const IntersectionBuffer& results,
       double distance = 10000) const;
+    inline const RayCacheStats& rayCacheStats() const;
+
+    // Entities added, removed or changed since the renderer last looked. Changes made through the
+    // spatial system are recorded automatically; anything else, e.g. doors moving, must call
+    // markChanged.
+    void markChanged(const CSpatial& c);
+    inline const std::set<entityId_t>& changedEntities() const;
+    inline void clearChanges();
 
     std::set<entityId_t> getAncestors(entityId_t entityId) const;
 
@@ -125,16 +141,71 @@ class SpatialSystem : public System {
       return *GET_VALUE(m_components, entityId);
     }
 
+  protected:
+    // Pairs each soft edge under zone with its twin. Virtual so tests can check it against a
+    // simpler search.
+    virtual void connectSubzones(CZone& zone);
+    bool areTwins(const CSoftEdge& se1, const CSoftEdge& se2) const;
+
   private:
     bool isRoot(const CSpatial& c) const;
     void removeEntity_r(entityId_t id);
     void crossZones(entityId_t entityId, entityId_t oldZone, entityId_t newZone);
-    void connectSubzones(CZone& zone);
-    bool areTwins(const CSoftEdge& se1, const CSoftEdge& se2) const;
     bool isAncestor(entityId_t a, entityId_t b) const;
-    void findIntersections_r(const Point& point, const Vec2f& dir, const Matrix& matrix,
-      const CZone& zone, const CSpatial& parent, std::vector<pIntersection_t>& intersections,
-      std::vector<entityId_t>& visited, double cullNearerThan, double& cullFartherThan) const;
+
+    // Camera-space rays cast since the camera last moved. The renderer offers its centre column,
+    // which is the ray gameplay systems most often cast (e.g. for focus and shooting).
+    //
+    // Each ray is dropped when anything it depends on is marked as changed, so a door opening on
+    // the other side of the map doesn't empty the cache. Like the rest of the system, the cache
+    // is only touched by the thread that owns the entity manager, which is the render thread while
+    // a frame is drawn. The renderer's worker threads never touch it.
+    struct CachedRay {
+      Vec2f dir;
+      double distance;
+      IntersectionBuffer results;
+      // The zones the ray passed through and the entities it hit
+      std::vector<entityId_t> dependencies;
+    };
+
+    struct RayCache {
+      const CZone* zone = nullptr;
+      double x = 0;
+      double y = 0;
+      double angle = 0;
+      std::vector<CachedRay> rays;
+      size_t size = 0;
+    };
+
+    // Bounding box of a zone's edges and vRects, including those of its descendants, so radius
+    // queries can skip whole subtrees. Boxes only grow as entities move, and are rebuilt when
+    // entities are added or removed.
+    struct ZoneBounds {
+      Point min = Point(1e10, 1e10);
+      Point max = Point(-1e10, -1e10);
+
+      void include(const Point& p);
+      void include(const ZoneBounds& b);
+      bool overlaps(const Circle& circle) const;
+    };
+
+    const ZoneBounds& rebuildBounds_r(const CZone& zone) const;
+    void growBounds(const CZone& zone, const Point& p);
+    void entitiesInRadius_r(const CZone& searchZone, const CZone& zone, const Circle& circle,
+      double heightAboveFloor, std::vector<RadiusHit>& hits) const;
+
+    void syncRayCache() const;
+    const CachedRay* findCachedRay(const Vec2f& dir, double distance) const;
+    void forgetCachedRays(entityId_t id);
+    void clearRayCache();
+    static IntersectionSpan retainAtHeight(IntersectionBuffer& buffer, double height,
+      double vAngle);
+
+    void castRays(const CZone& zone, const Point& pos, const Vec2f* dirs,
+      IntersectionBuffer* const* buffers, size_t n, const Matrix& matrix, RayScratch& scratch,
+      double distance) const;
+    void findIntersections_r(const Point& point, const Matrix& matrix, const CZone& zone,
+      const CSpatial& parent, RayScratch& scratch, size_t first, size_t last) const;
     void addChildToComponent(CSpatial& parent, pCSpatial_t child);
     bool removeChildFromComponent(CSpatial& parent, const CSpatial& child, bool keepAlive = false);
 
@@ -152,10 +223,44 @@ class SpatialSystem : public System {
 
     std::map<entityId_t, CSpatial*> m_components;
     std::map<entityId_t, std::set<CSpatial*>> m_entityChildren;
+    // Components taken out of the scene graph by detachEntity()
+    std::map<entityId_t, pCSpatial_t> m_detached;
 
     Vec2i m_playerCell;
+
+    mutable std::map<entityId_t, ZoneBounds> m_zoneBounds;
+    mutable bool m_zoneBoundsDirty = true;
+
+    std::set<entityId_t> m_changed;
+
+    // For the player_activate event
+    IntersectionBuffer m_rayBuffer;
+
+    mutable RayCache m_rayCache;
+    mutable RayCacheStats m_rayCacheStats;
 };
 
+//===========================================
+// SpatialSystem::rayCacheStats
+//===========================================
+inline const RayCacheStats& SpatialSystem::rayCacheStats() const {
+  return m_rayCacheStats;
+}
+
+//===========================================
+// SpatialSystem::changedEntities
+//===========================================
+inline const std::set<entityId_t>& SpatialSystem::changedEntities() const {
+  return m_changed;
+}
+
+//===========================================
+// SpatialSystem::clearChanges
+//===========================================
+inline void SpatialSystem::clearChanges() {
+  m_changed.clear();
+}
+
 std::ostream& operator<<(std::ostream& os, CSpatialKind kind);
 
 
@@ -10,46 +10,126 @@
 
 
 //===========================================
-// SpawnSystem::handleEvent
+// SpawnSystem::reconstruct_
 //===========================================
-void SpawnSystem::handleEvent(const GameEvent& event) {
-  if (event.name == "entity_destroyed") {
-    const EEntityDestroyed& e = dynamic_cast<const EEntityDestroyed&>(event);
+void SpawnSystem::reconstruct_(std::shared_ptr<CSpawnable> spawnable) {
+  entityId_t entityId = makeIdForObj(*spawnable->object);
 
-    auto it = m_spawnables.find(e.entityId);
+  m_rootFactory.constructObject(spawnable->typeName, entityId, *spawnable->object,
+    spawnable->parentId, spawnable->parentTransform);
 
-    if (it != m_spawnables.end()) {
-      std::shared_ptr<CSpawnable> spawnable(it->second.release());
+  SpatialSystem& spatialSystem = m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
 
-      m_timeService.onTimeout([this, spawnable]() {
-        entityId_t entityId = makeIdForObj(*spawnable->object);
+  const CSpatial& spatial = spatialSystem.getComponent(entityId);
 
-        m_rootFactory.constructObject(spawnable->typeName, entityId, *spawnable->object,
-          spawnable->parentId, spawnable->parentTransform);
+  // Only deal with V_RECTs for now
+  if (spatial.kind == CSpatialKind::V_RECT) {
+    const CVRect& vRect = dynamic_cast<const CVRect&>(spatial);
 
-        SpatialSystem& spatialSystem =
-          m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
+    CVRect& spawnPointVRect = m_entityManager.getComponent<CVRect>(spawnable->spawnPoint,
+      ComponentKind::C_SPATIAL);
 
-        const CSpatial& spatial = spatialSystem.getComponent(entityId);
+    Point oldPos = vRect.pos;
+    spatialSystem.relocateEntity(entityId, *spawnPointVRect.zone, spawnPointVRect.pos);
 
-        // Only deal with V_RECTs for now
-        if (spatial.kind == CSpatialKind::V_RECT) {
-          const CVRect& vRect = dynamic_cast<const CVRect&>(spatial);
+    AgentSystem& agentSystem = m_entityManager.system<AgentSystem>(ComponentKind::C_AGENT);
+
+    if (agentSystem.hasComponent(entityId)) {
+      agentSystem.navigateTo(entityId, oldPos);
+    }
+  }
+}
+
+//===========================================
+// SpawnSystem::respawn_
+//
+// Brings a parked entity back at its spawn point with its components reset, without
+// constructing anything
+//===========================================
+void SpawnSystem::respawn_(entityId_t entityId) {
+  auto it = m_spawnables.find(entityId);
+  if (it == m_spawnables.end()) {
+    // Deleted while parked
+    return;
+  }
+
+  CSpawnable& spawnable = *it->second;
+
+  SpatialSystem& spatialSystem = m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
+  DamageSystem& damageSystem = m_entityManager.system<DamageSystem>(ComponentKind::C_DAMAGE);
+  AgentSystem& agentSystem = m_entityManager.system<AgentSystem>(ComponentKind::C_AGENT);
+
+  CVRect& spawnPointVRect = m_entityManager.getComponent<CVRect>(spawnable.spawnPoint,
+    ComponentKind::C_SPATIAL);
+
+  // The delay may be shorter than the death animation
+  spatialSystem.detachEntity(entityId);
+  spatialSystem.attachEntity(entityId, *spawnPointVRect.zone, spawnPointVRect.pos);
+
+  if (damageSystem.hasComponent(entityId)) {
+    CDamage& damage = damageSystem.getComponent(entityId);
+    damage.health = damage.maxHealth;
+  }
+
+  spawnable.dead = false;
+  spawnable.recycle();
+
+  if (agentSystem.hasComponent(entityId)) {
+    agentSystem.setActive(entityId, true);
+    agentSystem.navigateTo(entityId, spawnable.origin);
+  }
+}
+
+//===========================================
+// SpawnSystem::despawn
+//
+// Call when a dead entity would otherwise be deleted. Returns false if the entity isn't pooled,
+// in which case the caller should delete it as normal.
+//===========================================
+bool SpawnSystem::despawn(entityId_t entityId) {
+  auto it = m_spawnables.find(entityId);
+  if (it == m_spawnables.end() || !it->second->recycle) {
+    return false;
+  }
+
+  // If it has already respawned there's nothing to do
+  if (it->second->dead) {
+    m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL).detachEntity(entityId);
+  }
+
+  return true;
+}
+
+//===========================================
+// SpawnSystem::handleEvent
+//===========================================
+void SpawnSystem::handleEvent(const GameEvent& event) {
+  if (event.name == "entity_destroyed") {
+    const EEntityDestroyed& e = dynamic_cast<const EEntityDestroyed&>(event);
 
-          CVRect& spawnPointVRect = m_entityManager.getComponent<CVRect>(spawnable->spawnPoint,
-            ComponentKind::C_SPATIAL);
+    auto it = m_spawnables.find(e.entityId);
 
-          Point oldPos = vRect.pos;
-          spatialSystem.relocateEntity(entityId, *spawnPointVRect.zone, spawnPointVRect.pos);
+    if (it != m_spawnables.end()) {
+      CSpawnable& spawnable = *it->second;
 
-          AgentSystem& agentSystem =
-            m_entityManager.system<AgentSystem>(ComponentKind::C_AGENT);
+      if (spawnable.recycle) {
+        if (!spawnable.dead) {
+          spawnable.dead = true;
 
-          if (agentSystem.hasComponent(entityId)) {
-            agentSystem.navigateTo(entityId, oldPos);
-          }
+          entityId_t entityId = e.entityId;
+          m_timeService.onTimeout([this, entityId]() {
+            respawn_(entityId);
+          }, spawnable.delay);
         }
-      }, spawnable->delay);
+      }
+      else {
+        std::shared_ptr<CSpawnable> pSpawnable(it->second.release());
+        m_spawnables.erase(it);
+
+        m_timeService.onTimeout([this, pSpawnable]() {
+          reconstruct_(pSpawnable);
+        }, pSpawnable->delay);
+      }
     }
   }
 }
@@ -69,6 +149,18 @@ void SpawnSystem::addComponent(pComponent_t component) {
     }
     case CSpawnKind::SPAWNABLE: {
       pCSpawnable_t c(dynamic_cast<CSpawnable*>(component.release()));
+
+      SpatialSystem& spatialSystem =
+        m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
+
+      if (spatialSystem.hasComponent(c->entityId())) {
+        const CSpatial& spatial = spatialSystem.getComponent(c->entityId());
+
+        if (spatial.kind == CSpatialKind::V_RECT) {
+          c->origin = dynamic_cast<const CVRect&>(spatial).pos;
+        }
+      }
+
       m_spawnables.insert(make_pair(c->entityId(), std::move(c)));
 
       break;
@@ -4,6 +4,7 @@
 
 #include <memory>
 #include <map>
+#include <functional>
 #include "raycast/system.hpp"
 #include "raycast/component.hpp"
 #include "raycast/map_parser.hpp"
@@ -38,6 +39,15 @@ struct CSpawnable : public CSpawn {
   entityId_t parentId;
   Matrix parentTransform;
   double delay = 5;
+
+  // If set, the entity is parked when it dies and recycled when it respawns, rather than being
+  // deleted and reconstructed from the object. Should restore any type-specific state, such as
+  // the current animation.
+  std::function<void()> recycle;
+
+  // Where the entity was first placed, and where it returns to after respawning
+  Point origin;
+  bool dead = false;
 };
 
 struct CSpawnPoint : public CSpawn {
@@ -69,7 +79,12 @@ class SpawnSystem : public System {
     CSpawn& getComponent(entityId_t entityId) const override;
     void removeEntity(entityId_t id) override;
 
+    bool despawn(entityId_t entityId);
+
   private:
+    void respawn_(entityId_t entityId);
+    void reconstruct_(std::shared_ptr<CSpawnable> spawnable);
+
     EntityManager& m_entityManager;
     RootFactory& m_rootFactory;
     TimeService& m_timeService;
@@ -121,7 +121,7 @@ void SpriteFactory::onCivilianDamage(entityId_t entityId) {
 
   if (damage.health == 0) {
     m_audioService.playSoundAtPos("civilian_death", vRect.pos);
-    auto& bucket = dynamic_cast<ItemBucket&>(*inventory.buckets["item"]);
+    auto& bucket = dynamic_cast<ItemBucket&>(*inventory.getBucket("item"));
 
     for (auto it = bucket.items.begin(); it != bucket.items.end(); ++it) {
       entityId_t itemId = it->second;
@@ -203,7 +203,7 @@ void SpriteFactory::setupCivilianInventory(entityId_t entityId, const parser::Ob
   const Matrix& parentTransform) {
 
   CCollector* inventory = new CCollector(entityId);
-  inventory->buckets["item"] = pBucket_t(new ItemBucket(1));
+  inventory->addBucket("item", pBucket_t(new ItemBucket(1)));
   inventorySys().addComponent(pComponent_t(inventory));
 
   for (auto it = obj.children.begin(); it != obj.children.end(); ++it) {
@@ -225,7 +225,7 @@ void SpriteFactory::setupCivilianInventory(entityId_t entityId, const parser::Ob
 // SpriteFactory::setupCivilianAgent
 //===========================================
 void SpriteFactory::setupCivilianAgent(entityId_t entityId, const parser::Object& obj) {
-  CAgent* agent = new CAgent(entityId, m_entityManager);
+  CAgent* agent = new CAgent(entityId, m_entityManager, m_timeService);
   agent->stPatrollingTrigger = getValue(obj.dict, "st_patrolling_trigger", "");
   agent->isHostile = false;
 
@@ -325,6 +325,10 @@ void SpriteFactory::setupBadGuySpawning(entityId_t entityId, const parser::Objec
       spawnable->delay = std::stod(delay);
     }
 
+    spawnable->recycle = [this, entityId]() {
+      animationSys().playAnimation(entityId, "idle", true);
+    };
+
     spawnSys().addComponent(pComponent_t(spawnable));
   }
 }
@@ -349,7 +353,7 @@ void SpriteFactory::onBadGuyDamage(entityId_t entityId) {
 
   if (damage.health == 0) {
     m_audioService.playSoundAtPos("monster_death", vRect.pos);
-    agentSys().removeEntity(entityId);
+    agentSys().setActive(entityId, false);
     animationSys().playAnimation(entityId, "death", false);
   }
   else {
@@ -369,7 +373,7 @@ void SpriteFactory::setupBadGuyEvents(entityId_t entityId) {
     [this, entityId](const GameEvent& e_) {
 
     auto& e = dynamic_cast<const EAnimationFinished&>(e_);
-    if (e.animName == "death") {
+    if (e.animName == "death" && !spawnSys().despawn(entityId)) {
       m_entityManager.deleteEntity(entityId);
     }
   }});
@@ -380,7 +384,7 @@ void SpriteFactory::setupBadGuyEvents(entityId_t entityId) {
 // SpriteFactory::setupBadGuyAgent
 //===========================================
 void SpriteFactory::setupBadGuyAgent(entityId_t entityId, const parser::Object& obj) {
-  CAgent* agent = new CAgent(entityId, m_entityManager);
+  CAgent* agent = new CAgent(entityId, m_entityManager, m_timeService);
 
   agent->isHostile = true;
   agent->stPatrollingTrigger = getValue(obj.dict, "st_patrolling_trigger", "");
@@ -8,6 +8,7 @@ using std::function;
 
 
 static long nextId = 0;
+static long nextTweenId = 0;
 
 
 //===========================================
@@ -23,7 +24,7 @@ double TimeService::now() const {
 void TimeService::addTween(const Tween& tween, string name) {
   if (name.empty()) {
     stringstream ss;
-    ss << "tween" << rand();
+    ss << "tween" << nextTweenId++;
     name = ss.str();
   }
 
@@ -1,38 +1,24 @@
-#include <chrono>
 #include "raycast/timing.hpp"
+#include "raycast/time_service.hpp"
 #include "utils.hpp"
 
 
-namespace chrono = std::chrono;
 using std::function;
 
 
-//===========================================
-// getTime
-//===========================================
-inline static unsigned long getTime() {
-  return chrono::high_resolution_clock::now().time_since_epoch() / chrono::milliseconds(1);
-}
-
-//===========================================
-// now
-//===========================================
-inline static double now() {
-  return 0.001 * getTime();
-}
-
 //===========================================
 // Debouncer::Debouncer
 //===========================================
-Debouncer::Debouncer(double seconds)
-  : m_duration(seconds),
-    m_start(now()) {}
+Debouncer::Debouncer(const TimeService& timeService, double seconds)
+  : m_timeService(&timeService),
+    m_duration(seconds),
+    m_start(timeService.now()) {}
 
 //===========================================
 // Debouncer::ready
 //===========================================
 bool Debouncer::ready() {
-  double t = now();
+  double t = m_timeService->now();
   if (t - m_start >= m_duration) {
     m_start = t;
     return true;
@@ -44,13 +30,18 @@ bool Debouncer::ready() {
 // Debouncer::reset
 //===========================================
 void Debouncer::reset() {
-  m_start = now();
+  m_start = m_timeService->now();
 }
 
 //===========================================
 // TRandomIntervals::TRandomIntervals
+//
+// min and max are in milliseconds
 //===========================================
-TRandomIntervals::TRandomIntervals(unsigned long min, unsigned long max) {
+TRandomIntervals::TRandomIntervals(const TimeService& timeService, unsigned long min,
+  unsigned long max)
+  : m_timeService(timeService) {
+
   m_randEngine.seed(randomSeed());
   m_distribution = std::uniform_real_distribution<>(min, max);
 
@@ -61,9 +52,7 @@ TRandomIntervals::TRandomIntervals(unsigned long min, unsigned long max) {
 // TRandomIntervals::doIfReady
 //===========================================
 bool TRandomIntervals::doIfReady(function<void()> fn) {
-  double t = getTime();
-
-  if (t >= m_dueTime) {
+  if (m_timeService.now() >= m_dueTime) {
     fn();
     calcDueTime();
 
@@ -77,5 +66,5 @@ bool TRandomIntervals::doIfReady(function<void()> fn) {
 // TRandomIntervals::calcDueTime
 //===========================================
 void TRandomIntervals::calcDueTime() {
-  m_dueTime = getTime() + m_distribution(m_randEngine);
+  m_dueTime = m_timeService.now() + 0.001 * m_distribution(m_randEngine);
 }
@@ -6,14 +6,19 @@
 #include <random>
 
 
+class TimeService;
+
+// Timing is measured in frames by the TimeService rather than by the wall clock, so behaviour is
+// the same however fast frames are produced
 class Debouncer {
   public:
-    Debouncer(double seconds);
+    Debouncer(const TimeService& timeService, double seconds);
 
     bool ready();
     void reset();
 
   private:
+    const TimeService* m_timeService;
     double m_duration;
     double m_start;
 };
@@ -27,16 +32,17 @@ class TimePattern {
 
 class TRandomIntervals : public TimePattern {
   public:
-    TRandomIntervals(unsigned long min, unsigned long max);
+    TRandomIntervals(const TimeService& timeService, unsigned long min, unsigned long max);
 
     virtual bool doIfReady(std::function<void()> fn) override;
 
     virtual ~TRandomIntervals() override {}
 
   private:
+    const TimeService& m_timeService;
     std::mt19937 m_randEngine;
     std::uniform_real_distribution<> m_distribution;
-    unsigned long m_dueTime;
+    double m_dueTime;
 
     void calcDueTime();
 };
@@ -0,0 +1,362 @@
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#ifdef WIN32
+#  include <io.h>
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+#include "state_journal.hpp"
+#include "exception.hpp"
+
+
+using std::string;
+
+
+// The journal isn't compacted until it's at least this big, and twice the size of the snapshot
+static const size_t MIN_COMPACTION_SIZE = 64 * 1024;
+
+// A record is its payload's length and checksum followed by the payload, which is the name's
+// length, the name, then the value
+static const size_t HEADER_SIZE = 8;
+
+
+//===========================================
+// crc32
+//===========================================
+static uint32_t crc32(const char* data, size_t len) {
+  static uint32_t table[256] = {};
+  static bool tableReady = false;
+
+  if (!tableReady) {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      table[i] = c;
+    }
+
+    tableReady = true;
+  }
+
+  uint32_t crc = 0xffffffffu;
+  for (size_t i = 0; i < len; ++i) {
+    crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xff] ^ (crc >> 8);
+  }
+
+  return crc ^ 0xffffffffu;
+}
+
+//===========================================
+// putU32
+//===========================================
+static void putU32(string& out, uint32_t x) {
+  for (int i = 0; i < 4; ++i) {
+    out.push_back(static_cast<char>((x >> (8 * i)) & 0xff));
+  }
+}
+
+//===========================================
+// getU32
+//===========================================
+static uint32_t getU32(const char* p) {
+  uint32_t x = 0;
+  for (int i = 0; i < 4; ++i) {
+    x |= static_cast<uint32_t>(static_cast<uint8_t>(p[i])) << (8 * i);
+  }
+
+  return x;
+}
+
+//===========================================
+// appendRecord
+//===========================================
+static void appendRecord(string& out, const string& name, const string& value) {
+  size_t start = out.length();
+
+  putU32(out, static_cast<uint32_t>(4 + name.length() + value.length()));
+  putU32(out, 0);
+  putU32(out, static_cast<uint32_t>(name.length()));
+  out.append(name);
+  out.append(value);
+
+  uint32_t crc = crc32(out.data() + start + HEADER_SIZE, out.length() - start - HEADER_SIZE);
+
+  string crcBytes;
+  putU32(crcBytes, crc);
+  out.replace(start + 4, 4, crcBytes);
+}
+
+//===========================================
+// readFile
+//
+// Returns false if the file doesn't exist
+//===========================================
+static bool readFile(const string& path, string& data) {
+  std::ifstream fin(path, std::ios::binary);
+
+  if (!fin.good()) {
+    return false;
+  }
+
+  std::stringstream ss;
+  ss << fin.rdbuf();
+  data = ss.str();
+
+  return true;
+}
+
+//===========================================
+// syncFile
+//===========================================
+static void syncFile(FILE* file) {
+#ifdef WIN32
+  _commit(_fileno(file));
+#else
+  fsync(fileno(file));
+#endif
+}
+
+//===========================================
+// syncParentDirectory
+//
+// A rename is only on disk once the directory holding the file is
+//===========================================
+#ifndef WIN32
+static void syncParentDirectory(const string& path) {
+  size_t slash = path.find_last_of('/');
+  string dir = slash == string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+
+  int fd = open(dir.c_str(), O_RDONLY);
+  if (fd != -1) {
+    fsync(fd);
+    close(fd);
+  }
+}
+#endif
+
+//===========================================
+// replaceFile
+//===========================================
+static bool replaceFile(const string& from, const string& to) {
+#ifdef WIN32
+  return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+  if (std::rename(from.c_str(), to.c_str()) != 0) {
+    return false;
+  }
+
+  syncParentDirectory(to);
+  return true;
+#endif
+}
+
+//===========================================
+// StateJournal::StateJournal
+//===========================================
+StateJournal::StateJournal(const string& basePath)
+  : m_basePath(basePath) {}
+
+//===========================================
+// StateJournal::snapshotPath
+//===========================================
+string StateJournal::snapshotPath() const {
+  return m_basePath + ".snapshot";
+}
+
+//===========================================
+// StateJournal::journalPath
+//===========================================
+string StateJournal::journalPath() const {
+  return m_basePath + ".journal";
+}
+
+//===========================================
+// StateJournal::replay
+//
+// Applies records until one is found to be incomplete or corrupt, and returns the number of bytes
+// applied
+//===========================================
+size_t StateJournal::replay(const string& data) {
+  size_t i = 0;
+
+  while (data.length() - i >= HEADER_SIZE) {
+    const char* p = data.data() + i;
+
+    uint32_t len = getU32(p);
+    uint32_t crc = getU32(p + 4);
+
+    if (len < 4 || len > data.length() - i - HEADER_SIZE) {
+      break;
+    }
+
+    const char* payload = p + HEADER_SIZE;
+
+    if (crc32(payload, len) != crc) {
+      break;
+    }
+
+    uint32_t nameLen = getU32(payload);
+    if (nameLen > len - 4) {
+      break;
+    }
+
+    m_state[string(payload + 4, nameLen)] = string(payload + 4 + nameLen, len - 4 - nameLen);
+
+    i += HEADER_SIZE + len;
+  }
+
+  return i;
+}
+
+//===========================================
+// StateJournal::load
+//
+// A torn write at the end of the journal is discarded by compacting straight away, so that new
+// records don't end up after it
+//===========================================
+bool StateJournal::load() {
+  m_state.clear();
+  m_pending.clear();
+
+  string snapshot;
+  bool haveSnapshot = readFile(snapshotPath(), snapshot);
+
+  if (haveSnapshot) {
+    m_snapshotSize = replay(snapshot);
+  }
+
+  string journal;
+  bool haveJournal = readFile(journalPath(), journal);
+
+  if (haveJournal) {
+    m_journalSize = replay(journal);
+
+    if (m_journalSize < journal.length()) {
+      compact();
+    }
+  }
+
+  return haveSnapshot || haveJournal;
+}
+
+//===========================================
+// StateJournal::set
+//===========================================
+void StateJournal::set(const string& name, const string& value) {
+  auto it = m_state.find(name);
+
+  if (it != m_state.end()) {
+    if (it->second == value) {
+      return;
+    }
+
+    it->second = value;
+  }
+  else {
+    m_state.insert(std::make_pair(name, value));
+  }
+
+  appendRecord(m_pending, name, value);
+}
+
+//===========================================
+// StateJournal::openJournal
+//===========================================
+void StateJournal::openJournal(const char* mode) {
+  if (m_journal != nullptr) {
+    fclose(m_journal);
+  }
+
+  m_journal = fopen(journalPath().c_str(), mode);
+
+  if (m_journal == nullptr) {
+    EXCEPTION("Error opening journal '" << journalPath() << "'");
+  }
+}
+
+//===========================================
+// StateJournal::commit
+//
+// The records are flushed to the OS, so they survive the process crashing, but only compaction
+// waits for them to reach the disk
+//===========================================
+void StateJournal::commit() {
+  if (m_pending.empty()) {
+    return;
+  }
+
+  if (m_journal == nullptr) {
+    openJournal("ab");
+  }
+
+  if (fwrite(m_pending.data(), 1, m_pending.length(), m_journal) != m_pending.length()
+    || fflush(m_journal) != 0) {
+
+    EXCEPTION("Error writing to journal '" << journalPath() << "'");
+  }
+
+  m_journalSize += m_pending.length();
+  m_pending.clear();
+
+  if (m_journalSize >= MIN_COMPACTION_SIZE && m_journalSize >= 2 * m_snapshotSize) {
+    compact();
+  }
+}
+
+//===========================================
+// StateJournal::compact
+//
+// The new snapshot is on disk before it replaces the old one, so a crash leaves either the old
+// snapshot and the full journal, or the new snapshot and some or all of the journal. Replaying
+// the journal over the new snapshot changes nothing.
+//
+// Only called once there's nothing pending, so the journal emptied here holds every change the
+// snapshot doesn't already.
+//===========================================
+void StateJournal::compact() {
+  assert(m_pending.empty());
+
+  string data;
+  for (auto& param : m_state) {
+    appendRecord(data, param.first, param.second);
+  }
+
+  string tmpPath = snapshotPath() + ".tmp";
+  FILE* file = fopen(tmpPath.c_str(), "wb");
+
+  if (file == nullptr) {
+    EXCEPTION("Error compacting journal; Couldn't open '" << tmpPath << "'");
+  }
+
+  bool written = fwrite(data.data(), 1, data.length(), file) == data.length()
+    && fflush(file) == 0;
+
+  if (written) {
+    syncFile(file);
+  }
+
+  fclose(file);
+
+  if (!written || !replaceFile(tmpPath, snapshotPath())) {
+    EXCEPTION("Error compacting journal; Couldn't write '" << snapshotPath() << "'");
+  }
+
+  openJournal("wb");
+
+  m_snapshotSize = data.length();
+  m_journalSize = 0;
+}
+
+//===========================================
+// StateJournal::~StateJournal
+//===========================================
+StateJournal::~StateJournal() {
+  if (m_journal != nullptr) {
+    fclose(m_journal);
+  }
+}
@@ -0,0 +1,63 @@
+#ifndef __PROCALC_STATE_JOURNAL_HPP__
+#define __PROCALC_STATE_JOURNAL_HPP__
+
+
+#include <cstdio>
+#include <string>
+#include <map>
+
+
+// Saves a set of named values such that a crash at any point loses at most the changes since the
+// last commit, and never leaves what was saved in an inconsistent state.
+//
+// Each change is appended to a journal as a checksummed record. Loading reads the snapshot and
+// replays the journal over it, stopping at the first record that's incomplete or fails its
+// checksum, as happens when a write is cut short. Once the journal has grown large, the whole
+// state is written to a temporary file which replaces the snapshot with a rename, and the journal
+// is emptied.
+class StateJournal {
+  public:
+    // The snapshot and journal are kept at basePath + ".snapshot" and basePath + ".journal"
+    explicit StateJournal(const std::string& basePath);
+
+    StateJournal(const StateJournal& cpy) = delete;
+
+    // Returns false if there was nothing to load
+    bool load();
+
+    inline const std::map<std::string, std::string>& state() const;
+    void set(const std::string& name, const std::string& value);
+
+    // Writes the changes made since the last commit, compacting the journal once it's grown large
+    void commit();
+
+    std::string snapshotPath() const;
+    std::string journalPath() const;
+
+    ~StateJournal();
+
+  private:
+    size_t replay(const std::string& data);
+    void compact();
+    void openJournal(const char* mode);
+
+    std::string m_basePath;
+    std::map<std::string, std::string> m_state;
+
+    // Encoded records not yet written
+    std::string m_pending;
+
+    FILE* m_journal = nullptr;
+    size_t m_journalSize = 0;
+    size_t m_snapshotSize = 0;
+};
+
+//===========================================
+// StateJournal::state
+//===========================================
+inline const std::map<std::string, std::string>& StateJournal::state() const {
+  return m_state;
+}
+
+
+#endif
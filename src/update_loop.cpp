@@ -8,11 +8,13 @@ using std::function;
 //===========================================
 // UpdateLoop::UpdateLoop
 //===========================================
-UpdateLoop::UpdateLoop(int interval)
-  : m_interval(interval) {
+UpdateLoop::UpdateLoop(FrameScheduler& scheduler, int interval)
+  : m_scheduler(scheduler),
+    m_interval(interval) {
 
-  m_timer = makeQtObjPtr<QTimer>();
-  connect(m_timer.get(), SIGNAL(timeout()), this, SLOT(tick()));
+  m_hTick = m_scheduler.add("UpdateLoop", m_interval, [this]() {
+    tick();
+  }, FrameScheduler::PRIORITY_NORMAL, false);
 }
 
 //===========================================
@@ -21,8 +23,8 @@ UpdateLoop::UpdateLoop(int interval)
 void UpdateLoop::add(function<bool()> fn, function<void()> fnOnFinish) {
   m_functions.push_back(FuncPair{fn, fnOnFinish});
 
-  if (!m_timer->isActive()) {
-    m_timer->start(m_interval);
+  if (!m_scheduler.isActive(m_hTick)) {
+    m_scheduler.setActive(m_hTick, true);
   }
 }
 
@@ -30,7 +32,7 @@ void UpdateLoop::add(function<bool()> fn, function<void()> fnOnFinish) {
 // UpdateLoop::finishAll
 //===========================================
 void UpdateLoop::finishAll() {
-  m_timer->stop();
+  m_scheduler.setActive(m_hTick, false);
 }
 
 //===========================================
@@ -56,7 +58,7 @@ void UpdateLoop::tick() {
   while (it != m_functions.end()) {
     bool result = false;
 
-    if (m_timer->isActive()) {
+    if (m_scheduler.isActive(m_hTick)) {
       result = it->fnPeriodic();
     }
 
@@ -70,6 +72,6 @@ void UpdateLoop::tick() {
   }
 
   if (m_functions.empty()) {
-    m_timer->stop();
+    m_scheduler.setActive(m_hTick, false);
   }
 }
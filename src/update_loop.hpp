@@ -4,32 +4,28 @@
 
 #include <list>
 #include <functional>
-#include <QObject>
-#include <QTimer>
-#include "qt_obj_ptr.hpp"
+#include "frame_scheduler.hpp"
 
 
-class UpdateLoop : QObject {
-  Q_OBJECT
-
+class UpdateLoop {
   public:
-    UpdateLoop(int interval);
+    UpdateLoop(FrameScheduler& scheduler, int interval);
 
     void add(std::function<bool()> fn, std::function<void()> fnOnFinish = []() {});
     int size() const;
     double fps() const;
     void finishAll();
 
-  private slots:
+  private:
     void tick();
 
-  private:
     struct FuncPair {
       std::function<bool()> fnPeriodic;
       std::function<void()> fnFinish;
     };
 
-    QtObjPtr<QTimer> m_timer;
+    FrameScheduler& m_scheduler;
+    FrameScheduler::Handle m_hTick;
     int m_interval;
     std::list<FuncPair> m_functions;
 };
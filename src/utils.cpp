@@ -39,8 +39,22 @@ std::ostream& operator<<(std::ostream& os, const QSize& sz) {
 }
 #endif
 
+// Once a session seed is set, seeds are drawn from it instead, so that a run can be reproduced
+static bool sessionSeeded = false;
+static std::mt19937 sessionRandEngine;
+
 //===========================================
-// randomSeed
+// setSessionSeed
+//
+// Only affects RNGs seeded after the call, not those initialised statically
+//===========================================
+void setSessionSeed(long seed) {
+  sessionRandEngine.seed(seed);
+  sessionSeeded = true;
+}
+
+//===========================================
+// platformRandomSeed
 //===========================================
 #ifdef __APPLE__
 #include <chrono>
@@ -49,16 +63,27 @@ using std::chrono::system_clock;
 using std::chrono::milliseconds;
 using std::chrono::duration_cast;
 
-long randomSeed() {
+static long platformRandomSeed() {
   return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
 }
 #else
-long randomSeed() {
+static long platformRandomSeed() {
   static std::random_device rd;
   return rd();
 }
 #endif
 
+//===========================================
+// randomSeed
+//===========================================
+long randomSeed() {
+  if (sessionSeeded) {
+    return sessionRandEngine();
+  }
+
+  return platformRandomSeed();
+}
+
 //===========================================
 // readString
 //===========================================
@@ -56,6 +56,7 @@ std::string readString(std::istream& is);
 void writeString(std::ostream& os, const std::string& s);
 std::vector<std::string> splitString(const std::string& s, char delim);
 long randomSeed();
+void setSessionSeed(long seed);
 #ifdef DEBUG
 class QRect;
 class QRectF;
@@ -0,0 +1,77 @@
+#include <cstdlib>
+#include <new>
+#include "alloc_counter.hpp"
+
+
+std::atomic<bool> countAllocations(false);
+std::atomic<long> numAllocations(0);
+std::atomic<long> liveBytes(0);
+
+// Each block is prefixed with its size, so it can be subtracted from liveBytes when the block is
+// freed. The header is 16 bytes to keep the returned pointer as aligned as malloc's.
+static const size_t HEADER_SIZE = 16;
+
+
+void* operator new(size_t size) {
+  if (countAllocations) {
+    ++numAllocations;
+  }
+
+  void* p = malloc(size + HEADER_SIZE);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  *static_cast<size_t*>(p) = size;
+  liveBytes += static_cast<long>(size);
+
+  return static_cast<char*>(p) + HEADER_SIZE;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return operator new(size);
+  }
+  catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept {
+  if (p == nullptr) {
+    return;
+  }
+
+  void* block = static_cast<char*>(p) - HEADER_SIZE;
+  liveBytes -= static_cast<long>(*static_cast<size_t*>(block));
+
+  free(block);
+}
+
+void operator delete[](void* p) noexcept {
+  operator delete(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+  operator delete(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  operator delete(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  operator delete(p);
+}
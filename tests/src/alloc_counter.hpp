@@ -0,0 +1,19 @@
+#ifndef __PROCALC_TESTS_ALLOC_COUNTER_HPP__
+#define __PROCALC_TESTS_ALLOC_COUNTER_HPP__
+
+
+#include <atomic>
+
+
+// The test binary replaces the global operator new and delete, so tests can see what the code
+// under test allocates. There can only be one replacement per program, so tests share these.
+
+// While set, calls to operator new are counted in numAllocations
+extern std::atomic<bool> countAllocations;
+extern std::atomic<long> numAllocations;
+
+// Bytes currently allocated with operator new
+extern std::atomic<long> liveBytes;
+
+
+#endif
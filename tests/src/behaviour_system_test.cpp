@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <raycast/behaviour_system.hpp>
+
+
+using std::set;
+using std::vector;
+
+
+// Moves for a fixed number of frames when activated, then sleeps, like a door or elevator
+class CTestBehaviour : public CBehaviour {
+  public:
+    CTestBehaviour(entityId_t entityId, int framesToMove)
+      : CBehaviour(entityId),
+        m_framesToMove(framesToMove) {
+
+      sleep();
+    }
+
+    void update() override {
+      ++numUpdates;
+
+      if (--m_framesLeft <= 0) {
+        sleep();
+      }
+    }
+
+    void handleBroadcastedEvent(const GameEvent&) override {
+      ++numBroadcasts;
+    }
+
+    void handleTargetedEvent(const GameEvent& e) override {
+      if (e.name == "activate_entity") {
+        m_framesLeft = m_framesToMove;
+        wake();
+      }
+    }
+
+    int numUpdates = 0;
+    int numBroadcasts = 0;
+
+  private:
+    int m_framesToMove;
+    int m_framesLeft = 0;
+};
+
+
+class BehaviourSystemTest : public testing::Test {
+  public:
+    virtual void SetUp() override {}
+
+    virtual void TearDown() override {}
+
+    CTestBehaviour& add(entityId_t id, int framesToMove) {
+      CTestBehaviour* c = new CTestBehaviour(id, framesToMove);
+      system.addComponent(pComponent_t(c));
+      return *c;
+    }
+
+    BehaviourSystem system;
+};
+
+
+TEST_F(BehaviourSystemTest, onlyAwakeBehavioursAreUpdated) {
+  CTestBehaviour& a = add(1, 2);
+  CTestBehaviour& b = add(2, 2);
+  CTestBehaviour& c = add(3, 2);
+
+  ASSERT_EQ(0, system.numAwake());
+
+  system.handleEvent(EActivateEntity{2}, set<entityId_t>{2});
+
+  ASSERT_TRUE(b.isAwake());
+  ASSERT_EQ(1, system.numAwake());
+
+  system.update();
+  system.update();
+  system.update();
+
+  ASSERT_EQ(0, a.numUpdates);
+  ASSERT_EQ(2, b.numUpdates);
+  ASSERT_EQ(0, c.numUpdates);
+  ASSERT_FALSE(b.isAwake());
+  ASSERT_EQ(0, system.numAwake());
+}
+
+TEST_F(BehaviourSystemTest, sleepingBehavioursStillReceiveBroadcasts) {
+  CTestBehaviour& a = add(1, 1);
+  CTestBehaviour& b = add(2, 1);
+
+  system.handleEvent(GameEvent{"something"});
+
+  ASSERT_EQ(1, a.numBroadcasts);
+  ASSERT_EQ(1, b.numBroadcasts);
+}
+
+TEST_F(BehaviourSystemTest, removingAwakeBehaviourKeepsOthersAwake) {
+  add(1, 10);
+  add(2, 10);
+  CTestBehaviour& c = add(3, 10);
+
+  system.handleEvent(EActivateEntity{0}, set<entityId_t>{1, 2, 3, 4});
+
+  ASSERT_EQ(3, system.numAwake());
+
+  system.removeEntity(1);
+  system.removeEntity(4);
+
+  ASSERT_EQ(2, system.numAwake());
+
+  system.update();
+
+  ASSERT_EQ(1, c.numUpdates);
+  ASSERT_TRUE(system.getComponent(2).isAwake());
+}
+
+// Of many doors and elevators, only those activated are updated, each only for as long as it
+// moves. The rest are never updated however many ticks pass.
+TEST_F(BehaviourSystemTest, sleepingBehavioursCostNoUpdates) {
+  const int NUM_BEHAVIOURS = 10000;
+  const int FRAMES_TO_MOVE = 50;
+  const int NUM_FRAMES = 200;
+
+  vector<CTestBehaviour*> behaviours;
+  for (int i = 0; i < NUM_BEHAVIOURS; ++i) {
+    behaviours.push_back(&add(i, FRAMES_TO_MOVE));
+  }
+
+  for (int numAwake : {0, 10, 100, 1000, 10000}) {
+    set<entityId_t> targets;
+    for (int i = 0; i < numAwake; ++i) {
+      targets.insert(i * (NUM_BEHAVIOURS / numAwake));
+    }
+
+    for (CTestBehaviour* c : behaviours) {
+      c->numUpdates = 0;
+    }
+
+    system.handleEvent(EActivateEntity{0}, targets);
+
+    ASSERT_EQ(numAwake, system.numAwake());
+
+    for (int i = 0; i < NUM_FRAMES; ++i) {
+      system.update();
+    }
+
+    ASSERT_EQ(0, system.numAwake());
+
+    long totalUpdates = 0;
+    for (entityId_t id = 0; id < NUM_BEHAVIOURS; ++id) {
+      int expected = targets.count(id) ? FRAMES_TO_MOVE : 0;
+      ASSERT_EQ(expected, behaviours[id]->numUpdates) << "Behaviour " << id;
+
+      totalUpdates += behaviours[id]->numUpdates;
+    }
+
+    ASSERT_EQ(static_cast<long>(numAwake) * FRAMES_TO_MOVE, totalUpdates);
+  }
+}
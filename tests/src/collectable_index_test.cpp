@@ -0,0 +1,236 @@
+#include <random>
+#include <gtest/gtest.h>
+#include <raycast/collectable_index.hpp>
+#include "alloc_counter.hpp"
+
+
+using std::vector;
+
+
+class CollectableIndexTest : public testing::Test {
+  public:
+    virtual void SetUp() override {
+      root.reset(new CZone(nextId++, -1));
+    }
+
+    virtual void TearDown() override {}
+
+    // A square grid of zones, each joined to the zones beside it by soft edges
+    void makeGrid(int n, double cellSize) {
+      gridSize = n;
+      this->cellSize = cellSize;
+
+      for (int i = 0; i < n * n; ++i) {
+        CZone* zone = new CZone(nextId++, root->entityId());
+        zone->parent = root.get();
+
+        root->children.push_back(pCZone_t(zone));
+        cells.push_back(zone);
+      }
+
+      for (int row = 0; row < n; ++row) {
+        for (int col = 0; col < n; ++col) {
+          if (col + 1 < n) {
+            join(cell(row, col), cell(row, col + 1));
+          }
+          if (row + 1 < n) {
+            join(cell(row, col), cell(row + 1, col));
+          }
+        }
+      }
+    }
+
+    CZone* cell(int row, int col) {
+      return cells[row * gridSize + col];
+    }
+
+    CZone* cellAt(const Point& p) {
+      return cell(static_cast<int>(p.y / cellSize), static_cast<int>(p.x / cellSize));
+    }
+
+    void join(CZone* a, CZone* b) {
+      for (CZone* z : {a, b}) {
+        CSoftEdge* se = new CSoftEdge(nextId++, z->entityId(), -1);
+        se->zoneA = a;
+        se->zoneB = b;
+        z->edges.push_back(pCEdge_t(se));
+      }
+    }
+
+    CVRect& addBody(CZone* zone, const Point& pos) {
+      CVRect* body = new CVRect(nextId++, zone->entityId(), Size(20, 20));
+      body->zone = zone;
+      body->pos = pos;
+      bodies.push_back(pCVRect_t(body));
+
+      return *body;
+    }
+
+    entityId_t nextId = 0;
+    pCZone_t root;
+    vector<CZone*> cells;
+    vector<pCVRect_t> bodies;
+    int gridSize = 0;
+    double cellSize = 0;
+};
+
+
+TEST_F(CollectableIndexTest, findsCollectablesInReach) {
+  makeGrid(3, 100.0);
+
+  CVRect& near = addBody(cell(1, 1), Point(150, 150));
+  CVRect& beside = addBody(cell(1, 2), Point(205, 150));
+  // Too far away
+  addBody(cell(1, 1), Point(110, 110));
+  addBody(cell(1, 0), Point(95, 150));
+  CVRect& high = addBody(cell(1, 1), Point(160, 160));
+  high.y = 100;
+
+  CollectableIndex index;
+  for (auto& body : bodies) {
+    index.insert(*body, body->zone->entityId());
+  }
+
+  CVRect& collector = addBody(cell(1, 1), Point(170, 150));
+
+  vector<entityId_t> found;
+  index.findNear(collector, 30.0, found);
+
+  ASSERT_EQ(vector<entityId_t>({near.entityId(), beside.entityId()}), found);
+  ASSERT_EQ(5, index.size());
+}
+
+TEST_F(CollectableIndexTest, movingAndRemoving) {
+  makeGrid(3, 100.0);
+
+  CVRect& a = addBody(cell(0, 0), Point(50, 50));
+  CVRect& b = addBody(cell(0, 0), Point(55, 50));
+  CVRect& c = addBody(cell(0, 0), Point(60, 50));
+
+  CollectableIndex index;
+  index.insert(a, cell(0, 0)->entityId());
+  index.insert(b, cell(0, 0)->entityId());
+  index.insert(c, cell(0, 0)->entityId());
+
+  CVRect& collector = addBody(cell(0, 0), Point(55, 55));
+  vector<entityId_t> found;
+
+  index.remove(a.entityId());
+  index.findNear(collector, 20.0, found);
+  ASSERT_EQ(vector<entityId_t>({b.entityId(), c.entityId()}), found);
+
+  // Move c across the map without telling the index, then tell it
+  c.zone = cell(2, 2);
+  c.pos = Point(250, 250);
+  index.move(c.entityId(), cell(2, 2)->entityId());
+
+  found.clear();
+  index.findNear(collector, 20.0, found);
+  ASSERT_EQ(vector<entityId_t>({b.entityId()}), found);
+
+  collector.zone = cell(2, 2);
+  collector.pos = Point(240, 240);
+
+  found.clear();
+  index.findNear(collector, 20.0, found);
+  ASSERT_EQ(vector<entityId_t>({c.entityId()}), found);
+
+  ASSERT_FALSE(index.contains(a.entityId()));
+  ASSERT_EQ(2, index.size());
+}
+
+// Zones are only searched one step out, so a collectable just across the corner where four zones
+// meet is missed, even though it's within reach
+TEST_F(CollectableIndexTest, searchesOnlyNeighbouringZones) {
+  makeGrid(3, 100.0);
+
+  CVRect& diagonal = addBody(cell(0, 0), Point(95, 95));
+  CVRect& beside = addBody(cell(0, 1), Point(105, 95));
+
+  CollectableIndex index;
+  index.insert(diagonal, cell(0, 0)->entityId());
+  index.insert(beside, cell(0, 1)->entityId());
+
+  CVRect& collector = addBody(cell(1, 1), Point(105, 105));
+
+  vector<entityId_t> found;
+  index.findNear(collector, 20.0, found);
+
+  ASSERT_EQ(vector<entityId_t>({beside.entityId()}), found);
+}
+
+// Collectors wander a grid of zones picking up whatever's in reach. Once the scratch space has
+// grown, searching and picking up allocate nothing.
+TEST_F(CollectableIndexTest, wanderingCollectorsDoNotAllocate) {
+  const int GRID_SIZE = 30;
+  const double CELL_SIZE = 100.0;
+  const int NUM_COLLECTABLES = 5000;
+  const int NUM_COLLECTORS = 100;
+  const int NUM_FRAMES = 50;
+  const double RADIUS = 50.0;
+  const double SPEED = 10.0;
+  const double W = GRID_SIZE * CELL_SIZE;
+
+  makeGrid(GRID_SIZE, CELL_SIZE);
+
+  std::mt19937 randEngine(1234);
+  std::uniform_real_distribution<double> randPos(0.0, W - 0.001);
+  std::uniform_real_distribution<double> randAngle(0.0, 2.0 * PI);
+
+  CollectableIndex index;
+
+  for (int i = 0; i < NUM_COLLECTABLES; ++i) {
+    Point p(randPos(randEngine), randPos(randEngine));
+    CVRect& body = addBody(cellAt(p), p);
+
+    index.insert(body, body.zone->entityId());
+  }
+
+  vector<CVRect*> collectors;
+  for (int i = 0; i < NUM_COLLECTORS; ++i) {
+    Point p(randPos(randEngine), randPos(randEngine));
+    collectors.push_back(&addBody(cellAt(p), p));
+  }
+
+  vector<entityId_t> found;
+  found.reserve(NUM_COLLECTABLES);
+  long numFound = 0;
+
+  auto runFrame = [&]() {
+    for (CVRect* collector : collectors) {
+      double a = randAngle(randEngine);
+      Point p = collector->pos + Vec2f(cos(a), sin(a)) * SPEED;
+
+      if (p.x >= 0 && p.x < W && p.y >= 0 && p.y < W) {
+        collector->pos = p;
+        collector->zone = cellAt(p);
+      }
+
+      found.clear();
+      index.findNear(*collector, RADIUS, found);
+
+      // Pick them up
+      for (entityId_t id : found) {
+        index.remove(id);
+      }
+
+      numFound += found.size();
+    }
+  };
+
+  // Grows the index's scratch space to fit
+  runFrame();
+
+  numAllocations = 0;
+  countAllocations = true;
+
+  for (int frame = 1; frame < NUM_FRAMES; ++frame) {
+    runFrame();
+  }
+
+  countAllocations = false;
+
+  ASSERT_GT(numFound, 0);
+  ASSERT_EQ(NUM_COLLECTABLES - numFound, index.size());
+  ASSERT_EQ(0, numAllocations);
+}
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <console_output.hpp>
+#include "alloc_counter.hpp"
+
+
+using std::string;
+using std::vector;
+
+
+class ConsoleOutputTest : public testing::Test {
+  public:
+    virtual void SetUp() override {}
+
+    virtual void TearDown() override {}
+};
+
+
+TEST_F(ConsoleOutputTest, keepsMostRecentLines) {
+  ConsoleOutput output(3);
+
+  for (int i = 0; i < 5; ++i) {
+    output.writeLine(std::to_string(i));
+  }
+
+  ASSERT_EQ(3u, output.numWaiting());
+  ASSERT_EQ(2ul, output.numDropped());
+
+  vector<string> lines;
+  ASSERT_FALSE(output.take(lines));
+  ASSERT_EQ(vector<string>({"2", "3", "4"}), lines);
+
+  output.writeLine("5");
+  output.close();
+
+  lines.clear();
+  ASSERT_TRUE(output.take(lines));
+  ASSERT_EQ(vector<string>({"5"}), lines);
+  ASSERT_EQ(0u, output.numWaiting());
+}
+
+TEST_F(ConsoleOutputTest, takesAtMostMaxLines) {
+  ConsoleOutput output(10);
+
+  for (int i = 0; i < 5; ++i) {
+    output.writeLine(std::to_string(i));
+  }
+  output.close();
+
+  vector<string> lines;
+  ASSERT_FALSE(output.take(lines, 3));
+  ASSERT_EQ(vector<string>({"0", "1", "2"}), lines);
+  ASSERT_EQ(2u, output.numWaiting());
+
+  ASSERT_TRUE(output.take(lines, 3));
+  ASSERT_EQ(vector<string>({"3", "4"}), lines);
+}
+
+TEST_F(ConsoleOutputTest, steadyStreamDoesNotAllocate) {
+  const string line = "A line too long to fit in a string's small buffer";
+
+  ConsoleOutput output(4);
+  vector<string> lines;
+
+  // Warm up, so that the ring buffer and the vector both hold strings with storage
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      output.writeLine(line);
+    }
+    output.take(lines);
+  }
+
+  numAllocations = 0;
+  countAllocations = true;
+
+  for (int i = 0; i < 100; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      output.writeLine(line);
+    }
+    output.take(lines);
+  }
+
+  countAllocations = false;
+
+  ASSERT_EQ(4u, lines.size());
+  ASSERT_EQ(0, numAllocations);
+}
+
+TEST_F(ConsoleOutputTest, resetReadiesForNextCommand) {
+  ConsoleOutput output(2);
+
+  output.writeLine("a");
+  output.writeLine("b");
+  output.writeLine("c");
+  output.cancel();
+  output.close();
+
+  output.reset();
+
+  ASSERT_FALSE(output.cancelled());
+  ASSERT_EQ(0u, output.numWaiting());
+  ASSERT_EQ(0ul, output.numDropped());
+
+  vector<string> lines;
+  ASSERT_FALSE(output.take(lines));
+  ASSERT_TRUE(lines.empty());
+}
+
+TEST_F(ConsoleOutputTest, cancelStopsWorker) {
+  ConsoleOutput output(100);
+
+  std::thread worker([&output]() {
+    while (!output.cancelled()) {
+      output.writeLine("spam");
+    }
+
+    output.close();
+  });
+
+  vector<string> lines;
+  output.take(lines);
+  output.cancel();
+
+  worker.join();
+
+  ASSERT_TRUE(output.take(lines));
+}
+
+// A command pipes a million lines from a worker thread while the main thread takes them once a
+// frame, as the console does. However fast the worker writes, the lines waiting and the
+// scrollback stay within their caps, and every line is either received or counted as dropped.
+TEST_F(ConsoleOutputTest, streamMillionLines) {
+  const size_t MAX_LINES = 10000;
+  const unsigned long NUM_LINES = 1000000;
+
+  ConsoleOutput output(MAX_LINES);
+
+  std::thread worker([&output, NUM_LINES]() {
+    for (unsigned long i = 0; i < NUM_LINES; ++i) {
+      output.writeLine("Line " + std::to_string(i) + " of some long running command's output");
+    }
+
+    output.close();
+  });
+
+  // Stands in for the scrollback, which never holds more than MAX_LINES
+  vector<string> scrollback;
+  vector<string> lines;
+
+  unsigned long numReceived = 0;
+  size_t maxWaiting = 0;
+  size_t maxScrollback = 0;
+  bool finished = false;
+
+  while (!finished) {
+    maxWaiting = std::max(maxWaiting, output.numWaiting());
+
+    lines.clear();
+    finished = output.take(lines);
+    numReceived += lines.size();
+
+    scrollback.insert(scrollback.end(), lines.begin(), lines.end());
+    if (scrollback.size() > MAX_LINES) {
+      scrollback.erase(scrollback.begin(), scrollback.end() - MAX_LINES);
+    }
+
+    maxScrollback = std::max(maxScrollback, scrollback.size());
+
+    if (!finished) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(16));
+    }
+  }
+
+  worker.join();
+
+  ASSERT_LE(maxWaiting, MAX_LINES);
+  ASSERT_LE(maxScrollback, MAX_LINES);
+  ASSERT_EQ(NUM_LINES, numReceived + output.numDropped());
+
+  ASSERT_EQ(MAX_LINES, scrollback.size());
+  ASSERT_EQ("Line 999999 of some long running command's output", scrollback.back());
+  ASSERT_EQ(NUM_LINES - MAX_LINES, std::stoul(scrollback.front().substr(5)));
+}
@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <gtest/gtest.h>
+#include <QApplication>
+#include <QEventLoop>
+#include <QKeyEvent>
+#include <QTextBlock>
+#include <QTimer>
+#include <console_widget.hpp>
+#include <frame_scheduler.hpp>
+#include <app_config.hpp>
+#include "alloc_counter.hpp"
+
+
+using std::string;
+
+
+class ConsoleWidgetTest : public testing::Test {
+  public:
+    static void SetUpTestCase() {
+      qputenv("QT_QPA_PLATFORM", "offscreen");
+
+      char tmpl[] = "/tmp/procalc_console_XXXXXX";
+      const char* tmpDir = mkdtemp(tmpl);
+      ASSERT_NE(nullptr, tmpDir);
+      m_tmpDir = tmpDir;
+
+      m_app = new QApplication(m_argc, m_argv);
+      m_appConfig = new AppConfig(m_argc, m_argv, m_tmpDir);
+    }
+
+    static void TearDownTestCase() {
+      delete m_appConfig;
+      delete m_app;
+
+      std::system(("rm -rf '" + m_tmpDir + "'").c_str());
+    }
+
+    virtual void SetUp() override {}
+
+    virtual void TearDown() override {}
+
+  protected:
+    static void sendKey(QWidget& widget, int key, Qt::KeyboardModifiers modifiers,
+      const QString& text = "") {
+
+      QKeyEvent event(QEvent::KeyPress, key, modifiers, text);
+      QApplication::sendEvent(&widget, &event);
+    }
+
+    static void enterCommand(QWidget& widget, const string& cmd) {
+      for (char c : cmd) {
+        QChar ch(c);
+        sendKey(widget, ch.toUpper().unicode(), Qt::NoModifier, QString(ch));
+      }
+
+      sendKey(widget, Qt::Key_Return, Qt::NoModifier, "\r");
+    }
+
+    static bool showingPrompt(const ConsoleWidget& widget) {
+      return widget.document()->lastBlock().text() == "> ";
+    }
+
+    // The stats of the console's flush, which is a scheduler client from construction
+    static FrameScheduler::ClientStats flushStats(const FrameScheduler& scheduler) {
+      for (auto& stats : scheduler.stats()) {
+        if (stats.name == "ConsoleWidget") {
+          return stats;
+        }
+      }
+
+      return FrameScheduler::ClientStats();
+    }
+
+    static int m_argc;
+    static char* m_argv[];
+    static string m_tmpDir;
+    static QApplication* m_app;
+    static AppConfig* m_appConfig;
+};
+
+int ConsoleWidgetTest::m_argc = 1;
+char* ConsoleWidgetTest::m_argv[] = { const_cast<char*>("unitTests"), nullptr };
+string ConsoleWidgetTest::m_tmpDir;
+QApplication* ConsoleWidgetTest::m_app = nullptr;
+AppConfig* ConsoleWidgetTest::m_appConfig = nullptr;
+
+// The command writes a million lines, far more than the scrollback holds, far faster than the
+// console takes them. Each frame's edit should add no more than the per-frame limit, the
+// scrollback should never grow past its cap, and the memory held by waiting lines should stay
+// bounded.
+TEST_F(ConsoleWidgetTest, flushesAtMostMaxLinesPerFrame) {
+  const int MAX_LINES = 2000;
+  const int MAX_LINES_PER_FRAME = 200;
+  const int NUM_LINES = 1000000;
+  const double FRAME_TIME = 1.0 / 60.0;
+  // Lines are too long for the small string optimisation, so every line kept costs heap. Keeping
+  // them all would take over 30MB.
+  const long MAX_BYTES = 4 * 1024 * 1024;
+
+  auto line = [](int i) {
+    return "Output line " + std::to_string(i) + " of the count command";
+  };
+
+  FrameScheduler scheduler;
+  ConsoleWidget widget(*m_appConfig, scheduler, "> ", {}, MAX_LINES, MAX_LINES_PER_FRAME);
+
+  widget.addStreamingCommand("count", [=](const ConsoleWidget::ArgList&, ConsoleOutput& output) {
+    for (int i = 0; i < NUM_LINES && !output.cancelled(); ++i) {
+      output.writeLine(line(i));
+    }
+  });
+
+  long bytesBefore = liveBytes;
+  long maxBytes = 0;
+
+  enterCommand(widget, "count");
+
+  QEventLoop loop;
+  QTimer::singleShot(10000, &loop, SLOT(quit()));
+
+  int prevBlocks = widget.document()->blockCount();
+  unsigned long prevFlushes = 0;
+  int maxBlocks = prevBlocks;
+  bool overLimit = false;
+
+  // Runs after the console's flush on any frame they share
+  FrameScheduler::Handle hSampler = scheduler.add("sampler", 1000 / 60, [&]() {
+    int blocks = widget.document()->blockCount();
+    unsigned long flushes = flushStats(scheduler).frames;
+
+    if (blocks - prevBlocks > MAX_LINES_PER_FRAME * static_cast<int>(flushes - prevFlushes)) {
+      overLimit = true;
+    }
+
+    maxBlocks = std::max(maxBlocks, blocks);
+    maxBytes = std::max(maxBytes, liveBytes - bytesBefore);
+    prevBlocks = blocks;
+    prevFlushes = flushes;
+
+    if (flushes > 0 && showingPrompt(widget)) {
+      loop.quit();
+    }
+  }, FrameScheduler::PRIORITY_LOW);
+
+  loop.exec();
+
+  ASSERT_TRUE(showingPrompt(widget)) << "Command didn't finish";
+
+  FrameScheduler::ClientStats stats = flushStats(scheduler);
+
+  EXPECT_FALSE(overLimit);
+  EXPECT_LE(maxBlocks, MAX_LINES);
+  EXPECT_LE(maxBytes, MAX_BYTES);
+  // At least enough frames to take a full ring buffer at the per-frame limit
+  EXPECT_GE(stats.frames, static_cast<unsigned long>(MAX_LINES / MAX_LINES_PER_FRAME));
+  EXPECT_LT(stats.maxTime, FRAME_TIME);
+
+  QTextBlock last = widget.document()->lastBlock();
+  EXPECT_EQ(line(NUM_LINES - 1), last.previous().text().toStdString());
+}
+
+TEST_F(ConsoleWidgetTest, ctrlCCancelsCommand) {
+  FrameScheduler scheduler;
+  ConsoleWidget widget(*m_appConfig, scheduler, "> ", {}, 100, 10);
+
+  widget.addStreamingCommand("yes", [](const ConsoleWidget::ArgList&, ConsoleOutput& output) {
+    while (!output.cancelled()) {
+      output.writeLine("y");
+    }
+  });
+
+  enterCommand(widget, "yes");
+
+  QEventLoop loop;
+  QTimer::singleShot(10000, &loop, SLOT(quit()));
+
+  int frames = 0;
+
+  FrameScheduler::Handle hSampler = scheduler.add("sampler", 1000 / 60, [&]() {
+    if (++frames == 5) {
+      sendKey(widget, Qt::Key_C, Qt::ControlModifier);
+    }
+    else if (frames > 5 && showingPrompt(widget)) {
+      loop.quit();
+    }
+  }, FrameScheduler::PRIORITY_LOW);
+
+  loop.exec();
+
+  ASSERT_TRUE(showingPrompt(widget)) << "Command wasn't cancelled";
+  EXPECT_LE(widget.document()->blockCount(), 100);
+}
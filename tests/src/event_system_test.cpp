@@ -0,0 +1,186 @@
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <event_system.hpp>
+#include "alloc_counter.hpp"
+
+
+using std::string;
+using std::vector;
+
+
+class EventSystemTest : public testing::Test {
+  public:
+    virtual void SetUp() override {
+      eventSystem.reset(new EventSystem);
+    }
+
+    virtual void TearDown() override {
+      eventSystem.reset();
+    }
+
+    // Calls the handlers directly, as EventSystem::event() does for events taken off the Qt queue
+    void processEvent(const Event& event) {
+      eventSystem->processEvent(event);
+    }
+
+    std::shared_ptr<EventSystem> eventSystem;
+};
+
+
+TEST_F(EventSystemTest, handlersReceiveEventsWithTheirPrefix) {
+  vector<string> calls;
+
+  EventHandle h0 = eventSystem->listen("", [&](const Event&) { calls.push_back("root"); });
+  EventHandle h1 = eventSystem->listen("a", [&](const Event&) { calls.push_back("a"); });
+  EventHandle h2 = eventSystem->listen("a.b", [&](const Event&) { calls.push_back("a.b"); });
+  EventHandle h3 = eventSystem->listen("a.c", [&](const Event&) { calls.push_back("a.c"); });
+  EventHandle h4 = eventSystem->listen("ab", [&](const Event&) { calls.push_back("ab"); });
+
+  processEvent(Event("a.b.d"));
+
+  ASSERT_EQ(3, calls.size());
+  ASSERT_EQ("root", calls[0]);
+  ASSERT_EQ("a", calls[1]);
+  ASSERT_EQ("a.b", calls[2]);
+}
+
+TEST_F(EventSystemTest, handlersAreCalledInOrderAdded) {
+  vector<int> calls;
+  vector<EventHandle> handles;
+
+  for (int i = 0; i < 10; ++i) {
+    handles.push_back(eventSystem->listen("x", [&calls, i](const Event&) {
+      calls.push_back(i);
+    }));
+  }
+
+  // Forget enough to force compaction
+  for (int i = 0; i < 10; i += 2) {
+    handles[i].forget();
+  }
+  for (int i = 10; i < 12; ++i) {
+    handles.push_back(eventSystem->listen("x", [&calls, i](const Event&) {
+      calls.push_back(i);
+    }));
+  }
+
+  processEvent(Event("x"));
+
+  vector<int> expected{1, 3, 5, 7, 9, 10, 11};
+  ASSERT_EQ(expected, calls);
+}
+
+TEST_F(EventSystemTest, changesDuringDispatchAreDeferred) {
+  int numCalls = 0;
+  int numLateCalls = 0;
+
+  EventHandle hLate;
+  EventHandle hSecond;
+
+  EventHandle hFirst = eventSystem->listen("e", [&](const Event&) {
+    ++numCalls;
+    hSecond.forget();
+
+    hLate = eventSystem->listen("e", [&](const Event&) {
+      ++numLateCalls;
+    });
+  });
+
+  hSecond = eventSystem->listen("e", [&](const Event&) {
+    ++numCalls;
+  });
+
+  processEvent(Event("e"));
+
+  ASSERT_EQ(2, numCalls);
+  ASSERT_EQ(0, numLateCalls);
+
+  hFirst.forget();
+  processEvent(Event("e"));
+
+  ASSERT_EQ(2, numCalls);
+  ASSERT_EQ(1, numLateCalls);
+}
+
+TEST_F(EventSystemTest, steadyStateDispatchDoesNotAllocate) {
+  const int DEPTH = 5;
+  const int BRANCHING = 2;
+  const int NUM_LISTENERS = 1000;
+  const int NUM_EVENTS = 100000;
+
+  // Every node in a five-level hierarchy of names, e.g. "n1.n0.n1.n1.n0"
+  vector<string> names;
+  vector<string> level{""};
+  for (int d = 0; d < DEPTH; ++d) {
+    vector<string> next;
+
+    for (const string& parent : level) {
+      for (int b = 0; b < BRANCHING; ++b) {
+        string name = (parent.empty() ? "" : parent + ".") + "n" + std::to_string(b);
+
+        next.push_back(name);
+        names.push_back(name);
+      }
+    }
+
+    level = next;
+  }
+
+  vector<Event> events;
+  for (const string& leaf : level) {
+    events.push_back(Event(leaf));
+  }
+
+  vector<long> hits(NUM_LISTENERS, 0);
+  vector<string> listenerNames;
+  vector<EventHandle> handles;
+
+  for (int i = 0; i < NUM_LISTENERS; ++i) {
+    const string& name = names[i % names.size()];
+    long* counter = &hits[i];
+
+    listenerNames.push_back(name);
+    handles.push_back(eventSystem->listen(name, [counter](const Event&) {
+      ++(*counter);
+    }));
+  }
+
+  // Warm up, so every name has been seen
+  for (const Event& event : events) {
+    processEvent(event);
+  }
+
+  numAllocations = 0;
+  countAllocations = true;
+
+  for (int i = 0; i < NUM_EVENTS; ++i) {
+    processEvent(events[i % events.size()]);
+  }
+
+  countAllocations = false;
+
+  ASSERT_EQ(0, numAllocations);
+
+  long expected = 0;
+  for (int i = 0; i < NUM_LISTENERS; ++i) {
+    const string& prefix = listenerNames[i];
+
+    for (size_t e = 0; e < events.size(); ++e) {
+      const string& name = events[e].name;
+
+      if (name.compare(0, prefix.length(), prefix) == 0) {
+        long timesFired = NUM_EVENTS / events.size() + (e < NUM_EVENTS % events.size() ? 1 : 0);
+        expected += timesFired + 1;
+      }
+    }
+  }
+
+  long total = 0;
+  for (long n : hits) {
+    total += n;
+  }
+
+  ASSERT_EQ(expected, total);
+}
@@ -0,0 +1,112 @@
+#include <memory>
+#include <string>
+#include <gtest/gtest.h>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QTimer>
+#include <frame_scheduler.hpp>
+
+
+using std::string;
+
+
+class FrameSchedulerTest : public testing::Test {
+  public:
+    static void SetUpTestCase() {
+      m_app = new QCoreApplication(m_argc, m_argv);
+    }
+
+    static void TearDownTestCase() {
+      delete m_app;
+    }
+
+    virtual void SetUp() override {}
+
+    virtual void TearDown() override {}
+
+  protected:
+    static void runEventLoop(int ms) {
+      QEventLoop loop;
+      QTimer::singleShot(ms, &loop, SLOT(quit()));
+      loop.exec();
+    }
+
+    static int m_argc;
+    static char* m_argv[];
+    static QCoreApplication* m_app;
+};
+
+int FrameSchedulerTest::m_argc = 1;
+char* FrameSchedulerTest::m_argv[] = { const_cast<char*>("unitTests"), nullptr };
+QCoreApplication* FrameSchedulerTest::m_app = nullptr;
+
+TEST_F(FrameSchedulerTest, clientCanRemoveItselfWhileRunning) {
+  FrameScheduler scheduler;
+
+  int selfCalls = 0;
+  int otherCalls = 0;
+  size_t payloadSize = 0;
+
+  // Big enough that std::function keeps the closure on the heap, so that were it destroyed
+  // mid-call, reading the payload afterwards would be a use after free
+  string payload(256, 'x');
+  FrameScheduler::Handle self;
+
+  self = scheduler.add("self", 0, [&, payload]() {
+    ++selfCalls;
+    self.forget();
+    payloadSize = payload.size();
+  });
+
+  FrameScheduler::Handle other = scheduler.add("other", 0, [&]() {
+    ++otherCalls;
+  }, FrameScheduler::PRIORITY_LOW);
+
+  runEventLoop(50);
+
+  EXPECT_EQ(1, selfCalls);
+  EXPECT_EQ(256u, payloadSize);
+  EXPECT_GT(otherCalls, 1);
+  EXPECT_EQ(1, scheduler.numActive());
+  ASSERT_EQ(1u, scheduler.stats().size());
+  EXPECT_EQ("other", scheduler.stats()[0].name);
+}
+
+TEST_F(FrameSchedulerTest, clientCanRemoveAnotherWhileRunning) {
+  FrameScheduler scheduler;
+
+  int firstCalls = 0;
+  int secondCalls = 0;
+
+  FrameScheduler::Handle second;
+
+  FrameScheduler::Handle first = scheduler.add("first", 0, [&]() {
+    ++firstCalls;
+    second.forget();
+  }, FrameScheduler::PRIORITY_HIGH);
+
+  second = scheduler.add("second", 0, [&]() {
+    ++secondCalls;
+  }, FrameScheduler::PRIORITY_LOW);
+
+  runEventLoop(50);
+
+  EXPECT_GT(firstCalls, 0);
+  EXPECT_EQ(0, secondCalls);
+  EXPECT_EQ(1, scheduler.numActive());
+}
+
+TEST_F(FrameSchedulerTest, handleSurvivesMoveToItself) {
+  FrameScheduler scheduler;
+
+  FrameScheduler::Handle handle = scheduler.add("client", 10, []() {});
+  FrameScheduler::Handle& alias = handle;
+
+  handle = std::move(alias);
+
+  EXPECT_EQ(1, scheduler.numActive());
+
+  handle.forget();
+
+  EXPECT_EQ(0, scheduler.numActive());
+}
@@ -1,6 +1,12 @@
+#include <random>
+#include <vector>
 #include <gtest/gtest.h>
 #include <raycast/geometry.hpp>
 #include <utils.hpp>
+#include "alloc_counter.hpp"
+
+
+using std::vector;
 
 
 class GeometryTest : public testing::Test {
@@ -8,6 +14,102 @@ class GeometryTest : public testing::Test {
     virtual void SetUp() override {}
 
     virtual void TearDown() override {}
+
+    // Segments anywhere in a 2000 x 2000 square, a fifth of them vertical and a fifth horizontal,
+    // as walls often are
+    static LineSegment randomSegment(std::mt19937& randEngine) {
+      std::uniform_real_distribution<double> randCoord(-1000.0, 1000.0);
+      std::uniform_int_distribution<int> randKind(0, 4);
+
+      Point A(randCoord(randEngine), randCoord(randEngine));
+      Point B(randCoord(randEngine), randCoord(randEngine));
+
+      switch (randKind(randEngine)) {
+        case 0: B.x = A.x; break;
+        case 1: B.y = A.y; break;
+      }
+
+      return LineSegment(A, B);
+    }
+
+    // Parameters of the intersection of A0 + t(B0 - A0) and A1 + u(B1 - A1), worked out in
+    // extended precision. Returns false if the lines are parallel.
+    static bool referenceIntersect(const LineSegment& l0, const LineSegment& l1, long double& t,
+      long double& u) {
+
+      long double rx = static_cast<long double>(l0.B.x) - l0.A.x;
+      long double ry = static_cast<long double>(l0.B.y) - l0.A.y;
+      long double sx = static_cast<long double>(l1.B.x) - l1.A.x;
+      long double sy = static_cast<long double>(l1.B.y) - l1.A.y;
+      long double qx = static_cast<long double>(l1.A.x) - l0.A.x;
+      long double qy = static_cast<long double>(l1.A.y) - l0.A.y;
+
+      long double denom = rx * sy - ry * sx;
+      if (denom == 0) {
+        return false;
+      }
+
+      t = (qx * sy - qy * sx) / denom;
+      u = (qx * ry - qy * rx) / denom;
+
+      return true;
+    }
+
+    // The sine of the angle between two segments
+    static double sinAngle(const LineSegment& l0, const LineSegment& l1) {
+      Vec2f r = l0.B - l0.A;
+      Vec2f s = l1.B - l1.A;
+
+      return fabs(crossProduct(r, s)) / (length(r) * length(s));
+    }
+
+    // How lineIntersect used to cope with steep lines, kept for comparison
+    static Point legacyLineIntersect(const Line& l0, const Line& l1, int depth = 0) {
+      if (l0.hasSteepGradient() || l1.hasSteepGradient()) {
+        static Matrix m(0.25 * PI, Vec2f(0, 0));
+        static Matrix m_inv = legacyInverse(m);
+
+        Vec3f l0params_ = Vec3f(l0.a, l0.b, l0.c) * m_inv;
+        Vec3f l1params_ = Vec3f(l1.a, l1.b, l1.c) * m_inv;
+
+        Line l0_(l0params_.x, l0params_.y, l0params_.z);
+        Line l1_(l1params_.x, l1params_.y, l1params_.z);
+
+        if (depth == 0 && (l0_.hasSteepGradient() || l1_.hasSteepGradient())) {
+          Point p = legacyLineIntersect(l0_, l1_, depth + 1);
+          Vec3f p_ = Vec3f(p.x, p.y, 0) * m;
+          return Point(p_.x, p_.y);
+        }
+
+        Vec3f p;
+        p.x = (l1_.b * l0_.c - l0_.b * l1_.c) / (l0_.b * l1_.a - l1_.b * l0_.a);
+        p.y = (-l0_.a * p.x - l0_.c) / l0_.b;
+        p = p * m;
+
+        return Point(p.x, p.y);
+      }
+
+      Point p;
+      p.x = (l1.b * l0.c - l0.b * l1.c) / (l0.b * l1.a - l1.b * l0.a);
+      p.y = (-l0.a * p.x - l0.c) / l0.b;
+
+      return p;
+    }
+
+    // How Matrix::inverse used to work for every matrix, kept for comparison
+    static Matrix legacyInverse(const Matrix& A) {
+      Matrix m;
+      double det_rp = 1.0 / A.determinant();
+
+      for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+          int sign = (row + col) % 2 == 0 ? 1.0 : -1.0;
+          m[col][row] = sign * det_rp * A.minor(row, col);
+        }
+      }
+
+      return m;
+    }
 };
 
 
@@ -228,3 +330,298 @@ TEST_F(GeometryTest, normaliseAngle_neg0) {
 TEST_F(GeometryTest, normaliseAngle_wrap0) {
   ASSERT_DOUBLE_EQ(1.23, normaliseAngle(2.0 * PI + 1.23));
 }
+
+TEST_F(GeometryTest, matrixInverse_affine) {
+  std::mt19937 randEngine(77);
+  std::uniform_real_distribution<double> randAngle(-PI, PI);
+  std::uniform_real_distribution<double> randCoord(-1000.0, 1000.0);
+  std::uniform_real_distribution<double> randScale(0.1, 10.0);
+
+  for (int i = 0; i < 1000; ++i) {
+    Matrix m(randAngle(randEngine), Vec2f(randCoord(randEngine), randCoord(randEngine)));
+
+    if (i % 2 == 0) {
+      Matrix scale;
+      scale[0][0] = randScale(randEngine);
+      scale[1][1] = randScale(randEngine);
+      m = m * scale;
+    }
+
+    Matrix expected = legacyInverse(m);
+    Matrix inv = m.inverse();
+    Matrix I = m * inv;
+
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col) {
+        ASSERT_NEAR(expected[row][col], inv[row][col], 1e-9);
+        ASSERT_NEAR(row == col ? 1.0 : 0.0, I[row][col], 1e-9);
+      }
+    }
+  }
+}
+
+TEST_F(GeometryTest, matrixInverse_projective) {
+  Matrix m;
+  m.data = {{
+    {{2.0, 1.0, 3.0}},
+    {{0.0, 1.0, 4.0}},
+    {{1.0, 0.0, 2.0}}
+  }};
+
+  Matrix I = m * m.inverse();
+
+  for (int row = 0; row < 3; ++row) {
+    for (int col = 0; col < 3; ++col) {
+      ASSERT_NEAR(row == col ? 1.0 : 0.0, I[row][col], 1e-12);
+    }
+  }
+}
+
+TEST_F(GeometryTest, rigidTransform_matchesMatrix) {
+  std::mt19937 randEngine(78);
+  std::uniform_real_distribution<double> randAngle(-PI, PI);
+  std::uniform_real_distribution<double> randCoord(-1000.0, 1000.0);
+
+  auto randPoint = [&]() {
+    return Point(randCoord(randEngine), randCoord(randEngine));
+  };
+
+  for (int i = 0; i < 1000; ++i) {
+    double a = randAngle(randEngine);
+    double b = randAngle(randEngine);
+    Vec2f ta = randPoint();
+    Vec2f tb = randPoint();
+    Point p = randPoint();
+
+    RigidTransform A(a, ta);
+    RigidTransform B(b, tb);
+    Matrix mA(a, ta);
+    Matrix mB(b, tb);
+
+    ASSERT_NEAR(a, A.a(), 1e-12);
+    ASSERT_TRUE(pointsEqual(mA * p, A * p, 1e-9));
+    ASSERT_TRUE(pointsEqual(mA.inverse() * p, A.inverse() * p, 1e-9));
+    ASSERT_TRUE(pointsEqual((mA * mB) * p, (A * B) * p, 1e-9));
+    ASSERT_TRUE(pointsEqual(p, A.inverse() * (A * p), 1e-9));
+
+    Matrix m = A.matrix();
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col) {
+        ASSERT_DOUBLE_EQ(mA[row][col], m[row][col]);
+      }
+    }
+  }
+}
+
+TEST_F(GeometryTest, lineIntersect_matchesReference) {
+  std::mt19937 randEngine(79);
+  int numChecked = 0;
+
+  for (int i = 0; i < 100000; ++i) {
+    LineSegment l0 = randomSegment(randEngine);
+    LineSegment l1 = randomSegment(randEngine);
+
+    long double t = 0;
+    long double u = 0;
+    if (!referenceIntersect(l0, l1, t, u) || sinAngle(l0, l1) < 0.01 || fabs(t) > 100.0) {
+      continue;
+    }
+
+    long double x = l0.A.x + t * (static_cast<long double>(l0.B.x) - l0.A.x);
+    long double y = l0.A.y + t * (static_cast<long double>(l0.B.y) - l0.A.y);
+
+    Point p = lineIntersect(l0.line(), l1.line());
+
+    ASSERT_NEAR(static_cast<double>(x), p.x, 1e-6) << l0 << ", " << l1;
+    ASSERT_NEAR(static_cast<double>(y), p.y, 1e-6) << l0 << ", " << l1;
+
+    ++numChecked;
+  }
+
+  ASSERT_GT(numChecked, 50000);
+}
+
+TEST_F(GeometryTest, lineSegmentIntersect_matchesReference) {
+  std::mt19937 randEngine(80);
+
+  // Cases this close to an end point could go either way
+  const long double MARGIN = 1e-9;
+
+  int numHits = 0;
+  int numMisses = 0;
+
+  for (int i = 0; i < 200000; ++i) {
+    LineSegment l0 = randomSegment(randEngine);
+    LineSegment l1 = randomSegment(randEngine);
+
+    // Half the pairs share an end point
+    if (i % 2 == 0) {
+      l1.A = l0.B;
+    }
+
+    long double t = 0;
+    long double u = 0;
+    bool parallel = !referenceIntersect(l0, l1, t, u);
+
+    Point p;
+    bool hit = lineSegmentIntersect(l0, l1, p);
+
+    if (parallel) {
+      ASSERT_FALSE(hit) << l0 << ", " << l1;
+      continue;
+    }
+
+    bool inside = t >= MARGIN && t <= 1 - MARGIN && u >= MARGIN && u <= 1 - MARGIN;
+    bool outside = t < -1e-3 || t > 1 + 1e-3 || u < -1e-3 || u > 1 + 1e-3;
+
+    if (inside || (i % 2 == 0 && !outside)) {
+      ASSERT_TRUE(hit) << l0 << ", " << l1;
+
+      long double x = l0.A.x + t * (static_cast<long double>(l0.B.x) - l0.A.x);
+      long double y = l0.A.y + t * (static_cast<long double>(l0.B.y) - l0.A.y);
+
+      ASSERT_NEAR(static_cast<double>(x), p.x, 1e-6) << l0 << ", " << l1;
+      ASSERT_NEAR(static_cast<double>(y), p.y, 1e-6) << l0 << ", " << l1;
+
+      ++numHits;
+    }
+    else if (outside) {
+      ASSERT_FALSE(hit) << l0 << ", " << l1;
+      ++numMisses;
+    }
+  }
+
+  ASSERT_GT(numHits, 100000);
+  ASSERT_GT(numMisses, 50000);
+}
+
+TEST_F(GeometryTest, raySegmentIntersect_matchesReference) {
+  std::mt19937 randEngine(81);
+  std::uniform_real_distribution<double> randAngle(-PI, PI);
+
+  const long double MARGIN = 1e-9;
+
+  int numHits = 0;
+  int numMisses = 0;
+
+  for (int i = 0; i < 100000; ++i) {
+    LineSegment lseg = randomSegment(randEngine);
+    Point origin = randomSegment(randEngine).A;
+    double a = randAngle(randEngine);
+    Vec2f dir(cos(a), sin(a));
+
+    long double t = 0;
+    long double u = 0;
+    if (!referenceIntersect(LineSegment(origin, origin + dir), lseg, t, u)) {
+      continue;
+    }
+
+    double t_ = 0;
+    bool hit = raySegmentIntersect(origin, dir, lseg, t_);
+
+    if (t >= MARGIN && u >= MARGIN && u <= 1 - MARGIN) {
+      ASSERT_TRUE(hit) << origin << ", " << dir << ", " << lseg;
+      ASSERT_NEAR(static_cast<double>(t), t_, 1e-6);
+      ++numHits;
+    }
+    else if (t < -1e-3 || u < -1e-3 || u > 1 + 1e-3) {
+      ASSERT_FALSE(hit) << origin << ", " << dir << ", " << lseg;
+      ++numMisses;
+    }
+  }
+
+  ASSERT_GT(numHits, 10000);
+  ASSERT_GT(numMisses, 10000);
+}
+
+TEST_F(GeometryTest, batchedIntersections_matchScalar) {
+  std::mt19937 randEngine(82);
+  std::uniform_real_distribution<double> randAngle(-PI, PI);
+
+  vector<LineSegment> walls;
+  for (int i = 0; i < 2000; ++i) {
+    walls.push_back(randomSegment(randEngine));
+  }
+
+  vector<SegmentHit> hits;
+
+  for (int i = 0; i < 200; ++i) {
+    LineSegment lseg = randomSegment(randEngine);
+
+    hits.clear();
+    lineSegmentIntersections(lseg, walls.data(), walls.size(), hits);
+
+    size_t h = 0;
+    for (size_t j = 0; j < walls.size(); ++j) {
+      Point p;
+      if (lineSegmentIntersect(lseg, walls[j], p)) {
+        ASSERT_LT(h, hits.size());
+        ASSERT_EQ(j, hits[h].idx);
+        ASSERT_TRUE(pointsEqual(p, hits[h].point, 1e-9));
+        ++h;
+      }
+    }
+    ASSERT_EQ(h, hits.size());
+
+    double a = randAngle(randEngine);
+    Vec2f dir(cos(a), sin(a));
+
+    hits.clear();
+    raySegmentIntersections(lseg.A, dir, walls.data(), walls.size(), hits);
+
+    h = 0;
+    for (size_t j = 0; j < walls.size(); ++j) {
+      double t = 0;
+      if (raySegmentIntersect(lseg.A, dir, walls[j], t)) {
+        ASSERT_LT(h, hits.size());
+        ASSERT_EQ(j, hits[h].idx);
+        ASSERT_DOUBLE_EQ(t, hits[h].t);
+        ++h;
+      }
+    }
+    ASSERT_EQ(h, hits.size());
+  }
+}
+
+TEST_F(GeometryTest, batchedIntersections_reuseHitBuffer) {
+  std::mt19937 randEngine(83);
+
+  vector<LineSegment> walls;
+  for (int i = 0; i < 1000; ++i) {
+    walls.push_back(randomSegment(randEngine));
+  }
+
+  vector<LineSegment> rays;
+  for (int i = 0; i < 1000; ++i) {
+    rays.push_back(randomSegment(randEngine));
+  }
+
+  // Grow the buffer to the most hits any ray will produce
+  vector<SegmentHit> hits;
+  for (const LineSegment& ray : rays) {
+    hits.clear();
+    lineSegmentIntersections(ray, walls.data(), walls.size(), hits);
+    hits.clear();
+    raySegmentIntersections(ray.A, ray.B - ray.A, walls.data(), walls.size(), hits);
+  }
+
+  size_t numHits = 0;
+
+  numAllocations = 0;
+  countAllocations = true;
+
+  for (const LineSegment& ray : rays) {
+    hits.clear();
+    lineSegmentIntersections(ray, walls.data(), walls.size(), hits);
+    numHits += hits.size();
+
+    hits.clear();
+    raySegmentIntersections(ray.A, ray.B - ray.A, walls.data(), walls.size(), hits);
+    numHits += hits.size();
+  }
+
+  countAllocations = false;
+
+  ASSERT_GT(numHits, 0u);
+  ASSERT_EQ(0, numAllocations);
+}
@@ -0,0 +1,263 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <QApplication>
+#include <QImage>
+#include <map_generator.hpp>
+#include <bench_world.hpp>
+#include <raycast/entity_manager.hpp>
+#include <raycast/game_event.hpp>
+#include <raycast/time_service.hpp>
+#include <app_config.hpp>
+#include "alloc_counter.hpp"
+
+
+using std::string;
+using std::vector;
+
+
+// In debug builds the factories print a line for every object they construct
+class SilenceStdout {
+  public:
+    SilenceStdout()
+      : m_buf(std::cout.rdbuf(nullptr)) {}
+
+    ~SilenceStdout() {
+      std::cout.rdbuf(m_buf);
+    }
+
+  private:
+    std::streambuf* m_buf;
+};
+
+enum class Growth {
+  LINEAR,
+  N_LOG_N
+};
+
+// Costs are counted rather than timed, so they're the same on every run
+struct Sample {
+  // Objects in the map: zones, edges, sprites and agents
+  double size;
+  double loadAllocations;
+  double bytes;
+  double tickAllocations;
+};
+
+static MapSpec makeSpec(int districts) {
+  MapSpec spec;
+  spec.seed = 7;
+  spec.districts = districts;
+  // Bodies look for walls from two zones above their own, so at depth 2 every move would
+  // search the whole map
+  spec.depth = 3;
+  spec.branching = 2;
+  spec.wallSegments = 2;
+  spec.sprites = 8 * districts;
+  spec.doors = 2 * districts;
+  spec.agents = 4 * districts;
+
+  return spec;
+}
+
+class MapGeneratorTest : public testing::Test {
+  public:
+    virtual void SetUp() override {}
+
+    virtual void TearDown() override {}
+};
+
+class MapScalingTest : public testing::Test {
+  public:
+    static void SetUpTestCase() {
+      qputenv("QT_QPA_PLATFORM", "offscreen");
+
+      char tmpl[] = "/tmp/procalc_scaling_XXXXXX";
+      const char* tmpDir = mkdtemp(tmpl);
+      ASSERT_NE(nullptr, tmpDir);
+      m_tmpDir = tmpDir;
+
+      m_app = new QApplication(m_argc, m_argv);
+      m_appConfig = new AppConfig(m_argc, m_argv, m_tmpDir);
+    }
+
+    static void TearDownTestCase() {
+      delete m_appConfig;
+      delete m_app;
+
+      std::system(("rm -rf '" + m_tmpDir + "'").c_str());
+    }
+
+    virtual void SetUp() override {}
+
+    virtual void TearDown() override {}
+
+  protected:
+    static string mapPath(int districts) {
+      return m_tmpDir + "/map_" + std::to_string(districts) + ".svg";
+    }
+
+    static Sample measure(int districts) {
+      const int WARM_UP_TICKS = 5;
+      const int TICKS = 20;
+
+      MapSpec spec = makeSpec(districts);
+      string path = mapPath(districts);
+      MapStats stats = generateMap(spec, path);
+
+      Sample sample;
+      sample.size = stats.zones + stats.joins + stats.walls + stats.sprites + stats.agents;
+
+      QImage target(320, 240, QImage::Format_ARGB32);
+      BenchWorld world(*m_appConfig, target, 60);
+
+      SilenceStdout silence;
+
+      long bytesBefore = liveBytes;
+      numAllocations = 0;
+      countAllocations = true;
+
+      world.loadMap(path);
+
+      countAllocations = false;
+      sample.loadAllocations = numAllocations;
+      sample.bytes = liveBytes - bytesBefore;
+
+      EntityManager& entityManager = world.entityManager();
+      entityManager.broadcastEvent(GameEvent(PATROL_TRIGGER));
+
+      // Agents plan their routes when they start moving, so the first few ticks aren't counted
+      for (int i = 0; i < WARM_UP_TICKS; ++i) {
+        world.tick();
+      }
+
+      numAllocations = 0;
+      countAllocations = true;
+
+      for (int i = 0; i < TICKS; ++i) {
+        world.tick();
+      }
+
+      countAllocations = false;
+      // Plus one, so a tick that allocates nothing still has a logarithm
+      sample.tickAllocations = 1.0 + static_cast<double>(numAllocations) / TICKS;
+
+      std::remove(path.c_str());
+
+      return sample;
+    }
+
+    static double bound(Growth growth, double n) {
+      return growth == Growth::LINEAR ? n : n * std::log(n);
+    }
+
+    // The slope of the least squares line through (log bound(n), log cost). A cost that grows
+    // exactly as the bound has slope 1.
+    static double growthExponent(const vector<Sample>& samples, Growth growth,
+      double Sample::*cost) {
+
+      double n = samples.size();
+      double sx = 0, sy = 0, sxx = 0, sxy = 0;
+
+      for (const Sample& s : samples) {
+        double x = std::log(bound(growth, s.size));
+        double y = std::log(s.*cost);
+
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+      }
+
+      return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    }
+
+    static int m_argc;
+    static char* m_argv[];
+    static string m_tmpDir;
+    static QApplication* m_app;
+    static AppConfig* m_appConfig;
+};
+
+int MapScalingTest::m_argc = 1;
+char* MapScalingTest::m_argv[] = { const_cast<char*>("unitTests"), nullptr };
+string MapScalingTest::m_tmpDir;
+QApplication* MapScalingTest::m_app = nullptr;
+AppConfig* MapScalingTest::m_appConfig = nullptr;
+
+TEST_F(MapGeneratorTest, sameSeedGivesSameMap) {
+  MapSpec spec = makeSpec(3);
+
+  std::stringstream ss1;
+  std::stringstream ss2;
+  generateMap(spec, ss1);
+  generateMap(spec, ss2);
+
+  EXPECT_EQ(ss1.str(), ss2.str());
+
+  spec.seed += 1;
+
+  std::stringstream ss3;
+  generateMap(spec, ss3);
+
+  EXPECT_NE(ss1.str(), ss3.str());
+}
+
+TEST_F(MapGeneratorTest, statsMatchSpec) {
+  MapSpec spec = makeSpec(2);
+
+  std::stringstream ss;
+  MapStats stats = generateMap(spec, ss);
+
+  // 2 districts, each holding 4 zones of 4 rooms
+  EXPECT_EQ(32, stats.rooms);
+  EXPECT_EQ(1 + 2 + 8 + 32 + spec.doors, stats.zones);
+  EXPECT_EQ(4 * (2 + 8) + 32 + 4 * spec.doors, stats.joins);
+  EXPECT_EQ(spec.sprites, stats.sprites);
+  EXPECT_EQ(spec.doors, stats.doors);
+  EXPECT_EQ(spec.agents, stats.agents);
+}
+
+TEST_F(MapGeneratorTest, invalidSpecThrows) {
+  std::stringstream ss;
+
+  MapSpec spec = makeSpec(1);
+  spec.depth = 0;
+  EXPECT_THROW(generateMap(spec, ss), std::invalid_argument);
+
+  spec = makeSpec(1);
+  spec.doors = 17;
+  EXPECT_THROW(generateMap(spec, ss), std::invalid_argument);
+}
+
+// Declared bounds, in the number of objects in the map:
+//   load time  O(n log n)  The factories and systems keep their components in std::maps
+//   memory     O(n)
+//   tick cost  O(n log n)  Agents are spread evenly, so there are O(n) of them, each of whose
+//                          moves looks up components and searches a bounded part of the map
+//
+// Load time and tick cost are stood in for by the number of allocations, which track the work
+// done without the noise of wall-clock timings. Pairing up zones and regions by comparing every
+// soft edge with every other, as was once done, copies a std::function for each zone visited per
+// soft edge, so its allocations grow quadratically and would fail the load check.
+TEST_F(MapScalingTest, loadTimeMemoryAndTickCostScale) {
+  const double TOLERANCE = 0.25;
+
+  vector<Sample> samples;
+  for (int districts : { 4, 8, 16, 32 }) {
+    samples.push_back(measure(districts));
+  }
+
+  double loadExp = growthExponent(samples, Growth::N_LOG_N, &Sample::loadAllocations);
+  double memoryExp = growthExponent(samples, Growth::LINEAR, &Sample::bytes);
+  double tickExp = growthExponent(samples, Growth::N_LOG_N, &Sample::tickAllocations);
+
+  EXPECT_LE(loadExp, 1.0 + TOLERANCE) << "Load time grows faster than O(n log n)";
+  EXPECT_LE(memoryExp, 1.0 + TOLERANCE) << "Memory grows faster than O(n)";
+  EXPECT_LE(tickExp, 1.0 + TOLERANCE) << "Tick cost grows faster than O(n log n)";
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <fragments/f_main/f_app_dialog/f_minesweeper/minesweeper_board.hpp>
+#include "alloc_counter.hpp"
+
+
+using std::vector;
+using doomsweeper::Coord;
+using doomsweeper::MinesweeperBoard;
+
+
+class MinesweeperBoardTest : public testing::Test {
+  public:
+    virtual void SetUp() override {}
+
+    virtual void TearDown() override {}
+};
+
+
+TEST_F(MinesweeperBoardTest, countsAndMines) {
+  std::mt19937 randEngine(1);
+  MinesweeperBoard board(8, 8);
+
+  board.placeMines(24, {Coord{0, 0}, Coord{7, 7}}, randEngine);
+
+  ASSERT_EQ(24, board.numMines());
+  ASSERT_EQ(24, board.mines().size());
+  ASSERT_FALSE(board.isMine(Coord{0, 0}));
+  ASSERT_FALSE(board.isMine(Coord{7, 7}));
+
+  for (int r = 0; r < 8; ++r) {
+    for (int c = 0; c < 8; ++c) {
+      int n = 0;
+
+      for (int i = r - 1; i <= r + 1; ++i) {
+        for (int j = c - 1; j <= c + 1; ++j) {
+          if ((i != r || j != c) && i >= 0 && i < 8 && j >= 0 && j < 8
+            && board.isMine(Coord{i, j})) {
+
+            ++n;
+          }
+        }
+      }
+
+      ASSERT_EQ(n, board.count(Coord{r, c}));
+    }
+  }
+}
+
+TEST_F(MinesweeperBoardTest, revealStopsAtNumbersAndFlags) {
+  std::mt19937 randEngine(1);
+  MinesweeperBoard board(5, 5);
+
+  // A single mine in the corner
+  vector<Coord> exclude;
+  for (int r = 0; r < 5; ++r) {
+    for (int c = 0; c < 5; ++c) {
+      if (r != 4 || c != 4) {
+        exclude.push_back(Coord{r, c});
+      }
+    }
+  }
+  board.placeMines(1, exclude, randEngine);
+  ASSERT_EQ(Coord({4, 4}), board.mines()[0]);
+
+  board.setFlagged(Coord{0, 4}, true);
+
+  vector<Coord> revealed;
+  int n = board.reveal(Coord{0, 0}, &revealed);
+
+  // Everything except the mine and the flagged cell
+  ASSERT_EQ(23, n);
+  ASSERT_EQ(23, revealed.size());
+  ASSERT_FALSE(board.isRevealed(Coord{4, 4}));
+  ASSERT_FALSE(board.isRevealed(Coord{0, 4}));
+  ASSERT_TRUE(board.isRevealed(Coord{3, 3}));
+
+  // Revealing a cell again picks up neighbours that have since been unflagged
+  board.setFlagged(Coord{0, 4}, false);
+  ASSERT_EQ(1, board.reveal(Coord{1, 3}));
+  ASSERT_TRUE(board.isRevealed(Coord{0, 4}));
+}
+
+TEST_F(MinesweeperBoardTest, noGuessBoardsAreSolvable) {
+  std::mt19937 randEngine(2);
+  MinesweeperBoard board(30, 16);
+
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_TRUE(board.placeMinesNoGuess(99, Coord{15, 8}, {}, randEngine));
+    ASSERT_EQ(99, board.numMines());
+    ASSERT_EQ(0, board.count(Coord{15, 8}));
+    ASSERT_TRUE(board.isSolvable(Coord{15, 8}));
+  }
+}
+
+TEST_F(MinesweeperBoardTest, solverNeedsAGuessForFiftyFifty) {
+  std::mt19937 randEngine(1);
+  MinesweeperBoard board(2, 3);
+
+  // Mine at (1, 2). Revealing (0, 0) opens up the column next to it, but the last column holds
+  // one mine in two cells either way.
+  vector<Coord> exclude{Coord{0, 0}, Coord{0, 1}, Coord{0, 2}, Coord{1, 0}, Coord{1, 1}};
+  board.placeMines(1, exclude, randEngine);
+
+  ASSERT_FALSE(board.isSolvable(Coord{0, 0}));
+}
+
+// A large board is generated without guesses and every safe cell revealed, as a player who
+// never guesses would. Revealing reuses the board's queue, which checking the board was solvable
+// has already grown to fit, so however many cells open up, nothing is allocated.
+TEST_F(MinesweeperBoardTest, largeBoardRevealsWithoutAllocating) {
+  const int SIZE = 300;
+  const int MINES = SIZE * SIZE * 15 / 100;
+
+  std::mt19937 randEngine(1234);
+  MinesweeperBoard board(SIZE, SIZE);
+  Coord start{SIZE / 2, SIZE / 2};
+
+  ASSERT_TRUE(board.placeMinesNoGuess(MINES, start, {}, randEngine));
+  ASSERT_EQ(MINES, board.numMines());
+
+  numAllocations = 0;
+  countAllocations = true;
+
+  int numRevealed = 0;
+  for (int r = 0; r < SIZE; ++r) {
+    for (int c = 0; c < SIZE; ++c) {
+      Coord cell{r, c};
+
+      if (!board.isMine(cell) && !board.isRevealed(cell)) {
+        numRevealed += board.reveal(cell);
+      }
+    }
+  }
+
+  countAllocations = false;
+
+  ASSERT_EQ(SIZE * SIZE - MINES, numRevealed);
+  ASSERT_EQ(0, numAllocations);
+}
@@ -12,3 +12,145 @@ class SpatialSystemTest : public testing::Test {
 
     virtual void TearDown() override {}
 };
+
+static Intersection makeIntersection(CSpatialKind kind, entityId_t id, double distance,
+  entityId_t zoneA, entityId_t zoneB) {
+
+  Intersection X(kind, kind);
+  X.entityId = id;
+  X.distanceFromOrigin = distance;
+  X.zoneA = zoneA;
+  X.zoneB = zoneB;
+
+  return X;
+}
+
+TEST_F(SpatialSystemTest, orderByZoneChain_0) {
+  IntersectionBuffer buffer;
+
+  buffer.add(makeIntersection(CSpatialKind::HARD_EDGE, 3, 3.0, 2, 2));
+  buffer.add(makeIntersection(CSpatialKind::SOFT_EDGE, 1, 1.0, 1, 2));
+  buffer.add(makeIntersection(CSpatialKind::V_RECT, 2, 2.0, 2, 2));
+  buffer.add(makeIntersection(CSpatialKind::V_RECT, 0, 0.5, 1, 1));
+
+  buffer.orderByZoneChain(1);
+  IntersectionSpan results = buffer.results();
+
+  ASSERT_EQ(4u, results.size());
+  EXPECT_EQ(0, results[0].entityId);
+  EXPECT_EQ(1, results[1].entityId);
+  EXPECT_EQ(2, results[2].entityId);
+  EXPECT_EQ(3, results[3].entityId);
+}
+
+TEST_F(SpatialSystemTest, orderByZoneChain_1) {
+  IntersectionBuffer buffer;
+
+  // Nearer, but in a zone the ray has not yet entered
+  buffer.add(makeIntersection(CSpatialKind::V_RECT, 0, 0.5, 2, 2));
+  buffer.add(makeIntersection(CSpatialKind::SOFT_EDGE, 1, 1.0, 1, 2));
+  buffer.add(makeIntersection(CSpatialKind::HARD_EDGE, 2, 2.0, 2, 2));
+  // Beyond the hard edge
+  buffer.add(makeIntersection(CSpatialKind::V_RECT, 3, 3.0, 2, 2));
+
+  buffer.orderByZoneChain(1);
+  IntersectionSpan results = buffer.results();
+
+  ASSERT_EQ(3u, results.size());
+  EXPECT_EQ(1, results[0].entityId);
+  EXPECT_EQ(0, results[1].entityId);
+  EXPECT_EQ(2, results[2].entityId);
+}
+
+TEST_F(SpatialSystemTest, orderByZoneChain_2) {
+  IntersectionBuffer buffer;
+
+  buffer.add(makeIntersection(CSpatialKind::V_RECT, 0, 1.0, 1, 1));
+  buffer.orderByZoneChain(1);
+  ASSERT_EQ(1u, buffer.results().size());
+
+  buffer.clear();
+  buffer.add(makeIntersection(CSpatialKind::V_RECT, 0, 1.0, 5, 5));
+  buffer.orderByZoneChain(1);
+  EXPECT_TRUE(buffer.results().empty());
+}
+
+TEST_F(SpatialSystemTest, assignResults_0) {
+  IntersectionBuffer src;
+
+  src.add(makeIntersection(CSpatialKind::V_RECT, 0, 0.5, 2, 2));
+  src.add(makeIntersection(CSpatialKind::SOFT_EDGE, 1, 1.0, 1, 2));
+  src.add(makeIntersection(CSpatialKind::HARD_EDGE, 2, 2.0, 2, 2));
+  src.orderByZoneChain(1);
+
+  IntersectionBuffer buffer;
+
+  buffer.assignResults(src, 1.5);
+  IntersectionSpan results = buffer.results();
+
+  ASSERT_EQ(2u, results.size());
+  EXPECT_EQ(1, results[0].entityId);
+  EXPECT_EQ(0, results[1].entityId);
+
+  // The ray wouldn't have reached the soft edge, so wouldn't have entered zone 2
+  buffer.assignResults(src, 0.8);
+  EXPECT_TRUE(buffer.results().empty());
+}
+
+TEST_F(SpatialSystemTest, assignResults_1) {
+  const std::vector<Intersection> intersections = {
+    makeIntersection(CSpatialKind::V_RECT, 0, 0.5, 1, 1),
+    makeIntersection(CSpatialKind::SOFT_EDGE, 1, 1.0, 1, 2),
+    // Nearer than the soft edges, but only reached through them
+    makeIntersection(CSpatialKind::V_RECT, 2, 0.8, 2, 2),
+    makeIntersection(CSpatialKind::V_RECT, 3, 1.2, 3, 3),
+    makeIntersection(CSpatialKind::SOFT_EDGE, 4, 2.0, 2, 3),
+    makeIntersection(CSpatialKind::V_RECT, 5, 1.5, 2, 2),
+    makeIntersection(CSpatialKind::HARD_EDGE, 6, 3.0, 3, 3),
+    // Never reached
+    makeIntersection(CSpatialKind::V_RECT, 7, 0.1, 4, 4)
+  };
+
+  IntersectionBuffer src;
+  for (const Intersection& X : intersections) {
+    src.add(X);
+  }
+  src.orderByZoneChain(1);
+
+  // Each distance limit should give the same results as a query cast with that limit, i.e. only
+  // the intersections within it, ordered by zone chain
+  for (double maxDistance : { 0.4, 0.6, 0.9, 1.3, 1.6, 2.5, 3.5 }) {
+    IntersectionBuffer expected;
+    for (const Intersection& X : intersections) {
+      if (X.distanceFromOrigin <= maxDistance) {
+        expected.add(X);
+      }
+    }
+    expected.orderByZoneChain(1);
+
+    IntersectionBuffer buffer;
+    buffer.assignResults(src, maxDistance);
+
+    IntersectionSpan actualResults = buffer.results();
+    IntersectionSpan expectedResults = expected.results();
+
+    ASSERT_EQ(expectedResults.size(), actualResults.size()) << maxDistance;
+
+    for (size_t i = 0; i < expectedResults.size(); ++i) {
+      EXPECT_EQ(expectedResults[i].entityId, actualResults[i].entityId) << maxDistance;
+    }
+  }
+
+  IntersectionBuffer buffer;
+  buffer.assignResults(src, 2.5);
+  IntersectionSpan results = buffer.results();
+
+  // The sprite at 1.2 comes after the soft edge at 2.0 in chain order
+  ASSERT_EQ(6u, results.size());
+  EXPECT_EQ(0, results[0].entityId);
+  EXPECT_EQ(1, results[1].entityId);
+  EXPECT_EQ(2, results[2].entityId);
+  EXPECT_EQ(5, results[3].entityId);
+  EXPECT_EQ(4, results[4].entityId);
+  EXPECT_EQ(3, results[5].entityId);
+}
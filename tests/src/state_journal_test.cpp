@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <gtest/gtest.h>
+#include <state_journal.hpp>
+
+
+using std::string;
+using std::vector;
+using std::map;
+
+
+class StateJournalTest : public testing::Test {
+  public:
+    virtual void SetUp() override {
+      char tmpl[] = "/tmp/procalc_journal_XXXXXX";
+      const char* tmpDir = mkdtemp(tmpl);
+      ASSERT_NE(nullptr, tmpDir);
+      dir = tmpDir;
+      basePath = dir + "/procalc";
+    }
+
+    virtual void TearDown() override {
+      std::system(("rm -rf '" + dir + "'").c_str());
+    }
+
+    static string readFile(const string& path) {
+      std::ifstream fin(path, std::ios::binary);
+      std::stringstream ss;
+      ss << fin.rdbuf();
+      return ss.str();
+    }
+
+    static void writeFile(const string& path, const string& data) {
+      std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+      fout.write(data.data(), data.length());
+    }
+
+    string dir;
+    string basePath;
+};
+
+
+TEST_F(StateJournalTest, roundTrip) {
+  {
+    StateJournal journal(basePath);
+    ASSERT_FALSE(journal.load());
+
+    journal.set("state-id", "3");
+    journal.set("password", "");
+    journal.set("binary", string("a\0b\xff", 4));
+    journal.commit();
+
+    journal.set("state-id", "4");
+    journal.commit();
+  }
+
+  StateJournal journal(basePath);
+  ASSERT_TRUE(journal.load());
+
+  map<string, string> expected{
+    {"state-id", "4"},
+    {"password", ""},
+    {"binary", string("a\0b\xff", 4)}
+  };
+
+  ASSERT_EQ(expected, journal.state());
+}
+
+TEST_F(StateJournalTest, uncommittedChangesAreLost) {
+  {
+    StateJournal journal(basePath);
+    journal.load();
+
+    journal.set("a", "1");
+    journal.commit();
+    journal.set("a", "2");
+  }
+
+  StateJournal journal(basePath);
+  journal.load();
+
+  ASSERT_EQ("1", journal.state().at("a"));
+}
+
+TEST_F(StateJournalTest, compactionPreservesState) {
+  map<string, string> expected;
+
+  {
+    StateJournal journal(basePath);
+    journal.load();
+
+    for (int i = 0; i < 5000; ++i) {
+      string name = "param" + std::to_string(i % 37);
+      string value = std::to_string(i);
+
+      journal.set(name, value);
+      journal.commit();
+
+      expected[name] = value;
+    }
+  }
+
+  // With the small number of params, the journal will have been compacted many times
+  ASSERT_LT(readFile(basePath + ".journal").length(), 2u * 64 * 1024);
+
+  StateJournal journal(basePath);
+  journal.load();
+  ASSERT_EQ(expected, journal.state());
+}
+
+TEST_F(StateJournalTest, crashDuringCompactionIsHarmless) {
+  map<string, string> expected;
+
+  {
+    StateJournal journal(basePath);
+    journal.load();
+
+    journal.set("a", "1");
+    journal.set("b", "2");
+    // Big enough to compact the journal as soon as it's committed
+    journal.set("c", string(64 * 1024, 'x'));
+    journal.commit();
+
+    ASSERT_EQ(0u, readFile(basePath + ".journal").length());
+
+    journal.set("a", "3");
+    journal.commit();
+
+    expected = journal.state();
+  }
+
+  // A snapshot that was never renamed into place
+  writeFile(basePath + ".snapshot.tmp", "garbage");
+
+  StateJournal journal(basePath);
+  journal.load();
+  ASSERT_EQ(expected, journal.state());
+}
+
+TEST_F(StateJournalTest, recoversConsistentPrefixAfterCrash) {
+  const int NUM_CHANGES = 1000;
+  const int NUM_CRASHES = 300;
+
+  std::mt19937 randEngine(1234);
+  std::uniform_int_distribution<int> randParam(0, 19);
+  std::uniform_int_distribution<int> randLength(0, 40);
+  std::uniform_int_distribution<int> randChar(0, 255);
+
+  // The state after each change, and the size of the journal once it's written
+  vector<map<string, string>> states{{}};
+  vector<size_t> offsets{0};
+
+  {
+    StateJournal journal(basePath);
+    journal.load();
+
+    for (int i = 0; i < NUM_CHANGES; ++i) {
+      string name = "param" + std::to_string(randParam(randEngine));
+      string value;
+
+      int len = randLength(randEngine);
+      for (int j = 0; j < len; ++j) {
+        value.push_back(static_cast<char>(randChar(randEngine)));
+      }
+
+      journal.set(name, value);
+      journal.commit();
+
+      if (journal.state() != states.back()) {
+        states.push_back(journal.state());
+        offsets.push_back(readFile(basePath + ".journal").length());
+      }
+    }
+  }
+
+  string full = readFile(basePath + ".journal");
+  ASSERT_EQ(offsets.back(), full.length());
+
+  std::uniform_int_distribution<size_t> randOffset(0, full.length());
+
+  for (int i = 0; i < NUM_CRASHES; ++i) {
+    size_t offset = randOffset(randEngine);
+    string torn = full.substr(0, offset);
+
+    // Sometimes the crash leaves junk behind rather than just cutting the file short
+    if (i % 3 == 0) {
+      for (int j = 0; j < 12; ++j) {
+        torn.push_back(static_cast<char>(randChar(randEngine)));
+      }
+    }
+
+    std::remove((basePath + ".snapshot").c_str());
+    writeFile(basePath + ".journal", torn);
+
+    size_t k = std::upper_bound(offsets.begin(), offsets.end(), offset) - offsets.begin() - 1;
+
+    StateJournal journal(basePath);
+    journal.load();
+
+    ASSERT_EQ(states[k], journal.state()) << "Crash at byte " << offset;
+
+    // The torn tail mustn't get in the way of later changes
+    journal.set("after", "crash");
+    journal.commit();
+
+    StateJournal reloaded(basePath);
+    reloaded.load();
+
+    map<string, string> expected = states[k];
+    expected["after"] = "crash";
+
+    ASSERT_EQ(expected, reloaded.state()) << "Crash at byte " << offset;
+  }
+}
+
+// Each commit appends just the records for what changed, however many values there are, where
+// AppConfig used to rewrite the whole document
+TEST_F(StateJournalTest, commitWritesOnlyChanges) {
+  const int NUM_CALLS = 10000;
+  const int NUM_PARAMS = 50;
+
+  {
+    StateJournal journal(basePath);
+    journal.load();
+
+    for (int i = 0; i < NUM_CALLS; ++i) {
+      string name = "param" + std::to_string(i % NUM_PARAMS);
+      string value = std::to_string(i);
+
+      size_t before = readFile(basePath + ".journal").length();
+
+      journal.set(name, value);
+      journal.commit();
+
+      size_t after = readFile(basePath + ".journal").length();
+
+      // Unless the commit compacted the journal, it grew by one record: the length, checksum,
+      // name length, name and value
+      if (after != 0) {
+        ASSERT_EQ(before + 12 + name.length() + value.length(), after);
+      }
+    }
+  }
+
+  StateJournal journal(basePath);
+  journal.load();
+
+  ASSERT_EQ(static_cast<size_t>(NUM_PARAMS), journal.state().size());
+  ASSERT_EQ(std::to_string(NUM_CALLS - 1), journal.state().at("param49"));
+}
@@ -0,0 +1,223 @@
+#include <regex>
+#include <map>
+#include <gtest/gtest.h>
+#include <fragments/f_main/f_settings_dialog/f_config_maze/text_grammar.hpp>
+#include "alloc_counter.hpp"
+
+
+using std::string;
+using std::vector;
+using std::map;
+
+
+struct RuleDef {
+  string name;
+  string text1;
+  string text2;
+};
+
+// The rules used by AreYouSureWidget
+static const vector<RuleDef> RULES = {
+  {"not", "not", ""},
+  {"sureYou", "<not,0-3>sure you", ""},
+  {"sureYouAre", "<sureYou,1-1>are", ""},
+  {"sureYou_", "<sureYouAre,0-1><sureYou,1-1>", ""},
+  {"sureYouWantTo", "<sureYou_,1-1>want to", ""},
+  {"continue", "continue", "proceed"},
+  {"verb", "<not,0-3><continue,1-1>", "<not,0-3>abort"},
+  {"continuing", "continuing", "proceeding"},
+  {"ing", "<not,0-3><continuing,1-1>", "<not,0-3>aborting"},
+  {"continueTo", "<continue,1-1><ingTo,1-1>", "<continueTo,1-1><verbTo,1-1>"},
+  {"verbTo", "<continueTo,1-1>", "abort <ingTo,1-1>"},
+  {"ingTo", "<ingIng,1-1><continuing,1-1>to", ""},
+  {"ingVerbIng", "<ingTo,1-1><verbIng,1-1>", ""},
+  {"ingIng", "<ing,1-2><ingVerbIng,0-1>", ""},
+  {"verbIng", "<verb,1-1><ingIng,1-1>", ""},
+  {"verbVerb", "<verbTo,1-1><verb,1-1>", ""},
+  {"verb_", "<verbIng,1-1>", "<verbVerb,1-1>"},
+  {"question", "Are you sure you are <sureYouWantTo,1-1><verb_,1-1>", ""}
+};
+
+
+// The regex-based generator TextGrammar replaced, kept as a reference
+class LegacyTemplate {
+  public:
+    typedef map<string, LegacyTemplate> TemplateMap;
+
+    LegacyTemplate(const string& text1, const string& text2)
+      : text1(text1),
+        text2(text2) {}
+
+    LegacyTemplate() {}
+
+    string generate(std::mt19937& randEngine, const TemplateMap& templates, int maxDepth) const {
+      if (text2.length() > 0) {
+        std::uniform_int_distribution<int> flipCoin(0, 1);
+        int coin = flipCoin(randEngine);
+
+        const string& text = (coin == 0 ? text1 : text2);
+        const string& altText = (coin == 1 ? text1 : text2);
+
+        string result = generate_(randEngine, templates, text, maxDepth);
+        if (result.length() == 0) {
+          return generate_(randEngine, templates, altText, maxDepth);
+        }
+        return result;
+      }
+      else {
+        return generate_(randEngine, templates, text1, maxDepth);
+      }
+    }
+
+    string text1;
+    string text2;
+
+  private:
+    string generate_(std::mt19937& randEngine, const TemplateMap& templates, const string& text,
+      int maxDepth) const {
+
+      if (maxDepth < 0) {
+        return "";
+      }
+
+      std::regex rx("<(\\w+),(\\d+)-(\\d+)>");
+      auto begin = std::sregex_iterator(text.begin(), text.end(), rx);
+      auto end = std::sregex_iterator();
+
+      string result = text;
+      int offset = 0;
+
+      for (auto it = begin; it != end; ++it) {
+        std::smatch m = *it;
+        string name = m.str(1);
+        int minReps = std::atoi(m.str(2).c_str());
+        int maxReps = std::atoi(m.str(3).c_str());
+
+        std::uniform_int_distribution<int> randReps(minReps, maxReps);
+        int reps = randReps(randEngine);
+
+        string expanded;
+        for (int rep = 0; rep < reps; ++rep) {
+          string subresult = templates.at(name).generate(randEngine, templates, maxDepth - 1);
+          if (subresult.length() == 0 && minReps > 0) {
+            return "";
+          }
+
+          expanded += subresult;
+        }
+
+        result.replace(m.position() + offset, m.length(), expanded);
+        offset += static_cast<int>(expanded.length() - m.length());
+      }
+
+      if (result.back() != ' ') {
+        result.push_back(' ');
+      }
+
+      return result;
+    }
+};
+
+
+class TextGrammarTest : public testing::Test {
+  public:
+    virtual void SetUp() override {
+      for (const RuleDef& def : RULES) {
+        grammar.addRule(def.name, def.text1, def.text2);
+        legacy[def.name] = LegacyTemplate(def.text1, def.text2);
+      }
+    }
+
+    virtual void TearDown() override {}
+
+    TextGrammar grammar;
+    LegacyTemplate::TemplateMap legacy;
+};
+
+
+TEST_F(TextGrammarTest, literalsAndReferences) {
+  TextGrammar g;
+  g.addRule("a", "x<b,2-2>y <c,1-1>");
+  g.addRule("b", "b");
+  g.addRule("c", "<not a ref,1-1>");
+
+  std::mt19937 randEngine(0);
+
+  ASSERT_EQ("xb b y <not a ref,1-1> ", g.generate("a", randEngine, 5));
+}
+
+TEST_F(TextGrammarTest, failsWhenDepthIsExhausted) {
+  TextGrammar g;
+  g.addRule("a", "a<a,1-1>");
+  g.addRule("b", "b<a,0-1>");
+
+  std::mt19937 randEngine(0);
+
+  ASSERT_EQ("", g.generate("a", randEngine, 8));
+
+  string out = "prefix";
+  ASSERT_FALSE(g.generate("a", randEngine, 8, out));
+  ASSERT_EQ("prefix", out);
+
+  string b = g.generate("b", randEngine, 8);
+  ASSERT_EQ(0, b.find("b"));
+}
+
+TEST_F(TextGrammarTest, matchesLegacyGeneratorForFixedSeed) {
+  std::mt19937 engineA(1234);
+  std::mt19937 engineB(1234);
+
+  for (int i = 0; i < 200; ++i) {
+    int maxDepth = 6 + i % 8;
+
+    string expected = legacy.at("question").generate(engineA, legacy, maxDepth);
+    string actual = grammar.generate("question", engineB, maxDepth);
+
+    ASSERT_EQ(expected, actual) << "Iteration " << i;
+  }
+
+  ASSERT_EQ(engineA(), engineB());
+}
+
+// Once the output buffer and the expansion stack have grown to fit, generating text allocates
+// nothing. The second pass draws the same texts as the first, so it needs no more room.
+TEST_F(TextGrammarTest, generateReusesBuffers) {
+  const int NUM_TEXTS = 10000;
+  const int MAX_DEPTH = 14;
+
+  string out;
+
+  auto generateAll = [&](size_t& totalLength) {
+    std::mt19937 randEngine(1234);
+
+    int numGenerated = 0;
+    totalLength = 0;
+
+    for (int i = 0; i < NUM_TEXTS; ++i) {
+      out.clear();
+
+      if (grammar.generate("question", randEngine, MAX_DEPTH, out)) {
+        totalLength += out.length();
+        ++numGenerated;
+      }
+    }
+
+    return numGenerated;
+  };
+
+  size_t firstLength = 0;
+  int firstGenerated = generateAll(firstLength);
+
+  numAllocations = 0;
+  countAllocations = true;
+
+  size_t secondLength = 0;
+  int secondGenerated = generateAll(secondLength);
+
+  countAllocations = false;
+
+  ASSERT_GT(firstGenerated, 0);
+  ASSERT_EQ(firstGenerated, secondGenerated);
+  ASSERT_EQ(firstLength, secondLength);
+  ASSERT_EQ(0, numAllocations);
+}
@@ -0,0 +1,205 @@
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <texture_baker.hpp>
+#include <image.hpp>
+
+
+using std::string;
+using std::vector;
+
+
+static const vector<string> PATTERN_NAMES{ "white", "value", "perlin", "worley", "brick", "panel" };
+
+
+class TextureBakerTest : public testing::Test {
+  public:
+    virtual void SetUp() override {}
+
+    virtual void TearDown() override {}
+
+    static BakeSpec makeSpec(Pattern pattern, int w, int h) {
+      BakeSpec spec;
+      spec.pattern = pattern;
+      spec.width = w;
+      spec.height = h;
+      spec.seed = 123;
+      spec.cells = 6;
+      spec.dark = Rgb{30, 20, 10};
+      spec.light = Rgb{220, 160, 120};
+
+      return spec;
+    }
+
+    static int colourDiff(const Rgb& a, const Rgb& b) {
+      return std::abs(a.r - b.r) + std::abs(a.g - b.g) + std::abs(a.b - b.b);
+    }
+
+    // The average difference between pixels in column x0 and column x1
+    static double columnDiff(const Image& img, int x0, int x1) {
+      double sum = 0;
+      for (int y = 0; y < img.height; ++y) {
+        sum += colourDiff(img.pixel(x0, y), img.pixel(x1, y));
+      }
+
+      return sum / img.height;
+    }
+
+    // The average difference between pixels in row y0 and row y1
+    static double rowDiff(const Image& img, int y0, int y1) {
+      double sum = 0;
+      for (int x = 0; x < img.width; ++x) {
+        sum += colourDiff(img.pixel(x, y0), img.pixel(x, y1));
+      }
+
+      return sum / img.width;
+    }
+
+    // When tiled, the seam where the last column meets the first should look like the other
+    // edges between lattice cells, bricks or panels. Likewise for rows.
+    static void assertSeamless(const Image& img, int periodX, int periodY) {
+      double colSum = 0;
+      int numCols = 0;
+      for (int x = periodX; x < img.width; x += periodX) {
+        colSum += columnDiff(img, x - 1, x);
+        ++numCols;
+      }
+
+      double rowSum = 0;
+      int numRows = 0;
+      for (int y = periodY; y < img.height; y += periodY) {
+        rowSum += rowDiff(img, y - 1, y);
+        ++numRows;
+      }
+
+      double colSeam = columnDiff(img, img.width - 1, 0);
+      double rowSeam = rowDiff(img, img.height - 1, 0);
+
+      ASSERT_NEAR(colSum / numCols, colSeam, 0.5 * colSum / numCols + 2.0);
+      ASSERT_NEAR(rowSum / numRows, rowSeam, 0.5 * rowSum / numRows + 2.0);
+    }
+};
+
+
+TEST_F(TextureBakerTest, patternsContinuePastEdges) {
+  const int W = 150;
+  const int H = 90;
+
+  for (const string& name : PATTERN_NAMES) {
+    Pattern pattern = parsePattern(name);
+
+    BakeSpec spec = makeSpec(pattern, W, H);
+    Image img = bake(spec, 2);
+
+    for (int i = 0; i < 3; ++i) {
+      for (int y = 0; y < H; ++y) {
+        ASSERT_LE(colourDiff(img.pixel(i, y), samplePixel(spec, W + i, y)), 3)
+          << name << " at " << i << ", " << y;
+        ASSERT_LE(colourDiff(img.pixel(W - 1 - i, y), samplePixel(spec, -1 - i, y)), 3)
+          << name << " at " << -1 - i << ", " << y;
+      }
+
+      for (int x = 0; x < W; ++x) {
+        ASSERT_LE(colourDiff(img.pixel(x, i), samplePixel(spec, x, H + i)), 3)
+          << name << " at " << x << ", " << i;
+        ASSERT_LE(colourDiff(img.pixel(x, H - 1 - i), samplePixel(spec, x, -1 - i)), 3)
+          << name << " at " << x << ", " << -1 - i;
+      }
+    }
+  }
+}
+
+TEST_F(TextureBakerTest, edgesWrapWithoutDiscontinuity) {
+  for (const string& name : PATTERN_NAMES) {
+    Pattern pattern = parsePattern(name);
+
+    if (pattern == Pattern::WHITE) {
+      continue;
+    }
+
+    // Cells and panels of 16x16 pixels, and bricks of 16x8
+    int periodX = 16;
+    int periodY = pattern == Pattern::BRICK ? 8 : 16;
+
+    for (int seed = 0; seed < 5; ++seed) {
+      BakeSpec spec = makeSpec(pattern, 128, 64);
+      spec.cells = 8;
+      spec.seed = seed;
+
+      Image img = bake(spec, 2);
+      assertSeamless(img, periodX, periodY);
+
+      vector<Image> mips = mipChain(img);
+      assertSeamless(mips[0], periodX / 2, periodY / 2);
+    }
+  }
+}
+
+TEST_F(TextureBakerTest, sameOutputForAnyNumberOfThreads) {
+  for (const string& name : PATTERN_NAMES) {
+    Pattern pattern = parsePattern(name);
+
+    BakeSpec spec = makeSpec(pattern, 200, 130);
+
+    Image a = bake(spec, 1);
+    Image b = bake(spec, 4);
+
+    ASSERT_EQ(a.data, b.data);
+
+    spec.seed += 1;
+    Image c = bake(spec, 4);
+
+    ASSERT_NE(a.data, c.data);
+  }
+}
+
+TEST_F(TextureBakerTest, mipChainHalvesDownToOnePixel) {
+  BakeSpec spec = makeSpec(Pattern::PERLIN, 64, 16);
+  Image img = bake(spec);
+
+  vector<Image> mips = mipChain(img);
+
+  ASSERT_EQ(6u, mips.size());
+  ASSERT_EQ(32, mips[0].width);
+  ASSERT_EQ(8, mips[0].height);
+  ASSERT_EQ(4, mips[3].width);
+  ASSERT_EQ(1, mips[3].height);
+  ASSERT_EQ(1, mips[5].width);
+  ASSERT_EQ(1, mips[5].height);
+
+  // Each level averages the one above
+  const Image& last = mips[5];
+  const Image& prev = mips[4];
+
+  Rgb expected{
+    static_cast<uint8_t>((prev.pixel(0, 0).r + prev.pixel(1, 0).r + 1) / 2),
+    static_cast<uint8_t>((prev.pixel(0, 0).g + prev.pixel(1, 0).g + 1) / 2),
+    static_cast<uint8_t>((prev.pixel(0, 0).b + prev.pixel(1, 0).b + 1) / 2)
+  };
+
+  ASSERT_LE(colourDiff(expected, last.pixel(0, 0)), 3);
+}
+
+// Timings are left to the noise tool, which is built optimised, e.g.
+//   noise 4096 4096 --pattern perlin --cells 32 --time
+TEST_F(TextureBakerTest, everyPatternBakesWithFullMipChain) {
+  const int SIZE = 256;
+
+  for (const string& name : PATTERN_NAMES) {
+    Pattern pattern = parsePattern(name);
+
+    BakeSpec spec = makeSpec(pattern, SIZE, SIZE);
+    spec.cells = 8;
+
+    Image img = bake(spec);
+    ASSERT_EQ(SIZE, img.width) << name;
+    ASSERT_EQ(SIZE, img.height) << name;
+
+    vector<Image> mips = mipChain(img);
+
+    ASSERT_EQ(8u, mips.size()) << name;
+    ASSERT_EQ(1, mips.back().width) << name;
+    ASSERT_EQ(1, mips.back().height) << name;
+  }
+}
@@ -0,0 +1,390 @@
+#include <cassert>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <QApplication>
+#include <QImage>
+#include <bench_world.hpp>
+#include <raycast/spatial_system.hpp>
+#include <raycast/render_system.hpp>
+#include <app_config.hpp>
+
+
+using std::string;
+using std::vector;
+
+
+namespace {
+
+// In debug builds the factories print a line for every object they construct
+class SilenceStdout {
+  public:
+    SilenceStdout()
+      : m_buf(std::cout.rdbuf(nullptr)) {}
+
+    ~SilenceStdout() {
+      std::cout.rdbuf(m_buf);
+    }
+
+  private:
+    std::streambuf* m_buf;
+};
+
+// Entity IDs differ each time a map is loaded, so they're numbered in the order they're first
+// seen, which is the same for both loads
+class IdNumbering {
+  public:
+    int operator()(entityId_t id) {
+      if (id == -1) {
+        return -1;
+      }
+
+      auto it = m_ids.find(id);
+      if (it == m_ids.end()) {
+        it = m_ids.insert(std::make_pair(id, static_cast<int>(m_ids.size()))).first;
+      }
+
+      return it->second;
+    }
+
+  private:
+    std::map<entityId_t, int> m_ids;
+};
+
+//===========================================
+// forEachZone
+//
+// fn can return false to abort the loop
+//===========================================
+bool forEachZone(CZone& zone, std::function<bool(CZone&)> fn) {
+  if (fn(zone)) {
+    for (auto& child : zone.children) {
+      if (!forEachZone(*child, fn)) {
+        break;
+      }
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+//===========================================
+// forEachRegion
+//
+// fn can return false to abort the loop
+//===========================================
+bool forEachRegion(CRegion& region, std::function<bool(CRegion&)> fn) {
+  if (fn(region)) {
+    for (auto& child : region.children) {
+      if (!forEachRegion(*child, fn)) {
+        break;
+      }
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+// Pairs soft edges by comparing every one with every other, as SpatialSystem did before
+// candidates were looked up by grid cell and join ID
+class ExhaustiveSpatialSystem : public SpatialSystem {
+  public:
+    using SpatialSystem::SpatialSystem;
+
+  protected:
+    void connectSubzones(CZone& zone) override {
+      int i = 0;
+      forEachZone(zone, [&](CZone& r) {
+        for (auto it = r.edges.begin(); it != r.edges.end(); ++it) {
+          if ((*it)->kind == CSpatialKind::SOFT_EDGE) {
+            CSoftEdge* se = dynamic_cast<CSoftEdge*>(it->get());
+            assert(se != nullptr);
+
+            bool hasTwin = false;
+            int j = 0;
+            forEachZone(zone, [&](CZone& r_) {
+              for (auto lt = r_.edges.begin(); lt != r_.edges.end(); ++lt) {
+                if ((*lt)->kind == CSpatialKind::SOFT_EDGE) {
+                  CSoftEdge* other = dynamic_cast<CSoftEdge*>(lt->get());
+
+                  if (other != se) {
+                    if (areTwins(*se, *other)) {
+                      hasTwin = true;
+
+                      se->joinId = other->joinId;
+                      se->zoneA = &r;
+                      se->zoneB = &r_;
+                      se->lseg = other->lseg;
+                      se->twinId = other->entityId();
+
+                      other->zoneA = &r_;
+                      other->zoneB = &r;
+                      other->twinId = se->entityId();
+
+                      return false;
+                    }
+
+                    // If they're already joined by id (i.e. portals)
+                    if (se->joinId != -1 && se->joinId == other->joinId) {
+                      hasTwin = true;
+
+                      se->zoneA = &r;
+                      se->zoneB = &r_;
+                      se->twinId = other->entityId();
+
+                      double a = other->lseg.angle() - se->lseg.angle();
+
+                      Matrix toOrigin(0, -se->lseg.A);
+                      Matrix rotate(a, Vec2f(0, 0));
+                      Matrix translate(0, other->lseg.A);
+                      Matrix m = translate * rotate * toOrigin;
+
+                      se->toTwin = m;
+
+                      other->zoneA = &r_;
+                      other->zoneB = &r;
+                      other->twinId = se->entityId();
+                      other->toTwin = m.inverse();
+                      other->lseg.A = m * se->lseg.A;
+                      other->lseg.B = m * se->lseg.B;
+
+                      return false;
+                    }
+                  }
+                }
+              }
+
+              if (j > i) {
+                return false;
+              }
+
+              ++j;
+              return true;
+            });
+
+            if (!hasTwin) {
+              assert(r.parent != nullptr);
+
+              se->zoneA = &r;
+              se->zoneB = r.parent;
+            }
+          }
+        }
+
+        ++i;
+        return true;
+      });
+    }
+};
+
+// Pairs each join by comparing it with every join in the preceding regions, as RenderSystem did
+// before joins were kept in a map by ID
+class ExhaustiveRenderSystem : public RenderSystem {
+  public:
+    using RenderSystem::RenderSystem;
+
+  protected:
+    void connectSubregions(const SpatialSystem& spatialSystem, CRegion& region) override {
+      auto joinIdOf = [&](const CJoin& join) {
+        return dynamic_cast<const CSoftEdge&>(spatialSystem.getComponent(join.entityId())).joinId;
+      };
+
+      int i = 0;
+      forEachRegion(region, [&](CRegion& r) {
+        for (auto jt = r.boundaries.begin(); jt != r.boundaries.end(); ++jt) {
+          if ((*jt)->kind == CRenderKind::JOIN) {
+            CJoin* je = dynamic_cast<CJoin*>(*jt);
+            assert(je != nullptr);
+
+            entityId_t id1 = joinIdOf(*je);
+
+            bool hasTwin = false;
+            int j = 0;
+            forEachRegion(region, [&](CRegion& r_) {
+              if (j >= i) {
+                return false;
+              }
+
+              for (auto lt = r_.boundaries.begin(); lt != r_.boundaries.end(); ++lt) {
+                if ((*lt)->kind == CRenderKind::JOIN) {
+                  CJoin* other = dynamic_cast<CJoin*>(*lt);
+
+                  if (id1 == joinIdOf(*other)) {
+                    hasTwin = true;
+
+                    je->joinId = other->joinId;
+                    je->regionA = other->regionA = &r;
+                    je->regionB = other->regionB = &r_;
+
+                    je->mergeIn(*other);
+                    other->mergeIn(*je);
+
+                    return false;
+                  }
+                }
+              }
+
+              ++j;
+              return true;
+            });
+
+            if (!hasTwin) {
+              je->regionA = &r;
+              je->regionB = &region;
+            }
+          }
+        }
+
+        ++i;
+        return true;
+      });
+    }
+};
+
+}
+
+class ZoneConnectionTest : public testing::Test {
+  public:
+    static void SetUpTestCase() {
+      qputenv("QT_QPA_PLATFORM", "offscreen");
+
+      char tmpl[] = "/tmp/procalc_zones_XXXXXX";
+      const char* saveDir = mkdtemp(tmpl);
+      ASSERT_NE(nullptr, saveDir);
+      m_saveDir = saveDir;
+
+      m_app = new QApplication(m_argc, m_argv);
+      m_appConfig = new AppConfig(m_argc, m_argv, m_saveDir);
+    }
+
+    static void TearDownTestCase() {
+      delete m_appConfig;
+      delete m_app;
+
+      std::system(("rm -rf '" + m_saveDir + "'").c_str());
+    }
+
+  protected:
+    // Loads the map and describes every soft edge and join, in scene graph order, with the
+    // twin, zones, regions and join ID it was given. If exhaustive is set, the spatial and render
+    // systems are swapped for ones that connect zones and regions by the reference search.
+    static vector<string> describeConnections(const string& mapFile, bool exhaustive) {
+      QImage target(320, 240, QImage::Format_ARGB32);
+      BenchWorld world(*m_appConfig, target, 60);
+
+      if (exhaustive) {
+        EntityManager& entityManager = world.entityManager();
+
+        entityManager.addSystem(ComponentKind::C_SPATIAL,
+          pSystem_t(new ExhaustiveSpatialSystem(entityManager, world.timeService(), 60)));
+        entityManager.addSystem(ComponentKind::C_RENDER,
+          pSystem_t(new ExhaustiveRenderSystem(*m_appConfig, entityManager, target)));
+      }
+
+      {
+        SilenceStdout silence;
+        world.loadMap(mapFile);
+      }
+
+      EntityManager& entityManager = world.entityManager();
+      auto& spatialSystem = entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
+      auto& renderSystem = entityManager.system<RenderSystem>(ComponentKind::C_RENDER);
+
+      IdNumbering id;
+      vector<string> lines;
+
+      std::function<void(const CZone&)> describeZone = [&](const CZone& zone) {
+        for (auto& edge : zone.edges) {
+          if (edge->kind == CSpatialKind::SOFT_EDGE) {
+            const CSoftEdge& se = dynamic_cast<const CSoftEdge&>(*edge);
+
+            std::stringstream ss;
+            ss << "soft edge " << id(se.entityId()) << " in zone " << id(zone.entityId())
+              << ": twin " << id(se.twinId)
+              << ", zones " << (se.zoneA ? id(se.zoneA->entityId()) : -1)
+              << "/" << (se.zoneB ? id(se.zoneB->entityId()) : -1)
+              << ", join " << id(se.joinId)
+              << ", " << se.lseg << ", toTwin " << se.toTwin;
+
+            lines.push_back(ss.str());
+          }
+        }
+
+        for (auto& child : zone.children) {
+          describeZone(*child);
+        }
+      };
+
+      std::function<void(const CRegion&)> describeRegion = [&](const CRegion& region) {
+        for (const CBoundary* b : region.boundaries) {
+          if (b->kind == CRenderKind::JOIN) {
+            const CJoin& join = dynamic_cast<const CJoin&>(*b);
+
+            std::stringstream ss;
+            ss << "join " << id(join.entityId()) << " in region " << id(region.entityId())
+              << ": regions " << (join.regionA ? id(join.regionA->entityId()) : -1)
+              << "/" << (join.regionB ? id(join.regionB->entityId()) : -1)
+              << ", join " << id(join.joinId)
+              << ", textures " << join.topTexture << "/" << join.bottomTexture;
+
+            lines.push_back(ss.str());
+          }
+        }
+
+        for (auto& child : region.children) {
+          describeRegion(*child);
+        }
+      };
+
+      describeZone(*spatialSystem.sg.rootZone);
+      describeRegion(*renderSystem.rg.rootRegion);
+
+      return lines;
+    }
+
+    static int m_argc;
+    static char* m_argv[];
+    static string m_saveDir;
+    static QApplication* m_app;
+    static AppConfig* m_appConfig;
+};
+
+int ZoneConnectionTest::m_argc = 1;
+char* ZoneConnectionTest::m_argv[] = { const_cast<char*>("unitTests"), nullptr };
+string ZoneConnectionTest::m_saveDir;
+QApplication* ZoneConnectionTest::m_app = nullptr;
+AppConfig* ZoneConnectionTest::m_appConfig = nullptr;
+
+TEST_F(ZoneConnectionTest, shippedMapsConnectAsExhaustiveSearchDoes) {
+  const vector<string> maps = {
+    "data/common/maps/house.svg",
+    "data/common/maps/test.svg",
+    "data/doomsweeper/map.svg",
+    "data/going_in_circles/map.svg",
+    "data/its_raining_tetrominos/map.svg",
+    "data/making_progress/map.svg",
+    "data/t_minus_two_minutes/map.svg",
+    "data/youve_got_mail/map.svg"
+  };
+
+  for (const string& mapFile : maps) {
+    vector<string> expected = describeConnections(mapFile, true);
+    vector<string> actual = describeConnections(mapFile, false);
+
+    ASSERT_FALSE(expected.empty()) << mapFile;
+    ASSERT_EQ(expected.size(), actual.size()) << mapFile;
+
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(expected[i], actual[i]) << mapFile;
+    }
+  }
+}
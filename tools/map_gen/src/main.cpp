@@ -0,0 +1,94 @@
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <cstdlib>
+#include "map_generator.hpp"
+
+
+using std::cout;
+using std::cerr;
+using std::string;
+
+
+//===========================================
+// printUsage
+//===========================================
+static void printUsage(const char* prog) {
+  cout << "Usage: " << prog << " out_file [options]\n"
+    "  --seed n            Seed for the layout, 0 by default\n"
+    "  --districts n       Zones directly beneath the root, 4 by default\n"
+    "  --depth n           Levels of zones beneath the root, the last being rooms, 3 by default\n"
+    "  --branching n       Each zone that isn't a room holds n x n zones, 2 by default\n"
+    "  --wall-segments n   Walls along each side of a room, 1 by default\n"
+    "  --sprites n         Sprites scattered over the rooms, 0 by default\n"
+    "  --doors n           Rooms with a door in their doorway, 0 by default\n"
+    "  --agents n          Patrolling agents scattered over the rooms, 0 by default\n";
+}
+
+//===========================================
+// main
+//===========================================
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printUsage(argv[0]);
+    return EXIT_SUCCESS;
+  }
+
+  try {
+    MapSpec spec;
+    string out = argv[1];
+
+    for (int i = 2; i < argc; ++i) {
+      string opt = argv[i];
+
+      if (i + 1 >= argc) {
+        throw std::invalid_argument("Missing value for " + opt);
+      }
+
+      string val = argv[++i];
+
+      if (opt == "--seed") {
+        spec.seed = static_cast<uint32_t>(std::stoul(val));
+      }
+      else if (opt == "--districts") {
+        spec.districts = std::stoi(val);
+      }
+      else if (opt == "--depth") {
+        spec.depth = std::stoi(val);
+      }
+      else if (opt == "--branching") {
+        spec.branching = std::stoi(val);
+      }
+      else if (opt == "--wall-segments") {
+        spec.wallSegments = std::stoi(val);
+      }
+      else if (opt == "--sprites") {
+        spec.sprites = std::stoi(val);
+      }
+      else if (opt == "--doors") {
+        spec.doors = std::stoi(val);
+      }
+      else if (opt == "--agents") {
+        spec.agents = std::stoi(val);
+      }
+      else {
+        throw std::invalid_argument("Unrecognised option " + opt);
+      }
+    }
+
+    MapStats stats = generateMap(spec, out);
+
+    cout << "Zones: " << stats.zones << " (" << stats.rooms << " rooms, " << stats.doors
+      << " doors)\n"
+      << "Joins: " << stats.joins << "\n"
+      << "Walls: " << stats.walls << "\n"
+      << "Sprites: " << stats.sprites << "\n"
+      << "Agents: " << stats.agents << "\n";
+  }
+  catch (const std::exception& e) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,557 @@
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "map_generator.hpp"
+
+
+using std::string;
+using std::vector;
+using std::ostream;
+
+
+static const long ROOM_SIZE = 400;
+static const long CORRIDOR_WIDTH = 120;
+static const long DOORWAY_WIDTH = 80;
+static const long DOOR_DEPTH = 16;
+// Sprites and patrol paths keep at least this far from a room's walls
+static const long ROOM_MARGIN = 60;
+
+static const char* const TEXTURE_ASSETS[][2] = {
+  { "default", "common/images/default.png" },
+  { "sky", "common/images/sky.png" },
+  { "gun", "common/images/gun.png" },
+  { "crosshair", "common/images/crosshair.png" },
+  { "player", "common/images/player.png,70,70" },
+  { "civilian", "common/images/civilian.png,70,70" },
+  { "door", "common/images/door.png,80,100" },
+  { "crate", "common/images/crate.png,30,30" },
+  { "plant", "common/images/office_plant.png,21,25" },
+  { "grey_stone", "common/images/grey_stone.png,30,30" },
+  { "light_bricks", "common/images/light_bricks.png" },
+  { "dark_bricks", "common/images/dark_bricks.png" },
+  { "metal_floor", "common/images/metal_floor.png" },
+  { "metal_ceiling", "common/images/metal_ceiling.png" }
+};
+
+static const char* const WALL_TEXTURES[] = { "light_bricks", "dark_bricks" };
+static const char* const SPRITE_TEXTURES[] = { "crate", "plant" };
+
+
+struct Pt {
+  long x;
+  long y;
+};
+
+typedef vector<std::pair<string, string>> KvPairs;
+
+struct Doorway {
+  Pt A;
+  Pt B;
+  // Unit vector pointing out of the room
+  Pt normal;
+};
+
+// Everything the writing functions share
+struct Builder {
+  Builder(const MapSpec& spec, ostream& out)
+    : spec(spec),
+      out(out),
+      randEngine(spec.seed) {}
+
+  const MapSpec& spec;
+  ostream& out;
+  std::mt19937 randEngine;
+  MapStats stats;
+
+  // Indexed by room, in the order they're written
+  vector<int> spritesInRoom;
+  vector<int> agentsInRoom;
+  vector<bool> roomHasDoor;
+};
+
+
+//===========================================
+// randInt
+//
+// In [0, n). std::uniform_int_distribution isn't the same across standard libraries, so the
+// engine's output is used directly, keeping maps the same on every platform.
+//===========================================
+static long randInt(Builder& b, long n) {
+  return static_cast<long>(b.randEngine() % static_cast<unsigned long>(n));
+}
+
+//===========================================
+// zoneSize
+//
+// Districts are at level 1 and rooms at level spec.depth
+//===========================================
+static long zoneSize(const MapSpec& spec, int level) {
+  long size = ROOM_SIZE;
+
+  for (int i = spec.depth; i > level; --i) {
+    size = spec.branching * size + (spec.branching + 1) * CORRIDOR_WIDTH;
+  }
+
+  return size;
+}
+
+//===========================================
+// numRooms
+//===========================================
+static long numRooms(const MapSpec& spec) {
+  long n = spec.districts;
+
+  for (int i = 1; i < spec.depth; ++i) {
+    n *= spec.branching * spec.branching;
+  }
+
+  return n;
+}
+
+//===========================================
+// districtGridSize
+//
+// Columns of districts, with as many rows as are needed to fit them all
+//===========================================
+static int districtGridSize(const MapSpec& spec) {
+  int cols = 1;
+  while (cols * cols < spec.districts) {
+    ++cols;
+  }
+
+  return cols;
+}
+
+//===========================================
+// beginObject
+//===========================================
+static void beginObject(Builder& b, int indent, const KvPairs& kv) {
+  string pad(2 * indent, ' ');
+
+  b.out << pad << "<g>\n";
+
+  for (auto& pair : kv) {
+    b.out << pad << "  <text><tspan>" << pair.first << "=" << pair.second << "</tspan></text>\n";
+  }
+}
+
+//===========================================
+// endObject
+//===========================================
+static void endObject(Builder& b, int indent) {
+  b.out << string(2 * indent, ' ') << "</g>\n";
+}
+
+//===========================================
+// writePath
+//
+// The path data must not end in whitespace, as the parser would read it as another point
+//===========================================
+static void writePath(Builder& b, int indent, const vector<Pt>& points, bool closed) {
+  b.out << string(2 * indent, ' ') << "<path d=\"M";
+
+  for (const Pt& p : points) {
+    b.out << " " << p.x << "," << p.y;
+  }
+
+  if (closed) {
+    b.out << " z";
+  }
+
+  b.out << "\"/>\n";
+}
+
+//===========================================
+// writeObject
+//
+// An object with a path and no children
+//===========================================
+static void writeObject(Builder& b, int indent, const KvPairs& kv, const vector<Pt>& points,
+  bool closed) {
+
+  beginObject(b, indent, kv);
+  writePath(b, indent + 1, points, closed);
+  endObject(b, indent);
+}
+
+//===========================================
+// triangleAt
+//
+// Objects are positioned by a triangle, whose centre is the position and whose furthest point
+// from the centre gives the direction faced
+//===========================================
+static vector<Pt> triangleAt(const Pt& p) {
+  return { Pt{p.x - 6, p.y - 6}, Pt{p.x - 6, p.y + 6}, Pt{p.x + 12, p.y} };
+}
+
+//===========================================
+// rectangle
+//===========================================
+static vector<Pt> rectangle(long x, long y, long w, long h) {
+  return { Pt{x, y}, Pt{x + w, y}, Pt{x + w, y + h}, Pt{x, y + h} };
+}
+
+//===========================================
+// writeRoomWalls
+//
+// The room's corners are visited starting from the one after the doorway, each side divided into
+// spec.wallSegments pieces. The doorway is cut from the middle of its side.
+//===========================================
+static Doorway writeRoomWalls(Builder& b, int indent, long x, long y) {
+  const long S = ROOM_SIZE;
+  const int n = b.spec.wallSegments;
+
+  Pt corners[] = { Pt{x, y}, Pt{x + S, y}, Pt{x + S, y + S}, Pt{x, y + S} };
+  Pt normals[] = { Pt{0, -1}, Pt{1, 0}, Pt{0, 1}, Pt{-1, 0} };
+
+  int side = static_cast<int>(randInt(b, 4));
+
+  const Pt& C0 = corners[side];
+  const Pt& C1 = corners[(side + 1) % 4];
+
+  auto along = [](const Pt& A, const Pt& B, long num, long den) {
+    return Pt{A.x + (B.x - A.x) * num / den, A.y + (B.y - A.y) * num / den};
+  };
+
+  long d0 = (S - DOORWAY_WIDTH) / 2;
+  long d1 = d0 + DOORWAY_WIDTH;
+
+  Doorway doorway{along(C0, C1, d0, S), along(C0, C1, d1, S), normals[side]};
+
+  vector<Pt> points{doorway.B};
+
+  for (int i = 1; i < n; ++i) {
+    if (i * S > d1 * n) {
+      points.push_back(along(C0, C1, i, n));
+    }
+  }
+
+  for (int k = 1; k <= 4; ++k) {
+    const Pt& A = corners[(side + k) % 4];
+    const Pt& B = corners[(side + k + 1) % 4];
+
+    points.push_back(A);
+
+    if (k < 4) {
+      for (int i = 1; i < n; ++i) {
+        points.push_back(along(A, B, i, n));
+      }
+    }
+  }
+
+  for (int i = 1; i < n; ++i) {
+    if (i * S < d0 * n) {
+      points.push_back(along(C0, C1, i, n));
+    }
+  }
+
+  points.push_back(doorway.A);
+
+  const char* texture = WALL_TEXTURES[randInt(b, 2)];
+  writeObject(b, indent, {{"type", "wall"}, {"texture", texture}}, points, false);
+
+  writeObject(b, indent, {{"type", "join"}, {"top_texture", texture}},
+    { doorway.A, doorway.B }, false);
+
+  b.stats.walls += static_cast<int>(points.size()) - 1;
+  b.stats.joins += 1;
+
+  return doorway;
+}
+
+//===========================================
+// randomPointInRoom
+//===========================================
+static Pt randomPointInRoom(Builder& b, long x, long y) {
+  long range = ROOM_SIZE - 2 * ROOM_MARGIN;
+  return Pt{x + ROOM_MARGIN + randInt(b, range), y + ROOM_MARGIN + randInt(b, range)};
+}
+
+//===========================================
+// writeAgent
+//
+// The agent patrols a square loop around the room, starting from its first corner
+//===========================================
+static void writeAgent(Builder& b, int indent, long x, long y) {
+  int idx = b.stats.agents++;
+
+  string name = "agent_" + std::to_string(idx);
+  string pathName = "patrol_" + std::to_string(idx);
+
+  long inset = ROOM_MARGIN + randInt(b, ROOM_SIZE / 2 - 2 * ROOM_MARGIN);
+  long w = ROOM_SIZE - 2 * inset;
+  vector<Pt> loop = rectangle(x + inset, y + inset, w, w);
+
+  if (randInt(b, 2) == 1) {
+    std::swap(loop[1], loop[3]);
+  }
+
+  writeObject(b, indent, {{"type", "path"}, {"name", pathName}}, loop, true);
+
+  writeObject(b, indent, {
+    {"type", "civilian"},
+    {"name", name},
+    {"patrol_path", pathName},
+    {"st_patrolling_trigger", PATROL_TRIGGER}
+  }, triangleAt(loop[0]), true);
+}
+
+//===========================================
+// writeRoom
+//===========================================
+static Doorway writeRoom(Builder& b, int indent, long x, long y) {
+  int idx = b.stats.rooms++;
+  ++b.stats.zones;
+
+  long ceilingHeight = 100 + 20 * randInt(b, 6);
+
+  beginObject(b, indent, {
+    {"type", "region"},
+    {"has_ceiling", "true"},
+    {"floor_height", "0"},
+    {"ceiling_height", std::to_string(ceilingHeight)},
+    {"floor_texture", "metal_floor"},
+    {"ceiling_texture", "metal_ceiling"}
+  });
+
+  Doorway doorway = writeRoomWalls(b, indent + 1, x, y);
+
+  for (int i = 0; i < b.spritesInRoom[idx]; ++i) {
+    const char* texture = SPRITE_TEXTURES[randInt(b, 2)];
+
+    writeObject(b, indent + 1, {{"type", "sprite"}, {"texture", texture}},
+      triangleAt(randomPointInRoom(b, x, y)), true);
+
+    ++b.stats.sprites;
+  }
+
+  for (int i = 0; i < b.agentsInRoom[idx]; ++i) {
+    writeAgent(b, indent + 1, x, y);
+  }
+
+  endObject(b, indent);
+
+  return doorway;
+}
+
+//===========================================
+// writeDoor
+//
+// The door sits in the corridor outside the doorway. Its inner edge is the twin of the doorway's
+// join, and the rest join it to the corridor.
+//===========================================
+static void writeDoor(Builder& b, int indent, const Doorway& doorway) {
+  Pt A2{doorway.A.x + doorway.normal.x * DOOR_DEPTH, doorway.A.y + doorway.normal.y * DOOR_DEPTH};
+  Pt B2{doorway.B.x + doorway.normal.x * DOOR_DEPTH, doorway.B.y + doorway.normal.y * DOOR_DEPTH};
+
+  beginObject(b, indent, {{"type", "door"}, {"player_activated", "true"}});
+
+  writeObject(b, indent + 1, {{"type", "join"}, {"top_texture", "door"}},
+    { doorway.B, doorway.A, A2, B2 }, true);
+
+  endObject(b, indent);
+
+  ++b.stats.zones;
+  ++b.stats.doors;
+  b.stats.joins += 4;
+}
+
+//===========================================
+// writeZone_r
+//
+// Writes a zone of the given level with its top left corner at x, y, along with any doors
+// belonging to its children
+//===========================================
+static void writeZone_r(Builder& b, int indent, int level, long x, long y);
+
+//===========================================
+// writeChildren
+//
+// Doors belong to the room's parent, so are written after its rooms
+//===========================================
+static void writeChildren(Builder& b, int indent, int level, const vector<Pt>& positions) {
+  if (level == b.spec.depth) {
+    vector<Doorway> doors;
+
+    for (const Pt& p : positions) {
+      int idx = b.stats.rooms;
+      Doorway doorway = writeRoom(b, indent, p.x, p.y);
+
+      if (b.roomHasDoor[idx]) {
+        doors.push_back(doorway);
+      }
+    }
+
+    for (const Doorway& doorway : doors) {
+      writeDoor(b, indent, doorway);
+    }
+  }
+  else {
+    for (const Pt& p : positions) {
+      writeZone_r(b, indent, level, p.x, p.y);
+    }
+  }
+}
+
+//===========================================
+// writeZone_r
+//===========================================
+static void writeZone_r(Builder& b, int indent, int level, long x, long y) {
+  const int n = b.spec.branching;
+  const long S = zoneSize(b.spec, level + 1);
+  const long W = zoneSize(b.spec, level);
+
+  ++b.stats.zones;
+
+  beginObject(b, indent, {{"type", "region"}});
+
+  writeObject(b, indent + 1, {{"type", "join"}}, rectangle(x, y, W, W), true);
+  b.stats.joins += 4;
+
+  vector<Pt> positions;
+  for (int j = 0; j < n; ++j) {
+    for (int i = 0; i < n; ++i) {
+      positions.push_back(Pt{x + CORRIDOR_WIDTH + i * (S + CORRIDOR_WIDTH),
+        y + CORRIDOR_WIDTH + j * (S + CORRIDOR_WIDTH)});
+    }
+  }
+
+  writeChildren(b, indent + 1, level + 1, positions);
+
+  endObject(b, indent);
+}
+
+//===========================================
+// writeConfig
+//===========================================
+static void writeConfig(Builder& b) {
+  beginObject(b, 1, {{"type", "config"}});
+
+  KvPairs textures;
+  for (auto& asset : TEXTURE_ASSETS) {
+    textures.push_back(std::make_pair(asset[0], asset[1]));
+  }
+
+  textures.insert(textures.begin(), std::make_pair("type", "texture_assets"));
+
+  beginObject(b, 2, textures);
+  endObject(b, 2);
+
+  endObject(b, 1);
+}
+
+//===========================================
+// scatter
+//
+// Assigns the sprites, agents and doors to rooms
+//===========================================
+static void scatter(Builder& b) {
+  long rooms = numRooms(b.spec);
+
+  b.spritesInRoom.assign(rooms, 0);
+  b.agentsInRoom.assign(rooms, 0);
+  b.roomHasDoor.assign(rooms, false);
+
+  for (int i = 0; i < b.spec.sprites; ++i) {
+    ++b.spritesInRoom[randInt(b, rooms)];
+  }
+
+  for (int i = 0; i < b.spec.agents; ++i) {
+    ++b.agentsInRoom[randInt(b, rooms)];
+  }
+
+  // The first spec.doors of a partial shuffle of the rooms
+  vector<long> order(rooms);
+  for (long i = 0; i < rooms; ++i) {
+    order[i] = i;
+  }
+
+  for (long i = 0; i < b.spec.doors; ++i) {
+    std::swap(order[i], order[i + randInt(b, rooms - i)]);
+    b.roomHasDoor[order[i]] = true;
+  }
+}
+
+//===========================================
+// generateMap
+//
+// The root region is walled in, with the player in its top left corner
+//===========================================
+MapStats generateMap(const MapSpec& spec, ostream& out) {
+  if (spec.districts < 1 || spec.depth < 1 || spec.branching < 1 || spec.wallSegments < 1) {
+    throw std::invalid_argument("Map must have at least one district, level, branch and wall "
+      "segment");
+  }
+
+  if (spec.sprites < 0 || spec.agents < 0 || spec.doors < 0 || spec.doors > numRooms(spec)) {
+    throw std::invalid_argument("Map must have between 0 and " + std::to_string(numRooms(spec))
+      + " doors, and no negative number of sprites or agents");
+  }
+
+  Builder b(spec, out);
+  scatter(b);
+
+  int cols = districtGridSize(spec);
+  int rows = (spec.districts + cols - 1) / cols;
+
+  long S = zoneSize(spec, 1);
+  long w = cols * S + (cols + 1) * CORRIDOR_WIDTH;
+  long h = rows * S + (rows + 1) * CORRIDOR_WIDTH;
+
+  out << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
+    << "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" viewBox=\"0 0 " << w << " "
+    << h << "\">\n";
+
+  beginObject(b, 1, {
+    {"type", "region"},
+    {"has_ceiling", "false"},
+    {"floor_height", "0"},
+    {"ceiling_height", "300"},
+    {"floor_texture", "grey_stone"},
+    {"ceiling_texture", "metal_ceiling"}
+  });
+
+  writeObject(b, 2, {{"type", "wall"}, {"texture", "light_bricks"}}, rectangle(0, 0, w, h), true);
+  b.stats.walls += 4;
+  ++b.stats.zones;
+
+  writeObject(b, 2, {{"type", "player"}, {"tallness", "50"}},
+    triangleAt(Pt{CORRIDOR_WIDTH / 2, CORRIDOR_WIDTH / 2}), true);
+
+  vector<Pt> positions;
+  for (int i = 0; i < spec.districts; ++i) {
+    positions.push_back(Pt{CORRIDOR_WIDTH + (i % cols) * (S + CORRIDOR_WIDTH),
+      CORRIDOR_WIDTH + (i / cols) * (S + CORRIDOR_WIDTH)});
+  }
+
+  writeChildren(b, 2, 1, positions);
+
+  endObject(b, 1);
+
+  writeConfig(b);
+
+  out << "</svg>\n";
+
+  return b.stats;
+}
+
+//===========================================
+// generateMap
+//===========================================
+MapStats generateMap(const MapSpec& spec, const string& filePath) {
+  std::ofstream fout(filePath, std::ios::trunc);
+
+  if (!fout.good()) {
+    throw std::runtime_error("Could not open '" + filePath + "' for writing");
+  }
+
+  MapStats stats = generateMap(spec, fout);
+
+  if (!fout.good()) {
+    throw std::runtime_error("Error writing map to '" + filePath + "'");
+  }
+
+  return stats;
+}
@@ -0,0 +1,49 @@
+#ifndef __PROCALC_MAP_GEN_MAP_GENERATOR_HPP__
+#define __PROCALC_MAP_GEN_MAP_GENERATOR_HPP__
+
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+
+// Agents start patrolling when an event with this name is broadcast
+static const char* const PATROL_TRIGGER = "start_patrols";
+
+// The root region is divided into a grid of districts, each of which is divided into a grid of
+// branching x branching zones, and so on, depth levels deep. The deepest zones are rooms, walled
+// in apart from a doorway. Zones are separated by corridors belonging to their parent, so every
+// join but those of doors connects a zone to its parent.
+struct MapSpec {
+  uint32_t seed = 0;
+  int districts = 4;
+  // Moving bodies look for walls from two levels above their own zone, so in maps less than 3
+  // levels deep every move searches the whole map
+  int depth = 3;
+  int branching = 2;
+  // Wall segments along each side of a room
+  int wallSegments = 1;
+  // Scattered over the rooms. There's at most one door per room, in its doorway.
+  int sprites = 0;
+  int doors = 0;
+  int agents = 0;
+};
+
+struct MapStats {
+  // Regions, including the root and doors
+  int zones = 0;
+  int rooms = 0;
+  // Edges
+  int joins = 0;
+  int walls = 0;
+  int sprites = 0;
+  int doors = 0;
+  int agents = 0;
+};
+
+// The same spec always produces the same map
+MapStats generateMap(const MapSpec& spec, std::ostream& out);
+MapStats generateMap(const MapSpec& spec, const std::string& filePath);
+
+
+#endif
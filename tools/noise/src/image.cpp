@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include "image.hpp"
+
+
+using std::string;
+using std::vector;
+using std::ofstream;
+
+
+struct __attribute__ ((packed)) BmpFileHeader {
+  BmpFileHeader(uint32_t s)
+    : size(s) {}
+
+  char type[2] = {'B', 'M'};
+  uint32_t size;
+  uint16_t reserved1 = 0;
+  uint16_t reserved2 = 0;
+  uint32_t offset = 54;
+};
+
+struct __attribute__ ((packed)) BmpImgHeader {
+  BmpImgHeader(uint32_t w, uint32_t h)
+    : width(w), height(h) {}
+
+  uint32_t size = 40;
+  uint32_t width;
+  uint32_t height;
+  uint16_t planes = 1;
+  uint16_t bitCount = 24;
+  uint32_t compression = 0;
+  uint32_t imgSize = 0;
+  uint32_t xPxPerMetre = 0;
+  uint32_t yPxPerMetre = 0;
+  uint32_t colMapEntriesUsed = 0;
+  uint32_t numImportantColours = 0;
+};
+
+struct __attribute__ ((packed)) BmpHeader {
+  BmpHeader(uint32_t imgW, uint32_t imgH, uint32_t rowBytes)
+    : fileHdr(54 + rowBytes * imgH),
+      imgHdr(imgW, imgH) {}
+
+  BmpFileHeader fileHdr;
+  BmpImgHeader imgHdr;
+};
+
+//===========================================
+// openFile
+//===========================================
+static ofstream openFile(const string& path) {
+  ofstream fout(path, ofstream::binary);
+
+  if (!fout.good()) {
+    throw std::runtime_error("Error opening '" + path + "' for writing");
+  }
+
+  return fout;
+}
+
+//===========================================
+// writeBmp
+//
+// Rows are stored bottom up as BGR, each padded to a multiple of 4 bytes
+//===========================================
+void writeBmp(const Image& img, const string& path) {
+  uint32_t rowBytes = (3 * img.width + 3) & ~3u;
+  BmpHeader hdr(img.width, img.height, rowBytes);
+
+  ofstream fout = openFile(path);
+  fout.write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+
+  vector<char> row(rowBytes, 0);
+
+  for (int y = img.height - 1; y >= 0; --y) {
+    for (int x = 0; x < img.width; ++x) {
+      Rgb c = img.pixel(x, y);
+
+      row[3 * x] = c.b;
+      row[3 * x + 1] = c.g;
+      row[3 * x + 2] = c.r;
+    }
+
+    fout.write(row.data(), rowBytes);
+  }
+}
+
+//===========================================
+// crc32
+//===========================================
+static uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0) {
+  static uint32_t table[256] = {};
+  static bool tableReady = false;
+
+  if (!tableReady) {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+      }
+      table[i] = c;
+    }
+
+    tableReady = true;
+  }
+
+  crc ^= 0xffffffffu;
+  for (size_t i = 0; i < len; ++i) {
+    crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+  }
+
+  return crc ^ 0xffffffffu;
+}
+
+//===========================================
+// putU32
+//
+// Big endian, as PNG and zlib require
+//===========================================
+static void putU32(vector<uint8_t>& out, uint32_t x) {
+  out.push_back(static_cast<uint8_t>(x >> 24));
+  out.push_back(static_cast<uint8_t>(x >> 16));
+  out.push_back(static_cast<uint8_t>(x >> 8));
+  out.push_back(static_cast<uint8_t>(x));
+}
+
+//===========================================
+// writeChunk
+//===========================================
+static void writeChunk(ofstream& fout, const char* type, const vector<uint8_t>& data) {
+  vector<uint8_t> hdr;
+  putU32(hdr, static_cast<uint32_t>(data.size()));
+  hdr.insert(hdr.end(), type, type + 4);
+
+  uint32_t crc = crc32(hdr.data() + 4, 4);
+  crc = crc32(data.data(), data.size(), crc);
+
+  vector<uint8_t> trailer;
+  putU32(trailer, crc);
+
+  fout.write(reinterpret_cast<const char*>(hdr.data()), hdr.size());
+  fout.write(reinterpret_cast<const char*>(data.data()), data.size());
+  fout.write(reinterpret_cast<const char*>(trailer.data()), trailer.size());
+}
+
+//===========================================
+// writePng
+//
+// The image data is wrapped in uncompressed deflate blocks, so there's no dependency on zlib.
+// The files are large, but every PNG reader accepts them.
+//===========================================
+void writePng(const Image& img, const string& path) {
+  static const uint8_t SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+  static const size_t MAX_BLOCK_SIZE = 65535;
+
+  vector<uint8_t> ihdr;
+  putU32(ihdr, img.width);
+  putU32(ihdr, img.height);
+  // Bit depth 8, colour type RGB, then the default compression, filter and interlace methods
+  ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });
+
+  // Each row is preceded by its filter type, which is always none
+  size_t rowBytes = 3 * static_cast<size_t>(img.width);
+  vector<uint8_t> raw;
+  raw.reserve((rowBytes + 1) * img.height);
+
+  for (int y = 0; y < img.height; ++y) {
+    raw.push_back(0);
+    raw.insert(raw.end(), img.data.begin() + y * rowBytes, img.data.begin() + (y + 1) * rowBytes);
+  }
+
+  vector<uint8_t> idat{ 0x78, 0x01 };
+  idat.reserve(raw.size() + 5 * (raw.size() / MAX_BLOCK_SIZE + 1) + 6);
+
+  uint32_t a = 1;
+  uint32_t b = 0;
+
+  for (size_t i = 0; i < raw.size() || i == 0; i += MAX_BLOCK_SIZE) {
+    size_t len = std::min(MAX_BLOCK_SIZE, raw.size() - i);
+    bool last = i + len == raw.size();
+
+    idat.push_back(last ? 1 : 0);
+    idat.push_back(static_cast<uint8_t>(len));
+    idat.push_back(static_cast<uint8_t>(len >> 8));
+    idat.push_back(static_cast<uint8_t>(~len));
+    idat.push_back(static_cast<uint8_t>(~len >> 8));
+    idat.insert(idat.end(), raw.begin() + i, raw.begin() + i + len);
+
+    for (size_t j = i; j < i + len; ++j) {
+      a = (a + raw[j]) % 65521;
+      b = (b + a) % 65521;
+    }
+  }
+
+  putU32(idat, (b << 16) | a);
+
+  ofstream fout = openFile(path);
+  fout.write(reinterpret_cast<const char*>(SIGNATURE), sizeof(SIGNATURE));
+
+  writeChunk(fout, "IHDR", ihdr);
+  writeChunk(fout, "IDAT", idat);
+  writeChunk(fout, "IEND", {});
+}
+
+//===========================================
+// writeImage
+//===========================================
+void writeImage(const Image& img, const string& path) {
+  string ext = path.length() >= 4 ? path.substr(path.length() - 4) : "";
+
+  if (ext == ".png") {
+    writePng(img, path);
+  }
+  else if (ext == ".bmp") {
+    writeBmp(img, path);
+  }
+  else {
+    throw std::runtime_error("Error writing '" + path + "'; Expected a .png or .bmp extension");
+  }
+}
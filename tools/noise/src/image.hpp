@@ -0,0 +1,53 @@
+#ifndef __PROCALC_NOISE_IMAGE_HPP__
+#define __PROCALC_NOISE_IMAGE_HPP__
+
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+struct Rgb {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+
+  bool operator==(const Rgb& rhs) const {
+    return r == rhs.r && g == rhs.g && b == rhs.b;
+  }
+};
+
+// 8 bits per channel RGB, stored a row at a time from the top
+struct Image {
+  Image()
+    : width(0), height(0) {}
+
+  Image(int w, int h)
+    : width(w), height(h), data(3 * static_cast<size_t>(w) * h) {}
+
+  int width;
+  int height;
+  std::vector<uint8_t> data;
+
+  Rgb pixel(int x, int y) const {
+    const uint8_t* p = &data[3 * (static_cast<size_t>(y) * width + x)];
+    return Rgb{p[0], p[1], p[2]};
+  }
+
+  void setPixel(int x, int y, const Rgb& c) {
+    uint8_t* p = &data[3 * (static_cast<size_t>(y) * width + x)];
+    p[0] = c.r;
+    p[1] = c.g;
+    p[2] = c.b;
+  }
+};
+
+// Both formats load with QImage, as the raycast textures are
+void writeBmp(const Image& img, const std::string& path);
+void writePng(const Image& img, const std::string& path);
+
+// Chooses the format from the file extension
+void writeImage(const Image& img, const std::string& path);
+
+
+#endif
@@ -1,75 +1,159 @@
+#include <chrono>
 #include <iostream>
-#include <fstream>
-#include <cstdint>
-
-using namespace std;
-
-
-struct __attribute__ ((packed)) BmpFileHeader {
-  BmpFileHeader(uint32_t s)
-    : size(s) {}
-
-  char type[2] = {'B', 'M'};
-  uint32_t size;
-  uint16_t reserved1 = 0;
-  uint16_t reserved2 = 0;
-  uint32_t offset = 54;
-};
-
-struct __attribute__ ((packed)) BmpImgHeader {
-  BmpImgHeader(uint32_t w, uint32_t h)
-    : width(w), height(h) {}
-
-  uint32_t size = 40;
-  uint32_t width;
-  uint32_t height;
-  uint16_t planes = 1;
-  uint16_t bitCount = 24;
-  uint32_t compression = 0;
-  uint32_t imgSize = 0;
-  uint32_t xPxPerMetre = 0;
-  uint32_t yPxPerMetre = 0;
-  uint32_t colMapEntriesUsed = 0;
-  uint32_t numImportantColours = 0;
-};
-
-struct __attribute__ ((packed)) BmpHeader {
-  BmpHeader(uint32_t imgW, uint32_t imgH)
-    : fileHdr(54 + imgW * imgH * 3),
-      imgHdr(imgW, imgH) {}
-
-  BmpFileHeader fileHdr;
-  BmpImgHeader imgHdr;
-};
-
-void setPixelComponent(uint8_t* img, int w, int x, int y, int c, uint8_t val) {
-  img[y * w * 3 + x * 3 + c] = val;
+#include <string>
+#include <stdexcept>
+#include <cstdlib>
+#include "texture_baker.hpp"
+#include "image.hpp"
+
+
+using std::cout;
+using std::cerr;
+using std::string;
+using std::vector;
+
+
+//===========================================
+// printUsage
+//===========================================
+static void printUsage(const char* prog) {
+  cout << "Usage: " << prog << " w h [options]\n"
+    "  --pattern p         white (default), value, perlin, worley, brick or panel\n"
+    "  --seed n            Seed for the pattern, 0 by default\n"
+    "  --cells n           Noise cells, bricks or panels across the texture, 8 by default\n"
+    "  --octaves n         Octaves of noise, 4 by default\n"
+    "  --colours a,b       Dark and light colours as rrggbb hex, 000000,ffffff by default\n"
+    "  --threads n         Worker threads, one per core by default\n"
+    "  --mips              Also write each mip level, as out_1.png, out_2.png, etc.\n"
+    "  --time              Print how long baking and building the mip chain take\n"
+    "  --out path          Output file, ending .png or .bmp, out.png by default\n";
+}
+
+//===========================================
+// parseColour
+//===========================================
+static Rgb parseColour(const string& hex) {
+  if (hex.length() != 6) {
+    throw std::invalid_argument("Expected a colour as rrggbb, got '" + hex + "'");
+  }
+
+  unsigned long x = std::stoul(hex, nullptr, 16);
+  return Rgb{static_cast<uint8_t>(x >> 16), static_cast<uint8_t>(x >> 8),
+    static_cast<uint8_t>(x)};
 }
 
+//===========================================
+// mipPath
+//===========================================
+static string mipPath(const string& path, int level) {
+  size_t dot = path.rfind('.');
+  return path.substr(0, dot) + "_" + std::to_string(level) + path.substr(dot);
+}
+
+//===========================================
+// ms
+//===========================================
+static double ms(std::chrono::high_resolution_clock::time_point a,
+  std::chrono::high_resolution_clock::time_point b) {
+
+  return std::chrono::duration<double, std::milli>(b - a).count();
+}
+
+//===========================================
+// main
+//===========================================
 int main(int argc, char** argv) {
   if (argc < 3) {
-    cout << "Usage: " << argv[0] << " w h\n";
+    printUsage(argv[0]);
     return EXIT_SUCCESS;
   }
 
-  uint32_t w = stoi(argv[1]);
-  uint32_t h = stoi(argv[2]);
-  size_t bytes = w * h * 3;
-  uint8_t* img = new uint8_t[bytes];
+  try {
+    BakeSpec spec;
+    spec.width = std::stoi(argv[1]);
+    spec.height = std::stoi(argv[2]);
+
+    int numThreads = 0;
+    bool mips = false;
+    bool time = false;
+    string out = "out.png";
+
+    for (int i = 3; i < argc; ++i) {
+      string opt = argv[i];
 
-  for (uint32_t j = 0; j < h; ++j) {
-    for (uint32_t i = 0; i < w; ++i) {
-      setPixelComponent(img, w, i, j, 0, rand() % 256);
-      setPixelComponent(img, w, i, j, 1, rand() % 256);
-      setPixelComponent(img, w, i, j, 2, rand() % 256);
+      if (opt == "--mips") {
+        mips = true;
+        continue;
+      }
+
+      if (opt == "--time") {
+        time = true;
+        continue;
+      }
+
+      if (i + 1 >= argc) {
+        throw std::invalid_argument("Missing value for " + opt);
+      }
+
+      string val = argv[++i];
+
+      if (opt == "--pattern") {
+        spec.pattern = parsePattern(val);
+      }
+      else if (opt == "--seed") {
+        spec.seed = static_cast<uint32_t>(std::stoul(val));
+      }
+      else if (opt == "--cells") {
+        spec.cells = std::stoi(val);
+      }
+      else if (opt == "--octaves") {
+        spec.octaves = std::stoi(val);
+      }
+      else if (opt == "--colours") {
+        size_t comma = val.find(',');
+        if (comma == string::npos) {
+          throw std::invalid_argument("Expected two colours separated by a comma");
+        }
+
+        spec.dark = parseColour(val.substr(0, comma));
+        spec.light = parseColour(val.substr(comma + 1));
+      }
+      else if (opt == "--threads") {
+        numThreads = std::stoi(val);
+      }
+      else if (opt == "--out") {
+        out = val;
+      }
+      else {
+        throw std::invalid_argument("Unrecognised option " + opt);
+      }
     }
-  }
 
-  BmpHeader hdr(w, h);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    Image img = bake(spec, numThreads);
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    if (time) {
+      vector<Image> levels = mipChain(img);
+      auto t2 = std::chrono::high_resolution_clock::now();
 
-  ofstream fout("out.bmp", ofstream::binary);
-  fout.write(reinterpret_cast<char*>(&hdr), sizeof(hdr));
-  fout.write(reinterpret_cast<char*>(img), bytes);
+      cout << "Bake: " << ms(t0, t1) << "ms, mips: " << ms(t1, t2) << "ms\n";
+    }
+
+    writeImage(img, out);
+
+    if (mips) {
+      vector<Image> levels = mipChain(img);
+
+      for (size_t i = 0; i < levels.size(); ++i) {
+        writeImage(levels[i], mipPath(out, i + 1));
+      }
+    }
+  }
+  catch (const std::exception& e) {
+    cerr << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
 
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,185 @@
+#include <cmath>
+#include <algorithm>
+#include "noise.hpp"
+
+
+//===========================================
+// wrap
+//
+// Lattice coordinates are almost always within one period, so the division is rarely needed
+//===========================================
+static inline int wrap(int i, int n) {
+  if (i >= 0 && i < n) {
+    return i;
+  }
+  if (i == n) {
+    return 0;
+  }
+
+  i %= n;
+  return i < 0 ? i + n : i;
+}
+
+//===========================================
+// floorInt
+//===========================================
+static inline int floorInt(double x) {
+  int i = static_cast<int>(x);
+  return x < i ? i - 1 : i;
+}
+
+//===========================================
+// fade
+//
+// Smoother than linear interpolation, with zero first and second derivatives at 0 and 1
+//===========================================
+static inline double fade(double t) {
+  return t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+}
+
+//===========================================
+// lerp
+//===========================================
+static inline double lerp(double a, double b, double t) {
+  return a + (b - a) * t;
+}
+
+//===========================================
+// hashCell
+//
+// Mixes the coordinates and seed together so that neighbouring cells get unrelated values
+//===========================================
+uint32_t hashCell(int x, int y, uint32_t seed) {
+  uint32_t h = seed * 0x9e3779b9u;
+  h ^= static_cast<uint32_t>(x) * 0x85ebca6bu;
+  h = (h << 13) | (h >> 19);
+  h ^= static_cast<uint32_t>(y) * 0xc2b2ae35u;
+
+  h ^= h >> 16;
+  h *= 0x7feb352du;
+  h ^= h >> 15;
+  h *= 0x846ca68bu;
+  h ^= h >> 16;
+
+  return h;
+}
+
+//===========================================
+// hashCell01
+//===========================================
+double hashCell01(int x, int y, uint32_t seed) {
+  return hashCell(x, y, seed) * (1.0 / 4294967296.0);
+}
+
+//===========================================
+// valueNoise
+//===========================================
+double valueNoise(double x, double y, int periodX, int periodY, uint32_t seed) {
+  int x0 = floorInt(x);
+  int y0 = floorInt(y);
+
+  double tx = fade(x - x0);
+  double ty = fade(y - y0);
+
+  int i0 = wrap(x0, periodX);
+  int i1 = wrap(x0 + 1, periodX);
+  int j0 = wrap(y0, periodY);
+  int j1 = wrap(y0 + 1, periodY);
+
+  double top = lerp(hashCell01(i0, j0, seed), hashCell01(i1, j0, seed), tx);
+  double bottom = lerp(hashCell01(i0, j1, seed), hashCell01(i1, j1, seed), tx);
+
+  return lerp(top, bottom, ty);
+}
+
+//===========================================
+// gradientDot
+//
+// Dot product of the (dx, dy) offset with one of eight unit gradients chosen by the cell's hash
+//===========================================
+static inline double gradientDot(int i, int j, uint32_t seed, double dx, double dy) {
+  static const double D = 0.70710678118654752;
+  static const double GRADIENTS[8][2] = {
+    { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+    { D, D }, { -D, D }, { D, -D }, { -D, -D }
+  };
+
+  const double* g = GRADIENTS[hashCell(i, j, seed) >> 29];
+  return g[0] * dx + g[1] * dy;
+}
+
+//===========================================
+// perlinNoise
+//===========================================
+double perlinNoise(double x, double y, int periodX, int periodY, uint32_t seed) {
+  int x0 = floorInt(x);
+  int y0 = floorInt(y);
+
+  double fx = x - x0;
+  double fy = y - y0;
+
+  int i0 = wrap(x0, periodX);
+  int i1 = wrap(x0 + 1, periodX);
+  int j0 = wrap(y0, periodY);
+  int j1 = wrap(y0 + 1, periodY);
+
+  double tx = fade(fx);
+  double ty = fade(fy);
+
+  double top = lerp(gradientDot(i0, j0, seed, fx, fy), gradientDot(i1, j0, seed, fx - 1.0, fy),
+    tx);
+  double bottom = lerp(gradientDot(i0, j1, seed, fx, fy - 1.0),
+    gradientDot(i1, j1, seed, fx - 1.0, fy - 1.0), tx);
+
+  // With unit gradients the result lies within +/- sqrt(0.5)
+  double n = lerp(top, bottom, ty);
+  return std::min(1.0, std::max(0.0, 0.5 + n * 0.70710678118654752));
+}
+
+//===========================================
+// worleyNoise
+//===========================================
+double worleyNoise(double x, double y, int periodX, int periodY, uint32_t seed) {
+  int x0 = floorInt(x);
+  int y0 = floorInt(y);
+
+  double nearest = 2.0;
+
+  for (int j = y0 - 1; j <= y0 + 1; ++j) {
+    for (int i = x0 - 1; i <= x0 + 1; ++i) {
+      uint32_t h = hashCell(wrap(i, periodX), wrap(j, periodY), seed);
+
+      double px = i + (h & 0xffff) * (1.0 / 65536.0);
+      double py = j + (h >> 16) * (1.0 / 65536.0);
+
+      double d = (px - x) * (px - x) + (py - y) * (py - y);
+      nearest = std::min(nearest, d);
+    }
+  }
+
+  return std::min(1.0, std::sqrt(nearest));
+}
+
+//===========================================
+// fractalNoise
+//===========================================
+double fractalNoise(noiseFn_t fn, double x, double y, int periodX, int periodY, int octaves,
+  uint32_t seed) {
+
+  double sum = 0.0;
+  double amplitude = 1.0;
+  double total = 0.0;
+
+  for (int i = 0; i < octaves; ++i) {
+    sum += amplitude * fn(x, y, periodX, periodY, seed + i);
+    total += amplitude;
+
+    x *= 2.0;
+    y *= 2.0;
+    periodX *= 2;
+    periodY *= 2;
+    amplitude *= 0.5;
+  }
+
+  return sum / total;
+}
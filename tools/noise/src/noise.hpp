@@ -0,0 +1,31 @@
+#ifndef __PROCALC_NOISE_NOISE_HPP__
+#define __PROCALC_NOISE_NOISE_HPP__
+
+
+#include <cstdint>
+
+
+// Each noise function is evaluated on a lattice that repeats every periodX cells horizontally and
+// periodY cells vertically, so a texture spanning whole periods tiles without a seam. The values
+// at the lattice points come from hashing their coordinates with the seed, rather than from a
+// random number generator, so any point can be evaluated on its own and in any order.
+//
+// Every function returns a value in [0, 1].
+
+uint32_t hashCell(int x, int y, uint32_t seed);
+double hashCell01(int x, int y, uint32_t seed);
+
+double valueNoise(double x, double y, int periodX, int periodY, uint32_t seed);
+double perlinNoise(double x, double y, int periodX, int periodY, uint32_t seed);
+// Distance to the nearest of one randomly placed point per cell
+double worleyNoise(double x, double y, int periodX, int periodY, uint32_t seed);
+
+typedef double (*noiseFn_t)(double x, double y, int periodX, int periodY, uint32_t seed);
+
+// Sums octaves of fn, each at double the frequency and half the amplitude of the last. The
+// periods double too, so the sum tiles like its first octave.
+double fractalNoise(noiseFn_t fn, double x, double y, int periodX, int periodY, int octaves,
+  uint32_t seed);
+
+
+#endif
@@ -0,0 +1,272 @@
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include "texture_baker.hpp"
+#include "noise.hpp"
+
+
+using std::string;
+using std::vector;
+
+
+static const int TILE_SIZE = 64;
+
+
+//===========================================
+// wrap
+//===========================================
+static inline int wrap(int i, int n) {
+  i %= n;
+  return i < 0 ? i + n : i;
+}
+
+//===========================================
+// mix
+//===========================================
+static inline Rgb mix(const Rgb& a, const Rgb& b, double t) {
+  t = std::min(1.0, std::max(0.0, t));
+
+  return Rgb{
+    static_cast<uint8_t>(a.r + (b.r - a.r) * t + 0.5),
+    static_cast<uint8_t>(a.g + (b.g - a.g) * t + 0.5),
+    static_cast<uint8_t>(a.b + (b.b - a.b) * t + 0.5)
+  };
+}
+
+//===========================================
+// cellsDown
+//
+// The number of cells down the texture that keeps them closest to square
+//===========================================
+static int cellsDown(const BakeSpec& spec) {
+  return std::max(1, static_cast<int>(std::lround(
+    static_cast<double>(spec.cells) * spec.height / spec.width)));
+}
+
+//===========================================
+// parsePattern
+//===========================================
+Pattern parsePattern(const string& name) {
+  if (name == "white") return Pattern::WHITE;
+  if (name == "value") return Pattern::VALUE;
+  if (name == "perlin") return Pattern::PERLIN;
+  if (name == "worley") return Pattern::WORLEY;
+  if (name == "brick") return Pattern::BRICK;
+  if (name == "panel") return Pattern::PANEL;
+
+  throw std::invalid_argument("Unknown pattern '" + name + "'");
+}
+
+//===========================================
+// sampleBrick
+//
+// Alternate rows are offset by half a brick, so there's always an even number of rows
+//===========================================
+static Rgb sampleBrick(const BakeSpec& spec, double u, double v) {
+  int bricksX = spec.cells;
+  int bricksY = 2 * cellsDown(spec);
+
+  double bx = u * bricksX;
+  double by = v * bricksY;
+
+  int row = static_cast<int>(std::floor(by));
+  if (wrap(row, 2) == 1) {
+    bx += 0.5;
+  }
+  int col = static_cast<int>(std::floor(bx));
+
+  double fx = bx - col;
+  double fy = by - row;
+
+  double brickW = static_cast<double>(spec.width) / bricksX;
+  double brickH = static_cast<double>(spec.height) / bricksY;
+  double mortar = std::max(1.0, 0.08 * brickH);
+
+  double grain = fractalNoise(valueNoise, u * bricksX * 8, v * bricksY * 4, bricksX * 8,
+    bricksY * 4, spec.octaves, spec.seed + 1000);
+
+  if (fx * brickW < mortar || fy * brickH < mortar) {
+    return mix(spec.dark, spec.light, 0.15 * grain);
+  }
+
+  double shade = 0.6 + 0.4 * hashCell01(wrap(col, bricksX), wrap(row, bricksY), spec.seed);
+  return mix(spec.dark, spec.light, shade * (0.8 + 0.2 * grain));
+}
+
+//===========================================
+// samplePanel
+//
+// Bevelled panels, lit from the top left, with a rivet in each corner
+//===========================================
+static Rgb samplePanel(const BakeSpec& spec, double u, double v) {
+  static const double BEVEL = 0.05;
+  static const double RIVET_INSET = 0.12;
+  static const double RIVET_RADIUS = 0.035;
+
+  int panelsX = spec.cells;
+  int panelsY = cellsDown(spec);
+
+  double px = u * panelsX;
+  double py = v * panelsY;
+
+  double fx = px - std::floor(px);
+  double fy = py - std::floor(py);
+
+  double grain = fractalNoise(valueNoise, px * 4, py * 4, panelsX * 4, panelsY * 4,
+    spec.octaves, spec.seed);
+
+  double shade = 0.5 + 0.1 * (grain - 0.5);
+
+  if (fx < BEVEL || fy < BEVEL) {
+    shade += 0.3;
+  }
+  else if (fx > 1.0 - BEVEL || fy > 1.0 - BEVEL) {
+    shade -= 0.3;
+  }
+  else {
+    double cx = fx < 0.5 ? RIVET_INSET : 1.0 - RIVET_INSET;
+    double cy = fy < 0.5 ? RIVET_INSET : 1.0 - RIVET_INSET;
+    double dx = cx - fx;
+    double dy = cy - fy;
+
+    if (dx * dx + dy * dy < RIVET_RADIUS * RIVET_RADIUS) {
+      shade += 0.2 * (dx + dy) / RIVET_RADIUS;
+    }
+  }
+
+  return mix(spec.dark, spec.light, shade);
+}
+
+//===========================================
+// samplePixel
+//===========================================
+Rgb samplePixel(const BakeSpec& spec, int x, int y) {
+  // Pixel centres, as fractions of the texture
+  double u = (x + 0.5) / spec.width;
+  double v = (y + 0.5) / spec.height;
+
+  int cellsX = spec.cells;
+  int cellsY = cellsDown(spec);
+
+  switch (spec.pattern) {
+    case Pattern::WHITE: {
+      uint32_t h = hashCell(wrap(x, spec.width), wrap(y, spec.height), spec.seed);
+      return Rgb{static_cast<uint8_t>(h), static_cast<uint8_t>(h >> 8),
+        static_cast<uint8_t>(h >> 16)};
+    }
+    case Pattern::VALUE: {
+      return mix(spec.dark, spec.light, fractalNoise(valueNoise, u * cellsX, v * cellsY, cellsX,
+        cellsY, spec.octaves, spec.seed));
+    }
+    case Pattern::PERLIN: {
+      return mix(spec.dark, spec.light, fractalNoise(perlinNoise, u * cellsX, v * cellsY, cellsX,
+        cellsY, spec.octaves, spec.seed));
+    }
+    case Pattern::WORLEY: {
+      return mix(spec.dark, spec.light, fractalNoise(worleyNoise, u * cellsX, v * cellsY, cellsX,
+        cellsY, spec.octaves, spec.seed));
+    }
+    case Pattern::BRICK: {
+      return sampleBrick(spec, u, v);
+    }
+    case Pattern::PANEL: {
+      return samplePanel(spec, u, v);
+    }
+  }
+
+  return spec.dark;
+}
+
+//===========================================
+// bake
+//===========================================
+Image bake(const BakeSpec& spec, int numThreads) {
+  if (spec.width < 1 || spec.height < 1 || spec.cells < 1 || spec.octaves < 1) {
+    throw std::invalid_argument("Error baking texture; Dimensions, cells and octaves must be at "
+      "least 1");
+  }
+
+  if (numThreads < 1) {
+    numThreads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  Image img(spec.width, spec.height);
+
+  int tilesX = (spec.width + TILE_SIZE - 1) / TILE_SIZE;
+  int tilesY = (spec.height + TILE_SIZE - 1) / TILE_SIZE;
+  int numTiles = tilesX * tilesY;
+
+  std::atomic<int> nextTile(0);
+
+  auto work = [&]() {
+    for (int tile = nextTile++; tile < numTiles; tile = nextTile++) {
+      int x0 = (tile % tilesX) * TILE_SIZE;
+      int y0 = (tile / tilesX) * TILE_SIZE;
+      int x1 = std::min(x0 + TILE_SIZE, spec.width);
+      int y1 = std::min(y0 + TILE_SIZE, spec.height);
+
+      for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+          img.setPixel(x, y, samplePixel(spec, x, y));
+        }
+      }
+    }
+  };
+
+  vector<std::thread> threads;
+  for (int i = 1; i < numThreads; ++i) {
+    threads.emplace_back(work);
+  }
+
+  work();
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return img;
+}
+
+//===========================================
+// mipChain
+//===========================================
+vector<Image> mipChain(const Image& img) {
+  vector<Image> levels;
+
+  while (true) {
+    const Image* prev = levels.empty() ? &img : &levels.back();
+
+    if (prev->width == 1 && prev->height == 1) {
+      break;
+    }
+
+    Image level(std::max(1, prev->width / 2), std::max(1, prev->height / 2));
+
+    for (int y = 0; y < level.height; ++y) {
+      int y0 = wrap(2 * y, prev->height);
+      int y1 = wrap(2 * y + 1, prev->height);
+
+      for (int x = 0; x < level.width; ++x) {
+        int x0 = wrap(2 * x, prev->width);
+        int x1 = wrap(2 * x + 1, prev->width);
+
+        Rgb a = prev->pixel(x0, y0);
+        Rgb b = prev->pixel(x1, y0);
+        Rgb c = prev->pixel(x0, y1);
+        Rgb d = prev->pixel(x1, y1);
+
+        level.setPixel(x, y, Rgb{
+          static_cast<uint8_t>((a.r + b.r + c.r + d.r + 2) / 4),
+          static_cast<uint8_t>((a.g + b.g + c.g + d.g + 2) / 4),
+          static_cast<uint8_t>((a.b + b.b + c.b + d.b + 2) / 4)
+        });
+      }
+    }
+
+    levels.push_back(std::move(level));
+  }
+
+  return levels;
+}
@@ -0,0 +1,46 @@
+#ifndef __PROCALC_NOISE_TEXTURE_BAKER_HPP__
+#define __PROCALC_NOISE_TEXTURE_BAKER_HPP__
+
+
+#include <string>
+#include <vector>
+#include "image.hpp"
+
+
+enum class Pattern {
+  WHITE,
+  VALUE,
+  PERLIN,
+  WORLEY,
+  BRICK,
+  PANEL
+};
+
+struct BakeSpec {
+  Pattern pattern = Pattern::WHITE;
+  int width = 128;
+  int height = 128;
+  uint32_t seed = 0;
+  // Lattice cells, bricks or panels across the texture. Down the texture there are as many as
+  // keep them roughly square, or for bricks, twice as wide as they are tall.
+  int cells = 8;
+  int octaves = 4;
+  Rgb dark = Rgb{0, 0, 0};
+  Rgb light = Rgb{255, 255, 255};
+};
+
+Pattern parsePattern(const std::string& name);
+
+// Every pattern wraps, so pixels outside the texture repeat those inside it
+Rgb samplePixel(const BakeSpec& spec, int x, int y);
+
+// The texture is divided into square tiles, which the threads take in turn. Each pixel depends
+// only on the spec, so the result is the same for any number of threads.
+Image bake(const BakeSpec& spec, int numThreads = 0);
+
+// Successively halved copies of img, down to 1x1, each pixel averaging 2x2 pixels of the level
+// above. Odd sizes borrow from the opposite edge, so every level tiles like img.
+std::vector<Image> mipChain(const Image& img);
+
+
+#endif
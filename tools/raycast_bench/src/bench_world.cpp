@@ -0,0 +1,138 @@
+#include <list>
+#include <regex>
+#include <QImage>
+#include "bench_world.hpp"
+#include "raycast/spatial_system.hpp"
+#include "raycast/behaviour_system.hpp"
+#include "raycast/render_system.hpp"
+#include "raycast/animation_system.hpp"
+#include "raycast/inventory_system.hpp"
+#include "raycast/event_handler_system.hpp"
+#include "raycast/damage_system.hpp"
+#include "raycast/spawn_system.hpp"
+#include "raycast/agent_system.hpp"
+#include "raycast/focus_system.hpp"
+#include "raycast/map_parser.hpp"
+#include "raycast/misc_factory.hpp"
+#include "raycast/sprite_factory.hpp"
+#include "raycast/geometry_factory.hpp"
+#include "app_config.hpp"
+#include "exception.hpp"
+
+
+using std::string;
+using std::list;
+
+
+//===========================================
+// BenchWorld::BenchWorld
+//===========================================
+BenchWorld::BenchWorld(const AppConfig& appConfig, QImage& target, int frameRate)
+  : m_appConfig(appConfig),
+    m_timeService(frameRate),
+    m_audioService(m_entityManager, m_timeService) {
+
+  setupObjectFactories();
+  setupSystems(target, frameRate);
+}
+
+//===========================================
+// BenchWorld::setupObjectFactories
+//===========================================
+void BenchWorld::setupObjectFactories() {
+  m_rootFactory.addFactory(pGameObjectFactory_t(new MiscFactory(m_rootFactory, m_entityManager,
+    m_audioService, m_timeService)));
+  m_rootFactory.addFactory(pGameObjectFactory_t(new SpriteFactory(m_rootFactory, m_entityManager,
+    m_audioService, m_timeService)));
+  m_rootFactory.addFactory(pGameObjectFactory_t(new GeometryFactory(m_rootFactory,
+    m_entityManager)));
+}
+
+//===========================================
+// BenchWorld::setupSystems
+//
+// All the systems are needed for the map's objects to be constructed, even though the bench only
+// exercises the spatial and render systems
+//===========================================
+void BenchWorld::setupSystems(QImage& target, int frameRate) {
+  m_entityManager.addSystem(ComponentKind::C_BEHAVIOUR, pSystem_t(new BehaviourSystem));
+  m_entityManager.addSystem(ComponentKind::C_SPATIAL, pSystem_t(new SpatialSystem(m_entityManager,
+    m_timeService, frameRate)));
+  m_entityManager.addSystem(ComponentKind::C_RENDER, pSystem_t(new RenderSystem(m_appConfig,
+    m_entityManager, target)));
+  m_entityManager.addSystem(ComponentKind::C_ANIMATION,
+    pSystem_t(new AnimationSystem(m_entityManager)));
+  m_entityManager.addSystem(ComponentKind::C_INVENTORY,
+    pSystem_t(new InventorySystem(m_entityManager)));
+  m_entityManager.addSystem(ComponentKind::C_EVENT_HANDLER, pSystem_t(new EventHandlerSystem));
+  m_entityManager.addSystem(ComponentKind::C_DAMAGE, pSystem_t(new DamageSystem(m_entityManager)));
+  m_entityManager.addSystem(ComponentKind::C_SPAWN, pSystem_t(new SpawnSystem(m_entityManager,
+    m_rootFactory, m_timeService)));
+  m_entityManager.addSystem(ComponentKind::C_AGENT, pSystem_t(new AgentSystem(m_timeService,
+    m_audioService)));
+  m_entityManager.addSystem(ComponentKind::C_FOCUS, pSystem_t(new FocusSystem(m_appConfig,
+    m_entityManager, m_timeService)));
+}
+
+//===========================================
+// BenchWorld::loadTextures
+//===========================================
+void BenchWorld::loadTextures(RenderGraph& rg, const parser::Object& obj) {
+  for (auto it = obj.dict.begin(); it != obj.dict.end(); ++it) {
+    Size sz(100, 100);
+
+    std::regex rx("([a-zA-Z0-9_\\.\\/]+)(?:,(\\d+),(\\d+))?");
+    std::smatch m;
+
+    std::regex_match(it->second, m, rx);
+    if (m.size() == 0) {
+      EXCEPTION("Error parsing texture description for texture with name '" << it->first << "'");
+    }
+
+    if (!m.str(2).empty()) {
+      sz.x = std::stod(m.str(2));
+    }
+    if (!m.str(3).empty()) {
+      sz.y = std::stod(m.str(3));
+    }
+
+    rg.textures[it->first] = Texture{QImage(m_appConfig.dataPath(m.str(1)).c_str()), sz};
+  }
+}
+
+//===========================================
+// BenchWorld::loadMap
+//===========================================
+void BenchWorld::loadMap(const string& mapFilePath) {
+  auto& renderSystem = m_entityManager.system<RenderSystem>(ComponentKind::C_RENDER);
+  auto& spatialSystem = m_entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
+
+  list<parser::pObject_t> objects;
+  parser::parse(mapFilePath, objects);
+
+  parser::Object* config = firstObjectOfType(objects, "config");
+  parser::Object* rootRegion = firstObjectOfType(objects, "region");
+
+  if (config == nullptr || rootRegion == nullptr) {
+    EXCEPTION("Error loading map '" << mapFilePath << "'; Expected config and region objects");
+  }
+
+  parser::Object* textures = firstObjectOfType(config->children, "texture_assets");
+  if (textures != nullptr) {
+    loadTextures(renderSystem.rg, *textures);
+  }
+
+  m_rootFactory.constructObject("region", -1, *rootRegion, -1, Matrix());
+
+  renderSystem.setCamera(&spatialSystem.sg.player->camera());
+}
+
+//===========================================
+// BenchWorld::tick
+//===========================================
+void BenchWorld::tick() {
+  m_entityManager.purgeEntities();
+  m_entityManager.update();
+
+  m_timeService.update();
+}
@@ -0,0 +1,49 @@
+#ifndef __PROCALC_RAYCAST_BENCH_BENCH_WORLD_HPP__
+#define __PROCALC_RAYCAST_BENCH_BENCH_WORLD_HPP__
+
+
+#include <string>
+#include "raycast/entity_manager.hpp"
+#include "raycast/time_service.hpp"
+#include "raycast/audio_service.hpp"
+#include "raycast/root_factory.hpp"
+
+
+class AppConfig;
+class QImage;
+struct RenderGraph;
+namespace parser { struct Object; }
+
+// The parts of RaycastWidget needed to load a map and render it, minus the window, input and
+// audio
+class BenchWorld {
+  public:
+    BenchWorld(const AppConfig& appConfig, QImage& target, int frameRate);
+
+    void loadMap(const std::string& mapFilePath);
+
+    // Advances the game by one frame, as RaycastWidget::tick does, without rendering
+    void tick();
+
+    EntityManager& entityManager() {
+      return m_entityManager;
+    }
+
+    TimeService& timeService() {
+      return m_timeService;
+    }
+
+  private:
+    void setupObjectFactories();
+    void setupSystems(QImage& target, int frameRate);
+    void loadTextures(RenderGraph& rg, const parser::Object& obj);
+
+    const AppConfig& m_appConfig;
+    EntityManager m_entityManager;
+    TimeService m_timeService;
+    AudioService m_audioService;
+    RootFactory m_rootFactory;
+};
+
+
+#endif
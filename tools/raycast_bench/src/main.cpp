@@ -0,0 +1,320 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <QApplication>
+#include <QImage>
+#include "bench_world.hpp"
+#include "raycast/entity_manager.hpp"
+#include "raycast/spatial_system.hpp"
+#include "raycast/render_system.hpp"
+#include "app_config.hpp"
+#include "exception.hpp"
+
+
+using std::cout;
+using std::cerr;
+using std::string;
+using std::vector;
+using std::ifstream;
+using std::istringstream;
+
+namespace chrono = std::chrono;
+
+
+static const int FRAME_RATE = 60;
+static const int WARMUP_FRAMES = 10;
+
+// Per frame
+static const double WALK_SPEED = 350.0 / FRAME_RATE;
+static const double WALK_TURN = 0.004 * PI;
+static const double SPIN_TURN = 2.0 * PI / 240.0;
+
+
+// Every allocation in the process is counted, including those made by the renderer's worker
+// threads
+static std::atomic<unsigned long> allocCount{0};
+static std::atomic<unsigned long> allocBytes{0};
+
+//===========================================
+// operator new
+//===========================================
+void* operator new(size_t size) {
+  ++allocCount;
+  allocBytes += size;
+
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  return p;
+}
+
+//===========================================
+// operator delete
+//===========================================
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+//===========================================
+// operator delete
+//===========================================
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+struct PathStep {
+  // In camera space
+  Vec2f move;
+  double hRotate;
+  double vRotate;
+};
+
+struct Options {
+  string mapFile;
+  int frames = 500;
+  int threads = -1;
+  string path = "walk";
+  int width = 320;
+  int height = 240;
+};
+
+//===========================================
+// scriptedPath
+//===========================================
+static vector<PathStep> scriptedPath(const string& name) {
+  if (name == "still") {
+    return { PathStep{Vec2f(0, 0), 0, 0} };
+  }
+  else if (name == "spin") {
+    return { PathStep{Vec2f(0, 0), SPIN_TURN, 0} };
+  }
+  else if (name == "walk") {
+    return { PathStep{Vec2f(WALK_SPEED, 0), WALK_TURN, 0} };
+  }
+
+  return {};
+}
+
+//===========================================
+// loadPath
+//
+// One step per line: forward, strafe, turn and pitch per frame. Lines beginning with # are
+// ignored.
+//===========================================
+static vector<PathStep> loadPath(const string& filePath) {
+  ifstream fin(filePath);
+  if (!fin.good()) {
+    EXCEPTION("Error loading camera path; Could not open file '" << filePath << "'");
+  }
+
+  vector<PathStep> steps;
+
+  string line;
+  while (std::getline(fin, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+
+    PathStep step{Vec2f(0, 0), 0, 0};
+
+    istringstream ss(line);
+    ss >> step.move.x >> step.move.y >> step.hRotate >> step.vRotate;
+
+    if (ss.fail()) {
+      EXCEPTION("Error loading camera path; Bad line '" << line << "'");
+    }
+
+    steps.push_back(step);
+  }
+
+  if (steps.empty()) {
+    EXCEPTION("Error loading camera path; File '" << filePath << "' is empty");
+  }
+
+  return steps;
+}
+
+//===========================================
+// percentile
+//
+// samples must be sorted
+//===========================================
+static double percentile(const vector<double>& samples, double p) {
+  size_t idx = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+  return samples[idx];
+}
+
+//===========================================
+// parseOptions
+//===========================================
+static bool parseOptions(int argc, char** argv, Options& opts) {
+  if (argc < 2) {
+    return false;
+  }
+
+  opts.mapFile = argv[1];
+
+  if (argc > 2) {
+    opts.frames = std::stoi(argv[2]);
+  }
+  if (argc > 3) {
+    opts.threads = std::stoi(argv[3]);
+  }
+  if (argc > 4) {
+    opts.path = argv[4];
+  }
+  if (argc > 5) {
+    opts.width = std::stoi(argv[5]);
+  }
+  if (argc > 6) {
+    opts.height = std::stoi(argv[6]);
+  }
+
+  return opts.frames > 0 && opts.width > 0 && opts.height > 0;
+}
+
+//===========================================
+// main
+//===========================================
+int main(int argc, char** argv) {
+  Options opts;
+
+  if (!parseOptions(argc, argv, opts)) {
+    cout << "Usage: " << argv[0] << " map_file [frames] [worker_threads] [path] [w] [h]\n\n"
+      << "  map_file        Relative to the data directory, e.g. doomsweeper/map.svg\n"
+      << "  frames          Frames to measure (default 500)\n"
+      << "  worker_threads  Renderer threads besides the main one (default: cores - 1)\n"
+      << "  path            still, spin, walk (default) or a path file with one\n"
+      << "                  'forward strafe turn pitch' step per line\n"
+      << "  w, h            Render resolution (default 320 240)\n";
+
+    return EXIT_SUCCESS;
+  }
+
+  try {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    // AppConfig treats its arguments as the app's, so don't pass ours on
+    int appArgc = 1;
+    QApplication app(appArgc, argv);
+    AppConfig appConfig(appArgc, argv);
+
+    vector<PathStep> path = scriptedPath(opts.path);
+    if (path.empty()) {
+      path = loadPath(opts.path);
+    }
+
+    QImage frame(opts.width, opts.height, QImage::Format_ARGB32);
+    frame.fill(Qt::black);
+
+    BenchWorld world(appConfig, frame, FRAME_RATE);
+    world.loadMap(appConfig.dataPath(opts.mapFile));
+
+    EntityManager& entityManager = world.entityManager();
+    auto& renderSystem = entityManager.system<RenderSystem>(ComponentKind::C_RENDER);
+    auto& spatialSystem = entityManager.system<SpatialSystem>(ComponentKind::C_SPATIAL);
+
+    if (opts.threads >= 0) {
+      renderSystem.setNumWorkerThreads(opts.threads);
+    }
+
+    vector<double> frameTimes;
+    frameTimes.reserve(opts.frames);
+
+    unsigned long columns = 0;
+    unsigned long allocs = 0;
+    unsigned long maxAllocs = 0;
+    unsigned long bytes = 0;
+
+    // Stands in for the focus system's ray, to measure how often gameplay queries are served by
+    // the ray cast for the centre column
+    IntersectionBuffer probeBuffer;
+    RayCacheStats cacheStats0;
+
+    for (int i = 0; i < WARMUP_FRAMES + opts.frames; ++i) {
+      const PathStep& step = path[i % path.size()];
+
+      if (step.move.x != 0 || step.move.y != 0) {
+        spatialSystem.movePlayer(step.move);
+      }
+      if (step.hRotate != 0) {
+        spatialSystem.hRotateCamera(step.hRotate);
+      }
+      if (step.vRotate != 0) {
+        spatialSystem.vRotateCamera(step.vRotate);
+      }
+
+      if (i == WARMUP_FRAMES) {
+        cacheStats0 = spatialSystem.rayCacheStats();
+      }
+
+      spatialSystem.entitiesAlong3dRay(Vec2f(1, 0), 0, probeBuffer,
+        spatialSystem.sg.player->activationRadius);
+
+      unsigned long allocs0 = allocCount;
+      unsigned long bytes0 = allocBytes;
+      auto t0 = chrono::high_resolution_clock::now();
+
+      renderSystem.render(frame);
+
+      auto t1 = chrono::high_resolution_clock::now();
+      unsigned long frameAllocs = allocCount - allocs0;
+
+      if (i < WARMUP_FRAMES) {
+        continue;
+      }
+
+      frameTimes.push_back(chrono::duration<double>(t1 - t0).count());
+      columns += renderSystem.lastFrameColumns();
+      allocs += frameAllocs;
+      maxAllocs = std::max(maxAllocs, frameAllocs);
+      bytes += allocBytes - bytes0;
+    }
+
+    double total = 0;
+    for (double t : frameTimes) {
+      total += t;
+    }
+
+    vector<double> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+
+    RayCacheStats cacheStats;
+    cacheStats.hits = spatialSystem.rayCacheStats().hits - cacheStats0.hits;
+    cacheStats.misses = spatialSystem.rayCacheStats().misses - cacheStats0.misses;
+
+    cout << "Map: " << opts.mapFile << "\n"
+      << "Resolution: " << opts.width << "x" << opts.height << "\n"
+      << "Worker threads: " << (opts.threads >= 0 ? std::to_string(opts.threads) : "default")
+      << "\n"
+      << "Path: " << opts.path << "\n"
+      << "Frames: " << opts.frames << "\n\n"
+      << "Frame time (ms)\n"
+      << "  mean: " << 1000.0 * total / opts.frames << "\n"
+      << "  p50:  " << 1000.0 * percentile(sorted, 0.5) << "\n"
+      << "  p90:  " << 1000.0 * percentile(sorted, 0.9) << "\n"
+      << "  p99:  " << 1000.0 * percentile(sorted, 0.99) << "\n"
+      << "  max:  " << 1000.0 * sorted.back() << "\n\n"
+      << "Columns/sec: " << (total > 0 ? columns / total : 0) << "\n\n"
+      << "Allocations per frame\n"
+      << "  mean:  " << static_cast<double>(allocs) / opts.frames << "\n"
+      << "  max:   " << maxAllocs << "\n"
+      << "  bytes: " << static_cast<double>(bytes) / opts.frames << "\n\n"
+      << "Ray cache hit rate: " << 100.0 * cacheStats.hitRate() << "%\n";
+  }
+  catch (const std::exception& e) {
+    cerr << "Error: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}